@@ -13,6 +13,8 @@ public:
     DirectX::XMFLOAT3 GetPosition() const { return m_position; }
     
     void SetRotation(float pitch, float yaw);
+    float GetPitch() const { return m_pitch; }
+    float GetYaw() const { return m_yaw; }
     void SetAspectRatio(float aspectRatio);
     
     void MoveForward(float distance);
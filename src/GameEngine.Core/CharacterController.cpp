@@ -0,0 +1,52 @@
+#include "CharacterController.h"
+#include "PhysicsWorld.h"
+
+using namespace DirectX;
+
+CharacterController::CharacterController(const PhysicsWorld* physics)
+    : m_physics(physics)
+    , m_center(0.0f, 0.0f, 0.0f)
+    , m_halfExtents(0.3f, 0.9f, 0.3f)
+    , m_eyeOffset(0.7f)
+    , m_verticalVelocity(0.0f)
+    , m_gravity(-20.0f)
+    , m_jumpSpeed(7.0f)
+    , m_grounded(false)
+{
+}
+
+void CharacterController::SetEyePosition(const XMFLOAT3& eye) {
+    m_center = XMFLOAT3(eye.x, eye.y - m_eyeOffset, eye.z);
+    m_verticalVelocity = 0.0f;
+    m_grounded = false;
+}
+
+XMFLOAT3 CharacterController::GetEyePosition() const {
+    return XMFLOAT3(m_center.x, m_center.y + m_eyeOffset, m_center.z);
+}
+
+void CharacterController::Move(const XMFLOAT3& displacement) {
+    m_center = m_physics->SweepAabb(m_center, m_halfExtents, XMFLOAT3(displacement.x, 0.0f, displacement.z));
+}
+
+void CharacterController::Jump() {
+    if (m_grounded) {
+        m_verticalVelocity = m_jumpSpeed;
+        m_grounded = false;
+    }
+}
+
+void CharacterController::Update(float deltaTime) {
+    m_verticalVelocity += m_gravity * deltaTime;
+
+    uint8_t blocked = 0;
+    float dy = m_verticalVelocity * deltaTime;
+    m_center = m_physics->SweepAabb(m_center, m_halfExtents, XMFLOAT3(0.0f, dy, 0.0f), &blocked);
+
+    if (blocked & 2) {
+        m_grounded = dy < 0.0f;
+        m_verticalVelocity = 0.0f;
+    } else {
+        m_grounded = false;
+    }
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <DirectXMath.h>
+
+class PhysicsWorld;
+
+// Walking player body: an upright box that slides along voxel walls, falls
+// under gravity and can jump when standing on something. Movement is
+// resolved immediately through PhysicsWorld::SweepAabb.
+class CharacterController {
+public:
+    explicit CharacterController(const PhysicsWorld* physics);
+
+    void SetEyePosition(const DirectX::XMFLOAT3& eye);
+    DirectX::XMFLOAT3 GetEyePosition() const;
+
+    // Horizontal displacement; the vertical component is ignored
+    void Move(const DirectX::XMFLOAT3& displacement);
+    void Jump();
+    void Update(float deltaTime);
+
+    bool IsGrounded() const { return m_grounded; }
+
+private:
+    const PhysicsWorld* m_physics;
+
+    DirectX::XMFLOAT3 m_center;
+    DirectX::XMFLOAT3 m_halfExtents;
+    float m_eyeOffset;
+    float m_verticalVelocity;
+    float m_gravity;
+    float m_jumpSpeed;
+    bool m_grounded;
+};
@@ -0,0 +1,79 @@
+#include "ChunkPageFile.h"
+#include <random>
+#include <string>
+
+ChunkPageFile::ChunkPageFile()
+    : m_slotCount(0)
+{
+}
+
+ChunkPageFile::~ChunkPageFile() {
+    if (m_file.is_open()) {
+        m_file.close();
+        std::error_code error;
+        std::filesystem::remove(m_path, error);
+    }
+}
+
+uint32_t ChunkPageFile::Write(const VoxelBlock& block) {
+    if (!m_file.is_open() && !Open()) {
+        return InvalidSlot;
+    }
+
+    uint32_t slot;
+    if (!m_freeSlots.empty()) {
+        slot = m_freeSlots.back();
+        m_freeSlots.pop_back();
+    } else {
+        slot = m_slotCount++;
+    }
+
+    m_file.seekp(static_cast<std::streamoff>(slot) * sizeof(VoxelBlock));
+    m_file.write(reinterpret_cast<const char*>(&block), sizeof(VoxelBlock));
+    if (!m_file) {
+        m_file.clear();
+        m_freeSlots.push_back(slot);
+        return InvalidSlot;
+    }
+    return slot;
+}
+
+bool ChunkPageFile::Read(uint32_t slot, VoxelBlock& block) {
+    if (!m_file.is_open() || slot >= m_slotCount) {
+        return false;
+    }
+
+    m_file.seekg(static_cast<std::streamoff>(slot) * sizeof(VoxelBlock));
+    m_file.read(reinterpret_cast<char*>(&block), sizeof(VoxelBlock));
+    if (!m_file) {
+        m_file.clear();
+        return false;
+    }
+    return true;
+}
+
+void ChunkPageFile::Free(uint32_t slot) {
+    if (slot < m_slotCount) {
+        m_freeSlots.push_back(slot);
+    }
+}
+
+void ChunkPageFile::Clear() {
+    m_freeSlots.clear();
+    for (uint32_t slot = m_slotCount; slot > 0; --slot) {
+        m_freeSlots.push_back(slot - 1);
+    }
+}
+
+bool ChunkPageFile::Open() {
+    std::error_code error;
+    std::filesystem::path directory = std::filesystem::temp_directory_path(error);
+    if (error) {
+        return false;
+    }
+
+    std::random_device random;
+    m_path = directory / ("GameEngine-" + std::to_string(random()) + ".chunks");
+    m_file.open(m_path, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+    return m_file.is_open();
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+#include "VoxelChunk.h"
+
+// Temporary file of fixed-size voxel block records, used to hold evicted
+// chunks that cannot be regenerated from the seed. Slots are reused after
+// being read back; the file is deleted when the page file is destroyed.
+class ChunkPageFile {
+public:
+    static constexpr uint32_t InvalidSlot = UINT32_MAX;
+
+    ChunkPageFile();
+    ~ChunkPageFile();
+
+    ChunkPageFile(const ChunkPageFile&) = delete;
+    ChunkPageFile& operator=(const ChunkPageFile&) = delete;
+
+    // Returns the slot written, or InvalidSlot if the file is unavailable
+    uint32_t Write(const VoxelBlock& block);
+    bool Read(uint32_t slot, VoxelBlock& block);
+    void Free(uint32_t slot);
+
+    // Forgets every slot; the file is kept and overwritten
+    void Clear();
+
+    uint32_t GetUsedSlots() const { return m_slotCount - static_cast<uint32_t>(m_freeSlots.size()); }
+    uint64_t GetFileBytes() const { return static_cast<uint64_t>(m_slotCount) * sizeof(VoxelBlock); }
+
+private:
+    bool Open();
+
+    std::filesystem::path m_path;
+    std::fstream m_file;
+    std::vector<uint32_t> m_freeSlots;
+    uint32_t m_slotCount;
+};
@@ -0,0 +1,141 @@
+#include "ChunkSizeBenchmark.h"
+#include "WorldGenerator.h"
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    // Region granularity in voxels, a whole number of chunks at every size
+    constexpr int REGION_SPAN = 64;
+
+    uint32_t Hash(uint32_t value) {
+        value ^= value >> 16;
+        value *= 0x7FEB352Du;
+        value ^= value >> 15;
+        value *= 0x846CA68Bu;
+        value ^= value >> 16;
+        return value;
+    }
+
+    template <int Size>
+    ChunkSizeStats MeasureChunkSize(int seed, int worldRadius, const std::vector<VoxelPosition>& samples,
+                                    ThreadPool* threadPool) {
+        using Dimensions = ChunkDimensions<Size>;
+        using Chunk = BasicVoxelChunk<Size>;
+        using ChunkMap = std::unordered_map<ChunkCoord, std::unique_ptr<Chunk>>;
+        constexpr int CHUNKS_PER_SPAN = REGION_SPAN / Size;
+
+        ChunkSizeStats stats = {};
+        stats.chunkSize = Size;
+
+        std::vector<ChunkCoord> region;
+        int horizontal = worldRadius * CHUNKS_PER_SPAN;
+        for (int cx = -horizontal; cx < horizontal; ++cx) {
+            for (int cy = -CHUNKS_PER_SPAN; cy < CHUNKS_PER_SPAN; ++cy) {
+                for (int cz = -horizontal; cz < horizontal; ++cz) {
+                    region.push_back(ChunkCoord{ cx, cy, cz });
+                }
+            }
+        }
+
+        auto start = Clock::now();
+        BasicWorldGenerator<Size> generator(seed, region, threadPool);
+        std::vector<std::unique_ptr<Chunk>> completed;
+        generator.Step(region.size(), completed);
+        stats.generationMilliseconds = std::chrono::duration<float, std::milli>(Clock::now() - start).count();
+
+        ChunkMap chunks;
+        chunks.reserve(completed.size());
+        for (std::unique_ptr<Chunk>& chunk : completed) {
+            ChunkCoord coord{ chunk->GetChunkX(), chunk->GetChunkY(), chunk->GetChunkZ() };
+            chunks.emplace(coord, std::move(chunk));
+        }
+        auto find = [&chunks](int x, int y, int z) -> const Chunk* {
+            auto it = chunks.find(ChunkCoord{ x, y, z });
+            return it != chunks.end() ? it->second.get() : nullptr;
+        };
+
+        // Meshes are measured and dropped one chunk at a time
+        std::unordered_set<const typename Chunk::Block*> blocks;
+        double meshSeconds = 0.0;
+        double remeshSeconds = 0.0;
+        uint32_t remeshed = 0;
+        for (auto& pair : chunks) {
+            const ChunkCoord& c = pair.first;
+            Chunk& chunk = *pair.second;
+            typename Chunk::Neighbors neighbors{ {
+                find(c.x, c.y, c.z + 1), find(c.x, c.y, c.z - 1),
+                find(c.x, c.y + 1, c.z), find(c.x, c.y - 1, c.z),
+                find(c.x + 1, c.y, c.z), find(c.x - 1, c.y, c.z)
+            } };
+
+            auto meshStart = Clock::now();
+            chunk.RegenerateMesh(neighbors);
+            double seconds = std::chrono::duration<double>(Clock::now() - meshStart).count();
+            meshSeconds += seconds;
+            if (!chunk.IsEmpty()) {
+                remeshSeconds += seconds;
+                ++remeshed;
+            }
+
+            if (!chunk.GetIndices().empty()) {
+                ++stats.drawCalls;
+            }
+            stats.meshBytes += chunk.GetVertices().size() * sizeof(Vertex) + chunk.GetIndices().size() * sizeof(uint32_t);
+            chunk.ReleaseMeshData();
+
+            stats.solidVoxels += chunk.GetBlock()->solidCount;
+            blocks.insert(chunk.GetBlock().get());
+        }
+        stats.chunks = static_cast<uint32_t>(chunks.size());
+        stats.meshMilliseconds = static_cast<float>(meshSeconds * 1000.0);
+        if (remeshed > 0) {
+            stats.remeshMicroseconds = static_cast<float>(remeshSeconds * 1e6 / remeshed);
+        }
+
+        // Same path as VoxelEngine::GetVoxel: map lookup, then the block
+        uint64_t checksum = 0;
+        auto lookupStart = Clock::now();
+        for (const VoxelPosition& p : samples) {
+            auto it = chunks.find(WorldToChunkCoord<Size>(p.x, p.y, p.z));
+            uint8_t voxel = it != chunks.end()
+                ? it->second->GetVoxel(Dimensions::ToLocal(p.x), Dimensions::ToLocal(p.y), Dimensions::ToLocal(p.z))
+                : static_cast<uint8_t>(BlockType::Air);
+            checksum = checksum * 31 + voxel;
+        }
+        double lookupSeconds = std::chrono::duration<double>(Clock::now() - lookupStart).count();
+        stats.lookupChecksum = checksum;
+        if (!samples.empty()) {
+            stats.lookupNanoseconds = static_cast<float>(lookupSeconds * 1e9 / samples.size());
+        }
+
+        // A map node holds the entry and a next pointer; buckets are one pointer each
+        stats.voxelBytes = blocks.size() * sizeof(typename Chunk::Block);
+        stats.chunkBytes = chunks.size() * (sizeof(Chunk) + sizeof(typename ChunkMap::value_type) + sizeof(void*)) +
+                           chunks.bucket_count() * sizeof(void*);
+        return stats;
+    }
+}
+
+ChunkSizeBenchmarkStats MeasureChunkSizes(int seed, int worldRadius, uint32_t lookups, ThreadPool* threadPool) {
+    worldRadius = std::max(worldRadius, 1);
+    int extent = worldRadius * REGION_SPAN;
+
+    std::vector<VoxelPosition> samples(lookups);
+    for (uint32_t i = 0; i < lookups; ++i) {
+        samples[i].x = static_cast<int>(Hash(i * 3) % (2 * extent)) - extent;
+        samples[i].y = static_cast<int>(Hash(i * 3 + 1) % (2 * REGION_SPAN)) - REGION_SPAN;
+        samples[i].z = static_cast<int>(Hash(i * 3 + 2) % (2 * extent)) - extent;
+    }
+
+    ChunkSizeBenchmarkStats stats = {};
+    stats.sizes[0] = MeasureChunkSize<CHUNK_SIZE_VARIANTS[0]>(seed, worldRadius, samples, threadPool);
+    stats.sizes[1] = MeasureChunkSize<CHUNK_SIZE_VARIANTS[1]>(seed, worldRadius, samples, threadPool);
+    stats.sizes[2] = MeasureChunkSize<CHUNK_SIZE_VARIANTS[2]>(seed, worldRadius, samples, threadPool);
+    return stats;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstdint>
+
+class ThreadPool;
+
+// Chunk sizes built side by side for comparison, smallest first; the engine
+// itself runs at CHUNK_SIZE, one of these
+constexpr uint32_t CHUNK_SIZE_VARIANT_COUNT = 3;
+constexpr int CHUNK_SIZE_VARIANTS[CHUNK_SIZE_VARIANT_COUNT] = { 16, 32, 64 };
+
+struct ChunkSizeStats {
+    int chunkSize;
+    uint32_t chunks;                // chunk map entries
+    uint32_t drawCalls;             // chunks with a mesh
+    uint64_t solidVoxels;
+    uint64_t lookupChecksum;        // over the sampled voxels, equal for equal worlds
+    float generationMilliseconds;
+    float meshMilliseconds;         // every chunk, on one thread
+    float remeshMicroseconds;       // average over non-empty chunks: the cost of an edit
+    float lookupNanoseconds;        // per world voxel read through the chunk map
+    uint64_t voxelBytes;            // distinct voxel blocks
+    uint64_t meshBytes;             // CPU vertices and indices
+    uint64_t chunkBytes;            // chunk objects and map entries, approximate
+};
+
+struct ChunkSizeBenchmarkStats {
+    ChunkSizeStats sizes[CHUNK_SIZE_VARIANT_COUNT];
+};
+
+// Generates, meshes and samples the same scratch region once per chunk
+// size. The region is 64 * worldRadius voxels either side of the origin in
+// x and z and [-64, 64) in y, whole chunks at every size, and every size
+// reads the same `lookups` pseudo-random voxels.
+ChunkSizeBenchmarkStats MeasureChunkSizes(int seed, int worldRadius, uint32_t lookups, ThreadPool* threadPool);
@@ -0,0 +1,220 @@
+#include "CommandBuffer.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+    // Sequential reader over an already validated payload
+    class PayloadReader {
+    public:
+        explicit PayloadReader(const uint8_t* data) : m_data(data) {}
+
+        template <typename T>
+        T Read() {
+            T value;
+            std::memcpy(&value, m_data, sizeof(T));
+            m_data += sizeof(T);
+            return value;
+        }
+
+    private:
+        const uint8_t* m_data;
+    };
+
+    class ResultWriter {
+    public:
+        explicit ResultWriter(uint8_t* data) : m_data(data), m_size(0) {}
+
+        template <typename T>
+        void Write(const T& value) {
+            std::memcpy(m_data + m_size, &value, sizeof(T));
+            m_size += sizeof(T);
+        }
+
+        size_t Size() const { return m_size; }
+
+    private:
+        uint8_t* m_data;
+        size_t m_size;
+    };
+
+    // Voxels in the inclusive box read from a FillVoxels payload
+    uint64_t GetFillVolume(const uint8_t* payload) {
+        int32_t box[6];
+        std::memcpy(box, payload, sizeof(box));
+        uint64_t volume = 1;
+        for (int axis = 0; axis < 3; ++axis) {
+            int64_t extent = static_cast<int64_t>(box[axis + 3]) - box[axis];
+            volume *= static_cast<uint64_t>(extent < 0 ? -extent : extent) + 1;
+        }
+        return volume;
+    }
+
+    int32_t Validate(const uint8_t* data, size_t size, size_t resultCapacity, uint32_t& commandCount) {
+        if (size < sizeof(CommandBufferHeader)) {
+            return CommandBufferBadHeader;
+        }
+
+        CommandBufferHeader header;
+        std::memcpy(&header, data, sizeof(header));
+        if (header.magic != COMMAND_BUFFER_MAGIC || header.flags != 0 || header.commandCount > INT32_MAX) {
+            return CommandBufferBadHeader;
+        }
+        if (header.version != COMMAND_BUFFER_VERSION) {
+            return CommandBufferUnsupportedVersion;
+        }
+
+        size_t offset = sizeof(CommandBufferHeader);
+        size_t resultSize = 0;
+        for (uint32_t i = 0; i < header.commandCount; ++i) {
+            if (offset >= size) {
+                return CommandBufferTruncated;
+            }
+
+            uint8_t opcode = data[offset];
+            size_t payloadSize, commandResultSize;
+            if (!GetEngineCommandLayout(opcode, payloadSize, commandResultSize)) {
+                return CommandBufferUnknownCommand;
+            }
+
+            offset += 1 + payloadSize;
+            if (offset > size) {
+                return CommandBufferTruncated;
+            }
+            if (static_cast<EngineCommand>(opcode) == EngineCommand::FillVoxels &&
+                GetFillVolume(data + offset - payloadSize) > MAX_FILL_VOLUME) {
+                return CommandBufferFillTooLarge;
+            }
+            resultSize += commandResultSize;
+        }
+
+        if (resultSize > resultCapacity) {
+            return CommandBufferResultOverflow;
+        }
+
+        commandCount = header.commandCount;
+        return CommandBufferOk;
+    }
+
+    void FillVoxels(CommandContext& context, int x0, int y0, int z0, int x1, int y1, int z1, uint8_t blockType) {
+        if (x0 > x1) std::swap(x0, x1);
+        if (y0 > y1) std::swap(y0, y1);
+        if (z0 > z1) std::swap(z0, z1);
+
+        // 64-bit counters, so a box ending at INT_MAX still terminates
+        for (int64_t z = z0; z <= z1; ++z) {
+            for (int64_t y = y0; y <= y1; ++y) {
+                for (int64_t x = x0; x <= x1; ++x) {
+                    context.SetVoxel(static_cast<int>(x), static_cast<int>(y), static_cast<int>(z), blockType);
+                }
+            }
+        }
+    }
+}
+
+bool GetEngineCommandLayout(uint8_t opcode, size_t& payloadSize, size_t& resultSize) {
+    resultSize = 0;
+    switch (static_cast<EngineCommand>(opcode)) {
+        case EngineCommand::SetCameraPosition: payloadSize = 3 * sizeof(float); return true;
+        case EngineCommand::SetCameraRotation: payloadSize = 2 * sizeof(float); return true;
+        case EngineCommand::MoveCameraForward:
+        case EngineCommand::MoveCameraRight:
+        case EngineCommand::MoveCameraUp: payloadSize = sizeof(float); return true;
+        case EngineCommand::SetVoxel: payloadSize = 3 * sizeof(int32_t) + 1; return true;
+        case EngineCommand::GetVoxel: payloadSize = 3 * sizeof(int32_t); resultSize = 1; return true;
+        case EngineCommand::GenerateTerrain: payloadSize = sizeof(int32_t); return true;
+        case EngineCommand::GetCameraPosition: payloadSize = 0; resultSize = 3 * sizeof(float); return true;
+        case EngineCommand::FillVoxels: payloadSize = 6 * sizeof(int32_t) + 1; return true;
+        case EngineCommand::SetEditorMode: payloadSize = 1; return true;
+        default: return false;
+    }
+}
+
+int32_t ExecuteCommands(CommandContext& context, const uint8_t* data, size_t size,
+                        uint8_t* results, size_t resultCapacity, size_t* resultSize) {
+    if (resultSize) {
+        *resultSize = 0;
+    }
+    if (!data || (!results && resultCapacity > 0)) {
+        return CommandBufferInvalidArgument;
+    }
+    if (!context.IsInitialized()) {
+        return CommandBufferNotInitialized;
+    }
+
+    uint32_t commandCount = 0;
+    int32_t status = Validate(data, size, resultCapacity, commandCount);
+    if (status != CommandBufferOk) {
+        return status;
+    }
+
+    PayloadReader reader(data + sizeof(CommandBufferHeader));
+    ResultWriter writer(results);
+
+    for (uint32_t i = 0; i < commandCount; ++i) {
+        switch (static_cast<EngineCommand>(reader.Read<uint8_t>())) {
+            case EngineCommand::SetCameraPosition: {
+                float x = reader.Read<float>();
+                float y = reader.Read<float>();
+                float z = reader.Read<float>();
+                context.SetCameraPosition(x, y, z);
+                break;
+            }
+            case EngineCommand::SetCameraRotation: {
+                float pitch = reader.Read<float>();
+                float yaw = reader.Read<float>();
+                context.SetCameraRotation(pitch, yaw);
+                break;
+            }
+            case EngineCommand::MoveCameraForward:
+                context.MoveCameraForward(reader.Read<float>());
+                break;
+            case EngineCommand::MoveCameraRight:
+                context.MoveCameraRight(reader.Read<float>());
+                break;
+            case EngineCommand::MoveCameraUp:
+                context.MoveCameraUp(reader.Read<float>());
+                break;
+            case EngineCommand::SetVoxel: {
+                int32_t x = reader.Read<int32_t>();
+                int32_t y = reader.Read<int32_t>();
+                int32_t z = reader.Read<int32_t>();
+                context.SetVoxel(x, y, z, reader.Read<uint8_t>());
+                break;
+            }
+            case EngineCommand::GetVoxel: {
+                int32_t x = reader.Read<int32_t>();
+                int32_t y = reader.Read<int32_t>();
+                int32_t z = reader.Read<int32_t>();
+                writer.Write(context.GetVoxel(x, y, z));
+                break;
+            }
+            case EngineCommand::GenerateTerrain:
+                context.GenerateTerrain(reader.Read<int32_t>());
+                break;
+            case EngineCommand::GetCameraPosition: {
+                float x, y, z;
+                context.GetCameraPosition(x, y, z);
+                writer.Write(x);
+                writer.Write(y);
+                writer.Write(z);
+                break;
+            }
+            case EngineCommand::FillVoxels: {
+                int32_t box[6];
+                for (int32_t& v : box) {
+                    v = reader.Read<int32_t>();
+                }
+                FillVoxels(context, box[0], box[1], box[2], box[3], box[4], box[5], reader.Read<uint8_t>());
+                break;
+            }
+            case EngineCommand::SetEditorMode:
+                context.SetEditorMode(reader.Read<uint8_t>() != 0);
+                break;
+        }
+    }
+
+    if (resultSize) {
+        *resultSize = writer.Size();
+    }
+    return static_cast<int32_t>(commandCount);
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Binary command stream accepted by ExecuteCommandBuffer. All values are
+// little-endian and unaligned; the stream is
+//
+//   CommandBufferHeader
+//   commandCount x { uint8_t opcode, payload }
+//
+// Every opcode has a fixed payload size, listed next to it. Commands that
+// produce output append it, in command order, to the caller's result buffer.
+constexpr uint32_t COMMAND_BUFFER_MAGIC = 0x42434547; // "GECB"
+constexpr uint16_t COMMAND_BUFFER_VERSION = 1;
+
+// Largest box one FillVoxels command may cover, in voxels; a larger one
+// rejects the whole buffer with CommandBufferFillTooLarge
+constexpr uint64_t MAX_FILL_VOLUME = 1u << 20;
+
+#pragma pack(push, 1)
+struct CommandBufferHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t flags;         // reserved, must be 0
+    uint32_t commandCount;
+};
+#pragma pack(pop)
+
+enum class EngineCommand : uint8_t {
+    SetCameraPosition = 1,  // float x, y, z
+    SetCameraRotation = 2,  // float pitch, yaw
+    MoveCameraForward = 3,  // float distance
+    MoveCameraRight = 4,    // float distance
+    MoveCameraUp = 5,       // float distance
+    SetVoxel = 6,           // int32 x, y, z; uint8 blockType
+    GetVoxel = 7,           // int32 x, y, z               -> uint8 blockType
+    GenerateTerrain = 8,    // int32 seed
+    GetCameraPosition = 9,  // (none)                      -> float x, y, z
+    FillVoxels = 10,        // int32 x0, y0, z0, x1, y1, z1; uint8 blockType (inclusive box)
+    SetEditorMode = 11,     // uint8 enabled
+};
+
+// Return codes of ExecuteCommandBuffer; non-negative values are the number
+// of commands executed
+enum CommandBufferStatus : int32_t {
+    CommandBufferOk = 0,
+    CommandBufferInvalidArgument = -1,
+    CommandBufferBadHeader = -2,
+    CommandBufferUnsupportedVersion = -3,
+    CommandBufferTruncated = -4,
+    CommandBufferUnknownCommand = -5,
+    CommandBufferResultOverflow = -6,
+    CommandBufferNotInitialized = -7,
+    CommandBufferFillTooLarge = -8,
+};
+
+// Engine operations a command buffer drives. EngineCore implements them
+// with the same helpers as its C exports, so a buffered command behaves
+// exactly like the corresponding call.
+class CommandContext {
+public:
+    virtual ~CommandContext() = default;
+
+    virtual bool IsInitialized() const = 0;
+
+    virtual void SetCameraPosition(float x, float y, float z) = 0;
+    virtual void SetCameraRotation(float pitch, float yaw) = 0;
+    virtual void MoveCameraForward(float distance) = 0;
+    virtual void MoveCameraRight(float distance) = 0;
+    virtual void MoveCameraUp(float distance) = 0;
+    virtual void GetCameraPosition(float& x, float& y, float& z) const = 0;
+
+    virtual void SetVoxel(int x, int y, int z, uint8_t blockType) = 0;
+    virtual uint8_t GetVoxel(int x, int y, int z) const = 0;
+    virtual void GenerateTerrain(int seed) = 0;
+    virtual void SetEditorMode(bool enabled) = 0;
+};
+
+// Payload and result sizes per opcode; false for unknown opcodes
+bool GetEngineCommandLayout(uint8_t opcode, size_t& payloadSize, size_t& resultSize);
+
+// Validates the whole stream first so a malformed buffer is rejected before
+// any command is applied, then executes it in a single pass.
+int32_t ExecuteCommands(CommandContext& context, const uint8_t* data, size_t size,
+                        uint8_t* results, size_t resultCapacity, size_t* resultSize);
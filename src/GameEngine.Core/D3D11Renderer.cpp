@@ -0,0 +1,405 @@
+#include "D3D11Renderer.h"
+#include "Camera.h"
+#include <d3dcompiler.h>
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+    // Same lighting as SoftwareRenderer: a fixed sun plus ambient, taken
+    // from the first vertex of each triangle
+    const char CHUNK_SHADER[] = R"(
+cbuffer Frame : register(b0) {
+    row_major float4x4 viewProjection;
+};
+
+struct VertexInput {
+    float3 position : POSITION;
+    float3 normal : NORMAL;
+    float2 texCoord : TEXCOORD0;
+    float3 color : COLOR0;
+};
+
+struct PixelInput {
+    float4 position : SV_POSITION;
+    nointerpolation float3 color : COLOR0;
+};
+
+PixelInput VSMain(VertexInput input) {
+    PixelInput output;
+    output.position = mul(float4(input.position, 1.0f), viewProjection);
+    float facing = dot(input.normal, float3(0.3015f, 0.9045f, 0.3015f));
+    output.color = input.color * (0.35f + 0.65f * max(facing, 0.0f));
+    return output;
+}
+
+float4 PSMain(PixelInput input) : SV_TARGET {
+    return float4(input.color, 1.0f);
+}
+)";
+
+    bool CompileShader(const char* entryPoint, const char* target, ComPtr<ID3DBlob>& code) {
+        ComPtr<ID3DBlob> errors;
+        HRESULT hr = D3DCompile(CHUNK_SHADER, sizeof(CHUNK_SHADER) - 1, "ChunkShader", nullptr, nullptr,
+                                entryPoint, target, D3DCOMPILE_OPTIMIZATION_LEVEL3, 0, &code, &errors);
+        return SUCCEEDED(hr);
+    }
+}
+
+D3D11Renderer::D3D11Renderer()
+    : m_arena(nullptr)
+    , m_arenaGeneration(0)
+    , m_argumentCapacity(0)
+    , m_width(0)
+    , m_height(0)
+{
+}
+
+D3D11Renderer::~D3D11Renderer() {
+    Shutdown();
+}
+
+bool D3D11Renderer::Initialize(void* hwnd, int width, int height) {
+    m_width = width;
+    m_height = height;
+    
+    if (!CreateDeviceAndSwapChain(hwnd, width, height)) {
+        return false;
+    }
+    
+    if (!CreateRenderTargets()) {
+        return false;
+    }
+    
+    // Create depth stencil state
+    D3D11_DEPTH_STENCIL_DESC depthStencilDesc = {};
+    depthStencilDesc.DepthEnable = TRUE;
+    depthStencilDesc.DepthWriteMask = D3D11_DEPTH_WRITE_MASK_ALL;
+    depthStencilDesc.DepthFunc = D3D11_COMPARISON_LESS;
+    depthStencilDesc.StencilEnable = FALSE;
+    
+    HRESULT hr = m_device->CreateDepthStencilState(&depthStencilDesc, &m_depthStencilState);
+    if (FAILED(hr)) {
+        return false;
+    }
+    
+    // Create rasterizer state
+    D3D11_RASTERIZER_DESC rasterizerDesc = {};
+    rasterizerDesc.FillMode = D3D11_FILL_SOLID;
+    rasterizerDesc.CullMode = D3D11_CULL_BACK;
+    rasterizerDesc.FrontCounterClockwise = TRUE;     // chunk mesher winding
+    rasterizerDesc.DepthClipEnable = TRUE;
+    
+    hr = m_device->CreateRasterizerState(&rasterizerDesc, &m_rasterizerState);
+    if (FAILED(hr)) {
+        return false;
+    }
+    
+    // Set viewport
+    D3D11_VIEWPORT viewport = {};
+    viewport.TopLeftX = 0;
+    viewport.TopLeftY = 0;
+    viewport.Width = static_cast<float>(width);
+    viewport.Height = static_cast<float>(height);
+    viewport.MinDepth = 0.0f;
+    viewport.MaxDepth = 1.0f;
+    
+    m_context->RSSetViewports(1, &viewport);
+    m_context->OMSetDepthStencilState(m_depthStencilState.Get(), 1);
+    m_context->RSSetState(m_rasterizerState.Get());
+    
+    return CreatePipeline();
+}
+
+void D3D11Renderer::Shutdown() {
+    m_argumentBuffer.Reset();
+    m_indexBuffer.Reset();
+    m_vertexBuffer.Reset();
+    m_arena = nullptr;
+    m_argumentCapacity = 0;
+    m_frameConstants.Reset();
+    m_inputLayout.Reset();
+    m_pixelShader.Reset();
+    m_vertexShader.Reset();
+    CleanupRenderTargets();
+    m_swapChain.Reset();
+    m_context.Reset();
+    m_device.Reset();
+}
+
+void D3D11Renderer::Resize(int width, int height) {
+    if (!m_swapChain) return;
+    
+    m_width = width;
+    m_height = height;
+    
+    CleanupRenderTargets();
+    
+    HRESULT hr = m_swapChain->ResizeBuffers(0, width, height, DXGI_FORMAT_UNKNOWN, 0);
+    if (FAILED(hr)) {
+        return;
+    }
+    
+    CreateRenderTargets();
+    
+    // Update viewport
+    D3D11_VIEWPORT viewport = {};
+    viewport.TopLeftX = 0;
+    viewport.TopLeftY = 0;
+    viewport.Width = static_cast<float>(width);
+    viewport.Height = static_cast<float>(height);
+    viewport.MinDepth = 0.0f;
+    viewport.MaxDepth = 1.0f;
+    
+    m_context->RSSetViewports(1, &viewport);
+}
+
+void D3D11Renderer::BeginFrame() {
+    Clear(0.1f, 0.1f, 0.15f, 1.0f);
+}
+
+void D3D11Renderer::EndFrame() {
+    if (m_swapChain) {
+        m_swapChain->Present(1, 0); // VSync on
+    }
+}
+
+void D3D11Renderer::Clear(float r, float g, float b, float a) {
+    float clearColor[4] = { r, g, b, a };
+    m_context->ClearRenderTargetView(m_renderTargetView.Get(), clearColor);
+    m_context->ClearDepthStencilView(m_depthStencilView.Get(), D3D11_CLEAR_DEPTH | D3D11_CLEAR_STENCIL, 1.0f, 0);
+}
+
+void D3D11Renderer::DrawMeshes(const MeshArena& arena, const std::vector<DrawIndexedIndirectArgs>& commands,
+                               const Camera& camera) {
+    if (commands.empty() || !m_vertexShader || !UploadArena(arena)) {
+        return;
+    }
+    
+    // The argument array is copied as is; its layout matches the indirect args
+    if (commands.size() > m_argumentCapacity) {
+        size_t capacity = std::max(commands.size(), m_argumentCapacity * 2);
+        m_argumentBuffer.Reset();
+        m_argumentCapacity = 0;
+        if (!CreateBuffer(0, D3D11_RESOURCE_MISC_DRAWINDIRECT_ARGS, nullptr,
+                          capacity * sizeof(DrawIndexedIndirectArgs), m_argumentBuffer)) {
+            return;
+        }
+        m_argumentCapacity = capacity;
+    }
+    D3D11_BOX arguments = { 0, 0, 0, static_cast<UINT>(commands.size() * sizeof(DrawIndexedIndirectArgs)), 1, 1 };
+    m_context->UpdateSubresource(m_argumentBuffer.Get(), 0, &arguments, commands.data(), 0, 0);
+    
+    D3D11_MAPPED_SUBRESOURCE mapped;
+    if (FAILED(m_context->Map(m_frameConstants.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped))) {
+        return;
+    }
+    DirectX::XMFLOAT4X4 viewProjection;
+    DirectX::XMStoreFloat4x4(&viewProjection,
+                             DirectX::XMMatrixMultiply(camera.GetViewMatrix(), camera.GetProjectionMatrix()));
+    std::memcpy(mapped.pData, &viewProjection, sizeof(viewProjection));
+    m_context->Unmap(m_frameConstants.Get(), 0);
+    
+    UINT stride = sizeof(Vertex);
+    UINT offset = 0;
+    m_context->IASetInputLayout(m_inputLayout.Get());
+    m_context->IASetVertexBuffers(0, 1, m_vertexBuffer.GetAddressOf(), &stride, &offset);
+    m_context->IASetIndexBuffer(m_indexBuffer.Get(), DXGI_FORMAT_R32_UINT, 0);
+    m_context->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+    m_context->VSSetShader(m_vertexShader.Get(), nullptr, 0);
+    m_context->VSSetConstantBuffers(0, 1, m_frameConstants.GetAddressOf());
+    m_context->PSSetShader(m_pixelShader.Get(), nullptr, 0);
+    
+    for (size_t i = 0; i < commands.size(); ++i) {
+        m_context->DrawIndexedInstancedIndirect(m_argumentBuffer.Get(),
+                                                static_cast<UINT>(i * sizeof(DrawIndexedIndirectArgs)));
+    }
+}
+
+bool D3D11Renderer::CreatePipeline() {
+    ComPtr<ID3DBlob> vertexCode;
+    ComPtr<ID3DBlob> pixelCode;
+    if (!CompileShader("VSMain", "vs_5_0", vertexCode) || !CompileShader("PSMain", "ps_5_0", pixelCode)) {
+        return false;
+    }
+    
+    HRESULT hr = m_device->CreateVertexShader(vertexCode->GetBufferPointer(), vertexCode->GetBufferSize(),
+                                              nullptr, &m_vertexShader);
+    if (FAILED(hr)) {
+        return false;
+    }
+    hr = m_device->CreatePixelShader(pixelCode->GetBufferPointer(), pixelCode->GetBufferSize(),
+                                     nullptr, &m_pixelShader);
+    if (FAILED(hr)) {
+        return false;
+    }
+    
+    const D3D11_INPUT_ELEMENT_DESC layout[] = {
+        { "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, static_cast<UINT>(offsetof(Vertex, position)),
+          D3D11_INPUT_PER_VERTEX_DATA, 0 },
+        { "NORMAL", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, static_cast<UINT>(offsetof(Vertex, normal)),
+          D3D11_INPUT_PER_VERTEX_DATA, 0 },
+        { "TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 0, static_cast<UINT>(offsetof(Vertex, texCoord)),
+          D3D11_INPUT_PER_VERTEX_DATA, 0 },
+        { "COLOR", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, static_cast<UINT>(offsetof(Vertex, color)),
+          D3D11_INPUT_PER_VERTEX_DATA, 0 },
+    };
+    hr = m_device->CreateInputLayout(layout, static_cast<UINT>(std::size(layout)), vertexCode->GetBufferPointer(),
+                                     vertexCode->GetBufferSize(), &m_inputLayout);
+    if (FAILED(hr)) {
+        return false;
+    }
+    
+    D3D11_BUFFER_DESC constantsDesc = {};
+    constantsDesc.ByteWidth = sizeof(DirectX::XMFLOAT4X4);
+    constantsDesc.Usage = D3D11_USAGE_DYNAMIC;
+    constantsDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+    constantsDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+    hr = m_device->CreateBuffer(&constantsDesc, nullptr, &m_frameConstants);
+    return SUCCEEDED(hr);
+}
+
+bool D3D11Renderer::CreateBuffer(UINT bindFlags, UINT miscFlags, const void* data, size_t bytes,
+                                 ComPtr<ID3D11Buffer>& buffer) {
+    D3D11_BUFFER_DESC desc = {};
+    desc.ByteWidth = static_cast<UINT>(bytes);
+    desc.Usage = D3D11_USAGE_DEFAULT;
+    desc.BindFlags = bindFlags;
+    desc.MiscFlags = miscFlags;
+    
+    D3D11_SUBRESOURCE_DATA initial = {};
+    initial.pSysMem = data;
+    HRESULT hr = m_device->CreateBuffer(&desc, data ? &initial : nullptr, &buffer);
+    return SUCCEEDED(hr);
+}
+
+bool D3D11Renderer::UploadArena(const MeshArena& arena) {
+    const ArenaVertexPool& vertices = arena.GetVertexPool();
+    const ArenaIndexPool& indices = arena.GetIndexPool();
+    if (vertices.empty() || indices.empty()) {
+        return false;
+    }
+    
+    // New capacity (or another arena): copy the whole pools once
+    if (&arena != m_arena || arena.GetGeneration() != m_arenaGeneration) {
+        m_vertexBuffer.Reset();
+        m_indexBuffer.Reset();
+        m_arena = nullptr;
+        if (!CreateBuffer(D3D11_BIND_VERTEX_BUFFER, 0, vertices.data(), vertices.size() * sizeof(Vertex),
+                          m_vertexBuffer) ||
+            !CreateBuffer(D3D11_BIND_INDEX_BUFFER, 0, indices.data(), indices.size() * sizeof(uint32_t),
+                          m_indexBuffer)) {
+            return false;
+        }
+        m_arena = &arena;
+        m_arenaGeneration = arena.GetGeneration();
+        return true;
+    }
+    
+    uint32_t begin = 0;
+    uint32_t end = 0;
+    arena.GetDirtyVertexRange(begin, end);
+    if (begin < end) {
+        D3D11_BOX box = { static_cast<UINT>(begin * sizeof(Vertex)), 0, 0,
+                          static_cast<UINT>(end * sizeof(Vertex)), 1, 1 };
+        m_context->UpdateSubresource(m_vertexBuffer.Get(), 0, &box, vertices.data() + begin, 0, 0);
+    }
+    arena.GetDirtyIndexRange(begin, end);
+    if (begin < end) {
+        D3D11_BOX box = { static_cast<UINT>(begin * sizeof(uint32_t)), 0, 0,
+                          static_cast<UINT>(end * sizeof(uint32_t)), 1, 1 };
+        m_context->UpdateSubresource(m_indexBuffer.Get(), 0, &box, indices.data() + begin, 0, 0);
+    }
+    return true;
+}
+
+bool D3D11Renderer::CreateDeviceAndSwapChain(void* hwnd, int width, int height) {
+    DXGI_SWAP_CHAIN_DESC swapChainDesc = {};
+    swapChainDesc.BufferCount = 2;
+    swapChainDesc.BufferDesc.Width = width;
+    swapChainDesc.BufferDesc.Height = height;
+    swapChainDesc.BufferDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+    swapChainDesc.BufferDesc.RefreshRate.Numerator = 60;
+    swapChainDesc.BufferDesc.RefreshRate.Denominator = 1;
+    swapChainDesc.BufferUsage = DXGI_USAGE_RENDER_TARGET_OUTPUT;
+    swapChainDesc.OutputWindow = static_cast<HWND>(hwnd);
+    swapChainDesc.SampleDesc.Count = 1;
+    swapChainDesc.SampleDesc.Quality = 0;
+    swapChainDesc.Windowed = TRUE;
+    swapChainDesc.SwapEffect = DXGI_SWAP_EFFECT_FLIP_DISCARD;
+    
+    D3D_FEATURE_LEVEL featureLevel;
+    D3D_FEATURE_LEVEL featureLevels[] = { D3D_FEATURE_LEVEL_11_0 };
+    
+    UINT createDeviceFlags = 0;
+#ifdef _DEBUG
+    createDeviceFlags |= D3D11_CREATE_DEVICE_DEBUG;
+#endif
+    
+    HRESULT hr = D3D11CreateDeviceAndSwapChain(
+        nullptr,
+        D3D_DRIVER_TYPE_HARDWARE,
+        nullptr,
+        createDeviceFlags,
+        featureLevels,
+        1,
+        D3D11_SDK_VERSION,
+        &swapChainDesc,
+        &m_swapChain,
+        &m_device,
+        &featureLevel,
+        &m_context
+    );
+    
+    return SUCCEEDED(hr);
+}
+
+bool D3D11Renderer::CreateRenderTargets() {
+    // Get back buffer
+    ComPtr<ID3D11Texture2D> backBuffer;
+    HRESULT hr = m_swapChain->GetBuffer(0, __uuidof(ID3D11Texture2D), &backBuffer);
+    if (FAILED(hr)) {
+        return false;
+    }
+    
+    // Create render target view
+    hr = m_device->CreateRenderTargetView(backBuffer.Get(), nullptr, &m_renderTargetView);
+    if (FAILED(hr)) {
+        return false;
+    }
+    
+    // Create depth stencil buffer
+    D3D11_TEXTURE2D_DESC depthStencilDesc = {};
+    depthStencilDesc.Width = m_width;
+    depthStencilDesc.Height = m_height;
+    depthStencilDesc.MipLevels = 1;
+    depthStencilDesc.ArraySize = 1;
+    depthStencilDesc.Format = DXGI_FORMAT_D24_UNORM_S8_UINT;
+    depthStencilDesc.SampleDesc.Count = 1;
+    depthStencilDesc.SampleDesc.Quality = 0;
+    depthStencilDesc.Usage = D3D11_USAGE_DEFAULT;
+    depthStencilDesc.BindFlags = D3D11_BIND_DEPTH_STENCIL;
+    
+    hr = m_device->CreateTexture2D(&depthStencilDesc, nullptr, &m_depthStencilBuffer);
+    if (FAILED(hr)) {
+        return false;
+    }
+    
+    // Create depth stencil view
+    hr = m_device->CreateDepthStencilView(m_depthStencilBuffer.Get(), nullptr, &m_depthStencilView);
+    if (FAILED(hr)) {
+        return false;
+    }
+    
+    // Bind render target and depth stencil
+    m_context->OMSetRenderTargets(1, m_renderTargetView.GetAddressOf(), m_depthStencilView.Get());
+    
+    return true;
+}
+
+void D3D11Renderer::CleanupRenderTargets() {
+    m_depthStencilView.Reset();
+    m_depthStencilBuffer.Reset();
+    m_renderTargetView.Reset();
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <d3d11.h>
+#include <DirectXMath.h>
+#include <wrl/client.h>
+#include "Renderer.h"
+
+using Microsoft::WRL::ComPtr;
+
+class D3D11Renderer : public Renderer {
+public:
+    D3D11Renderer();
+    ~D3D11Renderer() override;
+    
+    bool Initialize(void* hwnd, int width, int height);
+    void Shutdown() override;
+    void Resize(int width, int height) override;
+    
+    void BeginFrame() override;
+    void EndFrame() override;
+    
+    void Clear(float r, float g, float b, float a) override;
+    void DrawMeshes(const MeshArena& arena, const std::vector<DrawIndexedIndirectArgs>& commands,
+                    const Camera& camera) override;
+    
+    ID3D11Device* GetDevice() { return m_device.Get(); }
+    ID3D11DeviceContext* GetContext() { return m_context.Get(); }
+    
+private:
+    bool CreateDeviceAndSwapChain(void* hwnd, int width, int height);
+    bool CreateRenderTargets();
+    void CleanupRenderTargets();
+    bool CreatePipeline();
+    bool CreateBuffer(UINT bindFlags, UINT miscFlags, const void* data, size_t bytes,
+                      ComPtr<ID3D11Buffer>& buffer);
+    bool UploadArena(const MeshArena& arena);
+    
+    ComPtr<ID3D11Device> m_device;
+    ComPtr<ID3D11DeviceContext> m_context;
+    ComPtr<IDXGISwapChain> m_swapChain;
+    ComPtr<ID3D11RenderTargetView> m_renderTargetView;
+    ComPtr<ID3D11Texture2D> m_depthStencilBuffer;
+    ComPtr<ID3D11DepthStencilView> m_depthStencilView;
+    ComPtr<ID3D11DepthStencilState> m_depthStencilState;
+    ComPtr<ID3D11RasterizerState> m_rasterizerState;
+    
+    // Chunk pipeline: flat-shaded vertex colours, lit like SoftwareRenderer
+    ComPtr<ID3D11VertexShader> m_vertexShader;
+    ComPtr<ID3D11PixelShader> m_pixelShader;
+    ComPtr<ID3D11InputLayout> m_inputLayout;
+    ComPtr<ID3D11Buffer> m_frameConstants;
+    
+    // GPU copies of the arena pools, recreated when the arena or its
+    // generation changes and otherwise updated over the dirty ranges
+    ComPtr<ID3D11Buffer> m_vertexBuffer;
+    ComPtr<ID3D11Buffer> m_indexBuffer;
+    ComPtr<ID3D11Buffer> m_argumentBuffer;
+    const MeshArena* m_arena;
+    uint32_t m_arenaGeneration;
+    size_t m_argumentCapacity;          // draws
+    
+    int m_width;
+    int m_height;
+};
@@ -1,14 +1,423 @@
 #include "EngineCore.h"
 #include "VoxelEngine.h"
-#include "Renderer.h"
+#include "D3D11Renderer.h"
+#include "SoftwareRenderer.h"
 #include "Camera.h"
+#include "CommandBuffer.h"
+#include "ThreadPool.h"
+#include "PhysicsWorld.h"
+#include "CharacterController.h"
+#include "WorldHistory.h"
+#include "SessionTrace.h"
+#include "WorldGenerator.h"
+#include "Replication.h"
+#include "EntityWorld.h"
+#include "SystemScheduler.h"
+#include "EntitySystems.h"
+#include "ChunkSizeBenchmark.h"
+#include "VoxelQuery.h"
+#include "Navigation.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
 #include <memory>
+#include <thread>
+#include <unordered_map>
 
 namespace {
     std::unique_ptr<VoxelEngine> g_voxelEngine;
     std::unique_ptr<Renderer> g_renderer;
     std::unique_ptr<Camera> g_camera;
+    std::unique_ptr<ThreadPool> g_threadPool;
+    std::unique_ptr<PhysicsWorld> g_physics;
+    std::unique_ptr<CharacterController> g_character;
+    std::unique_ptr<WorldHistory> g_history;
+    std::unique_ptr<EntityWorld> g_entities;
+    std::unique_ptr<SystemScheduler> g_systems;
+    std::unique_ptr<NavigationGraph> g_navigation;
+    CoreComponents g_coreComponents = {};
+    SessionRecorder g_recorder;
     bool g_editorMode = false;
+    bool g_cameraCollision = false;
+    int g_viewportWidth = 0;
+    int g_viewportHeight = 0;
+    
+    // How far FindPath looks down for ground under each end
+    constexpr int PATH_SNAP_DEPTH = 64;
+    
+    // Largest burst one SpawnParticles call creates
+    constexpr uint32_t MAX_PARTICLE_BURST = 65536;
+    
+    // Appends one call to the session trace when recording; arguments are
+    // written back to back in the call's payload layout
+    template <typename Call, typename... Args>
+    void RecordCall(Call call, const Args&... args) {
+        if (!g_recorder.IsRecording()) {
+            return;
+        }
+        if constexpr (sizeof...(Args) == 0) {
+            g_recorder.Record(static_cast<uint8_t>(call), nullptr, 0);
+        } else {
+            uint8_t payload[(sizeof(Args) + ...)] = {};
+            size_t size = 0;
+            ((std::memcpy(payload + size, &args, sizeof(Args)), size += sizeof(Args)), ...);
+            g_recorder.Record(static_cast<uint8_t>(call), payload, size);
+        }
+    }
+    
+    // Dependants go first: each system only refers to those made before it
+    void ShutdownSystems() {
+        g_navigation.reset();
+        g_systems.reset();
+        g_entities.reset();
+        g_character.reset();
+        g_physics.reset();
+        g_history.reset();
+        g_voxelEngine.reset();
+        g_camera.reset();
+    }
+    
+    // Replaces any systems from an earlier initialization. The thread pool
+    // is kept if there is one, since the renderer may already share it.
+    bool InitializeSystems(int width, int height, const std::filesystem::path& meshCacheDirectory) {
+        ShutdownSystems();
+        g_viewportWidth = width;
+        g_viewportHeight = height;
+        
+        // Initialize camera
+        g_camera = std::make_unique<Camera>();
+        g_camera->SetPosition(50.0f, 30.0f, 50.0f);
+        g_camera->SetAspectRatio(static_cast<float>(width) / height);
+        
+        // Worker threads for terrain generation and physics
+        if (!g_threadPool) {
+            g_threadPool = std::make_unique<ThreadPool>();
+        }
+        
+        // Initialize voxel engine; terrain streams in around the camera
+        auto eye = g_camera->GetPosition();
+        g_voxelEngine = std::make_unique<VoxelEngine>(g_threadPool.get());
+        g_voxelEngine->SetGenerationFocus(eye.x, eye.y, eye.z);
+        g_voxelEngine->SetMeshCacheDirectory(meshCacheDirectory);
+        
+        // Undo history follows the world from its first swap on
+        g_history = std::make_unique<WorldHistory>();
+        g_voxelEngine->SetWorldReplacedListener([] {
+            g_history->Reset(*g_voxelEngine);
+        });
+        g_voxelEngine->SetResidencyListener([](const ChunkCoord& coord, const VoxelBlockRef& block, bool resident) {
+            if (resident) {
+                g_history->OnChunkReloaded(coord, block);
+            } else {
+                g_history->OnChunkEvicted(coord, block);
+            }
+        });
+        g_voxelEngine->SetStreamListener([](const ChunkCoord& coord, const VoxelBlockRef& block) {
+            g_history->OnChunkStreamed(coord, block);
+        });
+        g_voxelEngine->Initialize();
+        
+        // Initialize physics
+        g_physics = std::make_unique<PhysicsWorld>(g_voxelEngine.get(), g_threadPool.get());
+        g_character = std::make_unique<CharacterController>(g_physics.get());
+        g_character->SetEyePosition(g_camera->GetPosition());
+        
+        // Entities (mobs, items, particles) and the systems that update them
+        g_entities = std::make_unique<EntityWorld>();
+        g_coreComponents = RegisterCoreComponents(*g_entities);
+        g_systems = std::make_unique<SystemScheduler>(g_threadPool.get());
+        AddCoreSystems(*g_systems, g_coreComponents, g_voxelEngine.get());
+        
+        // Walkable-surface graph for agent paths, kept current by edits
+        g_navigation = std::make_unique<NavigationGraph>(g_voxelEngine.get(), g_threadPool.get());
+        
+        return true;
+    }
+    
+    bool IsCharacterActive() {
+        return g_character && g_cameraCollision && !g_editorMode;
+    }
+    
+    // Camera moves compute the free-flight target first, then the character
+    // controller resolves the horizontal part of it against the terrain
+    template <typename MoveFn>
+    void MoveCamera(MoveFn move) {
+        if (!g_camera) {
+            return;
+        }
+        if (!IsCharacterActive()) {
+            move();
+            return;
+        }
+        
+        auto from = g_camera->GetPosition();
+        move();
+        auto to = g_camera->GetPosition();
+        g_character->Move(DirectX::XMFLOAT3(to.x - from.x, 0.0f, to.z - from.z));
+        auto eye = g_character->GetEyePosition();
+        g_camera->SetPosition(eye.x, eye.y, eye.z);
+    }
+    
+    // Shared by the C exports and command buffers; callers record the call
+    void ApplyCameraPosition(float x, float y, float z) {
+        if (g_camera) {
+            g_camera->SetPosition(x, y, z);
+        }
+        if (g_character) {
+            g_character->SetEyePosition(DirectX::XMFLOAT3(x, y, z));
+        }
+    }
+    
+    void ApplyCameraRotation(float pitch, float yaw) {
+        if (g_camera) {
+            g_camera->SetRotation(pitch, yaw);
+        }
+    }
+    
+    void ApplyCameraUp(float distance) {
+        if (IsCharacterActive()) {
+            // Walking characters jump instead of flying
+            if (distance > 0.0f) {
+                g_character->Jump();
+            }
+            return;
+        }
+        if (g_camera) {
+            g_camera->MoveUp(distance);
+        }
+    }
+    
+    void ApplySetVoxel(int x, int y, int z, uint8_t blockType) {
+        if (g_voxelEngine) {
+            g_voxelEngine->SetVoxel(x, y, z, blockType);
+        }
+    }
+    
+    void ApplyGenerateTerrain(int seed) {
+        if (g_voxelEngine) {
+            if (g_camera) {
+                auto eye = g_camera->GetPosition();
+                g_voxelEngine->SetGenerationFocus(eye.x, eye.y, eye.z);
+            }
+            g_voxelEngine->GenerateTerrain(seed);
+        }
+    }
+    
+    class EngineCommandContext : public CommandContext {
+    public:
+        bool IsInitialized() const override { return g_voxelEngine && g_camera; }
+        
+        void SetCameraPosition(float x, float y, float z) override { ApplyCameraPosition(x, y, z); }
+        void SetCameraRotation(float pitch, float yaw) override { ApplyCameraRotation(pitch, yaw); }
+        void MoveCameraForward(float distance) override {
+            MoveCamera([distance] { g_camera->MoveForward(distance); });
+        }
+        void MoveCameraRight(float distance) override {
+            MoveCamera([distance] { g_camera->MoveRight(distance); });
+        }
+        void MoveCameraUp(float distance) override { ApplyCameraUp(distance); }
+        void GetCameraPosition(float& x, float& y, float& z) const override {
+            auto pos = g_camera->GetPosition();
+            x = pos.x;
+            y = pos.y;
+            z = pos.z;
+        }
+        
+        void SetVoxel(int x, int y, int z, uint8_t blockType) override { ApplySetVoxel(x, y, z, blockType); }
+        uint8_t GetVoxel(int x, int y, int z) const override { return g_voxelEngine->GetVoxel(x, y, z); }
+        void GenerateTerrain(int seed) override { ApplyGenerateTerrain(seed); }
+        void SetEditorMode(bool enabled) override { g_editorMode = enabled; }
+    };
+    
+    template <typename T>
+    T ReadPayload(const uint8_t*& payload) {
+        T value;
+        std::memcpy(&value, payload, sizeof(T));
+        payload += sizeof(T);
+        return value;
+    }
+    
+    // Body ids as recorded, mapped to the ids the replay's bodies got
+    using BodyIdMap = std::unordered_map<uint32_t, uint32_t>;
+    
+    uint32_t MapBodyId(const BodyIdMap& bodyIds, uint32_t recordedId) {
+        auto it = bodyIds.find(recordedId);
+        return it != bodyIds.end() ? it->second : InvalidBodyId;
+    }
+    
+    // Re-issues one recorded call through the same exports the editor uses
+    void ReplayCall(const SessionCallView& view, BodyIdMap& bodyIds) {
+        const uint8_t* p = view.payload;
+        switch (view.call) {
+        case static_cast<uint8_t>(SessionCall::UpdateEngine): {
+            float deltaTime = ReadPayload<float>(p);
+            UpdateEngine(deltaTime);
+            break;
+        }
+        case static_cast<uint8_t>(SessionCall::RenderEngine):
+            RenderEngine();
+            break;
+        case static_cast<uint8_t>(SessionCall::ResizeViewport): {
+            int32_t width = ReadPayload<int32_t>(p);
+            int32_t height = ReadPayload<int32_t>(p);
+            ResizeViewport(width, height);
+            break;
+        }
+        case static_cast<uint8_t>(SessionCall::ProcessMouseMove): {
+            float deltaX = ReadPayload<float>(p);
+            float deltaY = ReadPayload<float>(p);
+            ProcessMouseMove(deltaX, deltaY);
+            break;
+        }
+        case static_cast<uint8_t>(SessionCall::ProcessMouseWheel):
+            ProcessMouseWheel(ReadPayload<float>(p));
+            break;
+        case static_cast<uint8_t>(SessionCall::ProcessKeyInput): {
+            int32_t keyCode = ReadPayload<int32_t>(p);
+            bool pressed = ReadPayload<uint8_t>(p) != 0;
+            ProcessKeyInput(keyCode, pressed);
+            break;
+        }
+        case static_cast<uint8_t>(SessionCall::CommitWorldEdit):
+            CommitWorldEdit();
+            break;
+        case static_cast<uint8_t>(SessionCall::UndoWorldEdit):
+            UndoWorldEdit();
+            break;
+        case static_cast<uint8_t>(SessionCall::RedoWorldEdit):
+            RedoWorldEdit();
+            break;
+        case static_cast<uint8_t>(SessionCall::SetCameraCollision):
+            SetCameraCollision(ReadPayload<uint8_t>(p) != 0);
+            break;
+        case static_cast<uint8_t>(SessionCall::CancelTerrainGeneration):
+            CancelTerrainGeneration();
+            break;
+        case static_cast<uint8_t>(SessionCall::SetTerrainSwapThreshold):
+            SetTerrainSwapThreshold(ReadPayload<float>(p));
+            break;
+        case static_cast<uint8_t>(SessionCall::CreatePhysicsBody): {
+            float v[6];
+            for (float& f : v) {
+                f = ReadPayload<float>(p);
+            }
+            uint32_t recordedId = ReadPayload<uint32_t>(p);
+            uint32_t bodyId = CreatePhysicsBody(v[0], v[1], v[2], v[3], v[4], v[5]);
+            if (recordedId != InvalidBodyId) {
+                bodyIds[recordedId] = bodyId;
+            }
+            break;
+        }
+        case static_cast<uint8_t>(SessionCall::DestroyPhysicsBody): {
+            uint32_t recordedId = ReadPayload<uint32_t>(p);
+            DestroyPhysicsBody(MapBodyId(bodyIds, recordedId));
+            bodyIds.erase(recordedId);
+            break;
+        }
+        case static_cast<uint8_t>(SessionCall::SetPhysicsBodyVelocity): {
+            uint32_t bodyId = MapBodyId(bodyIds, ReadPayload<uint32_t>(p));
+            float x = ReadPayload<float>(p);
+            float y = ReadPayload<float>(p);
+            float z = ReadPayload<float>(p);
+            SetPhysicsBodyVelocity(bodyId, x, y, z);
+            break;
+        }
+        case static_cast<uint8_t>(SessionCall::SetMemoryBudget): {
+            uint32_t category = ReadPayload<uint32_t>(p);
+            uint64_t bytes = ReadPayload<uint64_t>(p);
+            SetMemoryBudget(category, bytes);
+            break;
+        }
+        case static_cast<uint8_t>(SessionCall::SpawnParticles): {
+            float x = ReadPayload<float>(p);
+            float y = ReadPayload<float>(p);
+            float z = ReadPayload<float>(p);
+            uint32_t count = ReadPayload<uint32_t>(p);
+            float speed = ReadPayload<float>(p);
+            float lifetime = ReadPayload<float>(p);
+            SpawnParticles(x, y, z, count, speed, lifetime);
+            break;
+        }
+        case static_cast<uint8_t>(SessionCall::ExecuteCommandBuffer): {
+            // Results go to scratch space; every command takes at least one
+            // byte and returns at most 12, which bounds the result size
+            uint32_t streamSize = ReadPayload<uint32_t>(p);
+            std::vector<uint8_t> results(static_cast<size_t>(streamSize) * 12);
+            size_t resultSize = 0;
+            ExecuteCommandBuffer(p, streamSize, results.data(), results.size(), &resultSize);
+            break;
+        }
+        case static_cast<uint8_t>(EngineCommand::SetCameraPosition): {
+            float x = ReadPayload<float>(p);
+            float y = ReadPayload<float>(p);
+            float z = ReadPayload<float>(p);
+            SetCameraPosition(x, y, z);
+            break;
+        }
+        case static_cast<uint8_t>(EngineCommand::SetCameraRotation): {
+            float pitch = ReadPayload<float>(p);
+            float yaw = ReadPayload<float>(p);
+            SetCameraRotation(pitch, yaw);
+            break;
+        }
+        case static_cast<uint8_t>(EngineCommand::MoveCameraForward):
+            MoveCameraForward(ReadPayload<float>(p));
+            break;
+        case static_cast<uint8_t>(EngineCommand::MoveCameraRight):
+            MoveCameraRight(ReadPayload<float>(p));
+            break;
+        case static_cast<uint8_t>(EngineCommand::MoveCameraUp):
+            MoveCameraUp(ReadPayload<float>(p));
+            break;
+        case static_cast<uint8_t>(EngineCommand::SetVoxel): {
+            int32_t x = ReadPayload<int32_t>(p);
+            int32_t y = ReadPayload<int32_t>(p);
+            int32_t z = ReadPayload<int32_t>(p);
+            uint8_t blockType = ReadPayload<uint8_t>(p);
+            SetVoxel(x, y, z, blockType);
+            break;
+        }
+        case static_cast<uint8_t>(EngineCommand::GenerateTerrain):
+            GenerateTerrain(ReadPayload<int32_t>(p));
+            break;
+        case static_cast<uint8_t>(EngineCommand::SetEditorMode):
+            SetEditorMode(ReadPayload<uint8_t>(p) != 0);
+            break;
+        default:
+            // Queries carry no state change worth replaying
+            break;
+        }
+    }
+    
+    bool FindVoxel(const VoxelRegion& region, uint8_t blockType, int* x, int* y, int* z) {
+        if (!g_voxelEngine || !x || !y || !z) {
+            return false;
+        }
+        VoxelPosition position;
+        if (!VoxelQuery(*g_voxelEngine, g_threadPool.get()).FindFirst(region, blockType, position)) {
+            return false;
+        }
+        *x = position.x;
+        *y = position.y;
+        *z = position.z;
+        return true;
+    }
+    
+    uint32_t CollectVoxels(const VoxelRegion& region, uint8_t blockType, int32_t* positions, uint32_t capacity) {
+        if (!g_voxelEngine || !positions) {
+            return 0;
+        }
+        std::vector<VoxelPosition> found;
+        VoxelQuery(*g_voxelEngine, g_threadPool.get()).Collect(region, blockType, found, capacity);
+        for (size_t i = 0; i < found.size(); ++i) {
+            positions[i * 3 + 0] = found[i].x;
+            positions[i * 3 + 1] = found[i].y;
+            positions[i * 3 + 2] = found[i].z;
+        }
+        return static_cast<uint32_t>(found.size());
+    }
 }
 
 extern "C" {
@@ -16,53 +425,122 @@ extern "C" {
 bool InitializeEngine(void* hwnd, int width, int height) {
     try {
         // Initialize renderer with DirectX 11
-        g_renderer = std::make_unique<Renderer>();
-        if (!g_renderer->Initialize(hwnd, width, height)) {
+        auto renderer = std::make_unique<D3D11Renderer>();
+        if (!renderer->Initialize(hwnd, width, height)) {
+            ShutdownEngine();
             return false;
         }
+        g_renderer = std::move(renderer);
         
-        // Initialize camera
-        g_camera = std::make_unique<Camera>();
-        g_camera->SetPosition(50.0f, 30.0f, 50.0f);
-        g_camera->SetAspectRatio(static_cast<float>(width) / height);
-        
-        // Initialize voxel engine
-        g_voxelEngine = std::make_unique<VoxelEngine>();
-        g_voxelEngine->Initialize();
+        // Chunk meshes persist between launches, keyed by their content
+        std::error_code error;
+        std::filesystem::path meshCache = std::filesystem::temp_directory_path(error);
+        if (!error) {
+            meshCache /= "GameEngine/MeshCache";
+        }
+        if (!InitializeSystems(width, height, error ? std::filesystem::path() : meshCache)) {
+            ShutdownEngine();
+            return false;
+        }
+        return true;
+    }
+    catch (...) {
+        ShutdownEngine();
+        return false;
+    }
+}
+
+bool InitializeEngineHeadless(int width, int height) {
+    try {
+        // No mesh cache, so replays do not depend on earlier runs
+        if (!InitializeSystems(width, height, std::filesystem::path())) {
+            ShutdownEngine();
+            return false;
+        }
+        return true;
+    }
+    catch (...) {
+        ShutdownEngine();
+        return false;
+    }
+}
+
+bool InitializeEngineSoftware(int width, int height) {
+    try {
+        // The renderer rejects unusable sizes before any system starts
+        if (!g_threadPool) {
+            g_threadPool = std::make_unique<ThreadPool>();
+        }
+        auto renderer = std::make_unique<SoftwareRenderer>(g_threadPool.get());
+        if (!renderer->Initialize(width, height)) {
+            ShutdownEngine();
+            return false;
+        }
+        g_renderer = std::move(renderer);
         
+        if (!InitializeSystems(width, height, std::filesystem::path())) {
+            ShutdownEngine();
+            return false;
+        }
         return true;
     }
     catch (...) {
+        ShutdownEngine();
         return false;
     }
 }
 
 void ShutdownEngine() {
-    g_voxelEngine.reset();
-    g_camera.reset();
+    g_recorder.Stop();
+    ShutdownSystems();
     g_renderer.reset();
+    g_threadPool.reset();
 }
 
 void UpdateEngine(float deltaTime) {
+    RecordCall(SessionCall::UpdateEngine, deltaTime);
     if (g_voxelEngine) {
         g_voxelEngine->Update(deltaTime);
     }
+    if (g_navigation) {
+        g_navigation->Update();
+    }
+    if (g_physics) {
+        g_physics->Step(deltaTime);
+    }
+    if (g_systems && g_entities) {
+        g_systems->Run(*g_entities, deltaTime);
+    }
+    if (IsCharacterActive() && g_camera) {
+        g_character->Update(deltaTime);
+        auto eye = g_character->GetEyePosition();
+        g_camera->SetPosition(eye.x, eye.y, eye.z);
+    }
     if (g_camera) {
         g_camera->Update(deltaTime);
     }
 }
 
 void RenderEngine() {
-    if (!g_renderer || !g_voxelEngine || !g_camera) {
+    RecordCall(SessionCall::RenderEngine);
+    if (!g_voxelEngine || !g_camera) {
         return;
     }
     
-    g_renderer->BeginFrame();
+    // Headless engines still build meshes and draw commands
+    if (g_renderer) {
+        g_renderer->BeginFrame();
+    }
     g_voxelEngine->Render(g_renderer.get(), g_camera.get());
-    g_renderer->EndFrame();
+    if (g_renderer) {
+        g_renderer->EndFrame();
+    }
 }
 
 void ResizeViewport(int width, int height) {
+    RecordCall(SessionCall::ResizeViewport, width, height);
+    g_viewportWidth = width;
+    g_viewportHeight = height;
     if (g_renderer) {
         g_renderer->Resize(width, height);
     }
@@ -72,9 +550,8 @@ void ResizeViewport(int width, int height) {
 }
 
 void SetCameraPosition(float x, float y, float z) {
-    if (g_camera) {
-        g_camera->SetPosition(x, y, z);
-    }
+    RecordCall(EngineCommand::SetCameraPosition, x, y, z);
+    ApplyCameraPosition(x, y, z);
 }
 
 void GetCameraPosition(float* x, float* y, float* z) {
@@ -87,33 +564,28 @@ void GetCameraPosition(float* x, float* y, float* z) {
 }
 
 void SetCameraRotation(float pitch, float yaw) {
-    if (g_camera) {
-        g_camera->SetRotation(pitch, yaw);
-    }
+    RecordCall(EngineCommand::SetCameraRotation, pitch, yaw);
+    ApplyCameraRotation(pitch, yaw);
 }
 
 void MoveCameraForward(float distance) {
-    if (g_camera) {
-        g_camera->MoveForward(distance);
-    }
+    RecordCall(EngineCommand::MoveCameraForward, distance);
+    MoveCamera([distance] { g_camera->MoveForward(distance); });
 }
 
 void MoveCameraRight(float distance) {
-    if (g_camera) {
-        g_camera->MoveRight(distance);
-    }
+    RecordCall(EngineCommand::MoveCameraRight, distance);
+    MoveCamera([distance] { g_camera->MoveRight(distance); });
 }
 
 void MoveCameraUp(float distance) {
-    if (g_camera) {
-        g_camera->MoveUp(distance);
-    }
+    RecordCall(EngineCommand::MoveCameraUp, distance);
+    ApplyCameraUp(distance);
 }
 
 void SetVoxel(int x, int y, int z, uint8_t blockType) {
-    if (g_voxelEngine) {
-        g_voxelEngine->SetVoxel(x, y, z, blockType);
-    }
+    RecordCall(EngineCommand::SetVoxel, x, y, z, blockType);
+    ApplySetVoxel(x, y, z, blockType);
 }
 
 uint8_t GetVoxel(int x, int y, int z) {
@@ -123,13 +595,581 @@ uint8_t GetVoxel(int x, int y, int z) {
     return 0;
 }
 
+uint64_t CountVoxelsInBox(int x0, int y0, int z0, int x1, int y1, int z1, uint8_t blockType) {
+    if (!g_voxelEngine) {
+        return 0;
+    }
+    return VoxelQuery(*g_voxelEngine, g_threadPool.get()).Count(VoxelRegion::Box(x0, y0, z0, x1, y1, z1), blockType);
+}
+
+uint64_t CountVoxelsInSphere(float x, float y, float z, float radius, uint8_t blockType) {
+    if (!g_voxelEngine) {
+        return 0;
+    }
+    return VoxelQuery(*g_voxelEngine, g_threadPool.get()).Count(VoxelRegion::Sphere(x, y, z, radius), blockType);
+}
+
+bool FindVoxelInBox(int x0, int y0, int z0, int x1, int y1, int z1, uint8_t blockType, int* x, int* y, int* z) {
+    return FindVoxel(VoxelRegion::Box(x0, y0, z0, x1, y1, z1), blockType, x, y, z);
+}
+
+bool FindVoxelInSphere(float x, float y, float z, float radius, uint8_t blockType, int* foundX, int* foundY, int* foundZ) {
+    return FindVoxel(VoxelRegion::Sphere(x, y, z, radius), blockType, foundX, foundY, foundZ);
+}
+
+uint32_t CollectVoxelsInBox(int x0, int y0, int z0, int x1, int y1, int z1, uint8_t blockType,
+                            int32_t* positions, uint32_t capacity) {
+    return CollectVoxels(VoxelRegion::Box(x0, y0, z0, x1, y1, z1), blockType, positions, capacity);
+}
+
+uint32_t CollectVoxelsInSphere(float x, float y, float z, float radius, uint8_t blockType,
+                               int32_t* positions, uint32_t capacity) {
+    return CollectVoxels(VoxelRegion::Sphere(x, y, z, radius), blockType, positions, capacity);
+}
+
+void MeasureVoxelQueries(int32_t seed, int32_t worldRadius, int32_t queryRadius, uint32_t queries,
+                         float* naiveMilliseconds, float* queryMilliseconds, uint32_t* mismatches) {
+    if (!naiveMilliseconds || !queryMilliseconds || !mismatches) {
+        return;
+    }
+    VoxelQueryBenchmarkStats stats = MeasureVoxelQueries(seed, worldRadius, queryRadius, queries, g_threadPool.get());
+    *naiveMilliseconds = stats.naiveMilliseconds;
+    *queryMilliseconds = stats.queryMilliseconds;
+    *mismatches = stats.mismatches;
+}
+
+uint32_t FindPath(float startX, float startY, float startZ, float goalX, float goalY, float goalZ,
+                  int32_t* positions, uint32_t capacity) {
+    if (!g_navigation) {
+        return 0;
+    }
+    
+    // Edits made since the last frame are applied first
+    g_navigation->Update();
+    VoxelPosition start, goal;
+    if (!g_navigation->FindStandingPosition(static_cast<int>(std::floor(startX)), static_cast<int>(std::floor(startY)),
+                                            static_cast<int>(std::floor(startZ)), PATH_SNAP_DEPTH, start) ||
+        !g_navigation->FindStandingPosition(static_cast<int>(std::floor(goalX)), static_cast<int>(std::floor(goalY)),
+                                            static_cast<int>(std::floor(goalZ)), PATH_SNAP_DEPTH, goal)) {
+        return 0;
+    }
+    std::vector<VoxelPosition> path;
+    if (g_navigation->FindPath(start, goal, path) != PathStatus::Found) {
+        return 0;
+    }
+    for (size_t i = 0; positions && i < path.size() && i < capacity; ++i) {
+        positions[i * 3 + 0] = path[i].x;
+        positions[i * 3 + 1] = path[i].y;
+        positions[i * 3 + 2] = path[i].z;
+    }
+    return static_cast<uint32_t>(path.size());
+}
+
+void GetNavigationStats(uint32_t* chunks, uint32_t* regions, uint32_t* portals, float* rebuildMilliseconds) {
+    if (g_navigation && chunks && regions && portals && rebuildMilliseconds) {
+        const NavigationStats& stats = g_navigation->GetStats();
+        *chunks = stats.chunks;
+        *regions = stats.regions;
+        *portals = stats.portals;
+        *rebuildMilliseconds = stats.rebuildMilliseconds;
+    }
+}
+
+void MeasurePathfinding(int32_t seed, int32_t worldRadius, uint32_t paths, uint32_t edits,
+                        float* pathsPerSecond, float* rebuildMicroseconds, uint32_t* found,
+                        uint32_t* invalid, uint32_t* mismatches) {
+    if (!pathsPerSecond || !rebuildMicroseconds || !found || !invalid || !mismatches) {
+        return;
+    }
+    PathfindingBenchmarkStats stats = MeasurePathfinding(seed, worldRadius, paths, edits, g_threadPool.get());
+    *pathsPerSecond = stats.pathsPerSecond;
+    *rebuildMicroseconds = stats.rebuildMicroseconds;
+    *found = stats.found;
+    *invalid = stats.invalid;
+    *mismatches = stats.mismatches;
+}
+
 void GenerateTerrain(int seed) {
+    RecordCall(EngineCommand::GenerateTerrain, seed);
+    ApplyGenerateTerrain(seed);
+}
+
+bool GetTerrainProgress(float* progress) {
+    if (!g_voxelEngine) {
+        return false;
+    }
+    if (progress) {
+        *progress = g_voxelEngine->GetTerrainProgress();
+    }
+    return g_voxelEngine->IsGeneratingTerrain();
+}
+
+void CancelTerrainGeneration() {
+    RecordCall(SessionCall::CancelTerrainGeneration);
+    if (g_voxelEngine) {
+        g_voxelEngine->CancelTerrainGeneration();
+    }
+}
+
+void SetTerrainSwapThreshold(float fraction) {
+    RecordCall(SessionCall::SetTerrainSwapThreshold, fraction);
     if (g_voxelEngine) {
-        g_voxelEngine->GenerateTerrain(seed);
+        g_voxelEngine->SetSwapThreshold(fraction);
+    }
+}
+
+void SetMemoryBudget(uint32_t category, uint64_t bytes) {
+    RecordCall(SessionCall::SetMemoryBudget, category, bytes);
+    if (g_voxelEngine && category < MEMORY_CATEGORY_COUNT) {
+        g_voxelEngine->GetMemoryBudget().SetBudget(static_cast<MemoryCategory>(category), bytes);
+    }
+}
+
+void GetMemoryStats(uint32_t category, uint64_t* bytes, uint64_t* peakBytes, uint64_t* budgetBytes, uint32_t* evictions) {
+    if (g_voxelEngine && category < MEMORY_CATEGORY_COUNT && bytes && peakBytes && budgetBytes && evictions) {
+        MemoryCategoryStats stats = g_voxelEngine->GetMemoryBudget().GetStats(static_cast<MemoryCategory>(category));
+        *bytes = stats.bytes;
+        *peakBytes = stats.peakBytes;
+        *budgetBytes = stats.budgetBytes;
+        *evictions = stats.evictions;
+    }
+}
+
+void GetChunkResidency(uint32_t* resident, uint32_t* evicted, uint32_t* persisted) {
+    if (g_voxelEngine && resident && evicted && persisted) {
+        ChunkResidency residency = g_voxelEngine->GetResidency();
+        *resident = residency.resident;
+        *evicted = residency.evicted;
+        *persisted = residency.persisted;
+    }
+}
+
+void MeasureConcurrentVoxelReads(uint32_t readerThreads, uint32_t milliseconds,
+                                 double* readsPerSecond, uint32_t* inconsistentReads) {
+    if (!readsPerSecond || !inconsistentReads) {
+        return;
+    }
+    ConcurrentReadStats stats = MeasureConcurrentReads(readerThreads, milliseconds);
+    *readsPerSecond = stats.seconds > 0.0f ? stats.reads / stats.seconds : 0.0;
+    *inconsistentReads = stats.inconsistentReads;
+}
+
+bool SetMeshCacheDirectory(const char* path) {
+    if (!g_voxelEngine) {
+        return false;
+    }
+    return g_voxelEngine->SetMeshCacheDirectory(path ? std::filesystem::path(path) : std::filesystem::path());
+}
+
+void GetMeshCacheStats(uint32_t* hits, uint32_t* misses, uint32_t* entries, uint64_t* fileBytes) {
+    if (g_voxelEngine && hits && misses && entries && fileBytes) {
+        MeshCacheStats stats = g_voxelEngine->GetMeshCache().GetStats();
+        *hits = stats.hits;
+        *misses = stats.misses;
+        *entries = stats.entries;
+        *fileBytes = stats.fileBytes;
+    }
+}
+
+void MeasureMeshCacheStartup(int32_t seed, int32_t worldRadius, float* coldFirstFrameMilliseconds,
+                             float* warmFirstFrameMilliseconds, float* coldMeshMilliseconds,
+                             float* warmMeshMilliseconds, uint32_t* warmHits) {
+    if (!coldFirstFrameMilliseconds || !warmFirstFrameMilliseconds || !coldMeshMilliseconds ||
+        !warmMeshMilliseconds || !warmHits) {
+        return;
+    }
+    MeshCacheStartupStats stats = MeasureMeshCacheStartup(seed, worldRadius);
+    *coldFirstFrameMilliseconds = stats.coldGenerateMilliseconds + stats.coldMeshMilliseconds;
+    *warmFirstFrameMilliseconds = stats.warmGenerateMilliseconds + stats.warmMeshMilliseconds;
+    *coldMeshMilliseconds = stats.coldMeshMilliseconds;
+    *warmMeshMilliseconds = stats.warmMeshMilliseconds;
+    *warmHits = stats.warmHits;
+}
+
+void GetMeshArenaStats(uint32_t* meshCount, float* fragmentation, uint32_t* defragmentations,
+                       uint64_t* defragmentedBytes) {
+    if (g_voxelEngine && meshCount && fragmentation && defragmentations && defragmentedBytes) {
+        MeshArenaStats stats = g_voxelEngine->GetMeshArena().GetStats();
+        *meshCount = stats.meshCount;
+        *fragmentation = stats.fragmentation;
+        *defragmentations = stats.defragmentations;
+        *defragmentedBytes = stats.defragmentedBytes;
+    }
+}
+
+void MeasureMeshArenaChurn(uint32_t meshCount, uint32_t frames, float* frameMilliseconds,
+                           float* averageFragmentation, uint32_t* defragmentations,
+                           uint64_t* dirtyBytesPerFrame) {
+    if (!frameMilliseconds || !averageFragmentation || !defragmentations || !dirtyBytesPerFrame) {
+        return;
+    }
+    MeshArenaBenchmarkStats stats = MeasureMeshArenaChurn(meshCount, frames);
+    *frameMilliseconds = stats.frameMilliseconds;
+    *averageFragmentation = stats.averageFragmentation;
+    *defragmentations = stats.defragmentations;
+    *dirtyBytesPerFrame = stats.dirtyBytesPerFrame;
+}
+
+void MeasureWorldGeneration(int32_t seed, int32_t worldRadius, float* milliseconds,
+                            uint32_t* chunks, float* stageChunksPerSecond) {
+    if (!milliseconds || !chunks || !stageChunksPerSecond) {
+        return;
+    }
+    WorldGenerationStats stats = MeasureWorldGeneration(seed, worldRadius, g_threadPool.get());
+    *milliseconds = static_cast<float>(stats.seconds * 1000.0);
+    *chunks = stats.stages[static_cast<uint32_t>(GenerationStage::Complete)].chunks;
+    for (uint32_t i = 0; i < 4; ++i) {
+        const GenerationStageStats& stage = stats.stages[static_cast<uint32_t>(GenerationStage::Density) + i];
+        stageChunksPerSecond[i] = stage.busySeconds > 0.0 ? static_cast<float>(stage.chunks / stage.busySeconds) : 0.0f;
+    }
+}
+
+void MeasureReplication(int32_t seed, int32_t worldRadius, uint32_t clients, uint32_t editsPerFrame,
+                        uint32_t frames, float* kilobytesPerSecond, float* encodeMegabytesPerSecond,
+                        float* decodeMegabytesPerSecond, float* compressionRatio, uint32_t* mismatches) {
+    if (!kilobytesPerSecond || !encodeMegabytesPerSecond || !decodeMegabytesPerSecond ||
+        !compressionRatio || !mismatches) {
+        return;
+    }
+    ReplicationBenchmarkStats stats = MeasureReplication(seed, worldRadius, clients, editsPerFrame, frames);
+    *kilobytesPerSecond = stats.bytesPerSecond / 1024.0f;
+    *encodeMegabytesPerSecond = stats.encodeBytesPerSecond / (1024.0f * 1024.0f);
+    *decodeMegabytesPerSecond = stats.decodeBytesPerSecond / (1024.0f * 1024.0f);
+    *compressionRatio = stats.compressionRatio;
+    *mismatches = stats.mismatches;
+}
+
+void MeasureChunkSizes(int32_t seed, int32_t worldRadius, int32_t* chunkSizes, uint32_t* chunks, uint32_t* drawCalls,
+                       float* generationMilliseconds, float* meshMilliseconds, float* remeshMicroseconds,
+                       float* lookupNanoseconds, uint64_t* memoryBytes) {
+    if (!chunkSizes || !chunks || !drawCalls || !generationMilliseconds || !meshMilliseconds ||
+        !remeshMicroseconds || !lookupNanoseconds || !memoryBytes) {
+        return;
+    }
+    ChunkSizeBenchmarkStats stats = MeasureChunkSizes(seed, worldRadius, 1u << 20, g_threadPool.get());
+    for (uint32_t i = 0; i < CHUNK_SIZE_VARIANT_COUNT; ++i) {
+        const ChunkSizeStats& size = stats.sizes[i];
+        chunkSizes[i] = size.chunkSize;
+        chunks[i] = size.chunks;
+        drawCalls[i] = size.drawCalls;
+        generationMilliseconds[i] = size.generationMilliseconds;
+        meshMilliseconds[i] = size.meshMilliseconds;
+        remeshMicroseconds[i] = size.remeshMicroseconds;
+        lookupNanoseconds[i] = size.lookupNanoseconds;
+        memoryBytes[i] = size.voxelBytes + size.meshBytes + size.chunkBytes;
+    }
+}
+
+bool CommitWorldEdit() {
+    RecordCall(SessionCall::CommitWorldEdit);
+    if (g_history && g_voxelEngine) {
+        return g_history->Commit(*g_voxelEngine);
+    }
+    return false;
+}
+
+bool UndoWorldEdit() {
+    RecordCall(SessionCall::UndoWorldEdit);
+    if (g_history && g_voxelEngine) {
+        return g_history->Undo(*g_voxelEngine);
+    }
+    return false;
+}
+
+bool RedoWorldEdit() {
+    RecordCall(SessionCall::RedoWorldEdit);
+    if (g_history && g_voxelEngine) {
+        return g_history->Redo(*g_voxelEngine);
+    }
+    return false;
+}
+
+void GetHistoryStats(uint32_t* undoDepth, uint32_t* redoDepth, uint64_t* totalBytes, uint64_t* lastEntryBytes) {
+    if (g_history && undoDepth && redoDepth && totalBytes && lastEntryBytes) {
+        HistoryStats stats = g_history->GetStats();
+        *undoDepth = stats.undoDepth;
+        *redoDepth = stats.redoDepth;
+        *totalBytes = stats.totalBytes;
+        *lastEntryBytes = stats.lastEntryBytes;
+    }
+}
+
+void SetCameraCollision(bool enabled) {
+    RecordCall(SessionCall::SetCameraCollision, static_cast<uint8_t>(enabled));
+    if (enabled && !g_cameraCollision && g_character && g_camera) {
+        g_character->SetEyePosition(g_camera->GetPosition());
+    }
+    g_cameraCollision = enabled;
+}
+
+uint32_t CreatePhysicsBody(float x, float y, float z, float halfX, float halfY, float halfZ) {
+    BodyId bodyId = InvalidBodyId;
+    if (g_physics) {
+        bodyId = g_physics->CreateBody(DirectX::XMFLOAT3(x, y, z), DirectX::XMFLOAT3(halfX, halfY, halfZ));
+    }
+    
+    // Replays map later calls on this id to the body they create
+    RecordCall(SessionCall::CreatePhysicsBody, x, y, z, halfX, halfY, halfZ, bodyId);
+    return bodyId;
+}
+
+void DestroyPhysicsBody(uint32_t bodyId) {
+    RecordCall(SessionCall::DestroyPhysicsBody, bodyId);
+    if (g_physics) {
+        g_physics->DestroyBody(bodyId);
+    }
+}
+
+void SetPhysicsBodyVelocity(uint32_t bodyId, float x, float y, float z) {
+    RecordCall(SessionCall::SetPhysicsBodyVelocity, bodyId, x, y, z);
+    if (g_physics) {
+        g_physics->SetVelocity(bodyId, DirectX::XMFLOAT3(x, y, z));
+    }
+}
+
+void GetPhysicsBodyPosition(uint32_t bodyId, float* x, float* y, float* z) {
+    if (g_physics && x && y && z) {
+        auto pos = g_physics->GetPosition(bodyId);
+        *x = pos.x;
+        *y = pos.y;
+        *z = pos.z;
+    }
+}
+
+void GetPhysicsStats(uint32_t* bodyCount, uint32_t* contactPairs, float* stepMilliseconds) {
+    if (g_physics && bodyCount && contactPairs && stepMilliseconds) {
+        const PhysicsStats& stats = g_physics->GetStats();
+        *bodyCount = stats.bodyCount;
+        *contactPairs = stats.contactPairs;
+        *stepMilliseconds = stats.stepMilliseconds;
+    }
+}
+
+void MeasurePhysicsStep(uint32_t bodyCount, uint32_t frames, float* stepMilliseconds,
+                        float* maxStepMilliseconds, uint32_t* contactPairs) {
+    if (!stepMilliseconds || !maxStepMilliseconds || !contactPairs) {
+        return;
+    }
+    PhysicsBenchmarkStats stats = MeasurePhysicsStep(bodyCount, frames, g_threadPool.get());
+    *stepMilliseconds = stats.stepMilliseconds;
+    *maxStepMilliseconds = stats.maxStepMilliseconds;
+    *contactPairs = stats.contactPairs;
+}
+
+uint32_t SpawnParticles(float x, float y, float z, uint32_t count, float speed, float lifetime) {
+    RecordCall(SessionCall::SpawnParticles, x, y, z, count, speed, lifetime);
+    if (!g_entities) {
+        return 0;
+    }
+    count = std::min(count, MAX_PARTICLE_BURST);
+    try {
+        SpawnParticles(*g_entities, g_coreComponents, DirectX::XMFLOAT3(x, y, z), count, speed, lifetime);
+    }
+    catch (...) {
+        return 0;
+    }
+    return count;
+}
+
+void GetEntityStats(uint32_t* entities, uint32_t* archetypes, uint32_t* phases, float* updateMilliseconds) {
+    if (g_entities && g_systems && entities && archetypes && phases && updateMilliseconds) {
+        EntityWorldStats stats = g_entities->GetStats();
+        *entities = stats.entities;
+        *archetypes = stats.archetypes;
+        *phases = g_systems->GetPhaseCount();
+        *updateMilliseconds = g_systems->GetLastRunMilliseconds();
+    }
+}
+
+void MeasureEntityUpdate(uint32_t entityCount, uint32_t frames, float* frameMilliseconds, float* entitiesPerSecond) {
+    if (!frameMilliseconds || !entitiesPerSecond) {
+        return;
+    }
+    EntityBenchmarkStats stats = MeasureEntityUpdate(entityCount, frames, g_threadPool.get());
+    *frameMilliseconds = stats.frameMilliseconds;
+    *entitiesPerSecond = stats.entitiesPerSecond;
+}
+
+bool SaveFrameImage(const char* path) {
+    auto* renderer = dynamic_cast<SoftwareRenderer*>(g_renderer.get());
+    return renderer && path && *path && renderer->SaveImage(path);
+}
+
+bool GetFrameImageHash(uint64_t* hash) {
+    auto* renderer = dynamic_cast<SoftwareRenderer*>(g_renderer.get());
+    if (!renderer || !hash) {
+        return false;
+    }
+    *hash = renderer->GetImageHash();
+    return true;
+}
+
+bool MeasureSoftwareRendering(int width, int height, uint32_t frames, const char* imagePath,
+                              float* frameMilliseconds, float* trianglesPerSecond, uint32_t* triangles) {
+    if (!g_voxelEngine || !g_camera || !frameMilliseconds || !trianglesPerSecond || !triangles) {
+        return false;
+    }
+    std::filesystem::path image = imagePath ? std::filesystem::path(imagePath) : std::filesystem::path();
+    SoftwareRenderBenchmarkStats stats = MeasureSoftwareRendering(g_voxelEngine->GetMeshArena(),
+                                                                  g_voxelEngine->GetDrawCommands(), *g_camera,
+                                                                  width, height, frames, g_threadPool.get(), image);
+    *frameMilliseconds = stats.frameMilliseconds;
+    *trianglesPerSecond = stats.trianglesPerSecond;
+    *triangles = stats.trianglesSubmitted;
+    return stats.frames > 0 && (image.empty() || stats.imageSaved);
+}
+
+bool CheckReferenceImage(const char* imagePath, uint64_t* hash) {
+    if (!hash) {
+        return false;
+    }
+    std::filesystem::path image = imagePath ? std::filesystem::path(imagePath) : std::filesystem::path();
+    ReferenceImageResult result = CheckReferenceImage(g_threadPool.get(), image);
+    *hash = result.hash;
+    return result.matches;
+}
+
+int32_t ExecuteCommandBuffer(const void* commands, size_t commandSize,
+                             void* results, size_t resultCapacity, size_t* resultSize) {
+    if (g_recorder.IsRecording() && commands && commandSize <= UINT32_MAX) {
+        std::vector<uint8_t> payload(sizeof(uint32_t) + commandSize);
+        uint32_t streamSize = static_cast<uint32_t>(commandSize);
+        std::memcpy(payload.data(), &streamSize, sizeof(streamSize));
+        std::memcpy(payload.data() + sizeof(streamSize), commands, commandSize);
+        g_recorder.Record(static_cast<uint8_t>(SessionCall::ExecuteCommandBuffer), payload.data(), payload.size());
+    }
+    EngineCommandContext context;
+    return ExecuteCommands(context, static_cast<const uint8_t*>(commands), commandSize,
+                           static_cast<uint8_t*>(results), resultCapacity, resultSize);
+}
+
+bool StartSessionRecording(const char* path) {
+    if (!path || !g_voxelEngine || !g_camera) {
+        return false;
+    }
+    
+    auto eye = g_camera->GetPosition();
+    SessionTraceHeader header = {};
+    header.magic = SESSION_TRACE_MAGIC;
+    header.version = SESSION_TRACE_VERSION;
+    header.seed = g_voxelEngine->GetSeed();
+    header.viewportWidth = g_viewportWidth;
+    header.viewportHeight = g_viewportHeight;
+    header.cameraX = eye.x;
+    header.cameraY = eye.y;
+    header.cameraZ = eye.z;
+    header.cameraPitch = g_camera->GetPitch();
+    header.cameraYaw = g_camera->GetYaw();
+    header.editorMode = g_editorMode ? 1 : 0;
+    header.cameraCollision = g_cameraCollision ? 1 : 0;
+    if (!g_recorder.Start(path, header)) {
+        return false;
+    }
+    
+    // Bodies alive now open the trace, so a replay starts with the same ones
+    if (g_physics) {
+        for (BodyId bodyId : g_physics->GetBodyIds()) {
+            auto position = g_physics->GetPosition(bodyId);
+            auto halfExtents = g_physics->GetHalfExtents(bodyId);
+            auto velocity = g_physics->GetVelocity(bodyId);
+            RecordCall(SessionCall::CreatePhysicsBody, position.x, position.y, position.z,
+                       halfExtents.x, halfExtents.y, halfExtents.z, bodyId);
+            RecordCall(SessionCall::SetPhysicsBodyVelocity, bodyId, velocity.x, velocity.y, velocity.z);
+        }
+    }
+    return true;
+}
+
+uint64_t StopSessionRecording() {
+    uint64_t calls = g_recorder.GetRecordedCalls();
+    g_recorder.Stop();
+    return calls;
+}
+
+int32_t ReplaySessionTrace(const char* path, bool realTime,
+                           uint32_t* frameCount, float* p50Milliseconds,
+                           float* p99Milliseconds, float* maxMilliseconds) {
+    if (!path) {
+        return SessionTraceInvalidArgument;
+    }
+    if (!g_voxelEngine || !g_camera) {
+        return SessionTraceNotInitialized;
+    }
+    if (g_recorder.IsRecording()) {
+        return SessionTraceBusy;
+    }
+    
+    SessionTrace trace;
+    int32_t status = LoadSessionTrace(path, trace);
+    if (status != SessionTraceOk) {
+        return status;
+    }
+    
+    // Rebuild the recorded starting state; the world is fully generated
+    // before timing starts
+    const SessionTraceHeader& header = trace.header;
+    if (header.viewportWidth > 0 && header.viewportHeight > 0) {
+        ResizeViewport(header.viewportWidth, header.viewportHeight);
+    }
+    SetEditorMode(header.editorMode != 0);
+    SetCameraCollision(false);
+    SetCameraPosition(header.cameraX, header.cameraY, header.cameraZ);
+    SetCameraRotation(header.cameraPitch, header.cameraYaw);
+    GenerateTerrain(header.seed);
+    g_voxelEngine->WaitForTerrain();
+    if (g_entities) {
+        g_entities->Clear();
+    }
+    
+    // Physics and the walking body start over too; the trace creates its
+    // own bodies and later calls are mapped to them
+    if (g_physics) {
+        g_character.reset();
+        g_physics = std::make_unique<PhysicsWorld>(g_voxelEngine.get(), g_threadPool.get());
+        g_character = std::make_unique<CharacterController>(g_physics.get());
+        g_character->SetEyePosition(g_camera->GetPosition());
+    }
+    SetCameraCollision(header.cameraCollision != 0);
+    
+    using Clock = std::chrono::steady_clock;
+    std::vector<float> frameTimes;
+    float currentFrame = 0.0f;
+    Clock::time_point scheduled = Clock::now();
+    
+    SessionTraceReader reader(trace);
+    SessionCallView view;
+    BodyIdMap bodyIds;
+    int32_t executed = 0;
+    while (reader.Next(view)) {
+        if (realTime) {
+            scheduled += std::chrono::microseconds(view.delayMicroseconds);
+            std::this_thread::sleep_until(scheduled);
+        }
+        
+        auto start = Clock::now();
+        ReplayCall(view, bodyIds);
+        currentFrame += std::chrono::duration<float, std::milli>(Clock::now() - start).count();
+        ++executed;
+        
+        // A frame is everything up to and including its RenderEngine call
+        if (view.call == static_cast<uint8_t>(SessionCall::RenderEngine)) {
+            frameTimes.push_back(currentFrame);
+            currentFrame = 0.0f;
+        }
+    }
+    
+    FrameTimeStats stats = ComputeFrameTimeStats(frameTimes);
+    if (frameCount && p50Milliseconds && p99Milliseconds && maxMilliseconds) {
+        *frameCount = stats.frameCount;
+        *p50Milliseconds = stats.p50Milliseconds;
+        *p99Milliseconds = stats.p99Milliseconds;
+        *maxMilliseconds = stats.maxMilliseconds;
     }
+    return executed;
 }
 
 void SetEditorMode(bool enabled) {
+    RecordCall(EngineCommand::SetEditorMode, static_cast<uint8_t>(enabled));
     g_editorMode = enabled;
 }
 
@@ -138,18 +1178,21 @@ bool IsEditorMode() {
 }
 
 void ProcessMouseMove(float deltaX, float deltaY) {
+    RecordCall(SessionCall::ProcessMouseMove, deltaX, deltaY);
     if (g_camera && !g_editorMode) {
         g_camera->ProcessMouseMovement(deltaX, deltaY);
     }
 }
 
 void ProcessMouseWheel(float delta) {
+    RecordCall(SessionCall::ProcessMouseWheel, delta);
     if (g_camera) {
         g_camera->ProcessMouseScroll(delta);
     }
 }
 
 void ProcessKeyInput(int keyCode, bool pressed) {
+    RecordCall(SessionCall::ProcessKeyInput, keyCode, static_cast<uint8_t>(pressed));
     // Handle keyboard input
     // This can be expanded based on game needs
 }
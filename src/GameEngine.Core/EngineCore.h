@@ -6,6 +6,7 @@
 #define ENGINECORE_API __declspec(dllimport)
 #endif
 
+#include <cstddef>
 #include <cstdint>
 
 extern "C" {
@@ -13,6 +14,13 @@ extern "C" {
     ENGINECORE_API bool InitializeEngine(void* hwnd, int width, int height);
     ENGINECORE_API void ShutdownEngine();
     
+    // Engine without a renderer or window, for replaying traces and batch tools
+    ENGINECORE_API bool InitializeEngineHeadless(int width, int height);
+    
+    // Engine drawing with the CPU rasterizer into an offscreen image instead
+    // of a window, e.g. for golden image tests on machines without a GPU
+    ENGINECORE_API bool InitializeEngineSoftware(int width, int height);
+    
     // Engine update and render
     ENGINECORE_API void UpdateEngine(float deltaTime);
     ENGINECORE_API void RenderEngine();
@@ -31,6 +39,167 @@ extern "C" {
     ENGINECORE_API uint8_t GetVoxel(int x, int y, int z);
     ENGINECORE_API void GenerateTerrain(int seed);
     
+    // Terrain generation runs in the background; the new world replaces the
+    // old one once the swap threshold fraction of its chunks is ready.
+    // GetTerrainProgress returns false when no generation is running.
+    ENGINECORE_API bool GetTerrainProgress(float* progress);
+    ENGINECORE_API void CancelTerrainGeneration();
+    ENGINECORE_API void SetTerrainSwapThreshold(float fraction);
+    
+    // Aggregate voxel queries over loaded chunks (see VoxelQuery.h). Boxes
+    // are inclusive; spheres take the voxels whose centres are within the
+    // radius. Find returns the first match in chunk scan order; Collect
+    // writes up to `capacity` x, y, z triples and returns how many it wrote.
+    // MeasureVoxelQueries compares them with per-voxel GetVoxel on a scratch
+    // world; mismatches must be 0.
+    ENGINECORE_API uint64_t CountVoxelsInBox(int x0, int y0, int z0, int x1, int y1, int z1, uint8_t blockType);
+    ENGINECORE_API uint64_t CountVoxelsInSphere(float x, float y, float z, float radius, uint8_t blockType);
+    ENGINECORE_API bool FindVoxelInBox(int x0, int y0, int z0, int x1, int y1, int z1, uint8_t blockType,
+                                       int* x, int* y, int* z);
+    ENGINECORE_API bool FindVoxelInSphere(float x, float y, float z, float radius, uint8_t blockType,
+                                          int* foundX, int* foundY, int* foundZ);
+    ENGINECORE_API uint32_t CollectVoxelsInBox(int x0, int y0, int z0, int x1, int y1, int z1, uint8_t blockType,
+                                               int32_t* positions, uint32_t capacity);
+    ENGINECORE_API uint32_t CollectVoxelsInSphere(float x, float y, float z, float radius, uint8_t blockType,
+                                                  int32_t* positions, uint32_t capacity);
+    ENGINECORE_API void MeasureVoxelQueries(int32_t seed, int32_t worldRadius, int32_t queryRadius, uint32_t queries,
+                                            float* naiveMilliseconds, float* queryMilliseconds, uint32_t* mismatches);
+    
+    // Paths for agents walking on the terrain (see Navigation.h). FindPath
+    // moves both ends down to the nearest standing position within 64
+    // voxels, writes up to `capacity` x, y, z triples and returns the number
+    // of positions on the path, or 0 if there is none. MeasurePathfinding
+    // solves a batch of paths and edits a scratch world; invalid and
+    // mismatches must be 0.
+    ENGINECORE_API uint32_t FindPath(float startX, float startY, float startZ, float goalX, float goalY, float goalZ,
+                                     int32_t* positions, uint32_t capacity);
+    ENGINECORE_API void GetNavigationStats(uint32_t* chunks, uint32_t* regions, uint32_t* portals,
+                                           float* rebuildMilliseconds);
+    ENGINECORE_API void MeasurePathfinding(int32_t seed, int32_t worldRadius, uint32_t paths, uint32_t edits,
+                                           float* pathsPerSecond, float* rebuildMicroseconds, uint32_t* found,
+                                           uint32_t* invalid, uint32_t* mismatches);
+    
+    // Memory accounting per category (0 voxel data, 1 CPU chunk meshes,
+    // 2 mesh arena, 3 total, 4 meshes waiting for the mesh cache file,
+    // 5 entity component chunks). A budget of 0 is unlimited; over budget
+    // the engine evicts the least recently visible meshes, then chunk data,
+    // and flushes the mesh cache.
+    ENGINECORE_API void SetMemoryBudget(uint32_t category, uint64_t bytes);
+    ENGINECORE_API void GetMemoryStats(uint32_t category, uint64_t* bytes, uint64_t* peakBytes,
+                                       uint64_t* budgetBytes, uint32_t* evictions);
+    ENGINECORE_API void GetChunkResidency(uint32_t* resident, uint32_t* evicted, uint32_t* persisted);
+    
+    // Stress test and scalability benchmark for wait-free voxel reads on a
+    // scratch world: one writer edits and publishes while readerThreads
+    // threads read. inconsistentReads counts torn snapshots and must be 0.
+    ENGINECORE_API void MeasureConcurrentVoxelReads(uint32_t readerThreads, uint32_t milliseconds,
+                                                    double* readsPerSecond, uint32_t* inconsistentReads);
+    
+    // Persistent chunk mesh cache, on by default in a temp directory for
+    // InitializeEngine and off for headless engines; null or "" turns it off.
+    // MeasureMeshCacheStartup generates and meshes a scratch world with an
+    // empty cache and again with a warm one; first-frame times include
+    // terrain generation.
+    ENGINECORE_API bool SetMeshCacheDirectory(const char* path);
+    ENGINECORE_API void GetMeshCacheStats(uint32_t* hits, uint32_t* misses, uint32_t* entries, uint64_t* fileBytes);
+    ENGINECORE_API void MeasureMeshCacheStartup(int32_t seed, int32_t worldRadius, float* coldFirstFrameMilliseconds,
+                                                float* warmFirstFrameMilliseconds, float* coldMeshMilliseconds,
+                                                float* warmMeshMilliseconds, uint32_t* warmHits);
+    
+    // Shared chunk mesh pools. MeasureMeshArenaChurn remeshes a sixteenth of
+    // meshCount scratch meshes per frame and reports the cost, fragmentation
+    // and bytes a renderer would re-upload per frame.
+    ENGINECORE_API void GetMeshArenaStats(uint32_t* meshCount, float* fragmentation, uint32_t* defragmentations,
+                                          uint64_t* defragmentedBytes);
+    ENGINECORE_API void MeasureMeshArenaChurn(uint32_t meshCount, uint32_t frames, float* frameMilliseconds,
+                                              float* averageFragmentation, uint32_t* defragmentations,
+                                              uint64_t* dirtyBytesPerFrame);
+    
+    // Staged world generation benchmark on a scratch region using the engine's
+    // worker threads. stageChunksPerSecond receives 4 values (density, caves,
+    // surface, decoration) in chunks per second of busy worker time.
+    ENGINECORE_API void MeasureWorldGeneration(int32_t seed, int32_t worldRadius, float* milliseconds,
+                                               uint32_t* chunks, float* stageChunksPerSecond);
+    
+    // Chunk replication benchmark: a scratch world replicated to `clients`
+    // in-process loopback clients under heavy editing (see Replication.h).
+    // Bandwidth assumes 60 ticks per second; encode and decode rates are in
+    // raw voxel bytes. mismatches counts replica voxels that differ from the
+    // server world at the end and must be 0.
+    ENGINECORE_API void MeasureReplication(int32_t seed, int32_t worldRadius, uint32_t clients, uint32_t editsPerFrame,
+                                           uint32_t frames, float* kilobytesPerSecond, float* encodeMegabytesPerSecond,
+                                           float* decodeMegabytesPerSecond, float* compressionRatio, uint32_t* mismatches);
+    
+    // Chunk size comparison on a scratch region generated and meshed once per
+    // instantiated chunk size (see ChunkSizeBenchmark.h). Every array receives
+    // 3 values, smallest chunks first; memoryBytes sums voxel blocks, CPU
+    // meshes and chunk bookkeeping.
+    ENGINECORE_API void MeasureChunkSizes(int32_t seed, int32_t worldRadius, int32_t* chunkSizes, uint32_t* chunks,
+                                          uint32_t* drawCalls, float* generationMilliseconds, float* meshMilliseconds,
+                                          float* remeshMicroseconds, float* lookupNanoseconds, uint64_t* memoryBytes);
+    
+    // Edit history: CommitWorldEdit closes the current edit stroke as one
+    // undo step; undo/redo restore copy-on-write chunk snapshots
+    ENGINECORE_API bool CommitWorldEdit();
+    ENGINECORE_API bool UndoWorldEdit();
+    ENGINECORE_API bool RedoWorldEdit();
+    ENGINECORE_API void GetHistoryStats(uint32_t* undoDepth, uint32_t* redoDepth, uint64_t* totalBytes, uint64_t* lastEntryBytes);
+    
+    // Physics: when camera collision is on (outside editor mode) the camera
+    // walks as a character that collides with terrain and falls under gravity.
+    // MeasurePhysicsStep steps a pile of boxes on a scratch world.
+    ENGINECORE_API void SetCameraCollision(bool enabled);
+    ENGINECORE_API uint32_t CreatePhysicsBody(float x, float y, float z, float halfX, float halfY, float halfZ);
+    ENGINECORE_API void DestroyPhysicsBody(uint32_t bodyId);
+    ENGINECORE_API void SetPhysicsBodyVelocity(uint32_t bodyId, float x, float y, float z);
+    ENGINECORE_API void GetPhysicsBodyPosition(uint32_t bodyId, float* x, float* y, float* z);
+    ENGINECORE_API void GetPhysicsStats(uint32_t* bodyCount, uint32_t* contactPairs, float* stepMilliseconds);
+    ENGINECORE_API void MeasurePhysicsStep(uint32_t bodyCount, uint32_t frames, float* stepMilliseconds,
+                                           float* maxStepMilliseconds, uint32_t* contactPairs);
+    
+    // Entities: archetype storage updated by parallel systems every
+    // UpdateEngine. SpawnParticles throws a burst of falling particles that
+    // come to rest on terrain and expire after up to `lifetime` seconds; a
+    // burst holds at most 65536 particles, and the number spawned is returned.
+    // MeasureEntityUpdate runs the same systems over a scratch world.
+    ENGINECORE_API uint32_t SpawnParticles(float x, float y, float z, uint32_t count, float speed, float lifetime);
+    ENGINECORE_API void GetEntityStats(uint32_t* entities, uint32_t* archetypes, uint32_t* phases, float* updateMilliseconds);
+    ENGINECORE_API void MeasureEntityUpdate(uint32_t entityCount, uint32_t frames, float* frameMilliseconds,
+                                            float* entitiesPerSecond);
+    
+    // Software rendering (see SoftwareRenderer.h). SaveFrameImage writes the
+    // last rendered frame as a BMP and GetFrameImageHash hashes its pixels;
+    // both need InitializeEngineSoftware. MeasureSoftwareRendering draws the
+    // current view's chunk meshes into a scratch width x height image on the
+    // engine's worker threads, optionally saving the last frame, and works
+    // with any engine that has rendered at least once. CheckReferenceImage
+    // renders the fixed reference scene (see SoftwareRenderer.h) without
+    // touching the engine, optionally saving it, and returns whether its
+    // hash matches the recorded one.
+    ENGINECORE_API bool SaveFrameImage(const char* path);
+    ENGINECORE_API bool GetFrameImageHash(uint64_t* hash);
+    ENGINECORE_API bool MeasureSoftwareRendering(int width, int height, uint32_t frames, const char* imagePath,
+                                                 float* frameMilliseconds, float* trianglesPerSecond,
+                                                 uint32_t* triangles);
+    ENGINECORE_API bool CheckReferenceImage(const char* imagePath, uint64_t* hash);
+    
+    // Batched commands (see CommandBuffer.h for the stream format). Returns the
+    // number of commands executed or a negative CommandBufferStatus.
+    ENGINECORE_API int32_t ExecuteCommandBuffer(const void* commands, size_t commandSize,
+                                                void* results, size_t resultCapacity, size_t* resultSize);
+    
+    // Session traces: while recording, every state-changing call above is
+    // appended to a timestamped binary trace (see SessionTrace.h). Replay
+    // rebuilds the recorded starting state on the running engine, re-issues
+    // the calls at full speed or with the recorded timing, and reports CPU
+    // time per frame (the calls up to each RenderEngine). Returns the number
+    // of calls replayed or a negative SessionTraceStatus.
+    ENGINECORE_API bool StartSessionRecording(const char* path);
+    ENGINECORE_API uint64_t StopSessionRecording();
+    ENGINECORE_API int32_t ReplaySessionTrace(const char* path, bool realTime,
+                                              uint32_t* frameCount, float* p50Milliseconds,
+                                              float* p99Milliseconds, float* maxMilliseconds);
+    
     // Editor mode
     ENGINECORE_API void SetEditorMode(bool enabled);
     ENGINECORE_API bool IsEditorMode();
@@ -0,0 +1,214 @@
+#include "EntitySystems.h"
+#include "SystemScheduler.h"
+#include "VoxelEngine.h"
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+namespace {
+    constexpr float GRAVITY = 9.81f;
+    constexpr float GROUND_FRICTION = 0.5f;
+
+    // Benchmark world; particles start just above the surface at the origin,
+    // found by searching down from SURFACE_TOP
+    constexpr int BENCHMARK_SEED = 12345;
+    constexpr int BENCHMARK_WORLD_RADIUS = 2;
+    constexpr int SURFACE_TOP = 64;
+    constexpr int SURFACE_DEPTH = 128;
+
+    ComponentMask MaskOf(ComponentId id) {
+        return ComponentMask(1) << id;
+    }
+
+    uint32_t Hash(uint32_t value) {
+        value ^= value >> 16;
+        value *= 0x7FEB352Du;
+        value ^= value >> 15;
+        value *= 0x846CA68Bu;
+        value ^= value >> 16;
+        return value;
+    }
+
+    float HashUnit(uint32_t value) {
+        return (Hash(value) & 0xFFFFFF) / static_cast<float>(0x1000000);
+    }
+
+    uint32_t FloatBits(float value) {
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        return bits;
+    }
+
+    // Remembers the last chunk looked up, since neighbouring entities
+    // usually share one
+    class VoxelProbe {
+    public:
+        explicit VoxelProbe(const VoxelEngine* voxels)
+            : m_voxels(voxels), m_coord{ 0, 0, 0 }, m_chunk(nullptr), m_valid(false) {}
+
+        bool IsSolid(float x, float y, float z) {
+            int vx = static_cast<int>(std::floor(x));
+            int vy = static_cast<int>(std::floor(y));
+            int vz = static_cast<int>(std::floor(z));
+            ChunkCoord coord = WorldToChunkCoord(vx, vy, vz);
+            if (!m_valid || !(coord == m_coord)) {
+                m_coord = coord;
+                m_chunk = m_voxels->FindChunk(coord);
+                m_valid = true;
+            }
+            if (!m_chunk || m_chunk->IsEmpty()) {
+                return false;
+            }
+            return m_chunk->GetVoxel(ChunkLayout::ToLocal(vx), ChunkLayout::ToLocal(vy), ChunkLayout::ToLocal(vz)) !=
+                   static_cast<uint8_t>(BlockType::Air);
+        }
+
+    private:
+        const VoxelEngine* m_voxels;
+        ChunkCoord m_coord;
+        const VoxelChunk* m_chunk;
+        bool m_valid;
+    };
+}
+
+CoreComponents RegisterCoreComponents(EntityWorld& world) {
+    CoreComponents components;
+    components.position = world.RegisterComponent<PositionComponent>();
+    components.velocity = world.RegisterComponent<VelocityComponent>();
+    components.lifetime = world.RegisterComponent<LifetimeComponent>();
+    components.gravity = world.RegisterComponent<GravityComponent>();
+    return components;
+}
+
+void AddCoreSystems(SystemScheduler& scheduler, const CoreComponents& components, const VoxelEngine* voxels) {
+    CoreComponents c = components;
+
+    scheduler.AddSystem("Gravity", MaskOf(c.gravity), MaskOf(c.velocity), [c](const SystemContext& context) {
+        context.ForEachChunk(MaskOf(c.gravity) | MaskOf(c.velocity), [&](const EntityChunkView& chunk) {
+            const GravityComponent* gravity = chunk.GetColumn<GravityComponent>(c.gravity);
+            VelocityComponent* velocity = chunk.GetColumn<VelocityComponent>(c.velocity);
+            float step = GRAVITY * context.deltaTime;
+            for (uint32_t i = 0; i < chunk.count; ++i) {
+                velocity[i].y -= gravity[i].scale * step;
+            }
+        });
+    });
+
+    // Independent of gravity, so both share the first phase
+    scheduler.AddSystem("Lifetime", 0, MaskOf(c.lifetime), [c](const SystemContext& context) {
+        context.ForEachChunk(MaskOf(c.lifetime), [&](const EntityChunkView& chunk) {
+            LifetimeComponent* lifetime = chunk.GetColumn<LifetimeComponent>(c.lifetime);
+            const EntityId* entities = chunk.GetEntities();
+            std::vector<EntityId> expired;
+            for (uint32_t i = 0; i < chunk.count; ++i) {
+                lifetime[i].remaining -= context.deltaTime;
+                if (lifetime[i].remaining <= 0.0f) {
+                    expired.push_back(entities[i]);
+                }
+            }
+            if (!expired.empty()) {
+                context.world.DestroyDeferred(expired.data(), expired.size());
+            }
+        });
+    });
+
+    // Ground contact also changes velocity, so this runs after gravity
+    ComponentMask moved = MaskOf(c.position) | MaskOf(c.velocity);
+    scheduler.AddSystem("Motion", 0, moved, [c, moved, voxels](const SystemContext& context) {
+        context.ForEachChunk(moved, [&](const EntityChunkView& chunk) {
+            PositionComponent* position = chunk.GetColumn<PositionComponent>(c.position);
+            VelocityComponent* velocity = chunk.GetColumn<VelocityComponent>(c.velocity);
+            float dt = context.deltaTime;
+            if (!voxels) {
+                for (uint32_t i = 0; i < chunk.count; ++i) {
+                    position[i].x += velocity[i].x * dt;
+                    position[i].y += velocity[i].y * dt;
+                    position[i].z += velocity[i].z * dt;
+                }
+                return;
+            }
+
+            VoxelProbe probe(voxels);
+            for (uint32_t i = 0; i < chunk.count; ++i) {
+                PositionComponent next{ position[i].x + velocity[i].x * dt,
+                                        position[i].y + velocity[i].y * dt,
+                                        position[i].z + velocity[i].z * dt };
+                if (probe.IsSolid(next.x, next.y, next.z)) {
+                    // Come to rest against the voxel instead of entering it
+                    velocity[i].x *= GROUND_FRICTION;
+                    velocity[i].y = 0.0f;
+                    velocity[i].z *= GROUND_FRICTION;
+                } else {
+                    position[i] = next;
+                }
+            }
+        });
+    });
+}
+
+void SpawnParticles(EntityWorld& world, const CoreComponents& components, const DirectX::XMFLOAT3& origin,
+                    uint32_t count, float speed, float lifetime) {
+    ComponentMask mask = MaskOf(components.position) | MaskOf(components.velocity) |
+                         MaskOf(components.lifetime) | MaskOf(components.gravity);
+    std::vector<EntityId> entities(count);
+    world.CreateEntities(mask, count, entities.data());
+
+    uint32_t salt = Hash(FloatBits(origin.x) ^ Hash(FloatBits(origin.y) ^ Hash(FloatBits(origin.z))));
+    for (uint32_t i = 0; i < count; ++i) {
+        // Upper hemisphere, biased upwards
+        float angle = HashUnit(salt + i * 2) * 6.2831853f;
+        float rise = 0.3f + 0.7f * HashUnit(salt + i * 2 + 1);
+        float flat = std::sqrt(1.0f - rise * rise);
+
+        EntityId entity = entities[i];
+        *world.Get<PositionComponent>(entity, components.position) = PositionComponent{ origin.x, origin.y, origin.z };
+        *world.Get<VelocityComponent>(entity, components.velocity) =
+            VelocityComponent{ std::cos(angle) * flat * speed, rise * speed, std::sin(angle) * flat * speed };
+        world.Get<LifetimeComponent>(entity, components.lifetime)->remaining = lifetime * (0.5f + 0.5f * HashUnit(~(salt + i)));
+        world.Get<GravityComponent>(entity, components.gravity)->scale = 1.0f;
+    }
+}
+
+EntityBenchmarkStats MeasureEntityUpdate(uint32_t entityCount, uint32_t frames, ThreadPool* threadPool) {
+    using Clock = std::chrono::steady_clock;
+    const float deltaTime = 1.0f / 60.0f;
+
+    VoxelEngine voxels(threadPool);
+    voxels.SetWorldRadius(BENCHMARK_WORLD_RADIUS);
+    voxels.GenerateTerrain(BENCHMARK_SEED);
+    voxels.WaitForTerrain();
+    int surface = SURFACE_TOP;
+    while (surface > SURFACE_TOP - SURFACE_DEPTH && voxels.GetVoxel(0, surface, 0) == 0) {
+        --surface;
+    }
+
+    EntityWorld world;
+    CoreComponents components = RegisterCoreComponents(world);
+    SystemScheduler scheduler(threadPool);
+    AddCoreSystems(scheduler, components, &voxels);
+
+    // Lifetimes outlast the run so the population stays constant
+    auto start = Clock::now();
+    SpawnParticles(world, components, DirectX::XMFLOAT3(0.5f, surface + 2.0f, 0.5f), entityCount, 10.0f,
+                   2.0f * (frames + 1) * deltaTime + 1.0f);
+    auto spawned = Clock::now();
+    for (uint32_t frame = 0; frame < frames; ++frame) {
+        scheduler.Run(world, deltaTime);
+    }
+    auto finished = Clock::now();
+
+    EntityBenchmarkStats stats = {};
+    stats.entities = entityCount;
+    stats.frames = frames;
+    stats.phases = scheduler.GetPhaseCount();
+    stats.spawnMilliseconds = std::chrono::duration<float, std::milli>(spawned - start).count();
+    float seconds = std::chrono::duration<float>(finished - spawned).count();
+    if (frames > 0) {
+        stats.frameMilliseconds = seconds * 1000.0f / frames;
+    }
+    if (seconds > 0.0f) {
+        stats.entitiesPerSecond = static_cast<float>(entityCount) * frames / seconds;
+    }
+    return stats;
+}
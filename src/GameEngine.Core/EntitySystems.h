@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdint>
+#include <DirectXMath.h>
+#include "EntityWorld.h"
+
+class SystemScheduler;
+class ThreadPool;
+class VoxelEngine;
+
+struct PositionComponent {
+    float x, y, z;
+};
+
+struct VelocityComponent {
+    float x, y, z;
+};
+
+// Seconds until the entity is destroyed
+struct LifetimeComponent {
+    float remaining;
+};
+
+struct GravityComponent {
+    float scale;
+};
+
+struct CoreComponents {
+    ComponentId position;
+    ComponentId velocity;
+    ComponentId lifetime;
+    ComponentId gravity;
+};
+
+CoreComponents RegisterCoreComponents(EntityWorld& world);
+
+// Gravity, lifetime expiry and motion. With a voxel world, moving entities
+// stop on solid voxels; the world must not be edited while systems run.
+void AddCoreSystems(SystemScheduler& scheduler, const CoreComponents& components, const VoxelEngine* voxels);
+
+// Burst of falling particles thrown upwards from `origin`. Directions are
+// derived from the arguments alone, so a replayed call spawns the same burst.
+void SpawnParticles(EntityWorld& world, const CoreComponents& components, const DirectX::XMFLOAT3& origin,
+                    uint32_t count, float speed, float lifetime);
+
+struct EntityBenchmarkStats {
+    uint32_t entities;
+    uint32_t frames;
+    uint32_t phases;
+    float spawnMilliseconds;
+    float frameMilliseconds;        // average scheduler run
+    float entitiesPerSecond;        // entity updates per second of frame time
+};
+
+// Core systems over a scratch entity world, with particles landing on a
+// small generated voxel world
+EntityBenchmarkStats MeasureEntityUpdate(uint32_t entityCount, uint32_t frames, ThreadPool* threadPool);
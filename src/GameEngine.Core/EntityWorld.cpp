@@ -0,0 +1,340 @@
+#include "EntityWorld.h"
+#include "MemoryBudget.h"
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <new>
+
+namespace {
+    constexpr size_t CHUNK_ALIGNMENT = 64;
+
+    uint8_t* AllocateChunk(size_t bytes) {
+        uint8_t* data = static_cast<uint8_t*>(::operator new(bytes, std::align_val_t(CHUNK_ALIGNMENT)));
+        TrackAllocation(MemoryCategory::Entities, bytes);
+        return data;
+    }
+
+    void FreeChunk(uint8_t* data, size_t bytes) {
+        TrackDeallocation(MemoryCategory::Entities, bytes);
+        ::operator delete(data, std::align_val_t(CHUNK_ALIGNMENT));
+    }
+
+    EntityId* GetEntityColumn(uint8_t* data) {
+        return reinterpret_cast<EntityId*>(data);
+    }
+
+    uint32_t GetSlot(EntityId entity) {
+        return static_cast<uint32_t>(entity);
+    }
+
+    uint32_t GetGeneration(EntityId entity) {
+        return static_cast<uint32_t>(entity >> 32);
+    }
+
+    EntityId MakeEntityId(uint32_t slot, uint32_t generation) {
+        return (static_cast<EntityId>(generation) << 32) | slot;
+    }
+
+    // Calls fn(id) for every component in the mask, lowest id first
+    template <typename Fn>
+    void ForEachComponent(ComponentMask mask, Fn&& fn) {
+        while (mask != 0) {
+            fn(static_cast<ComponentId>(std::countr_zero(mask)));
+            mask &= mask - 1;
+        }
+    }
+}
+
+EntityWorld::EntityWorld()
+    : m_entityCount(0)
+{
+}
+
+EntityWorld::~EntityWorld() {
+    for (const auto& archetype : m_archetypes) {
+        for (const EntityArchetype::Chunk& chunk : archetype->m_chunks) {
+            FreeChunk(chunk.data, archetype->m_chunkBytes);
+        }
+    }
+}
+
+ComponentId EntityWorld::RegisterComponent(std::type_index type, size_t size, size_t alignment) {
+    auto it = m_componentIds.find(type);
+    if (it != m_componentIds.end()) {
+        return it->second;
+    }
+    if (m_components.size() == MAX_COMPONENT_TYPES) {
+        return InvalidComponent;
+    }
+
+    ComponentId id = static_cast<ComponentId>(m_components.size());
+    m_components.push_back(ComponentInfo{ size, alignment });
+    m_componentIds.emplace(type, id);
+    return id;
+}
+
+uint32_t EntityWorld::GetOrCreateArchetype(ComponentMask mask) {
+    auto it = m_archetypeByMask.find(mask);
+    if (it != m_archetypeByMask.end()) {
+        return it->second;
+    }
+
+    auto archetype = std::make_unique<EntityArchetype>();
+    archetype->m_mask = mask;
+    archetype->m_entityCount = 0;
+    std::fill(std::begin(archetype->m_columnOffsets), std::end(archetype->m_columnOffsets), -1);
+
+    // As many entities as fit in one chunk after alignment padding
+    size_t entityBytes = sizeof(EntityId);
+    size_t padding = 0;
+    ForEachComponent(mask, [&](ComponentId id) {
+        entityBytes += m_components[id].size;
+        padding += m_components[id].alignment;
+    });
+    size_t capacity = ENTITY_CHUNK_BYTES > padding ? (ENTITY_CHUNK_BYTES - padding) / entityBytes : 0;
+    archetype->m_capacity = static_cast<uint32_t>(std::max<size_t>(capacity, 1));
+
+    // Entity ids first, then one column per component in id order
+    size_t offset = sizeof(EntityId) * archetype->m_capacity;
+    ForEachComponent(mask, [&](ComponentId id) {
+        const ComponentInfo& info = m_components[id];
+        offset = (offset + info.alignment - 1) / info.alignment * info.alignment;
+        archetype->m_columnOffsets[id] = static_cast<int32_t>(offset);
+        offset += info.size * archetype->m_capacity;
+    });
+    archetype->m_chunkBytes = offset;
+
+    uint32_t index = static_cast<uint32_t>(m_archetypes.size());
+    m_archetypes.push_back(std::move(archetype));
+    m_archetypeByMask.emplace(mask, index);
+    return index;
+}
+
+uint32_t EntityWorld::AllocateSlot() {
+    if (!m_freeSlots.empty()) {
+        uint32_t slot = m_freeSlots.back();
+        m_freeSlots.pop_back();
+        return slot;
+    }
+    m_records.push_back(EntityRecord{ 1, InvalidArchetype, 0, 0 });
+    return static_cast<uint32_t>(m_records.size() - 1);
+}
+
+EntityWorld::EntityRecord* EntityWorld::FindRecord(EntityId entity) {
+    uint32_t slot = GetSlot(entity);
+    if (slot >= m_records.size()) {
+        return nullptr;
+    }
+    EntityRecord& record = m_records[slot];
+    if (record.archetype == InvalidArchetype || record.generation != GetGeneration(entity)) {
+        return nullptr;
+    }
+    return &record;
+}
+
+const EntityWorld::EntityRecord* EntityWorld::FindRecord(EntityId entity) const {
+    return const_cast<EntityWorld*>(this)->FindRecord(entity);
+}
+
+void EntityWorld::AppendRow(uint32_t archetypeIndex, EntityId entity) {
+    EntityArchetype& archetype = *m_archetypes[archetypeIndex];
+    if (archetype.m_chunks.empty() || archetype.m_chunks.back().count == archetype.m_capacity) {
+        archetype.m_chunks.push_back(EntityArchetype::Chunk{ AllocateChunk(archetype.m_chunkBytes), 0 });
+    }
+
+    EntityArchetype::Chunk& chunk = archetype.m_chunks.back();
+    uint32_t row = chunk.count++;
+    GetEntityColumn(chunk.data)[row] = entity;
+    ForEachComponent(archetype.m_mask, [&](ComponentId id) {
+        size_t size = m_components[id].size;
+        std::memset(chunk.data + archetype.m_columnOffsets[id] + row * size, 0, size);
+    });
+    ++archetype.m_entityCount;
+
+    EntityRecord& record = m_records[GetSlot(entity)];
+    record.archetype = archetypeIndex;
+    record.chunk = static_cast<uint32_t>(archetype.m_chunks.size() - 1);
+    record.row = row;
+}
+
+void EntityWorld::RemoveRow(uint32_t archetypeIndex, uint32_t chunkIndex, uint32_t row) {
+    EntityArchetype& archetype = *m_archetypes[archetypeIndex];
+    uint32_t lastChunkIndex = static_cast<uint32_t>(archetype.m_chunks.size() - 1);
+    EntityArchetype::Chunk& last = archetype.m_chunks[lastChunkIndex];
+    uint32_t lastRow = last.count - 1;
+
+    if (chunkIndex != lastChunkIndex || row != lastRow) {
+        EntityArchetype::Chunk& target = archetype.m_chunks[chunkIndex];
+        EntityId moved = GetEntityColumn(last.data)[lastRow];
+        GetEntityColumn(target.data)[row] = moved;
+        ForEachComponent(archetype.m_mask, [&](ComponentId id) {
+            size_t size = m_components[id].size;
+            int32_t offset = archetype.m_columnOffsets[id];
+            std::memcpy(target.data + offset + row * size, last.data + offset + lastRow * size, size);
+        });
+
+        EntityRecord& record = m_records[GetSlot(moved)];
+        record.chunk = chunkIndex;
+        record.row = row;
+    }
+
+    if (--last.count == 0) {
+        FreeChunk(last.data, archetype.m_chunkBytes);
+        archetype.m_chunks.pop_back();
+    }
+    --archetype.m_entityCount;
+}
+
+EntityId EntityWorld::CreateEntity(ComponentMask components) {
+    EntityId entity;
+    CreateEntities(components, 1, &entity);
+    return entity;
+}
+
+void EntityWorld::CreateEntities(ComponentMask components, size_t count, EntityId* entities) {
+    uint32_t archetypeIndex = GetOrCreateArchetype(components);
+    for (size_t i = 0; i < count; ++i) {
+        uint32_t slot = AllocateSlot();
+        EntityId entity = MakeEntityId(slot, m_records[slot].generation);
+        AppendRow(archetypeIndex, entity);
+        if (entities) {
+            entities[i] = entity;
+        }
+    }
+    m_entityCount += static_cast<uint32_t>(count);
+}
+
+void EntityWorld::DestroyEntity(EntityId entity) {
+    EntityRecord* record = FindRecord(entity);
+    if (!record) {
+        return;
+    }
+
+    RemoveRow(record->archetype, record->chunk, record->row);
+    record->archetype = InvalidArchetype;
+    if (++record->generation == 0) {
+        record->generation = 1;
+    }
+    m_freeSlots.push_back(GetSlot(entity));
+    --m_entityCount;
+}
+
+bool EntityWorld::IsAlive(EntityId entity) const {
+    return FindRecord(entity) != nullptr;
+}
+
+void EntityWorld::MoveEntity(EntityId entity, ComponentMask newMask) {
+    EntityRecord* record = FindRecord(entity);
+    if (!record) {
+        return;
+    }
+    uint32_t oldIndex = record->archetype;
+    if (m_archetypes[oldIndex]->m_mask == newMask) {
+        return;
+    }
+
+    uint32_t oldChunk = record->chunk;
+    uint32_t oldRow = record->row;
+    uint32_t newIndex = GetOrCreateArchetype(newMask);
+    AppendRow(newIndex, entity);
+
+    // Carry over the components both archetypes have
+    const EntityArchetype& from = *m_archetypes[oldIndex];
+    const EntityArchetype& to = *m_archetypes[newIndex];
+    const uint8_t* source = from.m_chunks[oldChunk].data;
+    uint8_t* target = to.m_chunks[record->chunk].data;
+    ForEachComponent(from.m_mask & to.m_mask, [&](ComponentId id) {
+        size_t size = m_components[id].size;
+        std::memcpy(target + to.m_columnOffsets[id] + record->row * size,
+                    source + from.m_columnOffsets[id] + oldRow * size, size);
+    });
+
+    RemoveRow(oldIndex, oldChunk, oldRow);
+}
+
+void EntityWorld::AddComponents(EntityId entity, ComponentMask components) {
+    if (const EntityRecord* record = FindRecord(entity)) {
+        MoveEntity(entity, m_archetypes[record->archetype]->m_mask | components);
+    }
+}
+
+void EntityWorld::RemoveComponents(EntityId entity, ComponentMask components) {
+    if (const EntityRecord* record = FindRecord(entity)) {
+        MoveEntity(entity, m_archetypes[record->archetype]->m_mask & ~components);
+    }
+}
+
+void* EntityWorld::GetComponent(EntityId entity, ComponentId id) {
+    const EntityRecord* record = FindRecord(entity);
+    if (!record || id >= MAX_COMPONENT_TYPES) {
+        return nullptr;
+    }
+
+    const EntityArchetype& archetype = *m_archetypes[record->archetype];
+    int32_t offset = archetype.m_columnOffsets[id];
+    if (offset < 0) {
+        return nullptr;
+    }
+    return archetype.m_chunks[record->chunk].data + offset + record->row * m_components[id].size;
+}
+
+void EntityWorld::DestroyDeferred(const EntityId* entities, size_t count) {
+    std::lock_guard<std::mutex> lock(m_deferredMutex);
+    m_deferredDestroy.insert(m_deferredDestroy.end(), entities, entities + count);
+}
+
+void EntityWorld::FlushDeferred() {
+    std::vector<EntityId> destroy;
+    {
+        std::lock_guard<std::mutex> lock(m_deferredMutex);
+        destroy.swap(m_deferredDestroy);
+    }
+
+    // Sorted so the result does not depend on which thread queued first
+    std::sort(destroy.begin(), destroy.end());
+    destroy.erase(std::unique(destroy.begin(), destroy.end()), destroy.end());
+    for (EntityId entity : destroy) {
+        DestroyEntity(entity);
+    }
+}
+
+void EntityWorld::GatherChunks(ComponentMask required, std::vector<EntityChunkView>& chunks) const {
+    ForEachChunk(required, [&](const EntityChunkView& view) {
+        chunks.push_back(view);
+    });
+}
+
+void EntityWorld::Clear() {
+    for (const auto& archetype : m_archetypes) {
+        for (const EntityArchetype::Chunk& chunk : archetype->m_chunks) {
+            FreeChunk(chunk.data, archetype->m_chunkBytes);
+        }
+        archetype->m_chunks.clear();
+        archetype->m_entityCount = 0;
+    }
+
+    for (uint32_t slot = 0; slot < m_records.size(); ++slot) {
+        EntityRecord& record = m_records[slot];
+        if (record.archetype != InvalidArchetype) {
+            record.archetype = InvalidArchetype;
+            if (++record.generation == 0) {
+                record.generation = 1;
+            }
+            m_freeSlots.push_back(slot);
+        }
+    }
+    m_entityCount = 0;
+
+    std::lock_guard<std::mutex> lock(m_deferredMutex);
+    m_deferredDestroy.clear();
+}
+
+EntityWorldStats EntityWorld::GetStats() const {
+    EntityWorldStats stats = {};
+    stats.entities = m_entityCount;
+    stats.archetypes = static_cast<uint32_t>(m_archetypes.size());
+    for (const auto& archetype : m_archetypes) {
+        stats.chunks += static_cast<uint32_t>(archetype->m_chunks.size());
+    }
+    return stats;
+}
@@ -0,0 +1,183 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <typeindex>
+#include <typeinfo>
+#include <unordered_map>
+#include <vector>
+
+// Generation in the high 32 bits, slot in the low 32; generations start at
+// 1, so 0 never names an entity
+using EntityId = uint64_t;
+constexpr EntityId InvalidEntity = 0;
+
+using ComponentId = uint32_t;
+using ComponentMask = uint64_t;
+constexpr uint32_t MAX_COMPONENT_TYPES = 64;
+constexpr ComponentId InvalidComponent = UINT32_MAX;
+
+// Target size of one archetype chunk
+constexpr size_t ENTITY_CHUNK_BYTES = 16 * 1024;
+
+struct EntityWorldStats {
+    uint32_t entities;
+    uint32_t archetypes;
+    uint32_t chunks;
+};
+
+// All entities with exactly one set of components. They are stored in
+// fixed-size chunks; inside a chunk the entity ids and each component form
+// their own contiguous column, so a system touches only the columns it uses.
+class EntityArchetype {
+public:
+    ComponentMask GetMask() const { return m_mask; }
+    uint32_t GetChunkCapacity() const { return m_capacity; }
+    uint32_t GetEntityCount() const { return m_entityCount; }
+    size_t GetChunkCount() const { return m_chunks.size(); }
+
+    // Byte offset of a component's column within a chunk, -1 if absent
+    int32_t GetColumnOffset(ComponentId id) const { return m_columnOffsets[id]; }
+
+private:
+    friend class EntityWorld;
+
+    struct Chunk {
+        uint8_t* data;
+        uint32_t count;
+    };
+
+    ComponentMask m_mask;
+    int32_t m_columnOffsets[MAX_COMPONENT_TYPES];
+    uint32_t m_capacity;
+    size_t m_chunkBytes;
+    std::vector<Chunk> m_chunks;    // all full except the last
+    uint32_t m_entityCount;
+};
+
+// One chunk as seen by a system
+struct EntityChunkView {
+    const EntityArchetype* archetype;
+    uint8_t* data;
+    uint32_t count;
+
+    const EntityId* GetEntities() const { return reinterpret_cast<const EntityId*>(data); }
+
+    // Null if the archetype lacks the component
+    template <typename T>
+    T* GetColumn(ComponentId id) const {
+        int32_t offset = archetype->GetColumnOffset(id);
+        return offset >= 0 ? reinterpret_cast<T*>(data + offset) : nullptr;
+    }
+};
+
+// Archetype-based entity storage. Components are plain data registered
+// once per type; an entity's component set picks its archetype, and
+// adding or removing components moves it to another one. Destroying an
+// entity moves the archetype's last entity into the hole, so chunks stay
+// dense. Structural changes must not overlap iteration; systems running in
+// parallel queue destruction with DestroyDeferred instead.
+class EntityWorld {
+public:
+    EntityWorld();
+    ~EntityWorld();
+
+    EntityWorld(const EntityWorld&) = delete;
+    EntityWorld& operator=(const EntityWorld&) = delete;
+
+    // Returns the existing id if T is already registered
+    template <typename T>
+    ComponentId RegisterComponent() {
+        static_assert(std::is_trivially_copyable_v<T>, "components are copied as raw bytes");
+        static_assert(alignof(T) <= 64, "chunks are 64-byte aligned");
+        return RegisterComponent(std::type_index(typeid(T)), sizeof(T), alignof(T));
+    }
+
+    template <typename T>
+    ComponentId GetComponentId() const {
+        auto it = m_componentIds.find(std::type_index(typeid(T)));
+        return it != m_componentIds.end() ? it->second : InvalidComponent;
+    }
+
+    // New components start zeroed
+    EntityId CreateEntity(ComponentMask components);
+    void CreateEntities(ComponentMask components, size_t count, EntityId* entities = nullptr);
+    void DestroyEntity(EntityId entity);
+    bool IsAlive(EntityId entity) const;
+
+    void AddComponents(EntityId entity, ComponentMask components);
+    void RemoveComponents(EntityId entity, ComponentMask components);
+
+    // Null if the entity is dead or lacks the component. Pointers are
+    // invalidated by any structural change.
+    void* GetComponent(EntityId entity, ComponentId id);
+
+    template <typename T>
+    T* Get(EntityId entity, ComponentId id) { return static_cast<T*>(GetComponent(entity, id)); }
+
+    // Thread-safe; applied by FlushDeferred (the scheduler flushes after
+    // every run). Ids already dead by then are ignored.
+    void DestroyDeferred(const EntityId* entities, size_t count);
+    void FlushDeferred();
+
+    // Chunks of every archetype that has all of `required`
+    void GatherChunks(ComponentMask required, std::vector<EntityChunkView>& chunks) const;
+
+    template <typename Fn>
+    void ForEachChunk(ComponentMask required, Fn&& fn) const {
+        for (const auto& archetype : m_archetypes) {
+            if ((archetype->m_mask & required) != required) {
+                continue;
+            }
+            for (const EntityArchetype::Chunk& chunk : archetype->m_chunks) {
+                fn(EntityChunkView{ archetype.get(), chunk.data, chunk.count });
+            }
+        }
+    }
+
+    void Clear();
+    EntityWorldStats GetStats() const;
+
+private:
+    struct ComponentInfo {
+        size_t size;
+        size_t alignment;
+    };
+
+    struct EntityRecord {
+        uint32_t generation;
+        uint32_t archetype;     // InvalidArchetype: slot is free
+        uint32_t chunk;
+        uint32_t row;
+    };
+
+    static constexpr uint32_t InvalidArchetype = UINT32_MAX;
+
+    ComponentId RegisterComponent(std::type_index type, size_t size, size_t alignment);
+    uint32_t GetOrCreateArchetype(ComponentMask mask);
+    EntityRecord* FindRecord(EntityId entity);
+    const EntityRecord* FindRecord(EntityId entity) const;
+    uint32_t AllocateSlot();
+
+    // Appends a zeroed row for `entity` and points its record at it
+    void AppendRow(uint32_t archetypeIndex, EntityId entity);
+    // Fills the row with the archetype's last entity and frees the last row
+    void RemoveRow(uint32_t archetypeIndex, uint32_t chunk, uint32_t row);
+    void MoveEntity(EntityId entity, ComponentMask newMask);
+
+    std::unordered_map<std::type_index, ComponentId> m_componentIds;
+    std::vector<ComponentInfo> m_components;
+
+    std::vector<std::unique_ptr<EntityArchetype>> m_archetypes;
+    std::unordered_map<ComponentMask, uint32_t> m_archetypeByMask;
+
+    std::vector<EntityRecord> m_records;    // indexed by slot
+    std::vector<uint32_t> m_freeSlots;
+    uint32_t m_entityCount;
+
+    std::mutex m_deferredMutex;
+    std::vector<EntityId> m_deferredDestroy;
+};
@@ -0,0 +1,33 @@
+#include "Frustum.h"
+
+using namespace DirectX;
+
+Frustum::Frustum(const XMMATRIX& viewProjection) {
+    XMFLOAT4X4 m;
+    XMStoreFloat4x4(&m, viewProjection);
+
+    auto column = [&m](int c) {
+        return XMFLOAT4(m.m[0][c], m.m[1][c], m.m[2][c], m.m[3][c]);
+    };
+    XMFLOAT4 x = column(0), y = column(1), z = column(2), w = column(3);
+
+    m_planes[0] = XMFLOAT4(w.x + x.x, w.y + x.y, w.z + x.z, w.w + x.w);     // left
+    m_planes[1] = XMFLOAT4(w.x - x.x, w.y - x.y, w.z - x.z, w.w - x.w);     // right
+    m_planes[2] = XMFLOAT4(w.x + y.x, w.y + y.y, w.z + y.z, w.w + y.w);     // bottom
+    m_planes[3] = XMFLOAT4(w.x - y.x, w.y - y.y, w.z - y.z, w.w - y.w);     // top
+    m_planes[4] = z;                                                        // near
+    m_planes[5] = XMFLOAT4(w.x - z.x, w.y - z.y, w.z - z.z, w.w - z.w);     // far
+}
+
+bool Frustum::IntersectsAabb(const XMFLOAT3& minCorner, const XMFLOAT3& maxCorner) const {
+    for (const XMFLOAT4& plane : m_planes) {
+        // Corner furthest along the plane normal
+        float px = plane.x >= 0.0f ? maxCorner.x : minCorner.x;
+        float py = plane.y >= 0.0f ? maxCorner.y : minCorner.y;
+        float pz = plane.z >= 0.0f ? maxCorner.z : minCorner.z;
+        if (plane.x * px + plane.y * py + plane.z * pz + plane.w < 0.0f) {
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <DirectXMath.h>
+
+// View frustum as six inward-facing planes, extracted from a row-vector
+// view-projection matrix with D3D depth range [0, 1].
+class Frustum {
+public:
+    explicit Frustum(const DirectX::XMMATRIX& viewProjection);
+
+    // Conservative: may accept boxes just outside a corner, never rejects
+    // a box that is inside
+    bool IntersectsAabb(const DirectX::XMFLOAT3& minCorner, const DirectX::XMFLOAT3& maxCorner) const;
+
+private:
+    DirectX::XMFLOAT4 m_planes[6];
+};
@@ -0,0 +1,66 @@
+#include "MemoryBudget.h"
+#include <atomic>
+
+namespace {
+    std::atomic<uint64_t> g_trackedBytes[MEMORY_CATEGORY_COUNT];
+    std::atomic<uint64_t> g_peakBytes[MEMORY_CATEGORY_COUNT];
+
+    void RaisePeak(uint32_t index, uint64_t bytes) {
+        uint64_t peak = g_peakBytes[index].load(std::memory_order_relaxed);
+        while (bytes > peak && !g_peakBytes[index].compare_exchange_weak(peak, bytes, std::memory_order_relaxed)) {
+        }
+    }
+}
+
+void TrackAllocation(MemoryCategory category, size_t bytes) {
+    uint32_t index = static_cast<uint32_t>(category);
+    uint32_t total = static_cast<uint32_t>(MemoryCategory::Total);
+    RaisePeak(index, g_trackedBytes[index].fetch_add(bytes, std::memory_order_relaxed) + bytes);
+    RaisePeak(total, g_trackedBytes[total].fetch_add(bytes, std::memory_order_relaxed) + bytes);
+}
+
+void TrackDeallocation(MemoryCategory category, size_t bytes) {
+    g_trackedBytes[static_cast<uint32_t>(category)].fetch_sub(bytes, std::memory_order_relaxed);
+    g_trackedBytes[static_cast<uint32_t>(MemoryCategory::Total)].fetch_sub(bytes, std::memory_order_relaxed);
+}
+
+uint64_t GetTrackedBytes(MemoryCategory category) {
+    return g_trackedBytes[static_cast<uint32_t>(category)].load(std::memory_order_relaxed);
+}
+
+uint64_t GetPeakTrackedBytes(MemoryCategory category) {
+    return g_peakBytes[static_cast<uint32_t>(category)].load(std::memory_order_relaxed);
+}
+
+MemoryBudget::MemoryBudget()
+    : m_budgets{}
+    , m_evictions{}
+{
+}
+
+void MemoryBudget::SetBudget(MemoryCategory category, uint64_t bytes) {
+    m_budgets[static_cast<uint32_t>(category)] = bytes;
+}
+
+uint64_t MemoryBudget::GetBudget(MemoryCategory category) const {
+    return m_budgets[static_cast<uint32_t>(category)];
+}
+
+uint64_t MemoryBudget::GetOverage(MemoryCategory category) const {
+    uint64_t budget = GetBudget(category);
+    uint64_t bytes = GetTrackedBytes(category);
+    return (budget > 0 && bytes > budget) ? bytes - budget : 0;
+}
+
+void MemoryBudget::RecordEvictions(MemoryCategory category, uint32_t count) {
+    m_evictions[static_cast<uint32_t>(category)] += count;
+}
+
+MemoryCategoryStats MemoryBudget::GetStats(MemoryCategory category) const {
+    MemoryCategoryStats stats = {};
+    stats.bytes = GetTrackedBytes(category);
+    stats.peakBytes = GetPeakTrackedBytes(category);
+    stats.budgetBytes = GetBudget(category);
+    stats.evictions = m_evictions[static_cast<uint32_t>(category)];
+    return stats;
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+// Allocation tags. Total is not a tag: it is the sum of the others and
+// only carries a budget. Ids are part of the C ABI and of session traces,
+// so new tags are appended.
+enum class MemoryCategory : uint32_t {
+    VoxelData = 0,      // chunk voxel blocks, including ones shared with history and snapshots
+    ChunkMeshes = 1,    // CPU meshes between meshing and arena upload
+    MeshArena = 2,      // shared vertex and index pools
+    Total = 3,
+    Cache = 4,          // meshes waiting to be written to the mesh cache
+    Entities = 5,       // entity component chunks
+};
+
+constexpr uint32_t MEMORY_CATEGORY_COUNT = 6;
+
+// Process-wide byte counters per category; thread-safe
+void TrackAllocation(MemoryCategory category, size_t bytes);
+void TrackDeallocation(MemoryCategory category, size_t bytes);
+uint64_t GetTrackedBytes(MemoryCategory category);
+uint64_t GetPeakTrackedBytes(MemoryCategory category);
+
+// Standard allocator that reports every allocation to its category
+template <typename T, MemoryCategory Category>
+struct TrackingAllocator {
+    using value_type = T;
+
+    template <typename U>
+    struct rebind {
+        using other = TrackingAllocator<U, Category>;
+    };
+
+    TrackingAllocator() = default;
+    template <typename U>
+    TrackingAllocator(const TrackingAllocator<U, Category>&) {}
+
+    T* allocate(size_t count) {
+        T* data = static_cast<T*>(::operator new(count * sizeof(T)));
+        TrackAllocation(Category, count * sizeof(T));
+        return data;
+    }
+
+    void deallocate(T* data, size_t count) {
+        TrackDeallocation(Category, count * sizeof(T));
+        ::operator delete(data);
+    }
+
+    template <typename U>
+    bool operator==(const TrackingAllocator<U, Category>&) const { return true; }
+    template <typename U>
+    bool operator!=(const TrackingAllocator<U, Category>&) const { return false; }
+};
+
+struct MemoryCategoryStats {
+    uint64_t bytes;
+    uint64_t peakBytes;
+    uint64_t budgetBytes;   // 0: unlimited
+    uint32_t evictions;     // items evicted to meet this budget
+};
+
+// Configurable limits over the tracked categories. The budget only
+// reports overage; the owner of the evictable data decides what to drop.
+class MemoryBudget {
+public:
+    MemoryBudget();
+
+    void SetBudget(MemoryCategory category, uint64_t bytes);
+    uint64_t GetBudget(MemoryCategory category) const;
+
+    // Bytes above the budget, or 0 when within it or unlimited
+    uint64_t GetOverage(MemoryCategory category) const;
+
+    void RecordEvictions(MemoryCategory category, uint32_t count);
+    MemoryCategoryStats GetStats(MemoryCategory category) const;
+
+private:
+    uint64_t m_budgets[MEMORY_CATEGORY_COUNT];
+    uint32_t m_evictions[MEMORY_CATEGORY_COUNT];
+};
@@ -0,0 +1,638 @@
+#include "MeshArena.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <random>
+
+namespace {
+    // Defragment leaves a pool alone until at least this share of it is
+    // free; a few small holes in a full pool are not worth re-uploading
+    constexpr float DEFRAG_MIN_FREE = 0.125f;
+    // Elements one Defragment call may move per pool; a mesh larger than
+    // this still moves on its own
+    constexpr uint32_t DEFRAG_VERTEX_BUDGET = 1 << 13;
+    constexpr uint32_t DEFRAG_INDEX_BUDGET = 1 << 14;
+
+    constexpr uint32_t BENCHMARK_SEED = 12345;
+    constexpr uint32_t BENCHMARK_MIN_VERTICES = 64;
+    constexpr uint32_t BENCHMARK_MAX_VERTICES = 4096;
+
+    bool CanCompactFor(const FreeListAllocator& allocator, uint32_t count) {
+        uint32_t totalFree = allocator.GetCapacity() - allocator.GetUsed();
+        return totalFree >= count && totalFree >= allocator.GetCapacity() * DEFRAG_MIN_FREE;
+    }
+
+    float PoolFragmentation(const FreeListAllocator& allocator) {
+        uint32_t totalFree = allocator.GetCapacity() - allocator.GetUsed();
+        return totalFree > 0 ? 1.0f - static_cast<float>(allocator.GetLargestFreeBlock()) / totalFree : 0.0f;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// FreeListAllocator
+// ---------------------------------------------------------------------------
+
+FreeListAllocator::FreeListAllocator(uint32_t capacity)
+    : m_capacity(0)
+    , m_used(0)
+{
+    Reset(capacity, 0);
+}
+
+uint32_t FreeListAllocator::Allocate(uint32_t size) {
+    if (size == 0) {
+        return InvalidOffset;
+    }
+
+    // Best fit: smallest free block that can hold the request
+    auto fit = m_bySize.lower_bound(size);
+    if (fit == m_bySize.end()) {
+        return InvalidOffset;
+    }
+
+    uint32_t blockSize = fit->first;
+    uint32_t offset = fit->second;
+    EraseFree(m_byOffset.find(offset));
+
+    if (blockSize > size) {
+        InsertFree(offset + size, blockSize - size);
+    }
+
+    m_used += size;
+    return offset;
+}
+
+bool FreeListAllocator::AllocateAt(uint32_t offset, uint32_t size) {
+    auto block = m_byOffset.find(offset);
+    if (size == 0 || block == m_byOffset.end() || block->second < size) {
+        return false;
+    }
+
+    uint32_t blockSize = block->second;
+    EraseFree(block);
+    if (blockSize > size) {
+        InsertFree(offset + size, blockSize - size);
+    }
+
+    m_used += size;
+    return true;
+}
+
+void FreeListAllocator::Free(uint32_t offset, uint32_t size) {
+    if (size == 0 || offset == InvalidOffset) {
+        return;
+    }
+
+    m_used -= size;
+
+    // Coalesce with the following block
+    auto next = m_byOffset.find(offset + size);
+    if (next != m_byOffset.end()) {
+        size += next->second;
+        EraseFree(next);
+    }
+
+    // Coalesce with the preceding block
+    auto prev = m_byOffset.lower_bound(offset);
+    if (prev != m_byOffset.begin()) {
+        --prev;
+        if (prev->first + prev->second == offset) {
+            offset = prev->first;
+            size += prev->second;
+            EraseFree(prev);
+        }
+    }
+
+    InsertFree(offset, size);
+}
+
+void FreeListAllocator::Grow(uint32_t newCapacity) {
+    if (newCapacity <= m_capacity) {
+        return;
+    }
+
+    uint32_t tail = m_capacity;
+    uint32_t extra = newCapacity - m_capacity;
+    m_capacity = newCapacity;
+
+    // Free() subtracts from m_used, so pre-add the tail to keep it balanced
+    m_used += extra;
+    Free(tail, extra);
+}
+
+void FreeListAllocator::Reset(uint32_t capacity, uint32_t usedPrefix) {
+    m_byOffset.clear();
+    m_bySize.clear();
+    m_capacity = capacity;
+    m_used = std::min(usedPrefix, capacity);
+
+    if (m_capacity > m_used) {
+        InsertFree(m_used, m_capacity - m_used);
+    }
+}
+
+uint32_t FreeListAllocator::GetLargestFreeBlock() const {
+    return m_bySize.empty() ? 0 : m_bySize.rbegin()->first;
+}
+
+void FreeListAllocator::InsertFree(uint32_t offset, uint32_t size) {
+    m_byOffset.emplace(offset, size);
+    m_bySize.emplace(size, offset);
+}
+
+void FreeListAllocator::EraseFree(std::map<uint32_t, uint32_t>::iterator it) {
+    auto range = m_bySize.equal_range(it->second);
+    for (auto s = range.first; s != range.second; ++s) {
+        if (s->second == it->first) {
+            m_bySize.erase(s);
+            break;
+        }
+    }
+    m_byOffset.erase(it);
+}
+
+// ---------------------------------------------------------------------------
+// MeshArena
+// ---------------------------------------------------------------------------
+
+MeshArena::MeshArena(uint32_t initialVertices, uint32_t initialIndices)
+    : m_vertexPool(initialVertices)
+    , m_indexPool(initialIndices)
+    , m_vertexAllocator(initialVertices)
+    , m_indexAllocator(initialIndices)
+    , m_meshCount(0)
+    , m_dirtyVertexBegin(0)
+    , m_dirtyVertexEnd(0)
+    , m_dirtyIndexBegin(0)
+    , m_dirtyIndexEnd(0)
+    , m_generation(1)
+    , m_defragmentations(0)
+    , m_defragmentedBytes(0)
+    , m_initialVertices(initialVertices)
+    , m_initialIndices(initialIndices)
+{
+}
+
+MeshArena::~MeshArena() = default;
+
+MeshHandle MeshArena::Upload(MeshHandle handle, const Vertex* vertices, uint32_t vertexCount,
+                             const uint32_t* indices, uint32_t indexCount) {
+    MeshAllocation* mesh = Find(handle);
+    if (!mesh) {
+        handle = CreateHandle();
+        mesh = Find(handle);
+    }
+
+    // Reuse the existing ranges when the new mesh still fits, which is the
+    // common case for single-voxel edits
+    if (vertexCount > mesh->vertexCount || indexCount > mesh->indexCount) {
+        // Counts are recorded before the index allocation because it may
+        // defragment, which must see the freshly placed vertex range
+        FreeStorage(*mesh);
+        mesh->vertexOffset = AllocateVertices(vertexCount);
+        mesh->vertexCount = vertexCount;
+        mesh->indexOffset = AllocateIndices(indexCount);
+        mesh->indexCount = indexCount;
+    } else {
+        // Give back the unused tails
+        m_vertexAllocator.Free(mesh->vertexOffset + vertexCount, mesh->vertexCount - vertexCount);
+        m_indexAllocator.Free(mesh->indexOffset + indexCount, mesh->indexCount - indexCount);
+        mesh->vertexCount = vertexCount;
+        mesh->indexCount = indexCount;
+        if (vertexCount == 0) mesh->vertexOffset = FreeListAllocator::InvalidOffset;
+        if (indexCount == 0) mesh->indexOffset = FreeListAllocator::InvalidOffset;
+    }
+
+    if (vertexCount > 0) {
+        std::memcpy(&m_vertexPool[mesh->vertexOffset], vertices, vertexCount * sizeof(Vertex));
+        MarkVerticesDirty(mesh->vertexOffset, mesh->vertexOffset + vertexCount);
+    }
+    if (indexCount > 0) {
+        std::memcpy(&m_indexPool[mesh->indexOffset], indices, indexCount * sizeof(uint32_t));
+        MarkIndicesDirty(mesh->indexOffset, mesh->indexOffset + indexCount);
+    }
+
+    return handle;
+}
+
+void MeshArena::Release(MeshHandle handle) {
+    MeshAllocation* mesh = Find(handle);
+    if (!mesh) {
+        return;
+    }
+
+    FreeStorage(*mesh);
+    mesh->live = false;
+    m_freeHandles.push_back(handle);
+    --m_meshCount;
+}
+
+void MeshArena::SetVisible(MeshHandle handle, bool visible) {
+    if (MeshAllocation* mesh = Find(handle)) {
+        mesh->visible = visible;
+    }
+}
+
+bool MeshArena::IsValid(MeshHandle handle) const {
+    return Find(handle) != nullptr;
+}
+
+void MeshArena::BuildDrawCommands(std::vector<DrawIndexedIndirectArgs>& commands) const {
+    commands.clear();
+    commands.reserve(m_meshCount);
+
+    for (const MeshAllocation& mesh : m_meshes) {
+        if (!mesh.live || !mesh.visible || mesh.indexCount == 0) {
+            continue;
+        }
+
+        DrawIndexedIndirectArgs args;
+        args.indexCountPerInstance = mesh.indexCount;
+        args.instanceCount = 1;
+        args.startIndexLocation = mesh.indexOffset;
+        args.baseVertexLocation = static_cast<int32_t>(mesh.vertexOffset);
+        args.startInstanceLocation = 0;
+        commands.push_back(args);
+    }
+}
+
+bool MeshArena::Defragment(float threshold) {
+    auto needed = [threshold](const FreeListAllocator& allocator) {
+        uint32_t totalFree = allocator.GetCapacity() - allocator.GetUsed();
+        return totalFree >= allocator.GetCapacity() * DEFRAG_MIN_FREE && PoolFragmentation(allocator) > threshold;
+    };
+
+    uint32_t moved = 0;
+    if (needed(m_vertexAllocator)) {
+        moved += SlideDown(true, DEFRAG_VERTEX_BUDGET);
+    }
+    if (needed(m_indexAllocator)) {
+        moved += SlideDown(false, DEFRAG_INDEX_BUDGET);
+    }
+    if (moved == 0) {
+        return false;
+    }
+
+    ++m_defragmentations;
+    return true;
+}
+
+bool MeshArena::Trim() {
+    // Keep a quarter of headroom so the next few uploads do not regrow
+    auto target = [](const FreeListAllocator& allocator, uint32_t minimum) {
+        uint32_t used = allocator.GetUsed();
+        return std::max(minimum, used + used / 4);
+    };
+    uint32_t vertexTarget = target(m_vertexAllocator, m_initialVertices);
+    uint32_t indexTarget = target(m_indexAllocator, m_initialIndices);
+    if (vertexTarget >= m_vertexAllocator.GetCapacity() && indexTarget >= m_indexAllocator.GetCapacity()) {
+        return false;
+    }
+
+    Compact();
+    vertexTarget = std::min(vertexTarget, m_vertexAllocator.GetCapacity());
+    indexTarget = std::min(indexTarget, m_indexAllocator.GetCapacity());
+    m_vertexAllocator.Reset(vertexTarget, m_vertexAllocator.GetUsed());
+    m_indexAllocator.Reset(indexTarget, m_indexAllocator.GetUsed());
+    m_vertexPool.resize(vertexTarget);
+    m_vertexPool.shrink_to_fit();
+    m_indexPool.resize(indexTarget);
+    m_indexPool.shrink_to_fit();
+
+    // New capacity means the backend recreates its buffers from scratch
+    m_dirtyVertexBegin = 0;
+    m_dirtyVertexEnd = m_vertexAllocator.GetUsed();
+    m_dirtyIndexBegin = 0;
+    m_dirtyIndexEnd = m_indexAllocator.GetUsed();
+    ++m_generation;
+    return true;
+}
+
+uint64_t MeshArena::GetMeshBytes(MeshHandle handle) const {
+    const MeshAllocation* mesh = Find(handle);
+    if (!mesh) {
+        return 0;
+    }
+    return static_cast<uint64_t>(mesh->vertexCount) * sizeof(Vertex) +
+           static_cast<uint64_t>(mesh->indexCount) * sizeof(uint32_t);
+}
+
+uint64_t MeshArena::GetMinimumBytes() const {
+    return static_cast<uint64_t>(m_initialVertices) * sizeof(Vertex) +
+           static_cast<uint64_t>(m_initialIndices) * sizeof(uint32_t);
+}
+
+uint32_t MeshArena::SlideDown(bool vertices, uint32_t budget) {
+    FreeListAllocator& allocator = vertices ? m_vertexAllocator : m_indexAllocator;
+    uint32_t MeshAllocation::* offset = vertices ? &MeshAllocation::vertexOffset : &MeshAllocation::indexOffset;
+    uint32_t MeshAllocation::* count = vertices ? &MeshAllocation::vertexCount : &MeshAllocation::indexCount;
+    size_t elementSize = vertices ? sizeof(Vertex) : sizeof(uint32_t);
+    uint8_t* data = vertices ? reinterpret_cast<uint8_t*>(m_vertexPool.data())
+                             : reinterpret_cast<uint8_t*>(m_indexPool.data());
+
+    std::vector<MeshAllocation*> order;
+    order.reserve(m_meshCount);
+    for (MeshAllocation& mesh : m_meshes) {
+        if (mesh.live && mesh.*count > 0) {
+            order.push_back(&mesh);
+        }
+    }
+    std::sort(order.begin(), order.end(), [offset](const MeshAllocation* a, const MeshAllocation* b) {
+        return a->*offset < b->*offset;
+    });
+
+    // Everything below the cursor is packed, so the gap in front of the next
+    // mesh is one free block starting at the cursor; freeing the mesh merges
+    // it into that block and its front is then claimed back
+    uint32_t cursor = 0;
+    uint32_t moved = 0;
+    uint32_t dirtyBegin = 0;
+    uint32_t dirtyEnd = 0;
+    for (MeshAllocation* mesh : order) {
+        uint32_t size = mesh->*count;
+        if (mesh->*offset != cursor) {
+            if (moved > 0 && moved + size > budget) {
+                break;
+            }
+            std::memmove(data + cursor * elementSize, data + static_cast<size_t>(mesh->*offset) * elementSize,
+                         size * elementSize);
+            allocator.Free(mesh->*offset, size);
+            allocator.AllocateAt(cursor, size);
+            mesh->*offset = cursor;
+            if (moved == 0) {
+                dirtyBegin = cursor;
+            }
+            moved += size;
+            dirtyEnd = cursor + size;
+        }
+        cursor += size;
+    }
+
+    if (moved > 0) {
+        if (vertices) {
+            MarkVerticesDirty(dirtyBegin, dirtyEnd);
+        } else {
+            MarkIndicesDirty(dirtyBegin, dirtyEnd);
+        }
+        m_defragmentedBytes += static_cast<uint64_t>(moved) * elementSize;
+    }
+    return moved;
+}
+
+void MeshArena::Compact() {
+    // Live meshes ordered by their current position; sliding each one down
+    // to the end of the previous never overwrites data not yet moved
+    std::vector<MeshAllocation*> order;
+    order.reserve(m_meshCount);
+    for (MeshAllocation& mesh : m_meshes) {
+        if (mesh.live) {
+            order.push_back(&mesh);
+        }
+    }
+
+    std::sort(order.begin(), order.end(), [](const MeshAllocation* a, const MeshAllocation* b) {
+        return a->vertexOffset < b->vertexOffset;
+    });
+    uint32_t vertexCursor = 0;
+    for (MeshAllocation* mesh : order) {
+        if (mesh->vertexCount == 0) continue;
+        if (mesh->vertexOffset != vertexCursor) {
+            std::memmove(&m_vertexPool[vertexCursor], &m_vertexPool[mesh->vertexOffset],
+                         mesh->vertexCount * sizeof(Vertex));
+            m_defragmentedBytes += mesh->vertexCount * sizeof(Vertex);
+            mesh->vertexOffset = vertexCursor;
+        }
+        vertexCursor += mesh->vertexCount;
+    }
+
+    std::sort(order.begin(), order.end(), [](const MeshAllocation* a, const MeshAllocation* b) {
+        return a->indexOffset < b->indexOffset;
+    });
+    uint32_t indexCursor = 0;
+    for (MeshAllocation* mesh : order) {
+        if (mesh->indexCount == 0) continue;
+        if (mesh->indexOffset != indexCursor) {
+            std::memmove(&m_indexPool[indexCursor], &m_indexPool[mesh->indexOffset],
+                         mesh->indexCount * sizeof(uint32_t));
+            m_defragmentedBytes += mesh->indexCount * sizeof(uint32_t);
+            mesh->indexOffset = indexCursor;
+        }
+        indexCursor += mesh->indexCount;
+    }
+
+    m_vertexAllocator.Reset(m_vertexAllocator.GetCapacity(), vertexCursor);
+    m_indexAllocator.Reset(m_indexAllocator.GetCapacity(), indexCursor);
+    MarkVerticesDirty(0, vertexCursor);
+    MarkIndicesDirty(0, indexCursor);
+}
+
+void MeshArena::GetDirtyVertexRange(uint32_t& begin, uint32_t& end) const {
+    begin = m_dirtyVertexBegin;
+    end = m_dirtyVertexEnd;
+}
+
+void MeshArena::GetDirtyIndexRange(uint32_t& begin, uint32_t& end) const {
+    begin = m_dirtyIndexBegin;
+    end = m_dirtyIndexEnd;
+}
+
+void MeshArena::ClearDirtyRanges() {
+    m_dirtyVertexBegin = m_dirtyVertexEnd = 0;
+    m_dirtyIndexBegin = m_dirtyIndexEnd = 0;
+}
+
+MeshArenaStats MeshArena::GetStats() const {
+    MeshArenaStats stats = {};
+    stats.meshCount = m_meshCount;
+    stats.vertexCapacity = m_vertexAllocator.GetCapacity();
+    stats.vertexUsed = m_vertexAllocator.GetUsed();
+    stats.indexCapacity = m_indexAllocator.GetCapacity();
+    stats.indexUsed = m_indexAllocator.GetUsed();
+    stats.freeBlocks = m_vertexAllocator.GetFreeBlockCount() + m_indexAllocator.GetFreeBlockCount();
+    stats.defragmentations = m_defragmentations;
+    stats.defragmentedBytes = m_defragmentedBytes;
+
+    // Report the worse of the two pools
+    stats.fragmentation = std::max(PoolFragmentation(m_vertexAllocator), PoolFragmentation(m_indexAllocator));
+    return stats;
+}
+
+MeshArena::MeshAllocation* MeshArena::Find(MeshHandle handle) {
+    if (handle == InvalidMeshHandle || handle > m_meshes.size()) {
+        return nullptr;
+    }
+    MeshAllocation& mesh = m_meshes[handle - 1];
+    return mesh.live ? &mesh : nullptr;
+}
+
+const MeshArena::MeshAllocation* MeshArena::Find(MeshHandle handle) const {
+    return const_cast<MeshArena*>(this)->Find(handle);
+}
+
+MeshHandle MeshArena::CreateHandle() {
+    MeshHandle handle;
+    if (!m_freeHandles.empty()) {
+        handle = m_freeHandles.back();
+        m_freeHandles.pop_back();
+    } else {
+        m_meshes.push_back(MeshAllocation{});
+        handle = static_cast<MeshHandle>(m_meshes.size());
+    }
+
+    MeshAllocation& mesh = m_meshes[handle - 1];
+    mesh.vertexOffset = FreeListAllocator::InvalidOffset;
+    mesh.vertexCount = 0;
+    mesh.indexOffset = FreeListAllocator::InvalidOffset;
+    mesh.indexCount = 0;
+    mesh.visible = true;
+    mesh.live = true;
+    ++m_meshCount;
+    return handle;
+}
+
+void MeshArena::FreeStorage(MeshAllocation& mesh) {
+    m_vertexAllocator.Free(mesh.vertexOffset, mesh.vertexCount);
+    m_indexAllocator.Free(mesh.indexOffset, mesh.indexCount);
+    mesh.vertexOffset = FreeListAllocator::InvalidOffset;
+    mesh.indexOffset = FreeListAllocator::InvalidOffset;
+    mesh.vertexCount = 0;
+    mesh.indexCount = 0;
+}
+
+uint32_t MeshArena::AllocateVertices(uint32_t count) {
+    if (count == 0) {
+        return FreeListAllocator::InvalidOffset;
+    }
+
+    uint32_t offset = m_vertexAllocator.Allocate(count);
+    if (offset == FreeListAllocator::InvalidOffset) {
+        // Compact first; grow if the free space is genuinely too small, or
+        // so little that compacting would only buy a few more uploads
+        if (CanCompactFor(m_vertexAllocator, count)) {
+            Compact();
+            ++m_defragmentations;
+            offset = m_vertexAllocator.Allocate(count);
+        }
+    }
+    if (offset == FreeListAllocator::InvalidOffset) {
+        uint32_t capacity = std::max(m_vertexAllocator.GetCapacity() * 2, m_vertexAllocator.GetUsed() + count);
+        m_vertexAllocator.Grow(capacity);
+        m_vertexPool.resize(capacity);
+        ++m_generation;
+        offset = m_vertexAllocator.Allocate(count);
+    }
+    return offset;
+}
+
+uint32_t MeshArena::AllocateIndices(uint32_t count) {
+    if (count == 0) {
+        return FreeListAllocator::InvalidOffset;
+    }
+
+    uint32_t offset = m_indexAllocator.Allocate(count);
+    if (offset == FreeListAllocator::InvalidOffset) {
+        if (CanCompactFor(m_indexAllocator, count)) {
+            Compact();
+            ++m_defragmentations;
+            offset = m_indexAllocator.Allocate(count);
+        }
+    }
+    if (offset == FreeListAllocator::InvalidOffset) {
+        uint32_t capacity = std::max(m_indexAllocator.GetCapacity() * 2, m_indexAllocator.GetUsed() + count);
+        m_indexAllocator.Grow(capacity);
+        m_indexPool.resize(capacity);
+        ++m_generation;
+        offset = m_indexAllocator.Allocate(count);
+    }
+    return offset;
+}
+
+void MeshArena::MarkVerticesDirty(uint32_t begin, uint32_t end) {
+    if (m_dirtyVertexBegin >= m_dirtyVertexEnd) {
+        m_dirtyVertexBegin = begin;
+        m_dirtyVertexEnd = end;
+    } else {
+        m_dirtyVertexBegin = std::min(m_dirtyVertexBegin, begin);
+        m_dirtyVertexEnd = std::max(m_dirtyVertexEnd, end);
+    }
+}
+
+void MeshArena::MarkIndicesDirty(uint32_t begin, uint32_t end) {
+    if (m_dirtyIndexBegin >= m_dirtyIndexEnd) {
+        m_dirtyIndexBegin = begin;
+        m_dirtyIndexEnd = end;
+    } else {
+        m_dirtyIndexBegin = std::min(m_dirtyIndexBegin, begin);
+        m_dirtyIndexEnd = std::max(m_dirtyIndexEnd, end);
+    }
+}
+
+MeshArenaBenchmarkStats MeasureMeshArenaChurn(uint32_t meshCount, uint32_t frames) {
+    using Clock = std::chrono::steady_clock;
+    MeshArenaBenchmarkStats stats = {};
+    stats.meshes = meshCount;
+    stats.frames = frames;
+    if (meshCount == 0) {
+        return stats;
+    }
+
+    // Contents do not matter, only sizes; indices stay within their mesh
+    std::mt19937 rng(BENCHMARK_SEED);
+    std::uniform_int_distribution<uint32_t> vertexCount(BENCHMARK_MIN_VERTICES, BENCHMARK_MAX_VERTICES);
+    std::vector<Vertex> vertices(BENCHMARK_MAX_VERTICES, Vertex{});
+    std::vector<uint32_t> indices(BENCHMARK_MAX_VERTICES * 3 / 2);
+    for (size_t i = 0; i < indices.size(); ++i) {
+        indices[i] = static_cast<uint32_t>(i % BENCHMARK_MIN_VERTICES);
+    }
+
+    MeshArena arena;
+    std::vector<MeshHandle> handles(meshCount, InvalidMeshHandle);
+    auto upload = [&](MeshHandle& handle) {
+        uint32_t count = vertexCount(rng);
+        handle = arena.Upload(handle, vertices.data(), count, indices.data(), count * 3 / 2);
+    };
+    for (MeshHandle& handle : handles) {
+        upload(handle);
+    }
+    arena.ClearDirtyRanges();
+
+    uint32_t generation = arena.GetGeneration();
+    uint32_t defragmentations = arena.GetStats().defragmentations;
+    uint64_t defragmentedBytes = arena.GetStats().defragmentedBytes;
+    uint32_t perFrame = std::max(1u, meshCount / 16);
+    std::uniform_int_distribution<uint32_t> pick(0, meshCount - 1);
+    double seconds = 0.0;
+    double fragmentation = 0.0;
+    for (uint32_t frame = 0; frame < frames; ++frame) {
+        auto start = Clock::now();
+        for (uint32_t i = 0; i < perFrame; ++i) {
+            upload(handles[pick(rng)]);
+        }
+        arena.Defragment();
+        seconds += std::chrono::duration<double>(Clock::now() - start).count();
+
+        uint32_t begin, end;
+        arena.GetDirtyVertexRange(begin, end);
+        if (end > begin) stats.dirtyBytesPerFrame += static_cast<uint64_t>(end - begin) * sizeof(Vertex);
+        arena.GetDirtyIndexRange(begin, end);
+        if (end > begin) stats.dirtyBytesPerFrame += static_cast<uint64_t>(end - begin) * sizeof(uint32_t);
+        arena.ClearDirtyRanges();
+
+        if (arena.GetGeneration() != generation) {
+            generation = arena.GetGeneration();
+            ++stats.generations;
+        }
+        float sample = arena.GetStats().fragmentation;
+        fragmentation += sample;
+        stats.maxFragmentation = std::max(stats.maxFragmentation, sample);
+    }
+
+    stats.defragmentations = arena.GetStats().defragmentations - defragmentations;
+    stats.defragmentedBytes = arena.GetStats().defragmentedBytes - defragmentedBytes;
+    if (frames > 0) {
+        stats.frameMilliseconds = static_cast<float>(seconds * 1000.0 / frames);
+        stats.averageFragmentation = static_cast<float>(fragmentation / frames);
+        stats.dirtyBytesPerFrame /= frames;
+    }
+    return stats;
+}
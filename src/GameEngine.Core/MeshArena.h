@@ -0,0 +1,176 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <vector>
+#include "VoxelChunk.h"
+
+// Offset/size suballocator over a linear range of elements. Free blocks are
+// indexed both by offset (for coalescing on free) and by size (for best-fit
+// allocation), so both operations are O(log n) in the number of free blocks.
+class FreeListAllocator {
+public:
+    static constexpr uint32_t InvalidOffset = UINT32_MAX;
+
+    explicit FreeListAllocator(uint32_t capacity = 0);
+
+    uint32_t Allocate(uint32_t size);
+    // Takes [offset, offset + size) from the front of the free block that
+    // starts at `offset`; false if there is no such block or it is too small
+    bool AllocateAt(uint32_t offset, uint32_t size);
+    void Free(uint32_t offset, uint32_t size);
+
+    // Extends the range; the new tail is merged into the last free block.
+    void Grow(uint32_t newCapacity);
+    // Marks [0, usedPrefix) as allocated and the rest as one free block.
+    void Reset(uint32_t capacity, uint32_t usedPrefix);
+
+    uint32_t GetCapacity() const { return m_capacity; }
+    uint32_t GetUsed() const { return m_used; }
+    uint32_t GetFreeBlockCount() const { return static_cast<uint32_t>(m_byOffset.size()); }
+    uint32_t GetLargestFreeBlock() const;
+
+private:
+    void InsertFree(uint32_t offset, uint32_t size);
+    void EraseFree(std::map<uint32_t, uint32_t>::iterator it);
+
+    std::map<uint32_t, uint32_t> m_byOffset;        // offset -> size
+    std::multimap<uint32_t, uint32_t> m_bySize;     // size -> offset
+    uint32_t m_capacity;
+    uint32_t m_used;
+};
+
+// Layout-compatible with D3D11_DRAW_INDEXED_INSTANCED_INDIRECT_ARGS so the
+// array can be copied straight into an indirect argument buffer.
+struct DrawIndexedIndirectArgs {
+    uint32_t indexCountPerInstance;
+    uint32_t instanceCount;
+    uint32_t startIndexLocation;
+    int32_t baseVertexLocation;
+    uint32_t startInstanceLocation;
+};
+
+struct MeshArenaStats {
+    uint32_t meshCount;
+    uint32_t vertexCapacity;
+    uint32_t vertexUsed;
+    uint32_t indexCapacity;
+    uint32_t indexUsed;
+    uint32_t freeBlocks;
+    float fragmentation;     // 1 - largestFree / totalFree, worst pool
+    uint32_t defragmentations;
+    uint64_t defragmentedBytes;     // moved by Defragment and compaction
+};
+
+using ArenaVertexPool = std::vector<Vertex, TrackingAllocator<Vertex, MemoryCategory::MeshArena>>;
+using ArenaIndexPool = std::vector<uint32_t, TrackingAllocator<uint32_t, MemoryCategory::MeshArena>>;
+
+using MeshHandle = uint32_t;
+constexpr MeshHandle InvalidMeshHandle = 0;
+
+// Packs many small meshes into one shared vertex pool and one shared index
+// pool. The arena is backend-agnostic: it keeps the CPU copy of both pools
+// and tracks which element ranges changed, and a renderer mirrors them into
+// GPU buffers and consumes the indirect draw arguments produced each frame.
+class MeshArena {
+public:
+    MeshArena(uint32_t initialVertices = 1 << 16, uint32_t initialIndices = 1 << 17);
+    ~MeshArena();
+
+    // Replaces the mesh behind `handle` (or creates one for InvalidMeshHandle)
+    // and returns the handle that now refers to it.
+    MeshHandle Upload(MeshHandle handle, const Vertex* vertices, uint32_t vertexCount,
+                      const uint32_t* indices, uint32_t indexCount);
+    void Release(MeshHandle handle);
+
+    void SetVisible(MeshHandle handle, bool visible);
+    bool IsValid(MeshHandle handle) const;
+
+    // Emits one draw per visible, non-empty mesh. Chunk indices are local to
+    // their vertex allocation, so they are rebased with baseVertexLocation.
+    void BuildDrawCommands(std::vector<DrawIndexedIndirectArgs>& commands) const;
+
+    // Slides meshes down over the holes of each pool whose fragmentation
+    // exceeds the threshold and whose free space is a meaningful share of its
+    // capacity, moving a bounded number of elements per call so only that
+    // range is marked dirty. Returns true if data moved.
+    bool Defragment(float threshold = 0.5f);
+
+    // Compacts both pools and gives back capacity beyond what the live
+    // meshes need, plus some headroom. Returns true if capacity shrank.
+    bool Trim();
+    
+    // Elements held by one mesh in both pools
+    uint64_t GetMeshBytes(MeshHandle handle) const;
+    
+    // Pool bytes Trim never gives back
+    uint64_t GetMinimumBytes() const;
+
+    const ArenaVertexPool& GetVertexPool() const { return m_vertexPool; }
+    const ArenaIndexPool& GetIndexPool() const { return m_indexPool; }
+
+    // Dirty ranges are half-open element ranges; empty when begin >= end.
+    // The pool generation changes whenever capacity changes, which tells the
+    // backend to recreate its buffers instead of updating subranges.
+    void GetDirtyVertexRange(uint32_t& begin, uint32_t& end) const;
+    void GetDirtyIndexRange(uint32_t& begin, uint32_t& end) const;
+    void ClearDirtyRanges();
+    uint32_t GetGeneration() const { return m_generation; }
+
+    MeshArenaStats GetStats() const;
+
+private:
+    struct MeshAllocation {
+        uint32_t vertexOffset;
+        uint32_t vertexCount;
+        uint32_t indexOffset;
+        uint32_t indexCount;
+        bool visible;
+        bool live;
+    };
+
+    MeshAllocation* Find(MeshHandle handle);
+    const MeshAllocation* Find(MeshHandle handle) const;
+    MeshHandle CreateHandle();
+    void FreeStorage(MeshAllocation& mesh);
+    void Compact();
+    uint32_t SlideDown(bool vertices, uint32_t budget);
+    uint32_t AllocateVertices(uint32_t count);
+    uint32_t AllocateIndices(uint32_t count);
+    void MarkVerticesDirty(uint32_t begin, uint32_t end);
+    void MarkIndicesDirty(uint32_t begin, uint32_t end);
+
+    ArenaVertexPool m_vertexPool;
+    ArenaIndexPool m_indexPool;
+    FreeListAllocator m_vertexAllocator;
+    FreeListAllocator m_indexAllocator;
+
+    std::vector<MeshAllocation> m_meshes;    // handle - 1 indexes this
+    std::vector<MeshHandle> m_freeHandles;
+    uint32_t m_meshCount;
+
+    uint32_t m_dirtyVertexBegin, m_dirtyVertexEnd;
+    uint32_t m_dirtyIndexBegin, m_dirtyIndexEnd;
+    uint32_t m_generation;
+    uint32_t m_defragmentations;
+    uint64_t m_defragmentedBytes;
+    uint32_t m_initialVertices;
+    uint32_t m_initialIndices;
+};
+
+struct MeshArenaBenchmarkStats {
+    uint32_t meshes;
+    uint32_t frames;
+    float frameMilliseconds;        // remeshes plus Defragment, per frame
+    float averageFragmentation;     // sampled after each frame
+    float maxFragmentation;
+    uint32_t defragmentations;
+    uint64_t dirtyBytesPerFrame;    // what a renderer would re-upload
+    uint64_t defragmentedBytes;
+    uint32_t generations;           // pool reallocations
+};
+
+// Uploads `meshCount` chunk-sized meshes into a scratch arena, then each
+// frame replaces a sixteenth of them with meshes of a new random size and
+// lets Defragment run as VoxelEngine does after remeshing
+MeshArenaBenchmarkStats MeasureMeshArenaChurn(uint32_t meshCount, uint32_t frames);
@@ -0,0 +1,408 @@
+#include "MeshCache.h"
+#include "VoxelEngine.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <string>
+
+namespace {
+    constexpr uint32_t MESH_CACHE_MAGIC = 0x434D4547; // "GEMC"
+    constexpr uint32_t MESH_CACHE_VERSION = 1;
+    constexpr uint64_t DEFAULT_CAPACITY = 256ull * 1024 * 1024;
+    const char* const MESH_CACHE_FILE = "chunkmeshes.gemc";
+
+    // File layout: header, mesh data (4-byte aligned), then the entry table
+    struct MeshCacheHeader {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t mesherVersion;
+        uint32_t vertexSize;
+        uint64_t entryCount;
+        uint64_t entryOffset;
+    };
+
+    uint64_t Rotl(uint64_t value, int bits) {
+        return (value << bits) | (value >> (64 - bits));
+    }
+
+    // Fast non-cryptographic 64-bit hash, eight bytes per step
+    uint64_t HashBytes(const void* data, size_t size, uint64_t seed) {
+        constexpr uint64_t P1 = 0x9E3779B185EBCA87ull;
+        constexpr uint64_t P2 = 0xC2B2AE3D27D4EB4Full;
+        constexpr uint64_t P3 = 0x165667B19E3779F9ull;
+
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        uint64_t h = seed + P3 + size;
+        for (; size >= 8; bytes += 8, size -= 8) {
+            uint64_t k;
+            std::memcpy(&k, bytes, sizeof(k));
+            h ^= Rotl(k * P2, 31) * P1;
+            h = Rotl(h, 27) * P1 + P3;
+        }
+        for (; size > 0; ++bytes, --size) {
+            h ^= *bytes * P3;
+            h = Rotl(h, 11) * P1;
+        }
+
+        h ^= h >> 33;
+        h *= P2;
+        h ^= h >> 29;
+        h *= P3;
+        h ^= h >> 32;
+        return h;
+    }
+
+    uint64_t MeshBytes(uint32_t vertexCount, uint32_t indexCount) {
+        return static_cast<uint64_t>(vertexCount) * sizeof(Vertex) + static_cast<uint64_t>(indexCount) * sizeof(uint32_t);
+    }
+
+    uint64_t ChecksumMesh(uint64_t key, const void* vertices, uint32_t vertexCount,
+                          const void* indices, uint32_t indexCount) {
+        uint64_t checksum = HashBytes(vertices, vertexCount * sizeof(Vertex), key);
+        return HashBytes(indices, indexCount * sizeof(uint32_t), checksum);
+    }
+
+    bool IndicesInRange(const uint32_t* indices, uint32_t indexCount, uint32_t vertexCount) {
+        return std::all_of(indices, indices + indexCount, [vertexCount](uint32_t index) {
+            return index < vertexCount;
+        });
+    }
+}
+
+uint64_t ComputeChunkMeshKey(const VoxelChunk& chunk, const ChunkNeighbors& neighbors) {
+    // Chunk coordinates only name the same voxels at the same chunk size
+    const int32_t prefix[5] = {
+        chunk.GetChunkX(), chunk.GetChunkY(), chunk.GetChunkZ(), static_cast<int32_t>(MESHER_VERSION), CHUNK_SIZE
+    };
+    uint64_t key = HashBytes(prefix, sizeof(prefix), 0);
+    key = HashBytes(chunk.GetBlock()->voxels, CHUNK_VOLUME, key);
+
+    // Only whether the touching neighbour voxels are solid affects the mesh;
+    // a missing neighbour meshes like an all-air one
+    uint8_t border[6][CHUNK_SIZE * CHUNK_SIZE / 8] = {};
+    for (int face = 0; face < 6; ++face) {
+        const VoxelChunk* neighbor = neighbors.faces[face];
+        if (!neighbor || neighbor->IsEmpty()) {
+            continue;
+        }
+
+        int layer = (face % 2 == 0) ? 0 : CHUNK_SIZE - 1;
+        for (int a = 0; a < CHUNK_SIZE; ++a) {
+            for (int b = 0; b < CHUNK_SIZE; ++b) {
+                uint8_t voxel;
+                if (face < 2) {
+                    voxel = neighbor->GetVoxel(a, b, layer);
+                } else if (face < 4) {
+                    voxel = neighbor->GetVoxel(a, layer, b);
+                } else {
+                    voxel = neighbor->GetVoxel(layer, a, b);
+                }
+                if (voxel != static_cast<uint8_t>(BlockType::Air)) {
+                    int bit = a * CHUNK_SIZE + b;
+                    border[face][bit / 8] |= static_cast<uint8_t>(1u << (bit % 8));
+                }
+            }
+        }
+    }
+    return HashBytes(border, sizeof(border), key);
+}
+
+MeshCache::MeshCache()
+    : m_capacity(DEFAULT_CAPACITY)
+    , m_hits(0)
+    , m_misses(0)
+{
+}
+
+MeshCache::~MeshCache() {
+    Close();
+}
+
+bool MeshCache::Open(const std::filesystem::path& directory) {
+    Close();
+
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+    if (!std::filesystem::is_directory(directory, error)) {
+        return false;
+    }
+
+    m_path = directory / MESH_CACHE_FILE;
+    m_hits = 0;
+    m_misses = 0;
+    LoadFile();
+    return true;
+}
+
+void MeshCache::Close() {
+    if (!IsOpen()) {
+        return;
+    }
+
+    Flush();
+    m_file.Close();
+    m_entries.clear();
+    m_pending.clear();
+    m_used.clear();
+    m_path.clear();
+}
+
+bool MeshCache::Find(uint64_t key, CachedMesh& mesh) {
+    auto pending = m_pending.find(key);
+    if (pending != m_pending.end()) {
+        mesh = CachedMesh{
+            pending->second.vertices.data(), static_cast<uint32_t>(pending->second.vertices.size()),
+            pending->second.indices.data(), static_cast<uint32_t>(pending->second.indices.size())
+        };
+        ++m_hits;
+        return true;
+    }
+
+    auto it = m_entries.find(key);
+    if (it == m_entries.end()) {
+        ++m_misses;
+        return false;
+    }
+
+    // Extents were checked on load; the data is checked on first use so a
+    // damaged entry is never drawn
+    const Entry& entry = it->second;
+    const uint8_t* data = m_file.GetData() + entry.offset;
+    const Vertex* vertices = reinterpret_cast<const Vertex*>(data);
+    const uint32_t* indices = reinterpret_cast<const uint32_t*>(data + entry.vertexCount * sizeof(Vertex));
+    if (!m_used.count(key) &&
+        (ChecksumMesh(key, vertices, entry.vertexCount, indices, entry.indexCount) != entry.checksum ||
+         !IndicesInRange(indices, entry.indexCount, entry.vertexCount))) {
+        m_entries.erase(it);
+        ++m_misses;
+        return false;
+    }
+
+    mesh = CachedMesh{ vertices, entry.vertexCount, indices, entry.indexCount };
+    m_used.insert(key);
+    ++m_hits;
+    return true;
+}
+
+void MeshCache::Store(uint64_t key, const Vertex* vertices, uint32_t vertexCount,
+                      const uint32_t* indices, uint32_t indexCount) {
+    if (!IsOpen()) {
+        return;
+    }
+
+    m_used.insert(key);
+    if (m_entries.count(key) || m_pending.count(key)) {
+        return;
+    }
+
+    PendingMesh& mesh = m_pending[key];
+    mesh.vertices.assign(vertices, vertices + vertexCount);
+    mesh.indices.assign(indices, indices + indexCount);
+}
+
+bool MeshCache::Flush() {
+    if (!IsOpen() || m_pending.empty()) {
+        return true;
+    }
+
+    // Written next to the cache and renamed over it, so a crash mid-write
+    // never leaves a damaged cache behind. The mapping is read while writing
+    // and closed before the rename, which Windows needs.
+    std::filesystem::path temporary = m_path;
+    temporary += ".tmp";
+    bool written = WriteFile(temporary);
+    m_file.Close();
+
+    std::error_code error;
+    if (written) {
+        std::filesystem::rename(temporary, m_path, error);
+    }
+    if (!written || error) {
+        std::filesystem::remove(temporary, error);
+        LoadFile();
+        return false;
+    }
+
+    m_pending.clear();
+    LoadFile();
+    return true;
+}
+
+MeshCacheStats MeshCache::GetStats() const {
+    MeshCacheStats stats = {};
+    stats.entries = static_cast<uint32_t>(m_entries.size() + m_pending.size());
+    stats.pending = static_cast<uint32_t>(m_pending.size());
+    stats.hits = m_hits;
+    stats.misses = m_misses;
+    stats.fileBytes = m_file.GetSize();
+    return stats;
+}
+
+void MeshCache::LoadFile() {
+    m_entries.clear();
+    if (!m_file.Open(m_path)) {
+        return;
+    }
+
+    const uint8_t* data = m_file.GetData();
+    uint64_t size = m_file.GetSize();
+
+    MeshCacheHeader header;
+    if (size < sizeof(header)) {
+        m_file.Close();
+        return;
+    }
+    std::memcpy(&header, data, sizeof(header));
+    if (header.magic != MESH_CACHE_MAGIC || header.version != MESH_CACHE_VERSION ||
+        header.mesherVersion != MESHER_VERSION || header.vertexSize != sizeof(Vertex) ||
+        header.entryOffset < sizeof(header) || header.entryOffset > size ||
+        header.entryCount != (size - header.entryOffset) / sizeof(Entry) ||
+        (size - header.entryOffset) % sizeof(Entry) != 0) {
+        m_file.Close();
+        return;
+    }
+
+    m_entries.reserve(static_cast<size_t>(header.entryCount));
+    for (uint64_t i = 0; i < header.entryCount; ++i) {
+        Entry entry;
+        std::memcpy(&entry, data + header.entryOffset + i * sizeof(Entry), sizeof(entry));
+        bool inBounds = entry.offset >= sizeof(header) && entry.offset % 4 == 0 &&
+                        entry.offset <= header.entryOffset &&
+                        MeshBytes(entry.vertexCount, entry.indexCount) <= header.entryOffset - entry.offset;
+        if (inBounds && entry.indexCount % 3 == 0) {
+            m_entries.emplace(entry.key, entry);
+        }
+    }
+}
+
+bool MeshCache::WriteFile(const std::filesystem::path& path) {
+    struct Source {
+        uint64_t key;
+        const void* vertices;
+        uint32_t vertexCount;
+        const void* indices;
+        uint32_t indexCount;
+        uint64_t checksum;
+    };
+
+    // Mapped entries keep their checksum; it is only computed for new meshes
+    auto source = [this](uint64_t key, Source& out) {
+        auto pending = m_pending.find(key);
+        if (pending != m_pending.end()) {
+            const PendingMesh& mesh = pending->second;
+            uint32_t vertexCount = static_cast<uint32_t>(mesh.vertices.size());
+            uint32_t indexCount = static_cast<uint32_t>(mesh.indices.size());
+            out = Source{ key, mesh.vertices.data(), vertexCount, mesh.indices.data(), indexCount,
+                          ChecksumMesh(key, mesh.vertices.data(), vertexCount, mesh.indices.data(), indexCount) };
+            return true;
+        }
+        auto entry = m_entries.find(key);
+        if (entry != m_entries.end()) {
+            const uint8_t* data = m_file.GetData() + entry->second.offset;
+            out = Source{ key,
+                data, entry->second.vertexCount,
+                data + entry->second.vertexCount * sizeof(Vertex), entry->second.indexCount,
+                entry->second.checksum };
+            return true;
+        }
+        return false;
+    };
+
+    // Meshes used this session first, then older ones while they fit
+    std::vector<Source> sources;
+    uint64_t bytes = 0;
+    auto add = [&](uint64_t key) {
+        Source mesh;
+        if (!source(key, mesh)) {
+            return;
+        }
+        uint64_t meshBytes = MeshBytes(mesh.vertexCount, mesh.indexCount) + sizeof(Entry);
+        if (bytes + meshBytes <= m_capacity) {
+            sources.push_back(mesh);
+            bytes += meshBytes;
+        }
+    };
+    for (uint64_t key : m_used) {
+        add(key);
+    }
+    for (const auto& pair : m_entries) {
+        if (!m_used.count(pair.first)) {
+            add(pair.first);
+        }
+    }
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        return false;
+    }
+
+    MeshCacheHeader header = { MESH_CACHE_MAGIC, MESH_CACHE_VERSION, MESHER_VERSION,
+                               static_cast<uint32_t>(sizeof(Vertex)), static_cast<uint64_t>(sources.size()), 0 };
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    std::vector<Entry> entries;
+    entries.reserve(sources.size());
+    uint64_t offset = sizeof(header);
+    for (const Source& mesh : sources) {
+        entries.push_back(Entry{ mesh.key, offset, mesh.vertexCount, mesh.indexCount, mesh.checksum });
+        file.write(static_cast<const char*>(mesh.vertices), static_cast<std::streamsize>(mesh.vertexCount * sizeof(Vertex)));
+        file.write(static_cast<const char*>(mesh.indices), static_cast<std::streamsize>(mesh.indexCount * sizeof(uint32_t)));
+        offset += MeshBytes(mesh.vertexCount, mesh.indexCount);
+    }
+
+    header.entryOffset = offset;
+    file.write(reinterpret_cast<const char*>(entries.data()), static_cast<std::streamsize>(entries.size() * sizeof(Entry)));
+    file.seekp(0);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.close();
+    return !file.fail();
+}
+
+MeshCacheStartupStats MeasureMeshCacheStartup(int seed, int worldRadius) {
+    using Clock = std::chrono::steady_clock;
+    auto milliseconds = [](Clock::time_point start, Clock::time_point end) {
+        return std::chrono::duration<float, std::milli>(end - start).count();
+    };
+
+    MeshCacheStartupStats stats = {};
+    std::error_code error;
+    std::filesystem::path directory = std::filesystem::temp_directory_path(error);
+    if (error) {
+        return stats;
+    }
+    std::random_device random;
+    directory /= "GameEngine-meshcache-" + std::to_string(random());
+
+    // Same world twice; the first run leaves its cache file behind when the
+    // engine is destroyed
+    for (int run = 0; run < 2; ++run) {
+        VoxelEngine world;
+        world.SetWorldRadius(worldRadius);
+        world.SetMeshCacheDirectory(directory);
+
+        auto start = Clock::now();
+        world.GenerateTerrain(seed);
+        world.WaitForTerrain();
+        auto generated = Clock::now();
+
+        // No camera: every chunk is meshed
+        world.Render(nullptr, nullptr);
+        auto meshed = Clock::now();
+
+        if (run == 0) {
+            stats.coldGenerateMilliseconds = milliseconds(start, generated);
+            stats.coldMeshMilliseconds = milliseconds(generated, meshed);
+            stats.chunks = world.GetResidency().resident;
+        } else {
+            stats.warmGenerateMilliseconds = milliseconds(start, generated);
+            stats.warmMeshMilliseconds = milliseconds(generated, meshed);
+            stats.warmHits = world.GetMeshCache().GetStats().hits;
+            stats.cacheBytes = world.GetMeshCache().GetStats().fileBytes;
+        }
+    }
+
+    std::filesystem::remove_all(directory, error);
+    return stats;
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "MappedFile.h"
+#include "MemoryBudget.h"
+#include "VoxelChunk.h"
+
+// Content key of a chunk mesh: the chunk position and size, its voxels, which
+// voxels of the neighbour layers touching it are solid, and MESHER_VERSION. Chunks
+// with equal keys get identical meshes from RegenerateMesh.
+uint64_t ComputeChunkMeshKey(const VoxelChunk& chunk, const ChunkNeighbors& neighbors);
+
+// A cached mesh; the pointers stay valid until the next Flush or Close
+struct CachedMesh {
+    const Vertex* vertices;
+    uint32_t vertexCount;
+    const uint32_t* indices;
+    uint32_t indexCount;
+};
+
+struct MeshCacheStats {
+    uint32_t entries;       // meshes in the cache file or waiting for the next flush
+    uint32_t pending;       // stored since the last flush
+    uint32_t hits;
+    uint32_t misses;
+    uint64_t fileBytes;
+};
+
+// On-disk chunk mesh cache, one file of meshes keyed by content. The file
+// is memory-mapped, so a hit hands out pointers into the mapping that the
+// caller copies straight into its mesh storage. New meshes are held in
+// memory (MemoryCategory::Cache) until Flush rewrites the file: meshes used
+// since Open first, then older ones, up to the capacity. A file with another
+// format or mesher version is ignored, and entries whose data fails its
+// checksum are treated as misses.
+class MeshCache {
+public:
+    MeshCache();
+    ~MeshCache();
+
+    MeshCache(const MeshCache&) = delete;
+    MeshCache& operator=(const MeshCache&) = delete;
+
+    // Uses (and creates if needed) the cache file in `directory`
+    bool Open(const std::filesystem::path& directory);
+    // Flushes, then closes the file
+    void Close();
+    bool IsOpen() const { return !m_path.empty(); }
+
+    bool Find(uint64_t key, CachedMesh& mesh);
+    void Store(uint64_t key, const Vertex* vertices, uint32_t vertexCount,
+               const uint32_t* indices, uint32_t indexCount);
+
+    // Writes pending meshes to disk; a no-op when nothing is pending
+    bool Flush();
+
+    void SetCapacity(uint64_t bytes) { m_capacity = bytes; }
+    MeshCacheStats GetStats() const;
+
+private:
+    struct Entry {
+        uint64_t key;
+        uint64_t offset;    // vertices, then indices
+        uint32_t vertexCount;
+        uint32_t indexCount;
+        uint64_t checksum;  // of the mesh data, checked on first use
+    };
+
+    struct PendingMesh {
+        std::vector<Vertex, TrackingAllocator<Vertex, MemoryCategory::Cache>> vertices;
+        std::vector<uint32_t, TrackingAllocator<uint32_t, MemoryCategory::Cache>> indices;
+    };
+
+    void LoadFile();
+    bool WriteFile(const std::filesystem::path& path);
+
+    std::filesystem::path m_path;
+    MappedFile m_file;
+    std::unordered_map<uint64_t, Entry> m_entries;      // meshes in the mapped file
+    std::unordered_map<uint64_t, PendingMesh> m_pending;
+    std::unordered_set<uint64_t> m_used;                // hit or stored since Open
+    uint64_t m_capacity;
+    uint32_t m_hits;
+    uint32_t m_misses;
+};
+
+struct MeshCacheStartupStats {
+    uint32_t chunks;
+    float coldGenerateMilliseconds;
+    float coldMeshMilliseconds;
+    float warmGenerateMilliseconds;
+    float warmMeshMilliseconds;
+    uint32_t warmHits;
+    uint64_t cacheBytes;
+};
+
+// Cold vs warm start benchmark on scratch worlds: generates and meshes the
+// same world twice in a temporary cache directory, first with an empty cache
+// and then with the file the first run wrote. Time to first frame is the
+// generate plus mesh time of each run.
+MeshCacheStartupStats MeasureMeshCacheStartup(int seed, int worldRadius);
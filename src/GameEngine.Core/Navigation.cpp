@@ -0,0 +1,904 @@
+#include "Navigation.h"
+#include "ThreadPool.h"
+#include "VoxelEngine.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    constexpr uint32_t NO_REGION = UINT32_MAX;
+    constexpr uint32_t UNREACHED = UINT32_MAX;
+
+    // Chunks built and path requests solved per ParallelFor range
+    constexpr size_t CHUNK_GRAIN = 4;
+    constexpr size_t PATH_GRAIN = 4;
+
+    // Component labels are recomputed once there are this many times more
+    // labels than live regions
+    constexpr size_t COMPONENT_SLACK = 4;
+
+    // Benchmark endpoints: goals within PATH_SPAN voxels of their start, on
+    // the surface found by searching down from SURFACE_TOP
+    constexpr int PATH_SPAN = 64;
+    constexpr int SURFACE_TOP = 64;
+    constexpr int SURFACE_DEPTH = 128;
+
+    // Steps along +x, -x, +z, -z
+    constexpr int STEP_X[4] = { 1, -1, 0, 0 };
+    constexpr int STEP_Z[4] = { 0, 0, 1, -1 };
+
+    bool IsPassable(uint8_t voxel) {
+        return voxel == static_cast<uint8_t>(BlockType::Air);
+    }
+
+    bool IsFloor(uint8_t voxel) {
+        return voxel != static_cast<uint8_t>(BlockType::Air) && voxel != static_cast<uint8_t>(BlockType::Water);
+    }
+
+    // Lower bound on the steps between two positions
+    uint32_t Distance(const VoxelPosition& a, const VoxelPosition& b) {
+        return static_cast<uint32_t>(std::abs(a.x - b.x) + std::abs(a.z - b.z));
+    }
+
+    bool IsInsideChunk(int x, int y, int z) {
+        return (static_cast<unsigned>(x) | static_cast<unsigned>(y) | static_cast<unsigned>(z)) <
+               static_cast<unsigned>(CHUNK_SIZE);
+    }
+
+    ChunkCoord Offset(const ChunkCoord& coord, int dx, int dy, int dz) {
+        return ChunkCoord{ coord.x + dx, coord.y + dy, coord.z + dz };
+    }
+
+    // Orders chunks and positions by z, then y, then x
+    bool ChunkBefore(const ChunkCoord& a, const ChunkCoord& b) {
+        if (a.z != b.z) return a.z < b.z;
+        if (a.y != b.y) return a.y < b.y;
+        return a.x < b.x;
+    }
+
+    bool PositionBefore(const VoxelPosition& a, const VoxelPosition& b) {
+        if (a.z != b.z) return a.z < b.z;
+        if (a.y != b.y) return a.y < b.y;
+        return a.x < b.x;
+    }
+
+    uint32_t Hash(uint32_t value) {
+        value ^= value >> 16;
+        value *= 0x7FEB352Du;
+        value ^= value >> 15;
+        value *= 0x846CA68Bu;
+        value ^= value >> 16;
+        return value;
+    }
+
+    // The same rules as the graph, read straight from the world's voxels
+    bool IsStandableVoxel(VoxelEngine& world, const VoxelPosition& p) {
+        return IsFloor(world.GetVoxel(p.x, p.y - 1, p.z)) && IsPassable(world.GetVoxel(p.x, p.y, p.z)) &&
+               IsPassable(world.GetVoxel(p.x, p.y + 1, p.z));
+    }
+
+    bool IsWalkablePath(VoxelEngine& world, const PathRequest& request) {
+        const std::vector<VoxelPosition>& path = request.path;
+        if (path.empty() || !(path.front() == request.start) || !(path.back() == request.goal)) {
+            return false;
+        }
+        for (size_t i = 0; i < path.size(); ++i) {
+            if (!IsStandableVoxel(world, path[i])) {
+                return false;
+            }
+            if (i == 0) {
+                continue;
+            }
+            const VoxelPosition& from = path[i - 1];
+            const VoxelPosition& to = path[i];
+            int dy = to.y - from.y;
+            if (std::abs(to.x - from.x) + std::abs(to.z - from.z) != 1 || std::abs(dy) > 1) {
+                return false;
+            }
+            const VoxelPosition& lower = dy > 0 ? from : to;
+            if (dy != 0 && !IsPassable(world.GetVoxel(lower.x, lower.y + 2, lower.z))) {
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+// A step between chunks, seen from the chunk being collected
+struct NavigationGraph::Crossing {
+    uint32_t region;
+    ChunkCoord other;
+    uint32_t otherRegion;
+    VoxelPosition cell;
+    VoxelPosition otherCell;
+};
+
+// A* state reused across searches; nodes are reset lazily by stamp
+struct NavigationGraph::SearchScratch {
+    struct Node {
+        uint32_t cost;
+        int32_t parent;
+        uint32_t stamp;
+        bool closed;
+    };
+
+    struct OpenEntry {
+        uint32_t f;
+        uint32_t h;
+        int32_t node;
+    };
+
+    std::vector<Node> nodes;
+    std::vector<OpenEntry> open;
+    std::vector<int32_t> route;
+    uint32_t stamp = 0;
+
+    void Reset(size_t count) {
+        if (nodes.size() < count) {
+            nodes.resize(count, Node{ UNREACHED, -1, 0, false });
+        }
+        if (++stamp == 0) {
+            for (Node& node : nodes) {
+                node.stamp = 0;
+            }
+            stamp = 1;
+        }
+        open.clear();
+    }
+
+    Node& Get(int32_t index) {
+        Node& node = nodes[index];
+        if (node.stamp != stamp) {
+            node = Node{ UNREACHED, -1, stamp, false };
+        }
+        return node;
+    }
+
+    // Lowest f first, then the entry nearest the goal
+    static bool Later(const OpenEntry& a, const OpenEntry& b) {
+        return a.f > b.f || (a.f == b.f && a.h > b.h);
+    }
+
+    void Relax(int32_t index, uint32_t cost, int32_t parent, uint32_t h) {
+        Node& node = Get(index);
+        if (node.closed || cost >= node.cost) {
+            return;
+        }
+        node.cost = cost;
+        node.parent = parent;
+        open.push_back(OpenEntry{ cost + h, h, index });
+        std::push_heap(open.begin(), open.end(), Later);
+    }
+
+    // Next node to expand, or -1 when the open set is exhausted
+    int32_t Pop() {
+        while (!open.empty()) {
+            std::pop_heap(open.begin(), open.end(), Later);
+            int32_t index = open.back().node;
+            open.pop_back();
+            Node& node = Get(index);
+            if (!node.closed) {
+                node.closed = true;
+                return index;
+            }
+        }
+        return -1;
+    }
+};
+
+NavigationGraph::NavigationGraph(VoxelEngine* world, ThreadPool* threadPool)
+    : m_world(world)
+    , m_threadPool(threadPool)
+    , m_worldGeneration(world->GetWorldGeneration())
+    , m_rebuildAll(true)
+    , m_stats{}
+{
+    m_editListener = m_world->AddEditListener([this](const ChunkCoord& coord, int voxelIndex) {
+        OnVoxelEdited(coord, voxelIndex);
+    });
+}
+
+NavigationGraph::~NavigationGraph() {
+    m_world->RemoveEditListener(m_editListener);
+}
+
+void NavigationGraph::OnVoxelEdited(const ChunkCoord& coord, int voxelIndex) {
+    // A voxel is the floor of the cell above it and the body or headroom of
+    // the three below it, which may lie in the chunks above and below
+    m_dirty.insert(coord);
+    int y = voxelIndex >= 0 ? (voxelIndex >> ChunkLayout::SHIFT) & ChunkLayout::MASK : -1;
+    if (voxelIndex < 0 || y == CHUNK_SIZE - 1) {
+        m_dirty.insert(Offset(coord, 0, 1, 0));
+    }
+    if (voxelIndex < 0 || y <= 1) {
+        m_dirty.insert(Offset(coord, 0, -1, 0));
+    }
+}
+
+void NavigationGraph::Update() {
+    if (m_world->GetWorldGeneration() != m_worldGeneration) {
+        m_worldGeneration = m_world->GetWorldGeneration();
+        m_rebuildAll = true;
+    }
+    if (m_rebuildAll) {
+        m_rebuildAll = false;
+        m_chunks.clear();
+        m_portals.clear();
+        m_freePortals.clear();
+        m_components.clear();
+        m_dirty.clear();
+        m_stats = NavigationStats{};
+        // Cells may stand on a chunk's top layer from the empty space above it
+        m_world->ForEachChunk([this](const ChunkCoord& coord, const VoxelChunk&) {
+            m_dirty.insert(coord);
+            m_dirty.insert(Offset(coord, 0, 1, 0));
+        });
+    }
+    if (m_dirty.empty()) {
+        return;
+    }
+
+    auto start = Clock::now();
+    std::vector<ChunkCoord> dirty(m_dirty.begin(), m_dirty.end());
+    m_dirty.clear();
+    std::sort(dirty.begin(), dirty.end(), ChunkBefore);
+
+    // New cells and regions only read the world, so chunks build in parallel
+    std::vector<Chunk> built(dirty.size());
+    auto build = [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            BuildChunk(dirty[i], built[i]);
+        }
+    };
+    if (m_threadPool) {
+        m_threadPool->ParallelFor(dirty.size(), CHUNK_GRAIN, build);
+    } else {
+        build(0, dirty.size());
+    }
+
+    for (const ChunkCoord& coord : dirty) {
+        RemovePortals(coord);
+    }
+    for (size_t i = 0; i < dirty.size(); ++i) {
+        auto it = m_chunks.find(dirty[i]);
+        if (it != m_chunks.end()) {
+            m_stats.cells -= static_cast<uint32_t>(it->second.cells.size());
+            m_stats.regions -= static_cast<uint32_t>(it->second.regions.size());
+            m_chunks.erase(it);
+        }
+        if (!built[i].cells.empty()) {
+            for (Region& region : built[i].regions) {
+                region.component = static_cast<uint32_t>(m_components.size());
+                m_components.push_back(region.component);
+            }
+            m_stats.cells += static_cast<uint32_t>(built[i].cells.size());
+            m_stats.regions += static_cast<uint32_t>(built[i].regions.size());
+            m_chunks.emplace(dirty[i], std::move(built[i]));
+        }
+    }
+
+    // Portals to clean neighbours come from the dirty side; a pair of dirty
+    // chunks is linked once, from the one that sorts first
+    std::vector<std::vector<Crossing>> crossings(dirty.size());
+    auto collect = [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            CollectCrossings(dirty[i], crossings[i]);
+            auto linkedEarlier = [&](const Crossing& crossing) {
+                return ChunkBefore(crossing.other, dirty[i]) &&
+                       std::binary_search(dirty.begin(), dirty.end(), crossing.other, ChunkBefore);
+            };
+            crossings[i].erase(std::remove_if(crossings[i].begin(), crossings[i].end(), linkedEarlier),
+                               crossings[i].end());
+        }
+    };
+    if (m_threadPool) {
+        m_threadPool->ParallelFor(dirty.size(), CHUNK_GRAIN, collect);
+    } else {
+        collect(0, dirty.size());
+    }
+    for (size_t i = 0; i < dirty.size(); ++i) {
+        AddPortals(dirty[i], crossings[i]);
+    }
+
+    if (m_components.size() > COMPONENT_SLACK * std::max<size_t>(m_stats.regions, 64)) {
+        LabelComponents();
+    } else {
+        for (uint32_t& parent : m_components) {
+            parent = FindComponent(parent);
+        }
+    }
+
+    m_stats.chunks = static_cast<uint32_t>(m_chunks.size());
+    m_stats.chunksRebuilt = static_cast<uint32_t>(dirty.size());
+    m_stats.rebuildMilliseconds = std::chrono::duration<float, std::milli>(Clock::now() - start).count();
+}
+
+// Steps climb or drop at most one voxel, with headroom above the lower end
+bool NavigationGraph::CanStep(const Cell& from, int fromY, const Cell& to, int toY) {
+    int dy = toY - fromY;
+    if (dy == 1) {
+        return (from.flags & CELL_HEADROOM) != 0;
+    }
+    if (dy == -1) {
+        return (to.flags & CELL_HEADROOM) != 0;
+    }
+    return dy == 0;
+}
+
+void NavigationGraph::BuildChunk(const ChunkCoord& coord, Chunk& chunk) const {
+    const VoxelChunk* below = m_world->FindChunk(Offset(coord, 0, -1, 0));
+    const VoxelChunk* self = m_world->FindChunk(coord);
+    const VoxelChunk* above = m_world->FindChunk(Offset(coord, 0, 1, 0));
+
+    // Cells stand on this chunk's solid voxels, or at y = 0 on the top
+    // layer of the chunk below; a full chunk has no air to stand in
+    int maxY = self ? std::min(self->GetBlock()->maxSolidY + 1, CHUNK_SIZE - 1) : -1;
+    if (below && below->GetBlock()->layerSolidCounts[CHUNK_SIZE - 1] > 0) {
+        maxY = std::max(maxY, 0);
+    }
+    if (self && self->IsFull()) {
+        maxY = -1;
+    }
+    if (maxY < 0) {
+        return;
+    }
+
+    const VoxelBlock* blocks[3] = {
+        below ? below->GetBlock().get() : nullptr,
+        self ? self->GetBlock().get() : nullptr,
+        above ? above->GetBlock().get() : nullptr
+    };
+    auto voxelAt = [&blocks](int x, int y, int z) -> uint8_t {
+        int layer = 1;
+        if (y < 0) {
+            layer = 0;
+            y += CHUNK_SIZE;
+        } else if (y >= CHUNK_SIZE) {
+            layer = 2;
+            y -= CHUNK_SIZE;
+        }
+        const VoxelBlock* block = blocks[layer];
+        return block ? block->voxels[LocalVoxelIndex(x, y, z)] : static_cast<uint8_t>(BlockType::Air);
+    };
+
+    chunk.columnStart.assign(CHUNK_SIZE * CHUNK_SIZE + 1, 0);
+    for (int z = 0; z < CHUNK_SIZE; ++z) {
+        for (int x = 0; x < CHUNK_SIZE; ++x) {
+            int column = x + z * CHUNK_SIZE;
+            chunk.columnStart[column] = static_cast<uint32_t>(chunk.cells.size());
+            for (int y = 0; y <= maxY; ++y) {
+                if (IsFloor(voxelAt(x, y - 1, z)) && IsPassable(voxelAt(x, y, z)) && IsPassable(voxelAt(x, y + 1, z))) {
+                    uint8_t flags = IsPassable(voxelAt(x, y + 2, z)) ? CELL_HEADROOM : 0;
+                    chunk.cells.push_back(Cell{ static_cast<uint16_t>(column), static_cast<uint8_t>(y), flags, NO_REGION });
+                }
+            }
+        }
+    }
+    chunk.columnStart[CHUNK_SIZE * CHUNK_SIZE] = static_cast<uint32_t>(chunk.cells.size());
+    if (chunk.cells.empty()) {
+        return;
+    }
+
+    // Regions are flood filled over steps that stay inside the chunk
+    std::vector<uint32_t> stack;
+    for (size_t seed = 0; seed < chunk.cells.size(); ++seed) {
+        if (chunk.cells[seed].region != NO_REGION) {
+            continue;
+        }
+        uint32_t region = static_cast<uint32_t>(chunk.regions.size());
+        chunk.regions.emplace_back();
+        chunk.cells[seed].region = region;
+        stack.push_back(static_cast<uint32_t>(seed));
+        while (!stack.empty()) {
+            const Cell cell = chunk.cells[stack.back()];
+            stack.pop_back();
+            int x = cell.column & ChunkLayout::MASK;
+            int z = cell.column >> ChunkLayout::SHIFT;
+            for (int direction = 0; direction < 4; ++direction) {
+                int nx = x + STEP_X[direction];
+                int nz = z + STEP_Z[direction];
+                if (!IsInsideChunk(nx, 0, nz)) {
+                    continue;
+                }
+                int column = nx + nz * CHUNK_SIZE;
+                for (uint32_t j = chunk.columnStart[column]; j < chunk.columnStart[column + 1]; ++j) {
+                    Cell& next = chunk.cells[j];
+                    if (next.region == NO_REGION && CanStep(cell, cell.y, next, next.y)) {
+                        next.region = region;
+                        stack.push_back(j);
+                    }
+                }
+            }
+        }
+    }
+}
+
+void NavigationGraph::CollectCrossings(const ChunkCoord& coord, std::vector<Crossing>& crossings) const {
+    const Chunk* chunk = FindChunk(coord);
+    if (!chunk) {
+        return;
+    }
+    int originX = ChunkLayout::ToWorld(coord.x);
+    int originY = ChunkLayout::ToWorld(coord.y);
+    int originZ = ChunkLayout::ToWorld(coord.z);
+
+    for (const Cell& cell : chunk->cells) {
+        int x = cell.column & ChunkLayout::MASK;
+        int z = cell.column >> ChunkLayout::SHIFT;
+        int y = cell.y;
+        if (x != 0 && x != CHUNK_SIZE - 1 && z != 0 && z != CHUNK_SIZE - 1 && y != 0 && y != CHUNK_SIZE - 1) {
+            continue;
+        }
+        for (int direction = 0; direction < 4; ++direction) {
+            for (int dy = -1; dy <= 1; ++dy) {
+                int nx = x + STEP_X[direction];
+                int ny = y + dy;
+                int nz = z + STEP_Z[direction];
+                if (IsInsideChunk(nx, ny, nz)) {
+                    continue;
+                }
+                VoxelPosition target{ originX + nx, originY + ny, originZ + nz };
+                ChunkCoord other = WorldToChunkCoord(target.x, target.y, target.z);
+                const Chunk* otherChunk = FindChunk(other);
+                if (!otherChunk) {
+                    continue;
+                }
+                const Cell* next = FindCell(*otherChunk, ChunkLayout::ToLocal(target.x), ChunkLayout::ToLocal(target.y),
+                                            ChunkLayout::ToLocal(target.z));
+                if (next && CanStep(cell, y, *next, ny)) {
+                    crossings.push_back(Crossing{ cell.region, other, next->region,
+                                                  VoxelPosition{ originX + x, originY + y, originZ + z }, target });
+                }
+            }
+        }
+    }
+}
+
+void NavigationGraph::RemovePortals(const ChunkCoord& coord) {
+    auto it = m_chunks.find(coord);
+    if (it == m_chunks.end()) {
+        return;
+    }
+    for (Region& region : it->second.regions) {
+        for (uint32_t id : region.portals) {
+            Portal& portal = m_portals[id];
+            if (!portal.alive) {
+                continue;
+            }
+            portal.alive = false;
+            m_freePortals.push_back(id);
+            --m_stats.portals;
+
+            const PortalSide& other = portal.sides[portal.sides[0].chunk == coord ? 1 : 0];
+            auto otherChunk = m_chunks.find(other.chunk);
+            if (otherChunk != m_chunks.end()) {
+                std::vector<uint32_t>& portals = otherChunk->second.regions[other.region].portals;
+                portals.erase(std::remove(portals.begin(), portals.end(), id), portals.end());
+            }
+        }
+        region.portals.clear();
+    }
+}
+
+void NavigationGraph::AddPortals(const ChunkCoord& coord, std::vector<Crossing>& crossings) {
+    if (crossings.empty()) {
+        return;
+    }
+    auto key = [](const Crossing& a, const Crossing& b) {
+        if (a.region != b.region) return a.region < b.region;
+        if (!(a.other == b.other)) return ChunkBefore(a.other, b.other);
+        if (a.otherRegion != b.otherRegion) return a.otherRegion < b.otherRegion;
+        if (!(a.cell == b.cell)) return PositionBefore(a.cell, b.cell);
+        return PositionBefore(a.otherCell, b.otherCell);
+    };
+    std::sort(crossings.begin(), crossings.end(), key);
+
+    Chunk& chunk = m_chunks.at(coord);
+    size_t begin = 0;
+    while (begin < crossings.size()) {
+        const Crossing& first = crossings[begin];
+        size_t end = begin + 1;
+        while (end < crossings.size() && crossings[end].region == first.region &&
+               crossings[end].other == first.other && crossings[end].otherRegion == first.otherRegion) {
+            ++end;
+        }
+
+        // The crossing nearest the middle of the group stands for all of it
+        double meanX = 0.0, meanY = 0.0, meanZ = 0.0;
+        for (size_t i = begin; i < end; ++i) {
+            meanX += crossings[i].cell.x;
+            meanY += crossings[i].cell.y;
+            meanZ += crossings[i].cell.z;
+        }
+        double count = static_cast<double>(end - begin);
+        meanX /= count;
+        meanY /= count;
+        meanZ /= count;
+        size_t best = begin;
+        double bestDistance = 0.0;
+        for (size_t i = begin; i < end; ++i) {
+            double dx = crossings[i].cell.x - meanX;
+            double dy = crossings[i].cell.y - meanY;
+            double dz = crossings[i].cell.z - meanZ;
+            double distance = dx * dx + dy * dy + dz * dz;
+            if (i == begin || distance < bestDistance) {
+                best = i;
+                bestDistance = distance;
+            }
+        }
+
+        const Crossing& chosen = crossings[best];
+        uint32_t id;
+        if (!m_freePortals.empty()) {
+            id = m_freePortals.back();
+            m_freePortals.pop_back();
+        } else {
+            id = static_cast<uint32_t>(m_portals.size());
+            m_portals.emplace_back();
+        }
+        m_portals[id] = Portal{ { PortalSide{ coord, chosen.region, chosen.cell },
+                                  PortalSide{ chosen.other, chosen.otherRegion, chosen.otherCell } }, true };
+        chunk.regions[chosen.region].portals.push_back(id);
+        Region& otherRegion = m_chunks.at(chosen.other).regions[chosen.otherRegion];
+        otherRegion.portals.push_back(id);
+        uint32_t root = FindComponent(chunk.regions[chosen.region].component);
+        uint32_t otherRoot = FindComponent(otherRegion.component);
+        m_components[std::max(root, otherRoot)] = std::min(root, otherRoot);
+        ++m_stats.portals;
+        begin = end;
+    }
+}
+
+uint32_t NavigationGraph::FindComponent(uint32_t component) {
+    while (m_components[component] != component) {
+        m_components[component] = m_components[m_components[component]];
+        component = m_components[component];
+    }
+    return component;
+}
+
+// Drops the labels of rebuilt regions and splits components that lost
+// their portals
+void NavigationGraph::LabelComponents() {
+    for (auto& pair : m_chunks) {
+        for (Region& region : pair.second.regions) {
+            region.component = NO_REGION;
+        }
+    }
+
+    m_components.clear();
+    uint32_t component = 0;
+    std::vector<Region*> stack;
+    for (auto& pair : m_chunks) {
+        for (Region& seed : pair.second.regions) {
+            if (seed.component != NO_REGION) {
+                continue;
+            }
+            seed.component = component;
+            stack.push_back(&seed);
+            while (!stack.empty()) {
+                Region* region = stack.back();
+                stack.pop_back();
+                for (uint32_t id : region->portals) {
+                    for (const PortalSide& side : m_portals[id].sides) {
+                        Region& next = m_chunks.at(side.chunk).regions[side.region];
+                        if (next.component == NO_REGION) {
+                            next.component = component;
+                            stack.push_back(&next);
+                        }
+                    }
+                }
+            }
+            m_components.push_back(component);
+            ++component;
+        }
+    }
+}
+
+const NavigationGraph::Chunk* NavigationGraph::FindChunk(const ChunkCoord& coord) const {
+    auto it = m_chunks.find(coord);
+    return it != m_chunks.end() ? &it->second : nullptr;
+}
+
+const NavigationGraph::Cell* NavigationGraph::FindCell(const Chunk& chunk, int localX, int localY, int localZ) const {
+    int column = localX + localZ * CHUNK_SIZE;
+    for (uint32_t i = chunk.columnStart[column]; i < chunk.columnStart[column + 1]; ++i) {
+        if (chunk.cells[i].y == localY) {
+            return &chunk.cells[i];
+        }
+    }
+    return nullptr;
+}
+
+const NavigationGraph::Cell* NavigationGraph::FindCell(const VoxelPosition& position, const Chunk** chunk) const {
+    *chunk = FindChunk(WorldToChunkCoord(position.x, position.y, position.z));
+    if (!*chunk) {
+        return nullptr;
+    }
+    return FindCell(**chunk, ChunkLayout::ToLocal(position.x), ChunkLayout::ToLocal(position.y),
+                    ChunkLayout::ToLocal(position.z));
+}
+
+bool NavigationGraph::IsStandable(const VoxelPosition& position) const {
+    const Chunk* chunk = nullptr;
+    return FindCell(position, &chunk) != nullptr;
+}
+
+bool NavigationGraph::FindStandingPosition(int x, int y, int z, int maxDrop, VoxelPosition& position) const {
+    int lowest = y - std::max(maxDrop, 0);
+    int localX = ChunkLayout::ToLocal(x);
+    int localZ = ChunkLayout::ToLocal(z);
+    int column = localX + localZ * CHUNK_SIZE;
+
+    // One chunk at a time, top down; chunks without cells are skipped whole
+    while (y >= lowest) {
+        ChunkCoord coord = WorldToChunkCoord(x, y, z);
+        int bottom = std::max(ChunkLayout::ToWorld(coord.y), lowest);
+        if (const Chunk* chunk = FindChunk(coord)) {
+            for (uint32_t i = chunk->columnStart[column + 1]; i > chunk->columnStart[column]; --i) {
+                int cellY = ChunkLayout::ToWorld(coord.y) + chunk->cells[i - 1].y;
+                if (cellY <= y && cellY >= bottom) {
+                    position = VoxelPosition{ x, cellY, z };
+                    return true;
+                }
+            }
+        }
+        y = bottom - 1;
+    }
+    return false;
+}
+
+PathStatus NavigationGraph::FindPath(const VoxelPosition& start, const VoxelPosition& goal,
+                                     std::vector<VoxelPosition>& path) const {
+    SearchScratch scratch;
+    return FindPath(start, goal, path, scratch);
+}
+
+void NavigationGraph::FindPaths(std::vector<PathRequest>& requests) const {
+    auto solve = [this, &requests](size_t begin, size_t end) {
+        SearchScratch scratch;
+        for (size_t i = begin; i < end; ++i) {
+            PathRequest& request = requests[i];
+            request.status = FindPath(request.start, request.goal, request.path, scratch);
+        }
+    };
+    if (m_threadPool) {
+        m_threadPool->ParallelFor(requests.size(), PATH_GRAIN, solve);
+    } else {
+        solve(0, requests.size());
+    }
+}
+
+PathStatus NavigationGraph::FindPath(const VoxelPosition& start, const VoxelPosition& goal,
+                                     std::vector<VoxelPosition>& path, SearchScratch& scratch) const {
+    path.clear();
+    const Chunk* startChunk = nullptr;
+    const Chunk* goalChunk = nullptr;
+    const Cell* startCell = FindCell(start, &startChunk);
+    const Cell* goalCell = FindCell(goal, &goalChunk);
+    if (!startCell || !goalCell) {
+        return PathStatus::InvalidEndpoint;
+    }
+    ChunkCoord startCoord = WorldToChunkCoord(start.x, start.y, start.z);
+    ChunkCoord goalCoord = WorldToChunkCoord(goal.x, goal.y, goal.z);
+    path.push_back(start);
+    if (startCoord == goalCoord && startCell->region == goalCell->region) {
+        return RefineWithinRegion(startCoord, *startChunk, start, goal, path, scratch) ? PathStatus::Found
+                                                                                      : PathStatus::NoPath;
+    }
+    if (m_components[startChunk->regions[startCell->region].component] !=
+        m_components[goalChunk->regions[goalCell->region].component]) {
+        path.clear();
+        return PathStatus::NoPath;
+    }
+
+    // Abstract nodes are portal sides: node 2 * id + s stands at side s of
+    // portal id, just after crossing to it. The last node is the goal.
+    const int32_t goalNode = static_cast<int32_t>(m_portals.size() * 2);
+    scratch.Reset(m_portals.size() * 2 + 1);
+    auto expand = [&](int32_t node, uint32_t cost, const ChunkCoord& coord, const Chunk& chunk, uint32_t region,
+                      const VoxelPosition& at) {
+        if (coord == goalCoord && region == goalCell->region) {
+            scratch.Relax(goalNode, cost + Distance(at, goal), node, 0);
+        }
+        for (uint32_t id : chunk.regions[region].portals) {
+            if (node >= 0 && id == static_cast<uint32_t>(node / 2)) {
+                continue;
+            }
+            const Portal& portal = m_portals[id];
+            int nearSide = portal.sides[0].chunk == coord ? 0 : 1;
+            const PortalSide& farSide = portal.sides[1 - nearSide];
+            uint32_t stepCost = cost + Distance(at, portal.sides[nearSide].cell) + 1;
+            scratch.Relax(static_cast<int32_t>(id * 2 + (1 - nearSide)), stepCost, node, Distance(farSide.cell, goal));
+        }
+    };
+    expand(-1, 0, startCoord, *startChunk, startCell->region, start);
+
+    int32_t node;
+    while ((node = scratch.Pop()) >= 0 && node != goalNode) {
+        const PortalSide& side = m_portals[node / 2].sides[node % 2];
+        expand(node, scratch.Get(node).cost, side.chunk, *FindChunk(side.chunk), side.region, side.cell);
+    }
+    if (node != goalNode) {
+        path.clear();
+        return PathStatus::NoPath;
+    }
+
+    scratch.route.clear();
+    for (int32_t n = scratch.Get(goalNode).parent; n >= 0; n = scratch.Get(n).parent) {
+        scratch.route.push_back(n);
+    }
+    std::reverse(scratch.route.begin(), scratch.route.end());
+
+    VoxelPosition at = start;
+    ChunkCoord atCoord = startCoord;
+    const Chunk* atChunk = startChunk;
+    bool refined = true;
+    for (int32_t n : scratch.route) {
+        const Portal& portal = m_portals[n / 2];
+        const PortalSide& farSide = portal.sides[n % 2];
+        const PortalSide& nearSide = portal.sides[1 - n % 2];
+        refined = refined && RefineWithinRegion(atCoord, *atChunk, at, nearSide.cell, path, scratch);
+        path.push_back(farSide.cell);
+        at = farSide.cell;
+        atCoord = farSide.chunk;
+        atChunk = FindChunk(atCoord);
+    }
+    refined = refined && RefineWithinRegion(atCoord, *atChunk, at, goal, path, scratch);
+    if (!refined) {
+        path.clear();
+        return PathStatus::NoPath;
+    }
+    return PathStatus::Found;
+}
+
+bool NavigationGraph::RefineWithinRegion(const ChunkCoord& coord, const Chunk& chunk, const VoxelPosition& from,
+                                         const VoxelPosition& to, std::vector<VoxelPosition>& path,
+                                         SearchScratch& scratch) const {
+    if (from == to) {
+        return true;
+    }
+    int originX = ChunkLayout::ToWorld(coord.x);
+    int originY = ChunkLayout::ToWorld(coord.y);
+    int originZ = ChunkLayout::ToWorld(coord.z);
+    auto position = [&](int32_t index) {
+        const Cell& cell = chunk.cells[index];
+        return VoxelPosition{ originX + (cell.column & ChunkLayout::MASK), originY + cell.y,
+                              originZ + (cell.column >> ChunkLayout::SHIFT) };
+    };
+    int32_t source = static_cast<int32_t>(FindCell(chunk, from.x - originX, from.y - originY, from.z - originZ) -
+                                          chunk.cells.data());
+    int32_t target = static_cast<int32_t>(FindCell(chunk, to.x - originX, to.y - originY, to.z - originZ) -
+                                          chunk.cells.data());
+
+    scratch.Reset(chunk.cells.size());
+    scratch.Relax(source, 0, -1, Distance(from, to));
+    int32_t node;
+    while ((node = scratch.Pop()) >= 0 && node != target) {
+        const Cell& cell = chunk.cells[node];
+        uint32_t cost = scratch.Get(node).cost + 1;
+        int x = cell.column & ChunkLayout::MASK;
+        int z = cell.column >> ChunkLayout::SHIFT;
+        for (int direction = 0; direction < 4; ++direction) {
+            int nx = x + STEP_X[direction];
+            int nz = z + STEP_Z[direction];
+            if (!IsInsideChunk(nx, 0, nz)) {
+                continue;
+            }
+            int column = nx + nz * CHUNK_SIZE;
+            for (uint32_t j = chunk.columnStart[column]; j < chunk.columnStart[column + 1]; ++j) {
+                if (CanStep(cell, cell.y, chunk.cells[j], chunk.cells[j].y)) {
+                    scratch.Relax(static_cast<int32_t>(j), cost, node, Distance(position(j), to));
+                }
+            }
+        }
+    }
+    if (node != target) {
+        return false;
+    }
+
+    size_t first = path.size();
+    for (int32_t n = target; n != source; n = scratch.Get(n).parent) {
+        path.push_back(position(n));
+    }
+    std::reverse(path.begin() + first, path.end());
+    return true;
+}
+
+PathfindingBenchmarkStats MeasurePathfinding(int seed, int worldRadius, uint32_t paths, uint32_t edits,
+                                             ThreadPool* threadPool) {
+    VoxelEngine world(threadPool);
+    world.SetWorldRadius(worldRadius);
+    world.GenerateTerrain(seed);
+    world.WaitForTerrain();
+
+    PathfindingBenchmarkStats stats = {};
+    NavigationGraph graph(&world, threadPool);
+    auto buildStart = Clock::now();
+    graph.Update();
+    stats.buildMilliseconds = std::chrono::duration<float, std::milli>(Clock::now() - buildStart).count();
+    stats.chunks = graph.GetStats().chunks;
+    stats.regions = graph.GetStats().regions;
+    stats.portals = graph.GetStats().portals;
+
+    int extent = std::max(worldRadius, 1) * CHUNK_SIZE;
+    auto surface = [&graph, extent](int x, int z, VoxelPosition& position) {
+        x = std::clamp(x, -extent, extent - 1);
+        z = std::clamp(z, -extent, extent - 1);
+        return graph.FindStandingPosition(x, SURFACE_TOP, z, SURFACE_DEPTH, position);
+    };
+
+    std::vector<PathRequest> requests;
+    for (uint32_t i = 0; requests.size() < paths && i < paths * 4; ++i) {
+        int x = static_cast<int>(Hash(i * 4) % (2 * extent)) - extent;
+        int z = static_cast<int>(Hash(i * 4 + 1) % (2 * extent)) - extent;
+        int goalX = x + static_cast<int>(Hash(i * 4 + 2) % (2 * PATH_SPAN + 1)) - PATH_SPAN;
+        int goalZ = z + static_cast<int>(Hash(i * 4 + 3) % (2 * PATH_SPAN + 1)) - PATH_SPAN;
+        PathRequest request = {};
+        if (surface(x, z, request.start) && surface(goalX, goalZ, request.goal)) {
+            requests.push_back(std::move(request));
+        }
+    }
+    stats.paths = static_cast<uint32_t>(requests.size());
+
+    auto solveStart = Clock::now();
+    graph.FindPaths(requests);
+    double solveSeconds = std::chrono::duration<double>(Clock::now() - solveStart).count();
+    if (solveSeconds > 0.0) {
+        stats.pathsPerSecond = static_cast<float>(requests.size() / solveSeconds);
+    }
+    uint64_t steps = 0;
+    for (const PathRequest& request : requests) {
+        if (request.status == PathStatus::Found) {
+            ++stats.found;
+            steps += request.path.size() - 1;
+            if (!IsWalkablePath(world, request)) {
+                ++stats.invalid;
+            }
+        }
+    }
+    if (stats.found > 0) {
+        stats.averageLength = static_cast<float>(steps) / stats.found;
+    }
+
+    // Alternately dig out the floor under a surface position or fill it
+    double rebuildSeconds = 0.0;
+    for (uint32_t i = 0; i < edits; ++i) {
+        VoxelPosition position;
+        int x = static_cast<int>(Hash(0x9E3779B9u + i * 2) % (2 * extent)) - extent;
+        int z = static_cast<int>(Hash(0x9E3779B9u + i * 2 + 1) % (2 * extent)) - extent;
+        if (!surface(x, z, position)) {
+            continue;
+        }
+        if (i % 2 == 0) {
+            world.SetVoxel(position.x, position.y - 1, position.z, static_cast<uint8_t>(BlockType::Air));
+        } else {
+            world.SetVoxel(position.x, position.y, position.z, static_cast<uint8_t>(BlockType::Stone));
+        }
+        auto rebuildStart = Clock::now();
+        graph.Update();
+        rebuildSeconds += std::chrono::duration<double>(Clock::now() - rebuildStart).count();
+        ++stats.edits;
+    }
+    if (stats.edits > 0) {
+        stats.rebuildMicroseconds = static_cast<float>(rebuildSeconds * 1e6 / stats.edits);
+    }
+
+    // The updated graph must agree with one built from the edited world
+    std::vector<PathRequest> fresh = requests;
+    graph.FindPaths(requests);
+    NavigationGraph rebuilt(&world, threadPool);
+    rebuilt.Update();
+    rebuilt.FindPaths(fresh);
+    for (size_t i = 0; i < requests.size(); ++i) {
+        if (requests[i].status != fresh[i].status) {
+            ++stats.mismatches;
+        }
+        if (requests[i].status == PathStatus::Found && !IsWalkablePath(world, requests[i])) {
+            ++stats.invalid;
+        }
+    }
+    return stats;
+}
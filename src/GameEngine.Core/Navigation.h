@@ -0,0 +1,176 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "VoxelChunk.h"
+
+class ThreadPool;
+class VoxelEngine;
+
+enum class PathStatus : uint8_t {
+    Pending = 0,
+    Found = 1,
+    NoPath = 2,
+    InvalidEndpoint = 3,    // start or goal is not a standing position
+};
+
+struct PathRequest {
+    VoxelPosition start;
+    VoxelPosition goal;
+    PathStatus status;
+    std::vector<VoxelPosition> path;    // start to goal inclusive, one step apart
+};
+
+struct NavigationStats {
+    uint32_t chunks;                // chunks with standing positions
+    uint32_t cells;                 // standing positions
+    uint32_t regions;
+    uint32_t portals;
+    uint32_t chunksRebuilt;         // by the last Update that had work
+    float rebuildMilliseconds;
+};
+
+// Hierarchical pathfinding for agents walking on the voxel terrain.
+//
+// Agents are two voxels tall and stand in an air voxel above a solid voxel
+// other than water. A step moves one voxel along x or z and may climb or
+// drop one voxel; the lower of the two positions needs a third voxel of
+// air above it for the agent's head.
+//
+// Each chunk keeps its standing positions ("cells") grouped into regions,
+// the sets connected by steps that stay inside the chunk. Steps between
+// chunks are grouped into one portal per pair of regions, placed at the
+// crossing nearest the middle of the group. A path search runs A* over the
+// portals, costing moves inside a region by their x/z distance, then
+// refines each region it passes through with A* over that region's cells.
+// Paths are valid step by step but only near-shortest.
+//
+// Regions joined by portals share a component label, so most requests with
+// no path fail without a search. Labels are merged as portals are added and
+// never split when portals go; they only say a path may exist, and are
+// recomputed once enough rebuilt regions have accumulated.
+//
+// Edits mark the chunks whose cells they can change, through an edit
+// listener on the world, and Update rebuilds those chunks and their
+// portals, on the thread pool if there is one. Searches read only this
+// graph and may run on any threads between Updates. Chunks are read through
+// VoxelEngine::FindChunk, so evicted neighbours count as air until the
+// chunk is next rebuilt.
+class NavigationGraph {
+public:
+    // Every chunk the world holds is built by the first Update
+    explicit NavigationGraph(VoxelEngine* world, ThreadPool* threadPool = nullptr);
+    ~NavigationGraph();
+
+    NavigationGraph(const NavigationGraph&) = delete;
+    NavigationGraph& operator=(const NavigationGraph&) = delete;
+
+    // Rebuilds the chunks edited since the last call, or everything after
+    // the world was replaced
+    void Update();
+
+    bool IsStandable(const VoxelPosition& position) const;
+    // Highest standing position in the column at or below y, at most
+    // maxDrop voxels down
+    bool FindStandingPosition(int x, int y, int z, int maxDrop, VoxelPosition& position) const;
+
+    PathStatus FindPath(const VoxelPosition& start, const VoxelPosition& goal, std::vector<VoxelPosition>& path) const;
+    // Solves every request; with a thread pool, requests run in parallel
+    void FindPaths(std::vector<PathRequest>& requests) const;
+
+    const NavigationStats& GetStats() const { return m_stats; }
+
+private:
+    static constexpr uint8_t CELL_HEADROOM = 1;     // air two voxels above the feet
+
+    struct Cell {
+        uint16_t column;            // chunk-local x + z * Size
+        uint8_t y;                  // chunk-local
+        uint8_t flags;
+        uint32_t region;
+    };
+
+    struct Region {
+        std::vector<uint32_t> portals;
+        uint32_t component;         // index into m_components
+    };
+
+    struct Chunk {
+        std::vector<uint32_t> columnStart;  // Size * Size + 1 offsets into cells, by x + z * Size
+        std::vector<Cell> cells;            // by column, then y
+        std::vector<Region> regions;
+    };
+
+    struct PortalSide {
+        ChunkCoord chunk;
+        uint32_t region;
+        VoxelPosition cell;
+    };
+
+    struct Portal {
+        PortalSide sides[2];
+        bool alive;
+    };
+
+    struct Crossing;
+    struct SearchScratch;
+
+    static bool CanStep(const Cell& from, int fromY, const Cell& to, int toY);
+
+    void OnVoxelEdited(const ChunkCoord& coord, int voxelIndex);
+    void BuildChunk(const ChunkCoord& coord, Chunk& chunk) const;
+    void CollectCrossings(const ChunkCoord& coord, std::vector<Crossing>& crossings) const;
+    void RemovePortals(const ChunkCoord& coord);
+    void AddPortals(const ChunkCoord& coord, std::vector<Crossing>& crossings);
+    uint32_t FindComponent(uint32_t component);
+    void LabelComponents();
+
+    const Chunk* FindChunk(const ChunkCoord& coord) const;
+    const Cell* FindCell(const Chunk& chunk, int localX, int localY, int localZ) const;
+    const Cell* FindCell(const VoxelPosition& position, const Chunk** chunk) const;
+
+    PathStatus FindPath(const VoxelPosition& start, const VoxelPosition& goal, std::vector<VoxelPosition>& path,
+                        SearchScratch& scratch) const;
+    bool RefineWithinRegion(const ChunkCoord& coord, const Chunk& chunk, const VoxelPosition& from,
+                            const VoxelPosition& to, std::vector<VoxelPosition>& path, SearchScratch& scratch) const;
+
+    VoxelEngine* m_world;
+    ThreadPool* m_threadPool;
+    uint32_t m_editListener;            // VoxelEngine::EditListenerId
+    uint32_t m_worldGeneration;
+    bool m_rebuildAll;
+
+    std::unordered_map<ChunkCoord, Chunk> m_chunks;
+    std::vector<Portal> m_portals;
+    std::vector<uint32_t> m_freePortals;
+    std::vector<uint32_t> m_components; // union-find parents, flattened after each Update
+    std::unordered_set<ChunkCoord> m_dirty;
+    NavigationStats m_stats;
+};
+
+struct PathfindingBenchmarkStats {
+    uint32_t chunks;
+    uint32_t regions;
+    uint32_t portals;
+    float buildMilliseconds;        // every chunk of the scratch world
+    uint32_t paths;
+    uint32_t found;
+    uint32_t invalid;               // found paths with a step agents cannot take; must be 0
+    float averageLength;            // steps per found path
+    float pathsPerSecond;           // one batch through FindPaths
+    uint32_t edits;
+    float rebuildMicroseconds;      // Update after one edit, on average
+    uint32_t mismatches;            // outcomes after the edits that differ from a fresh graph; must be 0
+};
+
+// Generates a scratch world, builds its graph and solves `paths` requests
+// between pseudo-random surface positions up to 64 voxels apart in one
+// batch. Then `edits` single voxels are dug or placed on the surface, with
+// an Update after each, and the batch is solved again by the updated graph
+// and by one built from scratch; every found path is walked against the
+// world's voxels.
+PathfindingBenchmarkStats MeasurePathfinding(int seed, int worldRadius, uint32_t paths, uint32_t edits,
+                                             ThreadPool* threadPool);
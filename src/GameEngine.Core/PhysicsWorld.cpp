@@ -0,0 +1,490 @@
+#include "PhysicsWorld.h"
+#include "VoxelEngine.h"
+#include "VoxelChunk.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <random>
+
+using namespace DirectX;
+
+namespace {
+    constexpr uint8_t BODY_DYNAMIC = 1 << 0;
+    constexpr uint8_t BODY_GROUNDED = 1 << 1;
+
+    constexpr uint32_t INVALID_INDEX = UINT32_MAX;
+    constexpr uint64_t EMPTY_CELL = UINT64_MAX;     // keys only use 63 bits
+    constexpr float SKIN = 1e-3f;       // gap left between a body and the voxel it hit
+    constexpr size_t BODY_GRAIN = 256;
+
+    // Benchmark world; boxes are stacked a voxel apart in columns two voxels
+    // apart, each from just above the surface found searching down from
+    // SURFACE_TOP
+    constexpr int BENCHMARK_SEED = 12345;
+    constexpr int BENCHMARK_WORLD_RADIUS = 2;
+    constexpr int BENCHMARK_COLUMN_SPACING = 2;
+    constexpr float BENCHMARK_LAYER_SPACING = 1.5f;
+    constexpr float BENCHMARK_HALF_EXTENT = 0.4f;
+    constexpr float BENCHMARK_DRIFT = 2.0f;
+    constexpr int SURFACE_TOP = 64;
+    constexpr int SURFACE_DEPTH = 128;
+
+    inline int FloorToInt(float v) { return static_cast<int>(std::floor(v)); }
+    inline int CeilToInt(float v) { return static_cast<int>(std::ceil(v)); }
+}
+
+PhysicsWorld::PhysicsWorld(const VoxelEngine* world, ThreadPool* threadPool)
+    : m_world(world)
+    , m_threadPool(threadPool)
+    , m_cellSize(2.0f)
+    , m_cellShift(60)
+    , m_gravity(-20.0f)
+    , m_stats{}
+{
+}
+
+PhysicsWorld::~PhysicsWorld() = default;
+
+BodyId PhysicsWorld::CreateBody(const XMFLOAT3& position, const XMFLOAT3& halfExtents, bool dynamic) {
+    BodyId id;
+    if (!m_freeIds.empty()) {
+        id = m_freeIds.back();
+        m_freeIds.pop_back();
+    } else {
+        id = static_cast<BodyId>(m_sparse.size());
+        m_sparse.push_back(INVALID_INDEX);
+    }
+
+    m_sparse[id] = static_cast<uint32_t>(m_denseToId.size());
+    m_denseToId.push_back(id);
+    m_posX.push_back(position.x);
+    m_posY.push_back(position.y);
+    m_posZ.push_back(position.z);
+    m_velX.push_back(0.0f);
+    m_velY.push_back(0.0f);
+    m_velZ.push_back(0.0f);
+    m_halfX.push_back(halfExtents.x);
+    m_halfY.push_back(halfExtents.y);
+    m_halfZ.push_back(halfExtents.z);
+    m_pushX.push_back(0.0f);
+    m_pushY.push_back(0.0f);
+    m_pushZ.push_back(0.0f);
+    m_flags.push_back(dynamic ? BODY_DYNAMIC : 0);
+    return id;
+}
+
+void PhysicsWorld::DestroyBody(BodyId id) {
+    if (!IsValid(id)) {
+        return;
+    }
+
+    // Swap-remove keeps the arrays dense
+    uint32_t index = m_sparse[id];
+    uint32_t last = static_cast<uint32_t>(m_denseToId.size() - 1);
+    auto swapRemove = [index](auto& v) {
+        v[index] = v.back();
+        v.pop_back();
+    };
+    swapRemove(m_posX); swapRemove(m_posY); swapRemove(m_posZ);
+    swapRemove(m_velX); swapRemove(m_velY); swapRemove(m_velZ);
+    swapRemove(m_halfX); swapRemove(m_halfY); swapRemove(m_halfZ);
+    swapRemove(m_pushX); swapRemove(m_pushY); swapRemove(m_pushZ);
+    swapRemove(m_flags);
+    swapRemove(m_denseToId);
+
+    if (index != last) {
+        m_sparse[m_denseToId[index]] = index;
+    }
+    m_sparse[id] = INVALID_INDEX;
+    m_freeIds.push_back(id);
+}
+
+bool PhysicsWorld::IsValid(BodyId id) const {
+    return id < m_sparse.size() && m_sparse[id] != INVALID_INDEX;
+}
+
+void PhysicsWorld::SetVelocity(BodyId id, const XMFLOAT3& velocity) {
+    if (!IsValid(id)) return;
+    uint32_t i = m_sparse[id];
+    m_velX[i] = velocity.x;
+    m_velY[i] = velocity.y;
+    m_velZ[i] = velocity.z;
+}
+
+XMFLOAT3 PhysicsWorld::GetPosition(BodyId id) const {
+    if (!IsValid(id)) return XMFLOAT3(0.0f, 0.0f, 0.0f);
+    uint32_t i = m_sparse[id];
+    return XMFLOAT3(m_posX[i], m_posY[i], m_posZ[i]);
+}
+
+XMFLOAT3 PhysicsWorld::GetVelocity(BodyId id) const {
+    if (!IsValid(id)) return XMFLOAT3(0.0f, 0.0f, 0.0f);
+    uint32_t i = m_sparse[id];
+    return XMFLOAT3(m_velX[i], m_velY[i], m_velZ[i]);
+}
+
+XMFLOAT3 PhysicsWorld::GetHalfExtents(BodyId id) const {
+    if (!IsValid(id)) return XMFLOAT3(0.0f, 0.0f, 0.0f);
+    uint32_t i = m_sparse[id];
+    return XMFLOAT3(m_halfX[i], m_halfY[i], m_halfZ[i]);
+}
+
+bool PhysicsWorld::IsGrounded(BodyId id) const {
+    return IsValid(id) && (m_flags[m_sparse[id]] & BODY_GROUNDED) != 0;
+}
+
+void PhysicsWorld::Step(float deltaTime) {
+    auto start = std::chrono::high_resolution_clock::now();
+    size_t count = m_denseToId.size();
+
+    BuildSpatialHash();
+
+    std::atomic<uint32_t> voxelTests{ 0 };
+    std::atomic<uint32_t> skippedChunks{ 0 };
+    std::atomic<uint32_t> contactPairs{ 0 };
+    auto flush = [&](const Counters& counters) {
+        voxelTests += counters.voxelTests;
+        skippedChunks += counters.skippedChunks;
+        contactPairs += counters.contactPairs;
+    };
+
+    // Contacts only read positions and write each body's own push, and the
+    // sweep only writes each body's own state, so both passes are race-free
+    auto solve = [&](size_t begin, size_t end) {
+        Counters counters;
+        SolveContacts(begin, end, counters);
+        flush(counters);
+    };
+    auto integrate = [&](size_t begin, size_t end) {
+        Counters counters;
+        Integrate(begin, end, deltaTime, counters);
+        flush(counters);
+    };
+    if (m_threadPool) {
+        m_threadPool->ParallelFor(count, BODY_GRAIN, solve);
+        m_threadPool->ParallelFor(count, BODY_GRAIN, integrate);
+    } else {
+        solve(0, count);
+        integrate(0, count);
+    }
+
+    auto end = std::chrono::high_resolution_clock::now();
+    m_stats.bodyCount = static_cast<uint32_t>(count);
+    m_stats.contactPairs = contactPairs / 2; // each pair is seen from both sides
+    m_stats.voxelTests = voxelTests;
+    m_stats.skippedChunks = skippedChunks;
+    m_stats.stepMilliseconds = std::chrono::duration<float, std::milli>(end - start).count();
+}
+
+XMFLOAT3 PhysicsWorld::SweepAabb(const XMFLOAT3& center, const XMFLOAT3& halfExtents,
+                                 const XMFLOAT3& delta, uint8_t* blockedAxes) const {
+    Counters counters;
+    return SweepAabb(center, halfExtents, delta, blockedAxes, counters);
+}
+
+XMFLOAT3 PhysicsWorld::SweepAabb(const XMFLOAT3& center, const XMFLOAT3& halfExtents,
+                                 const XMFLOAT3& delta, uint8_t* blockedAxes, Counters& counters) const {
+    float minCorner[3] = { center.x - halfExtents.x, center.y - halfExtents.y, center.z - halfExtents.z };
+    float maxCorner[3] = { center.x + halfExtents.x, center.y + halfExtents.y, center.z + halfExtents.z };
+    const float wanted[3] = { delta.x, delta.y, delta.z };
+    uint8_t blocked = 0;
+
+    // Vertical first so walking on the ground does not snag on floor seams
+    static const int order[3] = { 1, 0, 2 };
+    for (int axis : order) {
+        float moved = SweepAxis(axis, minCorner, maxCorner, wanted[axis], counters);
+        if (moved != wanted[axis]) {
+            blocked |= static_cast<uint8_t>(1 << axis);
+        }
+        minCorner[axis] += moved;
+        maxCorner[axis] += moved;
+    }
+
+    if (blockedAxes) {
+        *blockedAxes = blocked;
+    }
+    return XMFLOAT3(
+        (minCorner[0] + maxCorner[0]) * 0.5f,
+        (minCorner[1] + maxCorner[1]) * 0.5f,
+        (minCorner[2] + maxCorner[2]) * 0.5f);
+}
+
+float PhysicsWorld::SweepAxis(int axis, const float* minCorner, const float* maxCorner, float delta,
+                              Counters& counters) const {
+    if (delta == 0.0f) {
+        return 0.0f;
+    }
+
+    // Voxel layer L along `axis` spans [L, L + 1). Only layers the box does
+    // not already overlap are tested, one slab at a time, nearest first.
+    int a1 = (axis + 1) % 3;
+    int a2 = (axis + 2) % 3;
+    int range[3][2];
+    range[a1][0] = FloorToInt(minCorner[a1]);
+    range[a1][1] = CeilToInt(maxCorner[a1]) - 1;
+    range[a2][0] = FloorToInt(minCorner[a2]);
+    range[a2][1] = CeilToInt(maxCorner[a2]) - 1;
+
+    if (delta > 0.0f) {
+        int first = CeilToInt(maxCorner[axis]);
+        int last = CeilToInt(maxCorner[axis] + delta) - 1;
+        for (int layer = first; layer <= last; ++layer) {
+            range[axis][0] = range[axis][1] = layer;
+            if (AnySolid(range[0][0], range[1][0], range[2][0], range[0][1], range[1][1], range[2][1], counters)) {
+                return std::max(0.0f, layer - SKIN - maxCorner[axis]);
+            }
+        }
+    } else {
+        int first = FloorToInt(minCorner[axis]) - 1;
+        int last = FloorToInt(minCorner[axis] + delta);
+        for (int layer = first; layer >= last; --layer) {
+            range[axis][0] = range[axis][1] = layer;
+            if (AnySolid(range[0][0], range[1][0], range[2][0], range[0][1], range[1][1], range[2][1], counters)) {
+                return std::min(0.0f, layer + 1 + SKIN - minCorner[axis]);
+            }
+        }
+    }
+    return delta;
+}
+
+bool PhysicsWorld::AnySolid(int x0, int y0, int z0, int x1, int y1, int z1, Counters& counters) const {
+    ChunkCoord c0 = VoxelEngine::WorldToChunk(x0, y0, z0);
+    ChunkCoord c1 = VoxelEngine::WorldToChunk(x1, y1, z1);
+
+    for (int cz = c0.z; cz <= c1.z; ++cz) {
+        for (int cy = c0.y; cy <= c1.y; ++cy) {
+            for (int cx = c0.x; cx <= c1.x; ++cx) {
+                const VoxelChunk* chunk = m_world->FindChunk(ChunkCoord{ cx, cy, cz });
+                if (!chunk || chunk->IsEmpty()) {
+                    ++counters.skippedChunks;
+                    continue;
+                }
+                if (chunk->IsFull()) {
+                    ++counters.skippedChunks;
+                    return true;
+                }
+
+                int lx0 = std::max(x0 - cx * CHUNK_SIZE, 0), lx1 = std::min(x1 - cx * CHUNK_SIZE, CHUNK_SIZE - 1);
+                int ly0 = std::max(y0 - cy * CHUNK_SIZE, 0), ly1 = std::min(y1 - cy * CHUNK_SIZE, CHUNK_SIZE - 1);
+                int lz0 = std::max(z0 - cz * CHUNK_SIZE, 0), lz1 = std::min(z1 - cz * CHUNK_SIZE, CHUNK_SIZE - 1);
+                for (int z = lz0; z <= lz1; ++z) {
+                    for (int y = ly0; y <= ly1; ++y) {
+                        for (int x = lx0; x <= lx1; ++x) {
+                            ++counters.voxelTests;
+                            if (chunk->GetVoxel(x, y, z) != static_cast<uint8_t>(BlockType::Air)) {
+                                return true;
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+    return false;
+}
+
+uint64_t PhysicsWorld::CellKey(int cx, int cy, int cz) const {
+    constexpr uint64_t mask = (1ull << 21) - 1;
+    return ((static_cast<uint64_t>(cx) & mask) << 42) |
+           ((static_cast<uint64_t>(cy) & mask) << 21) |
+           (static_cast<uint64_t>(cz) & mask);
+}
+
+void PhysicsWorld::BuildSpatialHash() {
+    size_t count = m_denseToId.size();
+
+    // Two bodies can only touch if their centers are closer than the sum of
+    // their extents, so cells twice the largest extent need a 3x3x3 search
+    float largest = 0.5f;
+    for (size_t i = 0; i < count; ++i) {
+        largest = std::max({ largest, m_halfX[i], m_halfY[i], m_halfZ[i] });
+    }
+    m_cellSize = largest * 2.0f;
+
+    m_cells.resize(count);
+    float inv = 1.0f / m_cellSize;
+    auto assign = [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            m_cells[i] = { CellKey(FloorToInt(m_posX[i] * inv), FloorToInt(m_posY[i] * inv), FloorToInt(m_posZ[i] * inv)),
+                           static_cast<uint32_t>(i) };
+        }
+    };
+    if (m_threadPool) {
+        m_threadPool->ParallelFor(count, BODY_GRAIN * 4, assign);
+    } else {
+        assign(0, count);
+    }
+    std::sort(m_cells.begin(), m_cells.end());
+
+    size_t tableSize = 16;
+    m_cellShift = 60;
+    while (tableSize < count * 2) {
+        tableSize <<= 1;
+        --m_cellShift;
+    }
+    m_cellTable.assign(tableSize, CellRange{ EMPTY_CELL, 0, 0 });
+
+    size_t mask = tableSize - 1;
+    for (size_t begin = 0; begin < count;) {
+        size_t end = begin + 1;
+        while (end < count && m_cells[end].first == m_cells[begin].first) {
+            ++end;
+        }
+
+        uint64_t key = m_cells[begin].first;
+        size_t slot = CellSlot(key);
+        while (m_cellTable[slot].key != EMPTY_CELL) {
+            slot = (slot + 1) & mask;
+        }
+        m_cellTable[slot] = CellRange{ key, static_cast<uint32_t>(begin), static_cast<uint32_t>(end) };
+        begin = end;
+    }
+}
+
+size_t PhysicsWorld::CellSlot(uint64_t key) const {
+    // Fibonacci hashing keeps the top bits of the product, which depend on
+    // every key bit; the middle bits dropped most of cx and clustered rows
+    return static_cast<size_t>((key * 0x9E3779B97F4A7C15ull) >> m_cellShift);
+}
+
+const PhysicsWorld::CellRange* PhysicsWorld::FindCell(uint64_t key) const {
+    size_t mask = m_cellTable.size() - 1;
+    size_t slot = CellSlot(key);
+    for (;;) {
+        const CellRange& cell = m_cellTable[slot];
+        if (cell.key == key) return &cell;
+        if (cell.key == EMPTY_CELL) return nullptr;
+        slot = (slot + 1) & mask;
+    }
+}
+
+void PhysicsWorld::SolveContacts(size_t begin, size_t end, Counters& counters) {
+    float inv = 1.0f / m_cellSize;
+
+    // Walk bodies in cell order so neighbouring queries hit the same cells
+    for (size_t sorted = begin; sorted < end; ++sorted) {
+        uint32_t i = m_cells[sorted].second;
+        m_pushX[i] = m_pushY[i] = m_pushZ[i] = 0.0f;
+        if (!(m_flags[i] & BODY_DYNAMIC)) continue;
+
+        int cx = FloorToInt(m_posX[i] * inv);
+        int cy = FloorToInt(m_posY[i] * inv);
+        int cz = FloorToInt(m_posZ[i] * inv);
+
+        for (int dz = -1; dz <= 1; ++dz) {
+            for (int dy = -1; dy <= 1; ++dy) {
+                for (int dx = -1; dx <= 1; ++dx) {
+                    const CellRange* cell = FindCell(CellKey(cx + dx, cy + dy, cz + dz));
+                    if (!cell) continue;
+
+                    for (uint32_t k = cell->begin; k < cell->end; ++k) {
+                        uint32_t j = m_cells[k].second;
+                        if (j == i) continue;
+
+                        float ox = (m_halfX[i] + m_halfX[j]) - std::fabs(m_posX[i] - m_posX[j]);
+                        float oy = (m_halfY[i] + m_halfY[j]) - std::fabs(m_posY[i] - m_posY[j]);
+                        float oz = (m_halfZ[i] + m_halfZ[j]) - std::fabs(m_posZ[i] - m_posZ[j]);
+                        if (ox <= 0.0f || oy <= 0.0f || oz <= 0.0f) continue;
+
+                        ++counters.contactPairs;
+
+                        // Separate along the axis of least penetration; dynamic
+                        // pairs split the correction, static partners do not move
+                        float share = (m_flags[j] & BODY_DYNAMIC) ? 0.5f : 1.0f;
+                        if (ox <= oy && ox <= oz) {
+                            m_pushX[i] += (m_posX[i] < m_posX[j] || (m_posX[i] == m_posX[j] && i < j) ? -ox : ox) * share;
+                        } else if (oy <= oz) {
+                            m_pushY[i] += (m_posY[i] < m_posY[j] || (m_posY[i] == m_posY[j] && i < j) ? -oy : oy) * share;
+                        } else {
+                            m_pushZ[i] += (m_posZ[i] < m_posZ[j] || (m_posZ[i] == m_posZ[j] && i < j) ? -oz : oz) * share;
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+void PhysicsWorld::Integrate(size_t begin, size_t end, float deltaTime, Counters& counters) {
+    for (size_t i = begin; i < end; ++i) {
+        if (!(m_flags[i] & BODY_DYNAMIC)) continue;
+
+        m_velY[i] += m_gravity * deltaTime;
+
+        XMFLOAT3 center(m_posX[i], m_posY[i], m_posZ[i]);
+        XMFLOAT3 half(m_halfX[i], m_halfY[i], m_halfZ[i]);
+        XMFLOAT3 delta(m_velX[i] * deltaTime + m_pushX[i],
+                       m_velY[i] * deltaTime + m_pushY[i],
+                       m_velZ[i] * deltaTime + m_pushZ[i]);
+
+        uint8_t blocked = 0;
+        XMFLOAT3 moved = SweepAabb(center, half, delta, &blocked, counters);
+        m_posX[i] = moved.x;
+        m_posY[i] = moved.y;
+        m_posZ[i] = moved.z;
+
+        if (blocked & 1) m_velX[i] = 0.0f;
+        if (blocked & 2) m_velY[i] = 0.0f;
+        if (blocked & 4) m_velZ[i] = 0.0f;
+
+        bool grounded = (blocked & 2) && delta.y < 0.0f;
+        m_flags[i] = static_cast<uint8_t>((m_flags[i] & ~BODY_GROUNDED) | (grounded ? BODY_GROUNDED : 0));
+    }
+}
+
+PhysicsBenchmarkStats MeasurePhysicsStep(uint32_t bodyCount, uint32_t frames, ThreadPool* threadPool) {
+    const float deltaTime = 1.0f / 60.0f;
+
+    VoxelEngine world(threadPool);
+    world.SetWorldRadius(BENCHMARK_WORLD_RADIUS);
+    world.GenerateTerrain(BENCHMARK_SEED);
+    world.WaitForTerrain();
+
+    const int extent = BENCHMARK_WORLD_RADIUS * CHUNK_SIZE;
+    const int columnsPerSide = 2 * extent / BENCHMARK_COLUMN_SPACING;
+    const uint32_t columns = static_cast<uint32_t>(columnsPerSide * columnsPerSide);
+    std::vector<int> surfaces(std::min(columns, bodyCount));
+
+    // Small sideways drift so falling columns spill into each other
+    PhysicsWorld physics(&world, threadPool);
+    std::mt19937 random(BENCHMARK_SEED);
+    std::uniform_real_distribution<float> drift(-BENCHMARK_DRIFT, BENCHMARK_DRIFT);
+    for (uint32_t i = 0; i < bodyCount; ++i) {
+        uint32_t column = i % columns;
+        uint32_t layer = i / columns;
+        int x = -extent + static_cast<int>(column % columnsPerSide) * BENCHMARK_COLUMN_SPACING;
+        int z = -extent + static_cast<int>(column / columnsPerSide) * BENCHMARK_COLUMN_SPACING;
+        if (layer == 0) {
+            int surface = SURFACE_TOP;
+            while (surface > SURFACE_TOP - SURFACE_DEPTH && world.GetVoxel(x, surface - 1, z) == 0) {
+                --surface;
+            }
+            surfaces[column] = surface;
+        }
+
+        float y = surfaces[column] + 1.0f + layer * BENCHMARK_LAYER_SPACING;
+        BodyId id = physics.CreateBody(XMFLOAT3(x + 0.5f, y, z + 0.5f),
+                                       XMFLOAT3(BENCHMARK_HALF_EXTENT, BENCHMARK_HALF_EXTENT, BENCHMARK_HALF_EXTENT));
+        physics.SetVelocity(id, XMFLOAT3(drift(random), 0.0f, drift(random)));
+    }
+
+    PhysicsBenchmarkStats stats = {};
+    stats.bodies = bodyCount;
+    stats.frames = frames;
+    float totalMilliseconds = 0.0f;
+    for (uint32_t frame = 0; frame < frames; ++frame) {
+        physics.Step(deltaTime);
+        totalMilliseconds += physics.GetStats().stepMilliseconds;
+        stats.maxStepMilliseconds = std::max(stats.maxStepMilliseconds, physics.GetStats().stepMilliseconds);
+    }
+    stats.contactPairs = physics.GetStats().contactPairs;
+    if (frames > 0) {
+        stats.stepMilliseconds = totalMilliseconds / frames;
+    }
+    if (totalMilliseconds > 0.0f) {
+        stats.bodiesPerSecond = static_cast<float>(bodyCount) * frames * 1000.0f / totalMilliseconds;
+    }
+    return stats;
+}
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include <DirectXMath.h>
+
+class VoxelEngine;
+class ThreadPool;
+
+using BodyId = uint32_t;
+constexpr BodyId InvalidBodyId = UINT32_MAX;
+
+struct PhysicsStats {
+    uint32_t bodyCount;
+    uint32_t contactPairs;      // entity-entity overlaps resolved last step
+    uint32_t voxelTests;        // individual voxels sampled last step
+    uint32_t skippedChunks;     // chunk visits answered by the empty/full shortcut
+    float stepMilliseconds;
+};
+
+// Axis-aligned boxes swept against the voxel grid, stepped as one batch.
+// Bodies are stored structure-of-arrays and processed in parallel ranges;
+// entity-entity contacts use a sorted spatial hash over body centers.
+class PhysicsWorld {
+public:
+    // Without a thread pool bodies are stepped on the calling thread
+    PhysicsWorld(const VoxelEngine* world, ThreadPool* threadPool);
+    ~PhysicsWorld();
+
+    BodyId CreateBody(const DirectX::XMFLOAT3& position, const DirectX::XMFLOAT3& halfExtents, bool dynamic = true);
+    void DestroyBody(BodyId id);
+    bool IsValid(BodyId id) const;
+
+    void SetVelocity(BodyId id, const DirectX::XMFLOAT3& velocity);
+    DirectX::XMFLOAT3 GetPosition(BodyId id) const;
+    DirectX::XMFLOAT3 GetVelocity(BodyId id) const;
+    DirectX::XMFLOAT3 GetHalfExtents(BodyId id) const;
+    bool IsGrounded(BodyId id) const;
+
+    void SetGravity(float gravity) { m_gravity = gravity; }
+    void Step(float deltaTime);
+
+    // Moves a box by `delta` one axis at a time (Y first), stopping just short
+    // of solid voxels. Bit n of blockedAxes is set when axis n was clipped.
+    DirectX::XMFLOAT3 SweepAabb(const DirectX::XMFLOAT3& center, const DirectX::XMFLOAT3& halfExtents,
+                                const DirectX::XMFLOAT3& delta, uint8_t* blockedAxes = nullptr) const;
+
+    const PhysicsStats& GetStats() const { return m_stats; }
+
+    // Live bodies in storage order
+    const std::vector<BodyId>& GetBodyIds() const { return m_denseToId; }
+
+private:
+    struct Counters {
+        uint32_t voxelTests = 0;
+        uint32_t skippedChunks = 0;
+        uint32_t contactPairs = 0;
+    };
+
+    bool AnySolid(int x0, int y0, int z0, int x1, int y1, int z1, Counters& counters) const;
+    float SweepAxis(int axis, const float* minCorner, const float* maxCorner, float delta, Counters& counters) const;
+    DirectX::XMFLOAT3 SweepAabb(const DirectX::XMFLOAT3& center, const DirectX::XMFLOAT3& halfExtents,
+                                const DirectX::XMFLOAT3& delta, uint8_t* blockedAxes, Counters& counters) const;
+
+    void BuildSpatialHash();
+    uint64_t CellKey(int cx, int cy, int cz) const;
+    void SolveContacts(size_t begin, size_t end, Counters& counters);
+    void Integrate(size_t begin, size_t end, float deltaTime, Counters& counters);
+
+    const VoxelEngine* m_world;
+    ThreadPool* m_threadPool;
+
+    // Dense body storage; m_sparse maps BodyId -> dense index
+    std::vector<float> m_posX, m_posY, m_posZ;
+    std::vector<float> m_velX, m_velY, m_velZ;
+    std::vector<float> m_halfX, m_halfY, m_halfZ;
+    std::vector<float> m_pushX, m_pushY, m_pushZ;
+    std::vector<uint8_t> m_flags;
+    std::vector<BodyId> m_denseToId;
+    std::vector<uint32_t> m_sparse;
+    std::vector<BodyId> m_freeIds;
+
+    // (cell key, dense index) sorted by key, plus an open-addressed table
+    // mapping each occupied cell to its run in m_cells
+    struct CellRange {
+        uint64_t key;
+        uint32_t begin;
+        uint32_t end;
+    };
+    size_t CellSlot(uint64_t key) const;
+    const CellRange* FindCell(uint64_t key) const;
+
+    std::vector<std::pair<uint64_t, uint32_t>> m_cells;
+    std::vector<CellRange> m_cellTable;
+    float m_cellSize;
+    uint32_t m_cellShift;       // 64 - log2(table size)
+
+    float m_gravity;
+    PhysicsStats m_stats;
+};
+
+struct PhysicsBenchmarkStats {
+    uint32_t bodies;
+    uint32_t frames;
+    float stepMilliseconds;         // average Step
+    float maxStepMilliseconds;
+    float bodiesPerSecond;          // body updates per second of step time
+    uint32_t contactPairs;          // resolved in the last step
+};
+
+// Boxes stacked in columns over a small generated voxel world, stepped at
+// 60 Hz while they land and pile up against each other
+PhysicsBenchmarkStats MeasurePhysicsStep(uint32_t bodyCount, uint32_t frames, ThreadPool* threadPool);
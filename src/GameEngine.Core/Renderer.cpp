@@ -1,204 +0,0 @@
-#include "Renderer.h"
-#include <stdexcept>
-
-Renderer::Renderer()
-    : m_width(0)
-    , m_height(0)
-{
-}
-
-Renderer::~Renderer() {
-    Shutdown();
-}
-
-bool Renderer::Initialize(void* hwnd, int width, int height) {
-    m_width = width;
-    m_height = height;
-    
-    if (!CreateDeviceAndSwapChain(hwnd, width, height)) {
-        return false;
-    }
-    
-    if (!CreateRenderTargets()) {
-        return false;
-    }
-    
-    // Create depth stencil state
-    D3D11_DEPTH_STENCIL_DESC depthStencilDesc = {};
-    depthStencilDesc.DepthEnable = TRUE;
-    depthStencilDesc.DepthWriteMask = D3D11_DEPTH_WRITE_MASK_ALL;
-    depthStencilDesc.DepthFunc = D3D11_COMPARISON_LESS;
-    depthStencilDesc.StencilEnable = FALSE;
-    
-    HRESULT hr = m_device->CreateDepthStencilState(&depthStencilDesc, &m_depthStencilState);
-    if (FAILED(hr)) {
-        return false;
-    }
-    
-    // Create rasterizer state
-    D3D11_RASTERIZER_DESC rasterizerDesc = {};
-    rasterizerDesc.FillMode = D3D11_FILL_SOLID;
-    rasterizerDesc.CullMode = D3D11_CULL_BACK;
-    rasterizerDesc.FrontCounterClockwise = FALSE;
-    rasterizerDesc.DepthClipEnable = TRUE;
-    
-    hr = m_device->CreateRasterizerState(&rasterizerDesc, &m_rasterizerState);
-    if (FAILED(hr)) {
-        return false;
-    }
-    
-    // Set viewport
-    D3D11_VIEWPORT viewport = {};
-    viewport.TopLeftX = 0;
-    viewport.TopLeftY = 0;
-    viewport.Width = static_cast<float>(width);
-    viewport.Height = static_cast<float>(height);
-    viewport.MinDepth = 0.0f;
-    viewport.MaxDepth = 1.0f;
-    
-    m_context->RSSetViewports(1, &viewport);
-    m_context->OMSetDepthStencilState(m_depthStencilState.Get(), 1);
-    m_context->RSSetState(m_rasterizerState.Get());
-    
-    return true;
-}
-
-void Renderer::Shutdown() {
-    CleanupRenderTargets();
-    m_swapChain.Reset();
-    m_context.Reset();
-    m_device.Reset();
-}
-
-void Renderer::Resize(int width, int height) {
-    if (!m_swapChain) return;
-    
-    m_width = width;
-    m_height = height;
-    
-    CleanupRenderTargets();
-    
-    HRESULT hr = m_swapChain->ResizeBuffers(0, width, height, DXGI_FORMAT_UNKNOWN, 0);
-    if (FAILED(hr)) {
-        return;
-    }
-    
-    CreateRenderTargets();
-    
-    // Update viewport
-    D3D11_VIEWPORT viewport = {};
-    viewport.TopLeftX = 0;
-    viewport.TopLeftY = 0;
-    viewport.Width = static_cast<float>(width);
-    viewport.Height = static_cast<float>(height);
-    viewport.MinDepth = 0.0f;
-    viewport.MaxDepth = 1.0f;
-    
-    m_context->RSSetViewports(1, &viewport);
-}
-
-void Renderer::BeginFrame() {
-    Clear(0.1f, 0.1f, 0.15f, 1.0f);
-}
-
-void Renderer::EndFrame() {
-    if (m_swapChain) {
-        m_swapChain->Present(1, 0); // VSync on
-    }
-}
-
-void Renderer::Clear(float r, float g, float b, float a) {
-    float clearColor[4] = { r, g, b, a };
-    m_context->ClearRenderTargetView(m_renderTargetView.Get(), clearColor);
-    m_context->ClearDepthStencilView(m_depthStencilView.Get(), D3D11_CLEAR_DEPTH | D3D11_CLEAR_STENCIL, 1.0f, 0);
-}
-
-bool Renderer::CreateDeviceAndSwapChain(void* hwnd, int width, int height) {
-    DXGI_SWAP_CHAIN_DESC swapChainDesc = {};
-    swapChainDesc.BufferCount = 2;
-    swapChainDesc.BufferDesc.Width = width;
-    swapChainDesc.BufferDesc.Height = height;
-    swapChainDesc.BufferDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
-    swapChainDesc.BufferDesc.RefreshRate.Numerator = 60;
-    swapChainDesc.BufferDesc.RefreshRate.Denominator = 1;
-    swapChainDesc.BufferUsage = DXGI_USAGE_RENDER_TARGET_OUTPUT;
-    swapChainDesc.OutputWindow = static_cast<HWND>(hwnd);
-    swapChainDesc.SampleDesc.Count = 1;
-    swapChainDesc.SampleDesc.Quality = 0;
-    swapChainDesc.Windowed = TRUE;
-    swapChainDesc.SwapEffect = DXGI_SWAP_EFFECT_FLIP_DISCARD;
-    
-    D3D_FEATURE_LEVEL featureLevel;
-    D3D_FEATURE_LEVEL featureLevels[] = { D3D_FEATURE_LEVEL_11_0 };
-    
-    UINT createDeviceFlags = 0;
-#ifdef _DEBUG
-    createDeviceFlags |= D3D11_CREATE_DEVICE_DEBUG;
-#endif
-    
-    HRESULT hr = D3D11CreateDeviceAndSwapChain(
-        nullptr,
-        D3D_DRIVER_TYPE_HARDWARE,
-        nullptr,
-        createDeviceFlags,
-        featureLevels,
-        1,
-        D3D11_SDK_VERSION,
-        &swapChainDesc,
-        &m_swapChain,
-        &m_device,
-        &featureLevel,
-        &m_context
-    );
-    
-    return SUCCEEDED(hr);
-}
-
-bool Renderer::CreateRenderTargets() {
-    // Get back buffer
-    ComPtr<ID3D11Texture2D> backBuffer;
-    HRESULT hr = m_swapChain->GetBuffer(0, __uuidof(ID3D11Texture2D), &backBuffer);
-    if (FAILED(hr)) {
-        return false;
-    }
-    
-    // Create render target view
-    hr = m_device->CreateRenderTargetView(backBuffer.Get(), nullptr, &m_renderTargetView);
-    if (FAILED(hr)) {
-        return false;
-    }
-    
-    // Create depth stencil buffer
-    D3D11_TEXTURE2D_DESC depthStencilDesc = {};
-    depthStencilDesc.Width = m_width;
-    depthStencilDesc.Height = m_height;
-    depthStencilDesc.MipLevels = 1;
-    depthStencilDesc.ArraySize = 1;
-    depthStencilDesc.Format = DXGI_FORMAT_D24_UNORM_S8_UINT;
-    depthStencilDesc.SampleDesc.Count = 1;
-    depthStencilDesc.SampleDesc.Quality = 0;
-    depthStencilDesc.Usage = D3D11_USAGE_DEFAULT;
-    depthStencilDesc.BindFlags = D3D11_BIND_DEPTH_STENCIL;
-    
-    hr = m_device->CreateTexture2D(&depthStencilDesc, nullptr, &m_depthStencilBuffer);
-    if (FAILED(hr)) {
-        return false;
-    }
-    
-    // Create depth stencil view
-    hr = m_device->CreateDepthStencilView(m_depthStencilBuffer.Get(), nullptr, &m_depthStencilView);
-    if (FAILED(hr)) {
-        return false;
-    }
-    
-    // Bind render target and depth stencil
-    m_context->OMSetRenderTargets(1, m_renderTargetView.GetAddressOf(), m_depthStencilView.Get());
-    
-    return true;
-}
-
-void Renderer::CleanupRenderTargets() {
-    m_depthStencilView.Reset();
-    m_depthStencilBuffer.Reset();
-    m_renderTargetView.Reset();
-}
@@ -1,42 +1,25 @@
 #pragma once
 
-#include <d3d11.h>
-#include <DirectXMath.h>
-#include <wrl/client.h>
+#include <vector>
+#include "MeshArena.h"
 
-using Microsoft::WRL::ComPtr;
+class Camera;
 
+// Rendering backend. A frame is BeginFrame, then clears and draws, then
+// EndFrame, all on the thread that owns the renderer.
 class Renderer {
 public:
-    Renderer();
-    ~Renderer();
+    virtual ~Renderer() = default;
     
-    bool Initialize(void* hwnd, int width, int height);
-    void Shutdown();
-    void Resize(int width, int height);
+    virtual void Shutdown() = 0;
+    virtual void Resize(int width, int height) = 0;
     
-    void BeginFrame();
-    void EndFrame();
+    virtual void BeginFrame() = 0;
+    virtual void EndFrame() = 0;
     
-    void Clear(float r, float g, float b, float a);
+    virtual void Clear(float r, float g, float b, float a) = 0;
     
-    ID3D11Device* GetDevice() { return m_device.Get(); }
-    ID3D11DeviceContext* GetContext() { return m_context.Get(); }
-    
-private:
-    bool CreateDeviceAndSwapChain(void* hwnd, int width, int height);
-    bool CreateRenderTargets();
-    void CleanupRenderTargets();
-    
-    ComPtr<ID3D11Device> m_device;
-    ComPtr<ID3D11DeviceContext> m_context;
-    ComPtr<IDXGISwapChain> m_swapChain;
-    ComPtr<ID3D11RenderTargetView> m_renderTargetView;
-    ComPtr<ID3D11Texture2D> m_depthStencilBuffer;
-    ComPtr<ID3D11DepthStencilView> m_depthStencilView;
-    ComPtr<ID3D11DepthStencilState> m_depthStencilState;
-    ComPtr<ID3D11RasterizerState> m_rasterizerState;
-    
-    int m_width;
-    int m_height;
+    // Draws the arena meshes named by `commands` as seen from `camera`
+    virtual void DrawMeshes(const MeshArena& arena, const std::vector<DrawIndexedIndirectArgs>& commands,
+                            const Camera& camera) = 0;
 };
@@ -0,0 +1,616 @@
+#include "Replication.h"
+#include "VoxelEngine.h"
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <random>
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    void WriteVarint(std::vector<uint8_t>& out, uint32_t value) {
+        while (value >= 0x80) {
+            out.push_back(static_cast<uint8_t>(value | 0x80));
+            value >>= 7;
+        }
+        out.push_back(static_cast<uint8_t>(value));
+    }
+
+    bool ReadVarint(const uint8_t*& data, const uint8_t* end, uint32_t& value) {
+        value = 0;
+        for (int shift = 0; shift < 35; shift += 7) {
+            if (data >= end) {
+                return false;
+            }
+            uint8_t byte = *data++;
+            value |= static_cast<uint32_t>(byte & 0x7F) << shift;
+            if ((byte & 0x80) == 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    uint32_t ZigZag(int32_t value) {
+        return (static_cast<uint32_t>(value) << 1) ^ static_cast<uint32_t>(value >> 31);
+    }
+
+    int32_t UnZigZag(uint32_t value) {
+        return static_cast<int32_t>(value >> 1) ^ -static_cast<int32_t>(value & 1);
+    }
+
+    void AppendPacket(std::vector<uint8_t>& message, ReplicationPacket type, const ChunkCoord& coord) {
+        message.push_back(static_cast<uint8_t>(type));
+        WriteVarint(message, ZigZag(coord.x));
+        WriteVarint(message, ZigZag(coord.y));
+        WriteVarint(message, ZigZag(coord.z));
+    }
+
+    int ChebyshevDistance(const ChunkCoord& a, const ChunkCoord& b) {
+        return std::max({ std::abs(a.x - b.x), std::abs(a.y - b.y), std::abs(a.z - b.z) });
+    }
+
+    bool IsDirty(const uint64_t* bits, int index) {
+        return (bits[index / 64] >> (index % 64)) & 1;
+    }
+
+    // Delta bodies this small are never worth comparing with a full chunk
+    constexpr size_t SMALL_DELTA_BYTES = 64;
+}
+
+void EncodeVoxelRuns(const uint8_t* values, size_t count, std::vector<uint8_t>& out) {
+    if (count == 0) {
+        out.push_back(1);
+        out.push_back(0);
+        return;
+    }
+
+    // Palette in order of first appearance
+    int16_t slots[256];
+    std::fill(std::begin(slots), std::end(slots), static_cast<int16_t>(-1));
+    uint8_t palette[256];
+    uint32_t paletteSize = 0;
+    for (size_t i = 0; i < count; ++i) {
+        if (slots[values[i]] < 0) {
+            slots[values[i]] = static_cast<int16_t>(paletteSize);
+            palette[paletteSize++] = values[i];
+        }
+    }
+
+    out.push_back(static_cast<uint8_t>(paletteSize));
+    out.insert(out.end(), palette, palette + paletteSize);
+
+    int bits = std::bit_width(paletteSize - 1);
+    for (size_t i = 0; i < count;) {
+        size_t runEnd = i + 1;
+        while (runEnd < count && values[runEnd] == values[i]) {
+            ++runEnd;
+        }
+        uint32_t run = static_cast<uint32_t>(runEnd - i - 1);
+        WriteVarint(out, (run << bits) | static_cast<uint32_t>(slots[values[i]]));
+        i = runEnd;
+    }
+}
+
+bool DecodeVoxelRuns(const uint8_t*& data, const uint8_t* end, uint8_t* values, size_t count) {
+    if (data >= end) {
+        return false;
+    }
+    uint32_t paletteSize = *data++;
+    if (paletteSize == 0) {
+        paletteSize = 256;
+    }
+    if (static_cast<size_t>(end - data) < paletteSize) {
+        return false;
+    }
+    const uint8_t* palette = data;
+    data += paletteSize;
+
+    int bits = std::bit_width(paletteSize - 1);
+    uint32_t mask = (1u << bits) - 1;
+    size_t filled = 0;
+    while (filled < count) {
+        uint32_t token;
+        if (!ReadVarint(data, end, token)) {
+            return false;
+        }
+        uint32_t index = token & mask;
+        size_t run = static_cast<size_t>(token >> bits) + 1;
+        if (index >= paletteSize || run > count - filled) {
+            return false;
+        }
+        std::memset(values + filled, palette[index], run);
+        filled += run;
+    }
+    return true;
+}
+
+ReplicationServer::ReplicationServer(VoxelEngine* world)
+    : m_world(world)
+    , m_worldGeneration(world->GetWorldGeneration())
+    , m_nextClientId(1)
+    , m_stats{}
+{
+    m_editListener = m_world->AddEditListener([this](const ChunkCoord& coord, int voxelIndex) {
+        OnVoxelEdited(coord, voxelIndex);
+    });
+}
+
+ReplicationServer::~ReplicationServer() {
+    m_world->RemoveEditListener(m_editListener);
+}
+
+ReplicationServer::ClientId ReplicationServer::AddClient(int interestRadius) {
+    ClientId id = m_nextClientId++;
+    Client& client = m_clients[id];
+    client.focus = ChunkCoord{ 0, 0, 0 };
+    client.radius = std::max(interestRadius, 1);
+    client.sequence = 0;
+    return id;
+}
+
+void ReplicationServer::RemoveClient(ClientId id) {
+    m_clients.erase(id);
+}
+
+void ReplicationServer::SetClientFocus(ClientId id, float x, float y, float z) {
+    auto it = m_clients.find(id);
+    if (it != m_clients.end()) {
+        it->second.focus = WorldToChunkCoord(static_cast<int>(std::floor(x)),
+                                             static_cast<int>(std::floor(y)),
+                                             static_cast<int>(std::floor(z)));
+    }
+}
+
+void ReplicationServer::OnVoxelEdited(const ChunkCoord& coord, int voxelIndex) {
+    DirtyChunk& dirty = m_dirty.try_emplace(coord).first->second;
+    if (voxelIndex < 0) {
+        dirty.whole = true;
+        return;
+    }
+
+    uint64_t bit = uint64_t(1) << (voxelIndex % 64);
+    uint64_t& word = dirty.bits[voxelIndex / 64];
+    if ((word & bit) == 0) {
+        word |= bit;
+        ++dirty.count;
+    }
+}
+
+void ReplicationServer::Tick() {
+    // A new world invalidates everything the clients hold
+    bool reset = m_world->GetWorldGeneration() != m_worldGeneration;
+    if (reset) {
+        m_worldGeneration = m_world->GetWorldGeneration();
+        m_dirty.clear();
+    }
+    m_encoded.clear();
+
+    for (auto& pair : m_clients) {
+        Client& client = pair.second;
+        std::vector<uint8_t> message(sizeof(ReplicationMessageHeader));
+        uint32_t packetCount = 0;
+
+        if (reset) {
+            AppendPacket(message, ReplicationPacket::WorldReset, ChunkCoord{ 0, 0, 0 });
+            ++packetCount;
+            client.known.clear();
+        }
+
+        // Changes to chunks the client holds; each is encoded once per tick
+        for (const auto& dirtyPair : m_dirty) {
+            if (client.known.count(dirtyPair.first) == 0) {
+                continue;
+            }
+            const EncodedChunk* encoded = EncodeDirtyChunk(dirtyPair.first, dirtyPair.second);
+            if (!encoded) {
+                continue;
+            }
+
+            AppendPacket(message, encoded->type, dirtyPair.first);
+            message.insert(message.end(), encoded->body.begin(), encoded->body.end());
+            ++packetCount;
+            if (encoded->type == ReplicationPacket::ChunkDelta) {
+                ++m_stats.deltaChunks;
+            } else if (encoded->type == ReplicationPacket::ChunkFull) {
+                ++m_stats.fullChunks;
+            } else {
+                client.known.erase(dirtyPair.first);
+                ++m_stats.droppedChunks;
+            }
+        }
+
+        UpdateInterest(client, message, packetCount);
+
+        if (packetCount > 0) {
+            ReplicationMessageHeader header = { REPLICATION_MAGIC, REPLICATION_VERSION, 0, client.sequence++, packetCount };
+            std::memcpy(message.data(), &header, sizeof(header));
+            ++m_stats.messages;
+            m_stats.bytesSent += message.size();
+            client.outbox.push_back(std::move(message));
+        }
+    }
+
+    // Chunks evicted since their edit could not be read; they go out once
+    // they are resident again
+    for (auto it = m_dirty.begin(); it != m_dirty.end();) {
+        if (!m_world->FindChunk(it->first) && m_world->IsChunkEvicted(it->first)) {
+            ++it;
+        } else {
+            it = m_dirty.erase(it);
+        }
+    }
+    m_encoded.clear();
+}
+
+const ReplicationServer::EncodedChunk* ReplicationServer::EncodeDirtyChunk(const ChunkCoord& coord,
+                                                                           const DirtyChunk& dirty) {
+    auto cached = m_encoded.find(coord);
+    if (cached != m_encoded.end()) {
+        return &cached->second;
+    }
+
+    const VoxelChunk* chunk = m_world->FindChunk(coord);
+    if (!chunk) {
+        if (m_world->IsChunkEvicted(coord)) {
+            return nullptr;
+        }
+        // Removed from the world, e.g. by undo
+        return &m_encoded.emplace(coord, EncodedChunk{ ReplicationPacket::ChunkDrop, {} }).first->second;
+    }
+
+    auto start = Clock::now();
+    EncodedChunk encoded{ ReplicationPacket::ChunkFull, {} };
+    if (!dirty.whole) {
+        // Spans of consecutive dirty voxels, then all their values as runs
+        const uint8_t* voxels = chunk->GetBlock()->voxels;
+        std::vector<uint8_t> spans;
+        std::vector<uint8_t> values;
+        values.reserve(dirty.count);
+        uint32_t spanCount = 0;
+        int previousEnd = 0;
+        int index = 0;
+        while (index < CHUNK_VOLUME) {
+            uint64_t word = dirty.bits[index / 64] >> (index % 64);
+            if (word == 0) {
+                index = (index / 64 + 1) * 64;
+                continue;
+            }
+            index += std::countr_zero(word);
+
+            int spanStart = index;
+            while (index < CHUNK_VOLUME && IsDirty(dirty.bits, index)) {
+                values.push_back(voxels[index]);
+                ++index;
+            }
+            WriteVarint(spans, static_cast<uint32_t>(spanStart - previousEnd));
+            WriteVarint(spans, static_cast<uint32_t>(index - spanStart));
+            previousEnd = index;
+            ++spanCount;
+        }
+
+        encoded.type = ReplicationPacket::ChunkDelta;
+        WriteVarint(encoded.body, spanCount);
+        encoded.body.insert(encoded.body.end(), spans.begin(), spans.end());
+        EncodeVoxelRuns(values.data(), values.size(), encoded.body);
+        m_stats.voxelsEncoded += values.size();
+    }
+
+    // Heavily edited chunks are often cheaper to send whole
+    if (dirty.whole || encoded.body.size() > SMALL_DELTA_BYTES) {
+        std::vector<uint8_t> full;
+        EncodeFullChunk(*chunk, full);
+        if (dirty.whole || full.size() < encoded.body.size()) {
+            encoded.type = ReplicationPacket::ChunkFull;
+            encoded.body.swap(full);
+        }
+    }
+    m_stats.encodeSeconds += std::chrono::duration<double>(Clock::now() - start).count();
+
+    return &m_encoded.emplace(coord, std::move(encoded)).first->second;
+}
+
+void ReplicationServer::EncodeFullChunk(const VoxelChunk& chunk, std::vector<uint8_t>& body) {
+    EncodeVoxelRuns(chunk.GetBlock()->voxels, CHUNK_VOLUME, body);
+    m_stats.voxelsEncoded += CHUNK_VOLUME;
+}
+
+void ReplicationServer::UpdateInterest(Client& client, std::vector<uint8_t>& message, uint32_t& packetCount) {
+    // Drop chunks more than one chunk outside the radius, so a client moving
+    // back and forth across the edge does not resend them every tick
+    for (auto it = client.known.begin(); it != client.known.end();) {
+        if (ChebyshevDistance(*it, client.focus) > client.radius + 1) {
+            AppendPacket(message, ReplicationPacket::ChunkDrop, *it);
+            ++packetCount;
+            ++m_stats.droppedChunks;
+            it = client.known.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    // Send chunks that entered the radius, nearest first
+    std::vector<std::pair<int, ChunkCoord>> candidates;
+    int r = client.radius;
+    for (int dz = -r; dz <= r; ++dz) {
+        for (int dy = -r; dy <= r; ++dy) {
+            for (int dx = -r; dx <= r; ++dx) {
+                ChunkCoord coord{ client.focus.x + dx, client.focus.y + dy, client.focus.z + dz };
+                if (client.known.count(coord) == 0 && m_world->FindChunk(coord)) {
+                    candidates.emplace_back(dx * dx + dy * dy + dz * dz, coord);
+                }
+            }
+        }
+    }
+
+    size_t sendCount = std::min(candidates.size(), MAX_NEW_CHUNKS_PER_TICK);
+    std::partial_sort(candidates.begin(), candidates.begin() + sendCount, candidates.end(),
+                      [](const auto& a, const auto& b) { return a.first < b.first; });
+
+    auto start = Clock::now();
+    for (size_t i = 0; i < sendCount; ++i) {
+        const ChunkCoord& coord = candidates[i].second;
+        AppendPacket(message, ReplicationPacket::ChunkFull, coord);
+        EncodeFullChunk(*m_world->FindChunk(coord), message);
+        ++packetCount;
+        ++m_stats.fullChunks;
+        client.known.insert(coord);
+    }
+    m_stats.encodeSeconds += std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+bool ReplicationServer::PopMessage(ClientId id, std::vector<uint8_t>& message) {
+    auto it = m_clients.find(id);
+    if (it == m_clients.end() || it->second.outbox.empty()) {
+        return false;
+    }
+    message = std::move(it->second.outbox.front());
+    it->second.outbox.pop_front();
+    return true;
+}
+
+size_t ReplicationServer::GetClientChunkCount(ClientId id) const {
+    auto it = m_clients.find(id);
+    return it != m_clients.end() ? it->second.known.size() : 0;
+}
+
+ReplicationClient::ReplicationClient()
+    : m_scratch(CHUNK_VOLUME)
+    , m_nextSequence(0)
+    , m_stats{}
+{
+}
+
+int32_t ReplicationClient::Receive(const uint8_t* data, size_t size) {
+    if (size < sizeof(ReplicationMessageHeader)) {
+        return ReplicationBadHeader;
+    }
+
+    ReplicationMessageHeader header;
+    std::memcpy(&header, data, sizeof(header));
+    if (header.magic != REPLICATION_MAGIC || header.flags != 0) {
+        return ReplicationBadHeader;
+    }
+    if (header.version != REPLICATION_VERSION) {
+        return ReplicationUnsupportedVersion;
+    }
+    if (header.sequence != m_nextSequence) {
+        return ReplicationOutOfSequence;
+    }
+    ++m_nextSequence;
+    ++m_stats.messages;
+    m_stats.bytesReceived += size;
+
+    auto start = Clock::now();
+    int32_t status = ReplicationOk;
+    const uint8_t* end = data + size;
+    data += sizeof(header);
+    for (uint32_t i = 0; i < header.packetCount && status == ReplicationOk; ++i) {
+        uint32_t x, y, z;
+        if (data >= end) {
+            status = ReplicationTruncated;
+            break;
+        }
+        uint8_t type = *data++;
+        if (!ReadVarint(data, end, x) || !ReadVarint(data, end, y) || !ReadVarint(data, end, z)) {
+            status = ReplicationTruncated;
+            break;
+        }
+        ChunkCoord coord{ UnZigZag(x), UnZigZag(y), UnZigZag(z) };
+
+        switch (static_cast<ReplicationPacket>(type)) {
+        case ReplicationPacket::ChunkFull:
+            if (!DecodeVoxelRuns(data, end, m_scratch.data(), CHUNK_VOLUME)) {
+                status = ReplicationTruncated;
+                break;
+            }
+            m_chunks[coord].assign(m_scratch.begin(), m_scratch.end());
+            m_stats.voxelsDecoded += CHUNK_VOLUME;
+            break;
+
+        case ReplicationPacket::ChunkDelta: {
+            auto chunk = m_chunks.find(coord);
+            if (chunk == m_chunks.end()) {
+                status = ReplicationUnknownChunk;
+                break;
+            }
+
+            // Validate the spans before touching the chunk
+            uint32_t spanCount;
+            if (!ReadVarint(data, end, spanCount) || spanCount > CHUNK_VOLUME) {
+                status = ReplicationTruncated;
+                break;
+            }
+            const uint8_t* spans = data;
+            uint32_t position = 0;
+            uint32_t valueCount = 0;
+            for (uint32_t s = 0; s < spanCount && status == ReplicationOk; ++s) {
+                uint32_t skip, length;
+                if (!ReadVarint(data, end, skip) || !ReadVarint(data, end, length) ||
+                    skip > CHUNK_VOLUME - position || length > CHUNK_VOLUME - position - skip) {
+                    status = ReplicationTruncated;
+                }
+                position += skip + length;
+                valueCount += length;
+            }
+            if (status != ReplicationOk || !DecodeVoxelRuns(data, end, m_scratch.data(), valueCount)) {
+                status = ReplicationTruncated;
+                break;
+            }
+
+            const uint8_t* value = m_scratch.data();
+            uint8_t* voxels = chunk->second.data();
+            position = 0;
+            for (uint32_t s = 0; s < spanCount; ++s) {
+                uint32_t skip, length;
+                ReadVarint(spans, end, skip);
+                ReadVarint(spans, end, length);
+                position += skip;
+                std::memcpy(voxels + position, value, length);
+                position += length;
+                value += length;
+            }
+            m_stats.voxelsDecoded += valueCount;
+            break;
+        }
+
+        case ReplicationPacket::ChunkDrop:
+            m_chunks.erase(coord);
+            break;
+
+        case ReplicationPacket::WorldReset:
+            m_chunks.clear();
+            break;
+
+        default:
+            status = ReplicationUnknownPacket;
+            break;
+        }
+    }
+
+    m_stats.decodeSeconds += std::chrono::duration<double>(Clock::now() - start).count();
+    return status;
+}
+
+const uint8_t* ReplicationClient::FindChunk(const ChunkCoord& coord) const {
+    auto it = m_chunks.find(coord);
+    return it != m_chunks.end() ? it->second.data() : nullptr;
+}
+
+uint8_t ReplicationClient::GetVoxel(int x, int y, int z) const {
+    ChunkCoord coord = WorldToChunkCoord(x, y, z);
+    const uint8_t* voxels = FindChunk(coord);
+    if (!voxels) {
+        return 0;
+    }
+    return voxels[LocalVoxelIndex(ChunkLayout::ToLocal(x), ChunkLayout::ToLocal(y), ChunkLayout::ToLocal(z))];
+}
+
+ReplicationBenchmarkStats MeasureReplication(int seed, int worldRadius, unsigned clients,
+                                             unsigned editsPerFrame, unsigned frames) {
+    ReplicationBenchmarkStats stats = {};
+    clients = std::max(clients, 1u);
+
+    VoxelEngine world;
+    world.SetWorldRadius(worldRadius);
+    world.GenerateTerrain(seed);
+    world.WaitForTerrain();
+
+    // Clients orbit the world centre so their interest sets keep changing
+    const int interestRadius = 3;
+    ReplicationServer server(&world);
+    std::vector<ReplicationServer::ClientId> ids;
+    std::vector<ReplicationClient> replicas(clients);
+    std::vector<ChunkCoord> focus(clients);
+    for (unsigned c = 0; c < clients; ++c) {
+        ids.push_back(server.AddClient(interestRadius));
+    }
+
+    std::minstd_rand rng(static_cast<unsigned>(seed));
+    auto offset = [&](int range) { return static_cast<int>(rng() % (2 * range + 1)) - range; };
+    const uint8_t brushBlocks[] = { 0, 2, 3, 6 };
+    const float orbit = worldRadius * CHUNK_SIZE * 0.5f;
+
+    std::vector<uint8_t> message;
+    auto deliver = [&] {
+        server.Tick();
+        bool any = false;
+        for (unsigned c = 0; c < clients; ++c) {
+            while (server.PopMessage(ids[c], message)) {
+                replicas[c].Receive(message.data(), message.size());
+                any = true;
+            }
+        }
+        return any;
+    };
+
+    for (unsigned frame = 0; frame < frames; ++frame) {
+        for (unsigned c = 0; c < clients; ++c) {
+            float angle = frame * 0.01f + c * 6.2831853f / clients;
+            int fx = static_cast<int>(std::cos(angle) * orbit);
+            int fz = static_cast<int>(std::sin(angle) * orbit);
+            server.SetClientFocus(ids[c], static_cast<float>(fx), 8.0f, static_cast<float>(fz));
+            focus[c] = WorldToChunkCoord(fx, 8, fz);
+
+            // Every fourth edit is a small sphere brush, the rest single voxels
+            for (unsigned e = 0; e < editsPerFrame; ++e) {
+                int x = fx + offset(24), y = offset(16), z = fz + offset(24);
+                uint8_t block = brushBlocks[rng() % 4];
+                if (e % 4 == 0) {
+                    for (int dz = -2; dz <= 2; ++dz) {
+                        for (int dy = -2; dy <= 2; ++dy) {
+                            for (int dx = -2; dx <= 2; ++dx) {
+                                if (dx * dx + dy * dy + dz * dz <= 4) {
+                                    world.SetVoxel(x + dx, y + dy, z + dz, block);
+                                }
+                            }
+                        }
+                    }
+                } else {
+                    world.SetVoxel(x, y, z, block);
+                }
+            }
+        }
+        deliver();
+    }
+
+    // Let the interest sets finish streaming, then compare every chunk in
+    // each client's radius with the server world
+    for (int settle = 0; settle < 1000 && deliver(); ++settle) {
+    }
+
+    uint64_t voxelsDecoded = 0;
+    double decodeSeconds = 0.0;
+    for (unsigned c = 0; c < clients; ++c) {
+        world.ForEachChunk([&](const ChunkCoord& coord, const VoxelChunk& chunk) {
+            if (ChebyshevDistance(coord, focus[c]) > interestRadius) {
+                return;
+            }
+            const uint8_t* replica = replicas[c].FindChunk(coord);
+            const uint8_t* voxels = chunk.GetBlock()->voxels;
+            for (int i = 0; i < CHUNK_VOLUME; ++i) {
+                if ((replica ? replica[i] : 0) != voxels[i]) {
+                    ++stats.mismatches;
+                }
+            }
+        });
+        voxelsDecoded += replicas[c].GetStats().voxelsDecoded;
+        decodeSeconds += replicas[c].GetStats().decodeSeconds;
+    }
+
+    const ReplicationServerStats& serverStats = server.GetStats();
+    stats.clients = clients;
+    stats.frames = frames;
+    stats.bytesSent = serverStats.bytesSent;
+    stats.bytesPerSecond = frames > 0 ? static_cast<float>(serverStats.bytesSent * 60.0 / frames) : 0.0f;
+    stats.encodeBytesPerSecond = serverStats.encodeSeconds > 0.0
+        ? static_cast<float>(serverStats.voxelsEncoded / serverStats.encodeSeconds) : 0.0f;
+    stats.decodeBytesPerSecond = decodeSeconds > 0.0 ? static_cast<float>(voxelsDecoded / decodeSeconds) : 0.0f;
+    stats.compressionRatio = serverStats.bytesSent > 0
+        ? static_cast<float>(static_cast<double>(voxelsDecoded) / serverStats.bytesSent) : 0.0f;
+    stats.fullChunks = serverStats.fullChunks;
+    stats.deltaChunks = serverStats.deltaChunks;
+    return stats;
+}
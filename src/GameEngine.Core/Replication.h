@@ -0,0 +1,190 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "VoxelChunk.h"
+
+class VoxelEngine;
+
+// Chunk replication stream from a ReplicationServer to one client. All
+// values are little-endian; each server tick sends at most one message:
+//
+//   ReplicationMessageHeader
+//   packetCount x { uint8_t type, varint cx, cy, cz (zigzag), body }
+//
+//   ChunkFull    voxel runs for the whole chunk
+//   ChunkDelta   varint spanCount, spanCount x { varint skip, varint length },
+//                then voxel runs for the spans' voxels in order. Spans are
+//                ranges of chunk-local voxel indices; skip counts from the
+//                end of the previous span.
+//   ChunkDrop    (none) the chunk left the client's interest set
+//   WorldReset   (coordinates are 0) the world was replaced; drop every chunk
+//
+// Voxel runs: uint8 paletteSize (1..255, 0 means 256), paletteSize block
+// types, then one varint per run holding (runLength - 1) << bits | index,
+// where bits is the width of the largest palette index.
+constexpr uint32_t REPLICATION_MAGIC = 0x50524547; // "GERP"
+constexpr uint16_t REPLICATION_VERSION = 1;
+
+#pragma pack(push, 1)
+struct ReplicationMessageHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t flags;         // reserved, must be 0
+    uint32_t sequence;      // per client, starting at 0
+    uint32_t packetCount;
+};
+#pragma pack(pop)
+
+enum class ReplicationPacket : uint8_t {
+    ChunkFull = 1,
+    ChunkDelta = 2,
+    ChunkDrop = 3,
+    WorldReset = 4,
+};
+
+// Return codes of ReplicationClient::Receive
+enum ReplicationStatus : int32_t {
+    ReplicationOk = 0,
+    ReplicationBadHeader = -1,
+    ReplicationUnsupportedVersion = -2,
+    ReplicationTruncated = -3,
+    ReplicationUnknownPacket = -4,
+    ReplicationUnknownChunk = -5,      // delta for a chunk the client does not hold
+    ReplicationOutOfSequence = -6,
+};
+
+// Palette and run-length coding of voxel values, shared by both packet types
+void EncodeVoxelRuns(const uint8_t* values, size_t count, std::vector<uint8_t>& out);
+bool DecodeVoxelRuns(const uint8_t*& data, const uint8_t* end, uint8_t* values, size_t count);
+
+struct ReplicationServerStats {
+    uint64_t messages;
+    uint64_t bytesSent;
+    uint32_t fullChunks;
+    uint32_t deltaChunks;
+    uint32_t droppedChunks;
+    uint64_t voxelsEncoded;     // raw voxels covered by full and delta bodies
+    double encodeSeconds;
+};
+
+struct ReplicationClientStats {
+    uint64_t messages;
+    uint64_t bytesReceived;
+    uint64_t voxelsDecoded;
+    double decodeSeconds;
+};
+
+// Replicates a VoxelEngine to any number of clients. Edits are collected
+// per chunk through an edit listener on the world as a bitset of touched
+// voxels, so repeated edits to one voxel cost nothing extra. Each Tick
+// encodes every dirty chunk once, as a delta or a full chunk if that is
+// smaller, and shares the bytes between all clients that hold the chunk.
+// A client holds the chunks within its interest radius of its focus;
+// chunks entering it are sent whole, nearest first, and are dropped once
+// they are more than a chunk outside it. Messages queue per client until
+// the transport pops them.
+class ReplicationServer {
+public:
+    using ClientId = uint32_t;
+
+    explicit ReplicationServer(VoxelEngine* world);
+    ~ReplicationServer();
+
+    ReplicationServer(const ReplicationServer&) = delete;
+    ReplicationServer& operator=(const ReplicationServer&) = delete;
+
+    ClientId AddClient(int interestRadius);
+    void RemoveClient(ClientId id);
+    void SetClientFocus(ClientId id, float x, float y, float z);
+
+    void Tick();
+    bool PopMessage(ClientId id, std::vector<uint8_t>& message);
+
+    size_t GetClientChunkCount(ClientId id) const;
+    const ReplicationServerStats& GetStats() const { return m_stats; }
+
+private:
+    static constexpr size_t DIRTY_WORDS = CHUNK_VOLUME / 64;
+    static constexpr size_t MAX_NEW_CHUNKS_PER_TICK = 16;
+
+    struct DirtyChunk {
+        uint64_t bits[DIRTY_WORDS];
+        uint32_t count;
+        bool whole;
+    };
+
+    struct EncodedChunk {
+        ReplicationPacket type;
+        std::vector<uint8_t> body;
+    };
+
+    struct Client {
+        ChunkCoord focus;
+        int radius;
+        std::unordered_set<ChunkCoord> known;
+        std::deque<std::vector<uint8_t>> outbox;
+        uint32_t sequence;
+    };
+
+    void OnVoxelEdited(const ChunkCoord& coord, int voxelIndex);
+    const EncodedChunk* EncodeDirtyChunk(const ChunkCoord& coord, const DirtyChunk& dirty);
+    void EncodeFullChunk(const VoxelChunk& chunk, std::vector<uint8_t>& body);
+    void UpdateInterest(Client& client, std::vector<uint8_t>& message, uint32_t& packetCount);
+
+    VoxelEngine* m_world;
+    uint32_t m_editListener;            // VoxelEngine::EditListenerId
+    uint32_t m_worldGeneration;
+    std::unordered_map<ChunkCoord, DirtyChunk> m_dirty;
+    std::unordered_map<ChunkCoord, EncodedChunk> m_encoded;    // this tick's dirty chunks
+    std::unordered_map<ClientId, Client> m_clients;
+    ClientId m_nextClientId;
+    ReplicationServerStats m_stats;
+};
+
+// Client-side copy of the chunks a server sends. Chunks it does not hold
+// read as air.
+class ReplicationClient {
+public:
+    ReplicationClient();
+
+    // Applies one message. A malformed message stops at the bad packet and
+    // returns its status; packets before it stay applied.
+    int32_t Receive(const uint8_t* data, size_t size);
+
+    uint8_t GetVoxel(int x, int y, int z) const;
+    const uint8_t* FindChunk(const ChunkCoord& coord) const;
+    size_t GetChunkCount() const { return m_chunks.size(); }
+    const ReplicationClientStats& GetStats() const { return m_stats; }
+
+private:
+    std::unordered_map<ChunkCoord, std::vector<uint8_t>> m_chunks;
+    std::vector<uint8_t> m_scratch;
+    uint32_t m_nextSequence;
+    ReplicationClientStats m_stats;
+};
+
+struct ReplicationBenchmarkStats {
+    uint32_t clients;
+    uint32_t frames;
+    uint64_t bytesSent;
+    float bytesPerSecond;           // at 60 ticks per second
+    float encodeBytesPerSecond;     // raw voxel bytes encoded per second of encode time
+    float decodeBytesPerSecond;
+    float compressionRatio;         // raw voxel bytes / bytes sent
+    uint32_t fullChunks;
+    uint32_t deltaChunks;
+    uint32_t mismatches;            // replica voxels differing from the server; should be 0
+};
+
+// Heavy-edit scenario on a scratch world with in-process loopback clients:
+// every frame each client's focus moves and editsPerFrame brush strokes
+// and scattered single-voxel edits land around the clients, then the
+// server ticks and every message is decoded. Replicas are compared with
+// the server world at the end.
+ReplicationBenchmarkStats MeasureReplication(int seed, int worldRadius, unsigned clients,
+                                             unsigned editsPerFrame, unsigned frames);
@@ -0,0 +1,190 @@
+#include "SessionTrace.h"
+#include "CommandBuffer.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iterator>
+
+bool GetSessionCallLayout(uint8_t call, size_t& payloadSize) {
+    switch (static_cast<SessionCall>(call)) {
+    case SessionCall::UpdateEngine:             payloadSize = 4; return true;
+    case SessionCall::RenderEngine:             payloadSize = 0; return true;
+    case SessionCall::ResizeViewport:           payloadSize = 8; return true;
+    case SessionCall::ProcessMouseMove:         payloadSize = 8; return true;
+    case SessionCall::ProcessMouseWheel:        payloadSize = 4; return true;
+    case SessionCall::ProcessKeyInput:          payloadSize = 5; return true;
+    case SessionCall::CommitWorldEdit:          payloadSize = 0; return true;
+    case SessionCall::UndoWorldEdit:            payloadSize = 0; return true;
+    case SessionCall::RedoWorldEdit:            payloadSize = 0; return true;
+    case SessionCall::SetCameraCollision:       payloadSize = 1; return true;
+    case SessionCall::CancelTerrainGeneration:  payloadSize = 0; return true;
+    case SessionCall::SetTerrainSwapThreshold:  payloadSize = 4; return true;
+    case SessionCall::CreatePhysicsBody:        payloadSize = 28; return true;
+    case SessionCall::DestroyPhysicsBody:       payloadSize = 4; return true;
+    case SessionCall::SetPhysicsBodyVelocity:   payloadSize = 16; return true;
+    case SessionCall::ExecuteCommandBuffer:     payloadSize = 4; return true;
+    case SessionCall::SetMemoryBudget:          payloadSize = 12; return true;
+    case SessionCall::SpawnParticles:           payloadSize = 24; return true;
+    }
+
+    size_t resultSize;
+    return GetEngineCommandLayout(call, payloadSize, resultSize);
+}
+
+SessionRecorder::SessionRecorder()
+    : m_recordedCalls(0)
+{
+}
+
+SessionRecorder::~SessionRecorder() {
+    Stop();
+}
+
+bool SessionRecorder::Start(const std::string& path, const SessionTraceHeader& header) {
+    Stop();
+
+    m_file.open(path, std::ios::binary | std::ios::trunc);
+    if (!m_file) {
+        m_file.close();
+        return false;
+    }
+
+    m_file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    m_lastCall = std::chrono::steady_clock::now();
+    m_recordedCalls = 0;
+    return true;
+}
+
+void SessionRecorder::Stop() {
+    if (m_file.is_open()) {
+        m_file.close();
+    }
+}
+
+void SessionRecorder::Record(uint8_t call, const void* payload, size_t payloadSize) {
+    if (!m_file.is_open()) {
+        return;
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(now - m_lastCall).count();
+    uint32_t delay = static_cast<uint32_t>(std::min<long long>(elapsed, UINT32_MAX));
+    m_lastCall = now;
+
+    uint8_t prefix[5];
+    std::memcpy(prefix, &delay, sizeof(delay));
+    prefix[4] = call;
+    m_file.write(reinterpret_cast<const char*>(prefix), sizeof(prefix));
+    if (payloadSize > 0) {
+        m_file.write(static_cast<const char*>(payload), static_cast<std::streamsize>(payloadSize));
+    }
+    ++m_recordedCalls;
+}
+
+int32_t LoadSessionTrace(const std::string& path, SessionTrace& trace) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return SessionTraceOpenFailed;
+    }
+
+    std::vector<uint8_t> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    if (data.size() < sizeof(SessionTraceHeader)) {
+        return SessionTraceBadHeader;
+    }
+
+    SessionTraceHeader header;
+    std::memcpy(&header, data.data(), sizeof(header));
+    if (header.magic != SESSION_TRACE_MAGIC || header.flags != 0) {
+        return SessionTraceBadHeader;
+    }
+    if (header.version != SESSION_TRACE_VERSION) {
+        return SessionTraceUnsupportedVersion;
+    }
+
+    // Validate every call up front so replay never stops halfway
+    const uint8_t* calls = data.data() + sizeof(header);
+    size_t size = data.size() - sizeof(header);
+    size_t offset = 0;
+    uint32_t callCount = 0;
+    while (offset < size) {
+        if (size - offset < 5) {
+            return SessionTraceTruncated;
+        }
+
+        uint8_t call = calls[offset + 4];
+        size_t payloadSize;
+        if (!GetSessionCallLayout(call, payloadSize)) {
+            return SessionTraceUnknownCall;
+        }
+
+        offset += 5;
+        if (size - offset < payloadSize) {
+            return SessionTraceTruncated;
+        }
+
+        if (call == static_cast<uint8_t>(SessionCall::ExecuteCommandBuffer)) {
+            uint32_t streamSize;
+            std::memcpy(&streamSize, calls + offset, sizeof(streamSize));
+            offset += payloadSize;
+            if (size - offset < streamSize) {
+                return SessionTraceTruncated;
+            }
+            offset += streamSize;
+        } else {
+            offset += payloadSize;
+        }
+        ++callCount;
+    }
+
+    trace.header = header;
+    trace.calls.assign(calls, calls + size);
+    trace.callCount = callCount;
+    return SessionTraceOk;
+}
+
+SessionTraceReader::SessionTraceReader(const SessionTrace& trace)
+    : m_data(trace.calls.data())
+    , m_size(trace.calls.size())
+    , m_offset(0)
+{
+}
+
+bool SessionTraceReader::Next(SessionCallView& view) {
+    if (m_offset >= m_size) {
+        return false;
+    }
+
+    std::memcpy(&view.delayMicroseconds, m_data + m_offset, sizeof(uint32_t));
+    view.call = m_data[m_offset + 4];
+    m_offset += 5;
+
+    GetSessionCallLayout(view.call, view.payloadSize);
+    if (view.call == static_cast<uint8_t>(SessionCall::ExecuteCommandBuffer)) {
+        uint32_t streamSize;
+        std::memcpy(&streamSize, m_data + m_offset, sizeof(streamSize));
+        view.payloadSize += streamSize;
+    }
+
+    view.payload = m_data + m_offset;
+    m_offset += view.payloadSize;
+    return true;
+}
+
+FrameTimeStats ComputeFrameTimeStats(std::vector<float>& frameMilliseconds) {
+    FrameTimeStats stats = {};
+    if (frameMilliseconds.empty()) {
+        return stats;
+    }
+
+    std::sort(frameMilliseconds.begin(), frameMilliseconds.end());
+    auto percentile = [&](double p) {
+        size_t rank = static_cast<size_t>(std::ceil(p * frameMilliseconds.size()));
+        return frameMilliseconds[std::max<size_t>(rank, 1) - 1];
+    };
+
+    stats.frameCount = static_cast<uint32_t>(frameMilliseconds.size());
+    stats.p50Milliseconds = percentile(0.50);
+    stats.p99Milliseconds = percentile(0.99);
+    stats.maxMilliseconds = frameMilliseconds.back();
+    return stats;
+}
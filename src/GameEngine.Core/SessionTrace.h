@@ -0,0 +1,144 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Binary trace of EngineCore API calls, used to replay editor sessions as
+// benchmarks. All values are little-endian and unaligned; the file is
+//
+//   SessionTraceHeader
+//   { uint32_t microsecondsSincePreviousCall, uint8_t call, payload }*
+//
+// Calls that also exist as command buffer opcodes (see CommandBuffer.h)
+// share their opcode and payload layout. Queries that do not change engine
+// state (GetVoxel, GetCameraPosition, the stats getters) are not recorded.
+constexpr uint32_t SESSION_TRACE_MAGIC = 0x52544547; // "GETR"
+constexpr uint16_t SESSION_TRACE_VERSION = 2;
+
+#pragma pack(push, 1)
+struct SessionTraceHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t flags;         // reserved, must be 0
+
+    // Engine state when recording started; a replay regenerates the world
+    // from the seed and starts with no physics bodies, so edits made before
+    // recording are not reproduced; neither are entities alive when
+    // recording started. Physics bodies alive then are written as the
+    // first calls of the trace.
+    int32_t seed;
+    int32_t viewportWidth;
+    int32_t viewportHeight;
+    float cameraX, cameraY, cameraZ;
+    float cameraPitch, cameraYaw;
+    uint8_t editorMode;
+    uint8_t cameraCollision;
+    uint16_t reserved;
+};
+#pragma pack(pop)
+
+// Trace-only calls, numbered clear of the command buffer opcodes
+enum class SessionCall : uint8_t {
+    UpdateEngine = 128,             // float deltaTime
+    RenderEngine = 129,             // (none)
+    ResizeViewport = 130,           // int32 width, height
+    ProcessMouseMove = 131,         // float deltaX, deltaY
+    ProcessMouseWheel = 132,        // float delta
+    ProcessKeyInput = 133,          // int32 keyCode; uint8 pressed
+    CommitWorldEdit = 134,          // (none)
+    UndoWorldEdit = 135,            // (none)
+    RedoWorldEdit = 136,            // (none)
+    SetCameraCollision = 137,       // uint8 enabled
+    CancelTerrainGeneration = 138,  // (none)
+    SetTerrainSwapThreshold = 139,  // float fraction
+    CreatePhysicsBody = 140,        // float x, y, z, halfX, halfY, halfZ; uint32 returned bodyId
+    DestroyPhysicsBody = 141,       // uint32 bodyId
+    SetPhysicsBodyVelocity = 142,   // uint32 bodyId; float x, y, z
+    ExecuteCommandBuffer = 143,     // uint32 size; size bytes of command stream
+    SetMemoryBudget = 144,          // uint32 category; uint64 bytes
+    SpawnParticles = 145,           // float x, y, z; uint32 count; float speed, lifetime
+};
+
+// Return codes of the trace functions; replay returns the number of calls
+// executed when non-negative
+enum SessionTraceStatus : int32_t {
+    SessionTraceOk = 0,
+    SessionTraceInvalidArgument = -1,
+    SessionTraceOpenFailed = -2,
+    SessionTraceBadHeader = -3,
+    SessionTraceUnsupportedVersion = -4,
+    SessionTraceTruncated = -5,
+    SessionTraceUnknownCall = -6,
+    SessionTraceNotInitialized = -7,
+    SessionTraceBusy = -8,
+};
+
+// Fixed payload size per call; ExecuteCommandBuffer reports only its size
+// prefix. False for unknown calls.
+bool GetSessionCallLayout(uint8_t call, size_t& payloadSize);
+
+// Appends calls to a trace file
+class SessionRecorder {
+public:
+    SessionRecorder();
+    ~SessionRecorder();
+
+    SessionRecorder(const SessionRecorder&) = delete;
+    SessionRecorder& operator=(const SessionRecorder&) = delete;
+
+    bool Start(const std::string& path, const SessionTraceHeader& header);
+    void Stop();
+    bool IsRecording() const { return m_file.is_open(); }
+
+    // Writes one call; `payload` must match the call's layout
+    void Record(uint8_t call, const void* payload, size_t payloadSize);
+
+    uint64_t GetRecordedCalls() const { return m_recordedCalls; }
+
+private:
+    std::ofstream m_file;
+    std::chrono::steady_clock::time_point m_lastCall;
+    uint64_t m_recordedCalls;
+};
+
+// A loaded and fully validated trace
+struct SessionTrace {
+    SessionTraceHeader header;
+    std::vector<uint8_t> calls;
+    uint32_t callCount;
+};
+
+int32_t LoadSessionTrace(const std::string& path, SessionTrace& trace);
+
+// One call decoded from a validated trace
+struct SessionCallView {
+    uint32_t delayMicroseconds;
+    uint8_t call;
+    const uint8_t* payload;
+    size_t payloadSize;
+};
+
+class SessionTraceReader {
+public:
+    explicit SessionTraceReader(const SessionTrace& trace);
+    bool Next(SessionCallView& view);
+
+private:
+    const uint8_t* m_data;
+    size_t m_size;
+    size_t m_offset;
+};
+
+struct FrameTimeStats {
+    uint32_t frameCount;
+    float p50Milliseconds;
+    float p99Milliseconds;
+    float maxMilliseconds;
+};
+
+// Nearest-rank percentiles; sorts the input in place
+FrameTimeStats ComputeFrameTimeStats(std::vector<float>& frameMilliseconds);
@@ -0,0 +1,713 @@
+#include "SoftwareRenderer.h"
+#include "Camera.h"
+#include "ThreadPool.h"
+#include "VoxelEngine.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <emmintrin.h>
+#include <fstream>
+#include <utility>
+
+using namespace DirectX;
+
+namespace {
+    constexpr int SUBPIXEL_BITS = 4;
+    constexpr int SUBPIXEL_ONE = 1 << SUBPIXEL_BITS;
+    constexpr int SUBPIXEL_HALF = SUBPIXEL_ONE / 2;
+
+    // Vertices are clipped to this many pixels from the viewport origin, so
+    // fixed-point edge values across a tile stay within 32 bits
+    constexpr float GUARD_BAND_PIXELS = 8192.0f;
+
+    // Fixed so that binning, and with it the image, does not depend on the
+    // number of threads
+    constexpr uint32_t BATCH_COUNT = 32;
+
+    // Reference scene for CheckReferenceImage
+    constexpr int REFERENCE_SEED = 12345;
+    constexpr int REFERENCE_WORLD_RADIUS = 3;
+    constexpr int REFERENCE_WIDTH = 640;
+    constexpr int REFERENCE_HEIGHT = 360;
+#if GAMEENGINE_CHUNK_SIZE == 16
+    constexpr uint64_t REFERENCE_IMAGE_HASH = 0xefd5bdd7a6059ecaull;
+#else
+    constexpr uint64_t REFERENCE_IMAGE_HASH = 0;
+#endif
+
+    constexpr float AMBIENT = 0.35f;
+    constexpr float LIGHT_X = 0.3015f;
+    constexpr float LIGHT_Y = 0.9045f;
+    constexpr float LIGHT_Z = 0.3015f;
+
+    constexpr uint32_t MAX_CLIP_VERTICES = 3 + 5;
+
+    struct ClipVertex {
+        float x, y, z, w;
+    };
+
+    // Outcode bits. Triangles may have to be clipped against the near plane
+    // and the guard band; a vertex is inside a plane when its distance is >= 0
+    constexpr uint32_t NEAR_PLANE = 1 << 0;
+    constexpr uint32_t LEFT_GUARD = 1 << 1;
+    constexpr uint32_t RIGHT_GUARD = 1 << 2;
+    constexpr uint32_t BOTTOM_GUARD = 1 << 3;
+    constexpr uint32_t TOP_GUARD = 1 << 4;
+    constexpr uint32_t CLIP_PLANES = NEAR_PLANE | LEFT_GUARD | RIGHT_GUARD | BOTTOM_GUARD | TOP_GUARD;
+
+    // Only used to reject triangles wholly outside the view; the guard band
+    // and the depth test take care of the rest
+    constexpr uint32_t BEYOND_FAR = 1 << 5;
+    constexpr uint32_t OUTSIDE_LEFT = 1 << 6;
+    constexpr uint32_t OUTSIDE_RIGHT = 1 << 7;
+    constexpr uint32_t OUTSIDE_BOTTOM = 1 << 8;
+    constexpr uint32_t OUTSIDE_TOP = 1 << 9;
+
+    struct ClipSpace {
+        float guardX;               // guard band in NDC units
+        float guardY;
+
+        float Distance(const ClipVertex& v, uint32_t plane) const {
+            switch (plane) {
+            case NEAR_PLANE:   return v.z;
+            case LEFT_GUARD:   return v.x + guardX * v.w;
+            case RIGHT_GUARD:  return guardX * v.w - v.x;
+            case BOTTOM_GUARD: return v.y + guardY * v.w;
+            default:           return guardY * v.w - v.y;
+            }
+        }
+
+        uint32_t Outcode(const ClipVertex& v) const {
+            float guardW = guardX * v.w;
+            float guardH = guardY * v.w;
+            return (v.z < 0.0f ? NEAR_PLANE : 0) |
+                   (v.x < -guardW ? LEFT_GUARD : 0) | (v.x > guardW ? RIGHT_GUARD : 0) |
+                   (v.y < -guardH ? BOTTOM_GUARD : 0) | (v.y > guardH ? TOP_GUARD : 0) |
+                   (v.z > v.w ? BEYOND_FAR : 0) |
+                   (v.x < -v.w ? OUTSIDE_LEFT : 0) | (v.x > v.w ? OUTSIDE_RIGHT : 0) |
+                   (v.y < -v.w ? OUTSIDE_BOTTOM : 0) | (v.y > v.w ? OUTSIDE_TOP : 0);
+        }
+
+        // Sutherland-Hodgman against the planes in `planes`; returns the
+        // vertex count of the clipped polygon
+        uint32_t Clip(ClipVertex* polygon, uint32_t count, uint32_t planes) const {
+            ClipVertex scratch[MAX_CLIP_VERTICES];
+            for (uint32_t plane = NEAR_PLANE; plane <= TOP_GUARD && count >= 3; plane <<= 1) {
+                if (!(planes & plane)) {
+                    continue;
+                }
+                uint32_t out = 0;
+                for (uint32_t i = 0; i < count; ++i) {
+                    const ClipVertex& a = polygon[i];
+                    const ClipVertex& b = polygon[(i + 1) % count];
+                    float da = Distance(a, plane);
+                    float db = Distance(b, plane);
+                    if (da >= 0.0f) {
+                        scratch[out++] = a;
+                    }
+                    if ((da >= 0.0f) != (db >= 0.0f)) {
+                        float t = da / (da - db);
+                        scratch[out++] = ClipVertex{ a.x + (b.x - a.x) * t, a.y + (b.y - a.y) * t,
+                                                     a.z + (b.z - a.z) * t, a.w + (b.w - a.w) * t };
+                    }
+                }
+                std::copy(scratch, scratch + out, polygon);
+                count = out;
+            }
+            return count;
+        }
+    };
+
+    int32_t ToFixed(float pixels) {
+        return static_cast<int32_t>(std::floor(pixels * SUBPIXEL_ONE + 0.5f));
+    }
+
+    uint32_t PackColor(float r, float g, float b, float a) {
+        auto channel = [](float value) {
+            return static_cast<uint32_t>(std::clamp(value, 0.0f, 1.0f) * 255.0f + 0.5f);
+        };
+        return channel(r) | (channel(g) << 8) | (channel(b) << 16) | (channel(a) << 24);
+    }
+
+    // Flat shading from the first vertex, like D3D's provoking vertex
+    uint32_t ShadeFace(const Vertex& vertex) {
+        float facing = vertex.normal.x * LIGHT_X + vertex.normal.y * LIGHT_Y + vertex.normal.z * LIGHT_Z;
+        float light = AMBIENT + (1.0f - AMBIENT) * std::max(facing, 0.0f);
+        return PackColor(vertex.color.x * light, vertex.color.y * light, vertex.color.z * light, 1.0f);
+    }
+
+    struct Triangle {
+        int32_t x[3];                       // 28.4 fixed point, clockwise on screen
+        int32_t y[3];
+        int32_t minX, minY, maxX, maxY;     // covered pixels, inclusive, inside the viewport
+        float originX, originY;             // first vertex in pixels
+        float depth, dzdx, dzdy;            // depth plane through the first vertex
+        uint32_t color;
+    };
+
+    struct ScreenVertex {
+        int32_t x, y;                       // 28.4 fixed point
+        float z;
+    };
+
+    ScreenVertex Project(const ClipVertex& v, int width, int height) {
+        float invW = 1.0f / v.w;
+        return ScreenVertex{ ToFixed((v.x * invW * 0.5f + 0.5f) * width), ToFixed((0.5f - v.y * invW * 0.5f) * height),
+                             v.z * invW };
+    }
+
+    // Fails for back faces, degenerate triangles and triangles that cover no
+    // pixel centre; the colour is left to the caller
+    bool SetupTriangle(const ScreenVertex& v0, const ScreenVertex& v1, const ScreenVertex& v2, int width, int height,
+                       Triangle& triangle) {
+        // Negative for front faces, which are counter-clockwise on screen
+        int64_t area = int64_t(v1.x - v0.x) * (v2.y - v0.y) - int64_t(v1.y - v0.y) * (v2.x - v0.x);
+        if (area >= 0) {
+            return false;
+        }
+
+        // Pixels whose centres lie inside the fixed-point bounds
+        int32_t minX = std::min({ v0.x, v1.x, v2.x });
+        int32_t maxX = std::max({ v0.x, v1.x, v2.x });
+        int32_t minY = std::min({ v0.y, v1.y, v2.y });
+        int32_t maxY = std::max({ v0.y, v1.y, v2.y });
+        triangle.minX = std::max((minX - SUBPIXEL_HALF + SUBPIXEL_ONE - 1) >> SUBPIXEL_BITS, 0);
+        triangle.minY = std::max((minY - SUBPIXEL_HALF + SUBPIXEL_ONE - 1) >> SUBPIXEL_BITS, 0);
+        triangle.maxX = std::min((maxX - SUBPIXEL_HALF) >> SUBPIXEL_BITS, width - 1);
+        triangle.maxY = std::min((maxY - SUBPIXEL_HALF) >> SUBPIXEL_BITS, height - 1);
+        if (triangle.minX > triangle.maxX || triangle.minY > triangle.maxY) {
+            return false;
+        }
+
+        // Stored clockwise, so the edge functions are positive inside
+        triangle.x[0] = v0.x;
+        triangle.y[0] = v0.y;
+        triangle.x[1] = v2.x;
+        triangle.y[1] = v2.y;
+        triangle.x[2] = v1.x;
+        triangle.y[2] = v1.y;
+
+        const float scale = 1.0f / SUBPIXEL_ONE;
+        float dx1 = (v1.x - v0.x) * scale, dy1 = (v1.y - v0.y) * scale, dz1 = v1.z - v0.z;
+        float dx2 = (v2.x - v0.x) * scale, dy2 = (v2.y - v0.y) * scale, dz2 = v2.z - v0.z;
+        float determinant = static_cast<float>(area) * scale * scale;
+        triangle.originX = v0.x * scale;
+        triangle.originY = v0.y * scale;
+        triangle.depth = v0.z;
+        triangle.dzdx = (dz1 * dy2 - dy1 * dz2) / determinant;
+        triangle.dzdy = (dx1 * dz2 - dz1 * dx2) / determinant;
+        return true;
+    }
+
+    void RasterizeTriangle(const Triangle& triangle, int tileX, int tileY, uint32_t* colorBuffer, float* depthBuffer,
+                           int pitch) {
+        // Rectangle of the triangle's bounds inside the tile, widened to whole
+        // groups of four pixels
+        int x0 = std::max(triangle.minX, tileX) & ~3;
+        int x1 = std::min(triangle.maxX, tileX + SoftwareRenderer::TILE_SIZE - 1);
+        int y0 = std::max(triangle.minY, tileY);
+        int y1 = std::min(triangle.maxY, tileY + SoftwareRenderer::TILE_SIZE - 1);
+        if (x0 > x1 || y0 > y1) {
+            return;
+        }
+        x1 = x0 + ((x1 - x0) | 3);
+
+        // Edge e runs between the two vertices other than e and is >= 0 inside.
+        // Evaluated in 64 bits at the rectangle corners: an edge with the whole
+        // rectangle on one side either rejects the triangle or drops out, and an
+        // edge crossing it has values small enough to step in 32 bits.
+        int64_t sampleX = int64_t(x0) * SUBPIXEL_ONE + SUBPIXEL_HALF;
+        int64_t sampleY = int64_t(y0) * SUBPIXEL_ONE + SUBPIXEL_HALF;
+        int32_t start[3], stepX[3], stepY[3];
+        for (int e = 0; e < 3; ++e) {
+            int a = (e + 1) % 3;
+            int b = (e + 2) % 3;
+            int64_t dx = triangle.x[b] - triangle.x[a];
+            int64_t dy = triangle.y[b] - triangle.y[a];
+
+            // Top-left rule: pixel centres exactly on other edges stay outside
+            bool topLeft = dy < 0 || (dy == 0 && dx > 0);
+            int64_t value = dx * (sampleY - triangle.y[a]) - dy * (sampleX - triangle.x[a]) - (topLeft ? 0 : 1);
+            int64_t spanX = -dy * SUBPIXEL_ONE * (x1 - x0);
+            int64_t spanY = dx * SUBPIXEL_ONE * (y1 - y0);
+            int64_t low = value + std::min<int64_t>(spanX, 0) + std::min<int64_t>(spanY, 0);
+            int64_t high = value + std::max<int64_t>(spanX, 0) + std::max<int64_t>(spanY, 0);
+            if (high < 0) {
+                return;
+            }
+            if (low >= 0) {
+                start[e] = stepX[e] = stepY[e] = 0;
+            } else {
+                start[e] = static_cast<int32_t>(value);
+                stepX[e] = static_cast<int32_t>(-dy * SUBPIXEL_ONE);
+                stepY[e] = static_cast<int32_t>(dx * SUBPIXEL_ONE);
+            }
+        }
+
+        __m128i rowEdge[3], groupStep[3], rowStep[3];
+        for (int e = 0; e < 3; ++e) {
+            rowEdge[e] = _mm_setr_epi32(start[e], start[e] + stepX[e], start[e] + 2 * stepX[e],
+                                        start[e] + 3 * stepX[e]);
+            groupStep[e] = _mm_set1_epi32(4 * stepX[e]);
+            rowStep[e] = _mm_set1_epi32(stepY[e]);
+        }
+
+        float rowDepth = triangle.depth + triangle.dzdx * (x0 + 0.5f - triangle.originX) +
+                         triangle.dzdy * (y0 + 0.5f - triangle.originY);
+        const __m128 depthLanes = _mm_setr_ps(0.0f, triangle.dzdx, 2.0f * triangle.dzdx, 3.0f * triangle.dzdx);
+        const __m128 depthStep = _mm_set1_ps(4.0f * triangle.dzdx);
+        const __m128i fill = _mm_set1_epi32(static_cast<int>(triangle.color));
+
+        for (int y = y0; y <= y1; ++y) {
+            __m128i w0 = rowEdge[0], w1 = rowEdge[1], w2 = rowEdge[2];
+            __m128 depth = _mm_add_ps(_mm_set1_ps(rowDepth), depthLanes);
+            uint32_t* colorRow = colorBuffer + static_cast<size_t>(y) * pitch + x0;
+            float* depthRow = depthBuffer + static_cast<size_t>(y) * pitch + x0;
+
+            // A row crosses a triangle in one run, so the row is done once
+            // a group of four falls outside after one was inside
+            bool entered = false;
+            for (int x = x0; x <= x1; x += 4) {
+                // All lanes set where any edge value is negative
+                __m128i outside = _mm_srai_epi32(_mm_or_si128(_mm_or_si128(w0, w1), w2), 31);
+                if (_mm_movemask_epi8(outside) == 0xFFFF) {
+                    if (entered) {
+                        break;
+                    }
+                } else {
+                    entered = true;
+                    __m128 stored = _mm_loadu_ps(depthRow);
+                    __m128i pass = _mm_andnot_si128(outside, _mm_castps_si128(_mm_cmplt_ps(depth, stored)));
+                    if (_mm_movemask_epi8(pass) != 0) {
+                        __m128 passDepth = _mm_castsi128_ps(pass);
+                        _mm_storeu_ps(depthRow,
+                                      _mm_or_ps(_mm_and_ps(passDepth, depth), _mm_andnot_ps(passDepth, stored)));
+                        __m128i old = _mm_loadu_si128(reinterpret_cast<const __m128i*>(colorRow));
+                        _mm_storeu_si128(reinterpret_cast<__m128i*>(colorRow),
+                                         _mm_or_si128(_mm_and_si128(pass, fill), _mm_andnot_si128(pass, old)));
+                    }
+                }
+                w0 = _mm_add_epi32(w0, groupStep[0]);
+                w1 = _mm_add_epi32(w1, groupStep[1]);
+                w2 = _mm_add_epi32(w2, groupStep[2]);
+                depth = _mm_add_ps(depth, depthStep);
+                colorRow += 4;
+                depthRow += 4;
+            }
+
+            for (int e = 0; e < 3; ++e) {
+                rowEdge[e] = _mm_add_epi32(rowEdge[e], rowStep[e]);
+            }
+            rowDepth += triangle.dzdy;
+        }
+    }
+}
+
+struct SoftwareRenderer::Batch {
+    std::vector<Triangle> triangles;
+    std::vector<std::vector<uint32_t>> bins;    // triangle indices per tile
+    std::vector<ClipVertex> vertices;           // one draw's transformed vertices,
+    std::vector<uint32_t> outcodes;             // the planes each is outside of
+    std::vector<ScreenVertex> projected;        // and where each lands, unless it needs clipping
+    uint32_t submitted;
+    uint32_t binEntries;
+};
+
+SoftwareRenderer::SoftwareRenderer(ThreadPool* threadPool)
+    : m_threadPool(threadPool)
+    , m_width(0)
+    , m_height(0)
+    , m_pitch(0)
+    , m_tilesX(0)
+    , m_tilesY(0)
+    , m_batches(BATCH_COUNT)
+    , m_clearColor(0)
+    , m_clearPending(false)
+    , m_stats{}
+{
+}
+
+SoftwareRenderer::~SoftwareRenderer() {
+    Shutdown();
+}
+
+bool SoftwareRenderer::Initialize(int width, int height) {
+    if (width <= 0 || height <= 0 || width > MAX_DIMENSION || height > MAX_DIMENSION) {
+        return false;
+    }
+    Resize(width, height);
+    return true;
+}
+
+void SoftwareRenderer::Shutdown() {
+    m_width = m_height = m_pitch = 0;
+    m_tilesX = m_tilesY = 0;
+    m_color.clear();
+    m_color.shrink_to_fit();
+    m_depth.clear();
+    m_depth.shrink_to_fit();
+    m_clearPending = false;
+    for (Batch& batch : m_batches) {
+        batch = Batch{};
+    }
+}
+
+void SoftwareRenderer::Resize(int width, int height) {
+    // Minimized windows report zero; keep the old buffers
+    if (width <= 0 || height <= 0 || width > MAX_DIMENSION || height > MAX_DIMENSION) {
+        return;
+    }
+    m_width = width;
+    m_height = height;
+    m_tilesX = (width + TILE_SIZE - 1) / TILE_SIZE;
+    m_tilesY = (height + TILE_SIZE - 1) / TILE_SIZE;
+    m_pitch = m_tilesX * TILE_SIZE;
+
+    // Whole tiles, so groups of four pixels never run past a row
+    size_t pixels = static_cast<size_t>(m_pitch) * m_tilesY * TILE_SIZE;
+    m_color.assign(pixels, m_clearColor);
+    m_depth.assign(pixels, 1.0f);
+    for (Batch& batch : m_batches) {
+        batch.bins.assign(static_cast<size_t>(m_tilesX) * m_tilesY, std::vector<uint32_t>());
+    }
+}
+
+void SoftwareRenderer::BeginFrame() {
+    m_stats = SoftwareRenderStats{};
+    Clear(0.1f, 0.1f, 0.15f, 1.0f);
+}
+
+void SoftwareRenderer::EndFrame() {
+    // Nothing to present; the frame stays readable until the next BeginFrame
+    ResolveClear();
+}
+
+void SoftwareRenderer::Clear(float r, float g, float b, float a) {
+    m_clearColor = PackColor(r, g, b, a);
+    m_clearPending = true;
+}
+
+void SoftwareRenderer::DrawMeshes(const MeshArena& arena, const std::vector<DrawIndexedIndirectArgs>& commands,
+                                  const Camera& camera) {
+    using Clock = std::chrono::steady_clock;
+    if (commands.empty() || m_width == 0) {
+        return;
+    }
+    auto start = Clock::now();
+
+    XMFLOAT4X4 viewProjection;
+    XMStoreFloat4x4(&viewProjection, XMMatrixMultiply(camera.GetViewMatrix(), camera.GetProjectionMatrix()));
+
+    // Contiguous runs of draws with about the same number of indices each
+    std::vector<uint64_t> prefix(commands.size() + 1, 0);
+    for (size_t i = 0; i < commands.size(); ++i) {
+        prefix[i + 1] = prefix[i] + commands[i].indexCountPerInstance;
+    }
+    size_t first[BATCH_COUNT + 1];
+    for (uint32_t b = 0; b <= BATCH_COUNT; ++b) {
+        uint64_t target = prefix.back() * b / BATCH_COUNT;
+        first[b] = std::lower_bound(prefix.begin(), prefix.end() - 1, target) - prefix.begin();
+    }
+    first[BATCH_COUNT] = commands.size();
+
+    auto setup = [&](size_t begin, size_t end) {
+        for (size_t b = begin; b < end; ++b) {
+            SetupBatch(m_batches[b], arena, commands.data() + first[b], first[b + 1] - first[b], viewProjection);
+        }
+    };
+    if (m_threadPool) {
+        m_threadPool->ParallelFor(BATCH_COUNT, 1, setup);
+    } else {
+        setup(0, BATCH_COUNT);
+    }
+    auto binned = Clock::now();
+
+    // A pending clear is done tile by tile here, while the tile is in cache
+    uint32_t tiles = static_cast<uint32_t>(m_tilesX * m_tilesY);
+    bool clear = m_clearPending;
+    auto raster = [this, clear](size_t begin, size_t end) {
+        for (size_t tile = begin; tile < end; ++tile) {
+            RasterizeTile(static_cast<uint32_t>(tile), clear);
+        }
+    };
+    if (m_threadPool) {
+        m_threadPool->ParallelFor(tiles, 1, raster);
+    } else {
+        raster(0, tiles);
+    }
+    m_clearPending = false;
+    auto finished = Clock::now();
+
+    for (const Batch& batch : m_batches) {
+        m_stats.trianglesSubmitted += batch.submitted;
+        m_stats.trianglesRasterized += static_cast<uint32_t>(batch.triangles.size());
+        m_stats.binEntries += batch.binEntries;
+    }
+    m_stats.geometryMilliseconds += std::chrono::duration<float, std::milli>(binned - start).count();
+    m_stats.rasterMilliseconds += std::chrono::duration<float, std::milli>(finished - binned).count();
+}
+
+void SoftwareRenderer::SetupBatch(Batch& batch, const MeshArena& arena, const DrawIndexedIndirectArgs* commands,
+                                  size_t count, const XMFLOAT4X4& viewProjection) {
+    batch.triangles.clear();
+    for (std::vector<uint32_t>& bin : batch.bins) {
+        bin.clear();
+    }
+    batch.submitted = 0;
+    batch.binEntries = 0;
+
+    const ClipSpace clipSpace{ 2.0f * GUARD_BAND_PIXELS / m_width - 1.0f, 2.0f * GUARD_BAND_PIXELS / m_height - 1.0f };
+    const XMFLOAT4X4& m = viewProjection;
+
+    auto emit = [&](const ScreenVertex& v0, const ScreenVertex& v1, const ScreenVertex& v2, const Vertex& provoking) {
+        Triangle triangle;
+        if (!SetupTriangle(v0, v1, v2, m_width, m_height, triangle)) {
+            return;
+        }
+        triangle.color = ShadeFace(provoking);
+        uint32_t index = static_cast<uint32_t>(batch.triangles.size());
+        batch.triangles.push_back(triangle);
+        for (int ty = triangle.minY / TILE_SIZE; ty <= triangle.maxY / TILE_SIZE; ++ty) {
+            for (int tx = triangle.minX / TILE_SIZE; tx <= triangle.maxX / TILE_SIZE; ++tx) {
+                batch.bins[ty * m_tilesX + tx].push_back(index);
+                ++batch.binEntries;
+            }
+        }
+    };
+
+    for (size_t c = 0; c < count; ++c) {
+        const DrawIndexedIndirectArgs& command = commands[c];
+        if (command.instanceCount == 0 || command.indexCountPerInstance < 3) {
+            continue;
+        }
+        const uint32_t* indices = arena.GetIndexPool().data() + command.startIndexLocation;
+        const Vertex* vertices = arena.GetVertexPool().data() + command.baseVertexLocation;
+        uint32_t indexCount = command.indexCountPerInstance - command.indexCountPerInstance % 3;
+
+        // Chunk meshes share each vertex between two triangles, so transform
+        // and project the draw's vertices once up front
+        uint32_t vertexCount = *std::max_element(indices, indices + indexCount) + 1;
+        batch.vertices.resize(vertexCount);
+        batch.outcodes.resize(vertexCount);
+        batch.projected.resize(vertexCount);
+        for (uint32_t i = 0; i < vertexCount; ++i) {
+            const XMFLOAT3& p = vertices[i].position;
+            ClipVertex& v = batch.vertices[i];
+            v = ClipVertex{ p.x * m.m[0][0] + p.y * m.m[1][0] + p.z * m.m[2][0] + m.m[3][0],
+                            p.x * m.m[0][1] + p.y * m.m[1][1] + p.z * m.m[2][1] + m.m[3][1],
+                            p.x * m.m[0][2] + p.y * m.m[1][2] + p.z * m.m[2][2] + m.m[3][2],
+                            p.x * m.m[0][3] + p.y * m.m[1][3] + p.z * m.m[2][3] + m.m[3][3] };
+            batch.outcodes[i] = clipSpace.Outcode(v);
+            if (!(batch.outcodes[i] & CLIP_PLANES)) {
+                batch.projected[i] = Project(v, m_width, m_height);
+            }
+        }
+
+        for (uint32_t i = 0; i < indexCount; i += 3) {
+            ++batch.submitted;
+            uint32_t i0 = indices[i], i1 = indices[i + 1], i2 = indices[i + 2];
+            uint32_t a = batch.outcodes[i0], b = batch.outcodes[i1], d = batch.outcodes[i2];
+            if (a & b & d) {
+                continue;
+            }
+            uint32_t crossed = (a | b | d) & CLIP_PLANES;
+            if (!crossed) {
+                emit(batch.projected[i0], batch.projected[i1], batch.projected[i2], vertices[i0]);
+                continue;
+            }
+
+            // Clipping keeps the winding, so the fan culls like the original
+            ClipVertex polygon[MAX_CLIP_VERTICES] = { batch.vertices[i0], batch.vertices[i1], batch.vertices[i2] };
+            uint32_t clipped = clipSpace.Clip(polygon, 3, crossed);
+            ScreenVertex screen[MAX_CLIP_VERTICES];
+            for (uint32_t k = 0; k < clipped; ++k) {
+                screen[k] = Project(polygon[k], m_width, m_height);
+            }
+            for (uint32_t k = 1; k + 1 < clipped; ++k) {
+                emit(screen[0], screen[k], screen[k + 1], vertices[i0]);
+            }
+        }
+    }
+}
+
+void SoftwareRenderer::RasterizeTile(uint32_t tile, bool clear) {
+    if (clear) {
+        ClearTile(tile);
+    }
+    int tileX = static_cast<int>(tile % m_tilesX) * TILE_SIZE;
+    int tileY = static_cast<int>(tile / m_tilesX) * TILE_SIZE;
+    for (const Batch& batch : m_batches) {
+        for (uint32_t index : batch.bins[tile]) {
+            RasterizeTriangle(batch.triangles[index], tileX, tileY, m_color.data(), m_depth.data(), m_pitch);
+        }
+    }
+}
+
+void SoftwareRenderer::ClearTile(uint32_t tile) {
+    size_t tileX = (tile % m_tilesX) * TILE_SIZE;
+    size_t tileY = (tile / m_tilesX) * TILE_SIZE;
+    for (size_t y = tileY; y < tileY + TILE_SIZE; ++y) {
+        size_t offset = y * m_pitch + tileX;
+        std::fill_n(m_color.data() + offset, TILE_SIZE, m_clearColor);
+        std::fill_n(m_depth.data() + offset, TILE_SIZE, 1.0f);
+    }
+}
+
+void SoftwareRenderer::ResolveClear() {
+    if (!m_clearPending) {
+        return;
+    }
+    uint32_t tiles = static_cast<uint32_t>(m_tilesX * m_tilesY);
+    auto clear = [this](size_t begin, size_t end) {
+        for (size_t tile = begin; tile < end; ++tile) {
+            ClearTile(static_cast<uint32_t>(tile));
+        }
+    };
+    if (m_threadPool) {
+        m_threadPool->ParallelFor(tiles, 1, clear);
+    } else {
+        clear(0, tiles);
+    }
+    m_clearPending = false;
+}
+
+void SoftwareRenderer::ReadPixels(std::vector<uint32_t>& pixels) const {
+    pixels.resize(static_cast<size_t>(m_width) * m_height);
+    for (int y = 0; y < m_height; ++y) {
+        std::copy_n(m_color.data() + static_cast<size_t>(y) * m_pitch, m_width,
+                    pixels.data() + static_cast<size_t>(y) * m_width);
+    }
+}
+
+bool SoftwareRenderer::SaveImage(const std::filesystem::path& path) const {
+    if (m_width == 0) {
+        return false;
+    }
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        return false;
+    }
+
+    uint32_t rowBytes = (static_cast<uint32_t>(m_width) * 3 + 3) & ~3u;
+    uint32_t imageBytes = rowBytes * static_cast<uint32_t>(m_height);
+    std::vector<uint8_t> header;
+    auto put = [&header](uint32_t value, int bytes) {
+        for (int i = 0; i < bytes; ++i) {
+            header.push_back(static_cast<uint8_t>(value >> (8 * i)));
+        }
+    };
+    // BITMAPFILEHEADER, then BITMAPINFOHEADER for bottom-up 24-bit BI_RGB
+    put('B' | ('M' << 8), 2);
+    put(14 + 40 + imageBytes, 4);
+    put(0, 4);
+    put(14 + 40, 4);
+    put(40, 4);
+    put(static_cast<uint32_t>(m_width), 4);
+    put(static_cast<uint32_t>(m_height), 4);
+    put(1, 2);
+    put(24, 2);
+    put(0, 4);
+    put(imageBytes, 4);
+    put(2835, 4);
+    put(2835, 4);
+    put(0, 4);
+    put(0, 4);
+    file.write(reinterpret_cast<const char*>(header.data()), static_cast<std::streamsize>(header.size()));
+
+    std::vector<uint8_t> row(rowBytes, 0);
+    for (int y = m_height - 1; y >= 0; --y) {
+        const uint32_t* source = m_color.data() + static_cast<size_t>(y) * m_pitch;
+        for (int x = 0; x < m_width; ++x) {
+            row[x * 3 + 0] = static_cast<uint8_t>(source[x] >> 16);
+            row[x * 3 + 1] = static_cast<uint8_t>(source[x] >> 8);
+            row[x * 3 + 2] = static_cast<uint8_t>(source[x]);
+        }
+        file.write(reinterpret_cast<const char*>(row.data()), rowBytes);
+    }
+    return static_cast<bool>(file);
+}
+
+uint64_t SoftwareRenderer::GetImageHash() const {
+    uint64_t hash = 14695981039346656037ull;
+    for (int y = 0; y < m_height; ++y) {
+        const uint32_t* row = m_color.data() + static_cast<size_t>(y) * m_pitch;
+        for (int x = 0; x < m_width; ++x) {
+            for (int shift = 0; shift < 32; shift += 8) {
+                hash ^= (row[x] >> shift) & 0xFF;
+                hash *= 1099511628211ull;
+            }
+        }
+    }
+    return hash;
+}
+
+SoftwareRenderBenchmarkStats MeasureSoftwareRendering(const MeshArena& arena,
+                                                      const std::vector<DrawIndexedIndirectArgs>& commands,
+                                                      const Camera& camera, int width, int height, uint32_t frames,
+                                                      ThreadPool* threadPool, const std::filesystem::path& imagePath) {
+    using Clock = std::chrono::steady_clock;
+    SoftwareRenderBenchmarkStats stats = {};
+    SoftwareRenderer renderer(threadPool);
+    if (!renderer.Initialize(width, height)) {
+        return stats;
+    }
+    Camera view = camera;
+    view.SetAspectRatio(static_cast<float>(width) / height);
+
+    auto start = Clock::now();
+    for (uint32_t frame = 0; frame < frames; ++frame) {
+        renderer.BeginFrame();
+        renderer.DrawMeshes(arena, commands, view);
+        renderer.EndFrame();
+        stats.geometryMilliseconds += renderer.GetStats().geometryMilliseconds;
+        stats.rasterMilliseconds += renderer.GetStats().rasterMilliseconds;
+    }
+    float seconds = std::chrono::duration<float>(Clock::now() - start).count();
+
+    stats.frames = frames;
+    stats.trianglesSubmitted = renderer.GetStats().trianglesSubmitted;
+    stats.trianglesRasterized = renderer.GetStats().trianglesRasterized;
+    if (frames > 0) {
+        stats.frameMilliseconds = seconds * 1000.0f / frames;
+        stats.geometryMilliseconds /= frames;
+        stats.rasterMilliseconds /= frames;
+    }
+    if (seconds > 0.0f) {
+        stats.trianglesPerSecond = static_cast<float>(stats.trianglesSubmitted) * frames / seconds;
+    }
+    stats.imageHash = renderer.GetImageHash();
+    if (!imagePath.empty()) {
+        stats.imageSaved = renderer.SaveImage(imagePath);
+    }
+    return stats;
+}
+
+ReferenceImageResult CheckReferenceImage(ThreadPool* threadPool, const std::filesystem::path& imagePath) {
+    ReferenceImageResult result = {};
+    result.expected = REFERENCE_IMAGE_HASH;
+
+    VoxelEngine world(threadPool);
+    world.SetWorldRadius(REFERENCE_WORLD_RADIUS);
+    world.GenerateTerrain(REFERENCE_SEED);
+    world.WaitForTerrain();
+
+    Camera camera;
+    camera.SetPosition(50.0f, 30.0f, 50.0f);
+    camera.SetRotation(-25.0f, 225.0f);
+    camera.SetAspectRatio(static_cast<float>(REFERENCE_WIDTH) / REFERENCE_HEIGHT);
+
+    SoftwareRenderer renderer(threadPool);
+    if (!renderer.Initialize(REFERENCE_WIDTH, REFERENCE_HEIGHT)) {
+        return result;
+    }
+    renderer.BeginFrame();
+    world.Render(&renderer, &camera);
+    renderer.EndFrame();
+
+    result.hash = renderer.GetImageHash();
+    result.matches = result.expected != 0 && result.hash == result.expected;
+    if (!imagePath.empty()) {
+        renderer.SaveImage(imagePath);
+    }
+    return result;
+}
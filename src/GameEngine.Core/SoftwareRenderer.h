@@ -0,0 +1,120 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+#include <DirectXMath.h>
+#include "Renderer.h"
+
+class ThreadPool;
+
+struct SoftwareRenderStats {
+    uint32_t trianglesSubmitted;
+    uint32_t trianglesRasterized;       // left after culling and clipping
+    uint32_t binEntries;                // triangle-tile pairs
+    float geometryMilliseconds;         // transform, clipping, set-up and binning
+    float rasterMilliseconds;
+};
+
+// CPU rendering backend for machines without a GPU. Draws chunk meshes into
+// an offscreen colour and depth buffer with the same conventions as the
+// D3D11 pipeline: counter-clockwise front faces as the chunk mesher emits
+// them, depth test LESS against [0, 1], R8G8B8A8 colour. Faces are flat
+// shaded from their normal.
+//
+// Each draw runs in two passes over the thread pool. Geometry: draw commands
+// are split into a fixed number of batches; each batch transforms, clips and
+// sets up its triangles and bins them into 64x64 pixel tiles. Raster: each
+// tile walks its bins in batch order and rasterizes four pixels at a time
+// with SSE2 edge functions in 28.4 fixed point and the top-left fill rule.
+// Tiles own disjoint pixels and see triangles in submission order, so the
+// image does not depend on the number of threads.
+class SoftwareRenderer : public Renderer {
+public:
+    static constexpr int TILE_SIZE = 64;
+    static constexpr int MAX_DIMENSION = 4096;
+
+    // Without a thread pool both passes run on the calling thread
+    explicit SoftwareRenderer(ThreadPool* threadPool = nullptr);
+    ~SoftwareRenderer() override;
+
+    bool Initialize(int width, int height);
+    void Shutdown() override;
+    void Resize(int width, int height) override;
+
+    void BeginFrame() override;
+    void EndFrame() override;
+
+    void Clear(float r, float g, float b, float a) override;
+    void DrawMeshes(const MeshArena& arena, const std::vector<DrawIndexedIndirectArgs>& commands,
+                    const Camera& camera) override;
+
+    int GetWidth() const { return m_width; }
+    int GetHeight() const { return m_height; }
+
+    // Frame readback, complete once EndFrame has been called. ReadPixels
+    // copies the visible pixels row by row from the top.
+    void ReadPixels(std::vector<uint32_t>& pixels) const;
+    // Uncompressed 24-bit BMP of the colour buffer
+    bool SaveImage(const std::filesystem::path& path) const;
+    // FNV-1a over the visible pixels, for golden image comparisons
+    uint64_t GetImageHash() const;
+
+    // Accumulated since BeginFrame
+    const SoftwareRenderStats& GetStats() const { return m_stats; }
+
+private:
+    struct Batch;
+
+    void SetupBatch(Batch& batch, const MeshArena& arena, const DrawIndexedIndirectArgs* commands, size_t count,
+                    const DirectX::XMFLOAT4X4& viewProjection);
+    void RasterizeTile(uint32_t tile, bool clear);
+    void ClearTile(uint32_t tile);
+    void ResolveClear();
+
+    ThreadPool* m_threadPool;
+    int m_width;
+    int m_height;
+    int m_pitch;                        // pixels per row, a multiple of TILE_SIZE
+    int m_tilesX;
+    int m_tilesY;
+    std::vector<uint32_t> m_color;
+    std::vector<float> m_depth;
+    std::vector<Batch> m_batches;
+    uint32_t m_clearColor;
+    bool m_clearPending;                // Clear is applied per tile by the next raster pass
+    SoftwareRenderStats m_stats;
+};
+
+struct SoftwareRenderBenchmarkStats {
+    uint32_t frames;
+    uint32_t trianglesSubmitted;        // per frame
+    uint32_t trianglesRasterized;       // per frame
+    float frameMilliseconds;
+    float geometryMilliseconds;
+    float rasterMilliseconds;
+    float trianglesPerSecond;           // submitted triangles per second of frame time
+    uint64_t imageHash;                 // last frame
+    bool imageSaved;
+};
+
+// Renders the given draws `frames` times into a scratch width x height
+// software renderer, seen from `camera` with its aspect ratio adjusted to
+// the image. Writes the last frame to `imagePath` unless it is empty.
+SoftwareRenderBenchmarkStats MeasureSoftwareRendering(const MeshArena& arena,
+                                                      const std::vector<DrawIndexedIndirectArgs>& commands,
+                                                      const Camera& camera, int width, int height, uint32_t frames,
+                                                      ThreadPool* threadPool, const std::filesystem::path& imagePath);
+
+struct ReferenceImageResult {
+    uint64_t hash;
+    uint64_t expected;                  // 0 if none is recorded for this chunk size
+    bool matches;
+};
+
+// Golden image check. Generates the reference world (seed 12345, world
+// radius 3) and renders it at 640x360 from (50, 30, 50) with pitch -25 and
+// yaw 225, then compares the image hash with the recorded one. Terrain,
+// meshing and rasterization all feed the hash, so an intended change to any
+// of them means recording the new hash. Only chunk size 16 has one.
+ReferenceImageResult CheckReferenceImage(ThreadPool* threadPool, const std::filesystem::path& imagePath);
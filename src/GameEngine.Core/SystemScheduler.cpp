@@ -0,0 +1,56 @@
+#include "SystemScheduler.h"
+#include <algorithm>
+#include <chrono>
+
+SystemScheduler::SystemScheduler(ThreadPool* threadPool)
+    : m_threadPool(threadPool)
+    , m_lastRunMilliseconds(0.0f)
+{
+}
+
+void SystemScheduler::AddSystem(std::string name, ComponentMask reads, ComponentMask writes, SystemFunction function) {
+    uint32_t phase = 0;
+    for (size_t i = 0; i < m_systems.size(); ++i) {
+        const System& earlier = m_systems[i];
+        bool conflicts = (earlier.writes & (reads | writes)) != 0 || (writes & earlier.reads) != 0;
+        if (conflicts) {
+            phase = std::max(phase, m_stats[i].phase + 1);
+        }
+    }
+
+    if (phase == m_phases.size()) {
+        m_phases.emplace_back();
+    }
+    m_phases[phase].push_back(m_systems.size());
+    m_systems.push_back(System{ reads, writes, std::move(function) });
+    m_stats.push_back(SystemStats{ std::move(name), phase, 0.0f });
+}
+
+void SystemScheduler::Run(EntityWorld& world, float deltaTime) {
+    using Clock = std::chrono::steady_clock;
+    auto runStart = Clock::now();
+    SystemContext context{ world, m_threadPool, deltaTime };
+
+    auto runSystem = [&](size_t index) {
+        auto start = Clock::now();
+        m_systems[index].function(context);
+        m_stats[index].milliseconds = std::chrono::duration<float, std::milli>(Clock::now() - start).count();
+    };
+
+    for (const std::vector<size_t>& phase : m_phases) {
+        if (!m_threadPool || phase.size() == 1) {
+            for (size_t index : phase) {
+                runSystem(index);
+            }
+            continue;
+        }
+        m_threadPool->ParallelFor(phase.size(), 1, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                runSystem(phase[i]);
+            }
+        });
+    }
+
+    world.FlushDeferred();
+    m_lastRunMilliseconds = std::chrono::duration<float, std::milli>(Clock::now() - runStart).count();
+}
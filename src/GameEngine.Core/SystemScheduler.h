@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+#include "EntityWorld.h"
+#include "ThreadPool.h"
+
+// What a running system gets to work with
+struct SystemContext {
+    EntityWorld& world;
+    ThreadPool* threadPool;
+    float deltaTime;
+
+    // Runs fn(const EntityChunkView&) over every chunk that has all of
+    // `required`, spread across the pool one chunk at a time
+    template <typename Fn>
+    void ForEachChunk(ComponentMask required, Fn&& fn) const {
+        std::vector<EntityChunkView> chunks;
+        world.GatherChunks(required, chunks);
+        if (!threadPool) {
+            for (const EntityChunkView& chunk : chunks) {
+                fn(chunk);
+            }
+            return;
+        }
+        threadPool->ParallelFor(chunks.size(), 1, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                fn(chunks[i]);
+            }
+        });
+    }
+};
+
+using SystemFunction = std::function<void(const SystemContext& context)>;
+
+struct SystemStats {
+    std::string name;
+    uint32_t phase;
+    float milliseconds;     // last run
+};
+
+// Runs entity systems once per frame. Every system declares the components
+// it reads and writes. A system waits for each earlier system it conflicts
+// with (either one writes a component the other reads or writes) and
+// otherwise shares a phase with them, so the order systems were added in
+// only matters where they conflict. Phases run one after another with
+// their systems in parallel; deferred destruction is applied at the end.
+class SystemScheduler {
+public:
+    explicit SystemScheduler(ThreadPool* threadPool);
+
+    void AddSystem(std::string name, ComponentMask reads, ComponentMask writes, SystemFunction function);
+    void Run(EntityWorld& world, float deltaTime);
+
+    uint32_t GetPhaseCount() const { return static_cast<uint32_t>(m_phases.size()); }
+    const std::vector<SystemStats>& GetStats() const { return m_stats; }
+    float GetLastRunMilliseconds() const { return m_lastRunMilliseconds; }
+
+private:
+    struct System {
+        ComponentMask reads;
+        ComponentMask writes;
+        SystemFunction function;
+    };
+
+    ThreadPool* m_threadPool;
+    std::vector<System> m_systems;
+    std::vector<std::vector<size_t>> m_phases;     // system indices per phase
+    std::vector<SystemStats> m_stats;
+    float m_lastRunMilliseconds;
+};
@@ -0,0 +1,118 @@
+#include "ThreadPool.h"
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+ThreadPool::ThreadPool(unsigned threadCount)
+    : m_runningTasks(0)
+    , m_stopping(false)
+{
+    if (threadCount == 0) {
+        unsigned hardware = std::thread::hardware_concurrency();
+        threadCount = hardware > 1 ? hardware - 1 : 1;
+    }
+
+    m_workers.reserve(threadCount);
+    for (unsigned i = 0; i < threadCount; ++i) {
+        m_workers.emplace_back(&ThreadPool::WorkerLoop, this);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_taskAvailable.notify_all();
+
+    for (std::thread& worker : m_workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::Submit(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_tasks.push_back(std::move(task));
+    }
+    m_taskAvailable.notify_one();
+}
+
+void ThreadPool::ParallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t)>& fn) {
+    if (count == 0) {
+        return;
+    }
+    grain = std::max<size_t>(grain, 1);
+    size_t rangeCount = (count + grain - 1) / grain;
+
+    if (rangeCount == 1 || m_workers.empty()) {
+        fn(0, count);
+        return;
+    }
+
+    // Shared with helper tasks, which may start after this call returned;
+    // by then every range is claimed and they exit without touching fn
+    struct State {
+        std::atomic<size_t> nextRange{ 0 };
+        std::atomic<size_t> doneRanges{ 0 };
+        std::mutex mutex;
+        std::condition_variable done;
+    };
+    auto state = std::make_shared<State>();
+    const auto* work = &fn;
+
+    auto runRanges = [state, work, count, grain, rangeCount]() {
+        size_t completed = 0;
+        for (;;) {
+            size_t range = state->nextRange.fetch_add(1, std::memory_order_relaxed);
+            if (range >= rangeCount) break;
+            size_t begin = range * grain;
+            (*work)(begin, std::min(begin + grain, count));
+            ++completed;
+        }
+        if (completed > 0 && state->doneRanges.fetch_add(completed) + completed == rangeCount) {
+            std::lock_guard<std::mutex> lock(state->mutex);
+            state->done.notify_all();
+        }
+    };
+
+    size_t helpers = std::min<size_t>(m_workers.size(), rangeCount - 1);
+    for (size_t i = 0; i < helpers; ++i) {
+        Submit(runRanges);
+    }
+    runRanges();
+
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->done.wait(lock, [&] { return state->doneRanges.load() == rangeCount; });
+}
+
+void ThreadPool::WaitIdle() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_idle.wait(lock, [this] { return m_tasks.empty() && m_runningTasks == 0; });
+}
+
+void ThreadPool::WorkerLoop() {
+    for (;;) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_taskAvailable.wait(lock, [this] { return m_stopping || !m_tasks.empty(); });
+            if (m_stopping && m_tasks.empty()) {
+                return;
+            }
+            task = std::move(m_tasks.front());
+            m_tasks.pop_front();
+            ++m_runningTasks;
+        }
+
+        task();
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            --m_runningTasks;
+            if (m_tasks.empty() && m_runningTasks == 0) {
+                m_idle.notify_all();
+            }
+        }
+    }
+}
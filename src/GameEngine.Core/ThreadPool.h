@@ -0,0 +1,43 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads shared by the engine's batch systems.
+class ThreadPool {
+public:
+    // 0 picks one worker per hardware thread minus the calling thread
+    explicit ThreadPool(unsigned threadCount = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    void Submit(std::function<void()> task);
+
+    // Runs fn(begin, end) over [0, count) in ranges of `grain` items. The
+    // calling thread takes part, and the call returns once every range is
+    // done, even if some workers are still busy with unrelated tasks.
+    void ParallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t)>& fn);
+
+    // Blocks until the queue is empty and no task is running
+    void WaitIdle();
+
+    unsigned GetThreadCount() const { return static_cast<unsigned>(m_workers.size()); }
+
+private:
+    void WorkerLoop();
+
+    std::vector<std::thread> m_workers;
+    std::deque<std::function<void()>> m_tasks;
+    std::mutex m_mutex;
+    std::condition_variable m_taskAvailable;
+    std::condition_variable m_idle;
+    size_t m_runningTasks;
+    bool m_stopping;
+};
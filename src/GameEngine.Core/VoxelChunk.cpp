@@ -1,129 +1,128 @@
 #include "VoxelChunk.h"
-#include "Renderer.h"
-#include "Camera.h"
-#include <cmath>
 #include <algorithm>
 
-// Simple 3D Perlin-like noise function
-static float Noise3D(float x, float y, float z, int seed) {
-    int n = static_cast<int>(x * 57 + y * 113 + z * 197 + seed * 1019);
-    n = (n << 13) ^ n;
-    return 1.0f - ((n * (n * n * 15731 + 789221) + 1376312589) & 0x7fffffff) / 1073741824.0f;
+// All new chunks start out sharing one read-only block of air
+template <int Size>
+static const BasicVoxelBlockRef<Size>& EmptyBlock() {
+    static const BasicVoxelBlockRef<Size> empty = [] {
+        auto block = MakeVoxelBlock<Size>();
+        std::fill(std::begin(block->voxels), std::end(block->voxels), static_cast<uint8_t>(BlockType::Air));
+        block->solidCount = 0;
+        std::fill(std::begin(block->typeCounts), std::end(block->typeCounts), 0u);
+        block->typeCounts[static_cast<uint8_t>(BlockType::Air)] = ChunkDimensions<Size>::VOLUME;
+        std::fill(std::begin(block->layerSolidCounts), std::end(block->layerSolidCounts), static_cast<uint16_t>(0));
+        block->minSolidY = Size;
+        block->maxSolidY = -1;
+        return block;
+    }();
+    return empty;
 }
 
-static float PerlinNoise3D(float x, float y, float z, int seed) {
-    int xi = static_cast<int>(std::floor(x));
-    int yi = static_cast<int>(std::floor(y));
-    int zi = static_cast<int>(std::floor(z));
-    
-    float xf = x - xi;
-    float yf = y - yi;
-    float zf = z - zi;
-    
-    // Smoothstep
-    float u = xf * xf * (3 - 2 * xf);
-    float v = yf * yf * (3 - 2 * yf);
-    float w = zf * zf * (3 - 2 * zf);
-    
-    // Sample corners
-    float n000 = Noise3D(static_cast<float>(xi), static_cast<float>(yi), static_cast<float>(zi), seed);
-    float n100 = Noise3D(static_cast<float>(xi + 1), static_cast<float>(yi), static_cast<float>(zi), seed);
-    float n010 = Noise3D(static_cast<float>(xi), static_cast<float>(yi + 1), static_cast<float>(zi), seed);
-    float n110 = Noise3D(static_cast<float>(xi + 1), static_cast<float>(yi + 1), static_cast<float>(zi), seed);
-    float n001 = Noise3D(static_cast<float>(xi), static_cast<float>(yi), static_cast<float>(zi + 1), seed);
-    float n101 = Noise3D(static_cast<float>(xi + 1), static_cast<float>(yi), static_cast<float>(zi + 1), seed);
-    float n011 = Noise3D(static_cast<float>(xi), static_cast<float>(yi + 1), static_cast<float>(zi + 1), seed);
-    float n111 = Noise3D(static_cast<float>(xi + 1), static_cast<float>(yi + 1), static_cast<float>(zi + 1), seed);
-    
-    // Trilinear interpolation
-    float x00 = n000 * (1 - u) + n100 * u;
-    float x10 = n010 * (1 - u) + n110 * u;
-    float x01 = n001 * (1 - u) + n101 * u;
-    float x11 = n011 * (1 - u) + n111 * u;
-    
-    float y0 = x00 * (1 - v) + x10 * v;
-    float y1 = x01 * (1 - v) + x11 * v;
-    
-    return y0 * (1 - w) + y1 * w;
-}
-
-VoxelChunk::VoxelChunk(int chunkX, int chunkY, int chunkZ)
-    : m_chunkX(chunkX)
+template <int Size>
+BasicVoxelChunk<Size>::BasicVoxelChunk(int chunkX, int chunkY, int chunkZ)
+    : m_block(EmptyBlock<Size>())
+    , m_chunkX(chunkX)
     , m_chunkY(chunkY)
     , m_chunkZ(chunkZ)
     , m_meshDirty(true)
 {
-    std::fill(std::begin(m_voxels), std::end(m_voxels), static_cast<uint8_t>(BlockType::Air));
 }
 
-VoxelChunk::~VoxelChunk() = default;
+template <int Size>
+BasicVoxelChunk<Size>::~BasicVoxelChunk() = default;
 
-void VoxelChunk::SetVoxel(int x, int y, int z, uint8_t blockType) {
-    if (x >= 0 && x < CHUNK_SIZE && y >= 0 && y < CHUNK_SIZE && z >= 0 && z < CHUNK_SIZE) {
-        m_voxels[GetIndex(x, y, z)] = blockType;
+template <int Size>
+void BasicVoxelChunk<Size>::SetVoxel(int x, int y, int z, uint8_t blockType) {
+    if (InBounds(x, y, z)) {
+        int index = Dimensions::Index(x, y, z);
+        if (m_block->voxels[index] == blockType) {
+            return;
+        }
+        
+        // Copy on write: snapshots still reference the old block
+        if (m_block.use_count() > 1) {
+            m_block = MakeVoxelBlock(*m_block);
+        }
+        
+        Block& block = *m_block;
+        uint8_t& voxel = block.voxels[index];
+        --block.typeCounts[VoxelTypeBucket(voxel)];
+        ++block.typeCounts[VoxelTypeBucket(blockType)];
+        
+        bool wasSolid = voxel != static_cast<uint8_t>(BlockType::Air);
+        bool isSolid = blockType != static_cast<uint8_t>(BlockType::Air);
+        voxel = blockType;
         m_meshDirty = true;
+        if (wasSolid == isSolid) {
+            return;
+        }
+        
+        if (isSolid) {
+            ++block.solidCount;
+            ++block.layerSolidCounts[y];
+            block.minSolidY = std::min(block.minSolidY, y);
+            block.maxSolidY = std::max(block.maxSolidY, y);
+            return;
+        }
+        
+        // Clearing the last solid voxel of an end layer moves that end
+        // inwards to the next layer with solid voxels
+        --block.solidCount;
+        if (--block.layerSolidCounts[y] == 0) {
+            if (block.solidCount == 0) {
+                block.minSolidY = Size;
+                block.maxSolidY = -1;
+            } else if (y == block.minSolidY) {
+                while (block.layerSolidCounts[block.minSolidY] == 0) {
+                    ++block.minSolidY;
+                }
+            } else if (y == block.maxSolidY) {
+                while (block.layerSolidCounts[block.maxSolidY] == 0) {
+                    --block.maxSolidY;
+                }
+            }
+        }
     }
 }
 
-uint8_t VoxelChunk::GetVoxel(int x, int y, int z) const {
-    if (x >= 0 && x < CHUNK_SIZE && y >= 0 && y < CHUNK_SIZE && z >= 0 && z < CHUNK_SIZE) {
-        return m_voxels[GetIndex(x, y, z)];
-    }
-    return static_cast<uint8_t>(BlockType::Air);
+template <int Size>
+void BasicVoxelChunk<Size>::SetBlock(BlockRef block) {
+    m_block = block ? std::move(block) : EmptyBlock<Size>();
+    m_meshDirty = true;
 }
 
-void VoxelChunk::GenerateTerrain(int seed) {
-    for (int x = 0; x < CHUNK_SIZE; ++x) {
-        for (int z = 0; z < CHUNK_SIZE; ++z) {
-            int worldX = m_chunkX * CHUNK_SIZE + x;
-            int worldZ = m_chunkZ * CHUNK_SIZE + z;
-            
-            // Generate height using Perlin noise
-            float noise = PerlinNoise3D(worldX * 0.05f, 0, worldZ * 0.05f, seed);
-            int height = static_cast<int>(noise * 8.0f) + 8; // Height from 0 to 16
-            
-            for (int y = 0; y < CHUNK_SIZE; ++y) {
-                int worldY = m_chunkY * CHUNK_SIZE + y;
-                
-                if (worldY < height - 3) {
-                    SetVoxel(x, y, z, static_cast<uint8_t>(BlockType::Stone));
-                } else if (worldY < height - 1) {
-                    SetVoxel(x, y, z, static_cast<uint8_t>(BlockType::Dirt));
-                } else if (worldY < height) {
-                    SetVoxel(x, y, z, static_cast<uint8_t>(BlockType::Grass));
-                } else {
-                    SetVoxel(x, y, z, static_cast<uint8_t>(BlockType::Air));
-                }
-            }
-        }
+template <int Size>
+uint8_t BasicVoxelChunk<Size>::GetVoxel(int x, int y, int z) const {
+    if (InBounds(x, y, z)) {
+        return m_block->voxels[Dimensions::Index(x, y, z)];
     }
-    
-    m_meshDirty = true;
+    return static_cast<uint8_t>(BlockType::Air);
 }
 
-void VoxelChunk::RegenerateMesh() {
+template <int Size>
+void BasicVoxelChunk<Size>::RegenerateMesh(const Neighbors& neighbors) {
     m_vertices.clear();
     m_indices.clear();
     
-    for (int x = 0; x < CHUNK_SIZE; ++x) {
-        for (int y = 0; y < CHUNK_SIZE; ++y) {
-            for (int z = 0; z < CHUNK_SIZE; ++z) {
+    for (int x = 0; x < Size; ++x) {
+        for (int y = 0; y < Size; ++y) {
+            for (int z = 0; z < Size; ++z) {
                 BlockType blockType = static_cast<BlockType>(GetVoxel(x, y, z));
                 if (blockType == BlockType::Air) continue;
                 
                 DirectX::XMFLOAT3 blockPos(
-                    static_cast<float>(m_chunkX * CHUNK_SIZE + x),
-                    static_cast<float>(m_chunkY * CHUNK_SIZE + y),
-                    static_cast<float>(m_chunkZ * CHUNK_SIZE + z)
+                    static_cast<float>(m_chunkX * Size + x),
+                    static_cast<float>(m_chunkY * Size + y),
+                    static_cast<float>(m_chunkZ * Size + z)
                 );
                 
                 // Check each face and add if not occluded
-                if (!IsVoxelSolid(x, y, z + 1)) AddFace(blockPos, 0, blockType); // Front
-                if (!IsVoxelSolid(x, y, z - 1)) AddFace(blockPos, 1, blockType); // Back
-                if (!IsVoxelSolid(x, y + 1, z)) AddFace(blockPos, 2, blockType); // Top
-                if (!IsVoxelSolid(x, y - 1, z)) AddFace(blockPos, 3, blockType); // Bottom
-                if (!IsVoxelSolid(x + 1, y, z)) AddFace(blockPos, 4, blockType); // Right
-                if (!IsVoxelSolid(x - 1, y, z)) AddFace(blockPos, 5, blockType); // Left
+                if (!IsVoxelSolid(x, y, z + 1, neighbors)) AddFace(blockPos, 0, blockType); // Front
+                if (!IsVoxelSolid(x, y, z - 1, neighbors)) AddFace(blockPos, 1, blockType); // Back
+                if (!IsVoxelSolid(x, y + 1, z, neighbors)) AddFace(blockPos, 2, blockType); // Top
+                if (!IsVoxelSolid(x, y - 1, z, neighbors)) AddFace(blockPos, 3, blockType); // Bottom
+                if (!IsVoxelSolid(x + 1, y, z, neighbors)) AddFace(blockPos, 4, blockType); // Right
+                if (!IsVoxelSolid(x - 1, y, z, neighbors)) AddFace(blockPos, 5, blockType); // Left
             }
         }
     }
@@ -131,27 +130,31 @@ void VoxelChunk::RegenerateMesh() {
     m_meshDirty = false;
 }
 
-void VoxelChunk::Render(Renderer* renderer, Camera* camera) {
-    if (m_meshDirty) {
-        RegenerateMesh();
-    }
-    
-    // TODO: Implement actual rendering with DirectX
-    // For now, this is a placeholder
-}
-
-int VoxelChunk::GetIndex(int x, int y, int z) const {
-    return x + y * CHUNK_SIZE + z * CHUNK_SIZE * CHUNK_SIZE;
+template <int Size>
+void BasicVoxelChunk<Size>::ReleaseMeshData() {
+    ChunkVertexList().swap(m_vertices);
+    ChunkIndexList().swap(m_indices);
 }
 
-bool VoxelChunk::IsVoxelSolid(int x, int y, int z) const {
-    if (x < 0 || x >= CHUNK_SIZE || y < 0 || y >= CHUNK_SIZE || z < 0 || z >= CHUNK_SIZE) {
-        return false; // Assume air outside chunk
+template <int Size>
+bool BasicVoxelChunk<Size>::IsVoxelSolid(int x, int y, int z, const Neighbors& neighbors) const {
+    // Face neighbours only ever step over one chunk boundary at a time
+    const BasicVoxelChunk* chunk = this;
+    if (z >= Size)      { chunk = neighbors.faces[0]; z -= Size; }
+    else if (z < 0)     { chunk = neighbors.faces[1]; z += Size; }
+    else if (y >= Size) { chunk = neighbors.faces[2]; y -= Size; }
+    else if (y < 0)     { chunk = neighbors.faces[3]; y += Size; }
+    else if (x >= Size) { chunk = neighbors.faces[4]; x -= Size; }
+    else if (x < 0)     { chunk = neighbors.faces[5]; x += Size; }
+    
+    if (!chunk) {
+        return false; // Assume air where there is no chunk
     }
-    return GetVoxel(x, y, z) != static_cast<uint8_t>(BlockType::Air);
+    return chunk->GetVoxel(x, y, z) != static_cast<uint8_t>(BlockType::Air);
 }
 
-void VoxelChunk::AddFace(const DirectX::XMFLOAT3& pos, int face, BlockType blockType) {
+template <int Size>
+void BasicVoxelChunk<Size>::AddFace(const DirectX::XMFLOAT3& pos, int face, BlockType blockType) {
     using namespace DirectX;
     
     // Face vertices (simplified cube)
@@ -204,13 +207,20 @@ void VoxelChunk::AddFace(const DirectX::XMFLOAT3& pos, int face, BlockType block
     m_indices.push_back(baseIndex + 3);
 }
 
-DirectX::XMFLOAT3 VoxelChunk::GetBlockColor(BlockType type) const {
+template <int Size>
+DirectX::XMFLOAT3 BasicVoxelChunk<Size>::GetBlockColor(BlockType type) const {
     switch (type) {
         case BlockType::Grass: return DirectX::XMFLOAT3(0.3f, 0.8f, 0.2f);
         case BlockType::Dirt: return DirectX::XMFLOAT3(0.6f, 0.4f, 0.2f);
         case BlockType::Stone: return DirectX::XMFLOAT3(0.5f, 0.5f, 0.5f);
         case BlockType::Sand: return DirectX::XMFLOAT3(0.9f, 0.9f, 0.6f);
         case BlockType::Water: return DirectX::XMFLOAT3(0.2f, 0.4f, 0.8f);
+        case BlockType::Wood: return DirectX::XMFLOAT3(0.45f, 0.3f, 0.15f);
+        case BlockType::Leaves: return DirectX::XMFLOAT3(0.2f, 0.55f, 0.15f);
         default: return DirectX::XMFLOAT3(1.0f, 1.0f, 1.0f);
     }
 }
+
+template class BasicVoxelChunk<16>;
+template class BasicVoxelChunk<32>;
+template class BasicVoxelChunk<64>;
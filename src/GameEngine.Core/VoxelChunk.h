@@ -1,14 +1,86 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
+#include <bit>
+#include <functional>
+#include <memory>
 #include <vector>
 #include <DirectXMath.h>
+#include "MemoryBudget.h"
 
-class Renderer;
-class Camera;
+// Edge length of the engine's chunks. Other sizes are built alongside for
+// comparison (see ChunkSizeBenchmark.h); this one must be among them.
+#ifndef GAMEENGINE_CHUNK_SIZE
+#define GAMEENGINE_CHUNK_SIZE 16
+#endif
 
-constexpr int CHUNK_SIZE = 16;
-constexpr int CHUNK_VOLUME = CHUNK_SIZE * CHUNK_SIZE * CHUNK_SIZE;
+// Layout of a cubic chunk with a power-of-two edge. World coordinates split
+// into chunk and local parts with shifts and masks; the arithmetic shift
+// floors negative coordinates.
+template <int Size>
+struct ChunkDimensions {
+    static_assert(Size >= 4 && Size <= 128 && (Size & (Size - 1)) == 0, "chunk size must be a power of two");
+    
+    static constexpr int SIZE = Size;
+    static constexpr int SHIFT = std::countr_zero(static_cast<unsigned>(Size));
+    static constexpr int MASK = Size - 1;
+    static constexpr int VOLUME = Size * Size * Size;
+    
+    static constexpr int ToChunk(int world) { return world >> SHIFT; }
+    static constexpr int ToLocal(int world) { return world & MASK; }
+    static constexpr int ToWorld(int chunk) { return chunk * Size; }
+    
+    // x fastest, then y, then z
+    static constexpr int Index(int x, int y, int z) { return x | (y << SHIFT) | (z << (2 * SHIFT)); }
+};
+
+using ChunkLayout = ChunkDimensions<GAMEENGINE_CHUNK_SIZE>;
+
+constexpr int CHUNK_SIZE = ChunkLayout::SIZE;
+constexpr int CHUNK_VOLUME = ChunkLayout::VOLUME;
+
+static_assert(CHUNK_SIZE == 16 || CHUNK_SIZE == 32 || CHUNK_SIZE == 64,
+              "GAMEENGINE_CHUNK_SIZE must be one of the instantiated chunk sizes");
+
+struct ChunkCoord {
+    int x, y, z;
+    
+    bool operator==(const ChunkCoord& other) const {
+        return x == other.x && y == other.y && z == other.z;
+    }
+};
+
+// A voxel in world coordinates
+struct VoxelPosition {
+    int x, y, z;
+    
+    bool operator==(const VoxelPosition& other) const {
+        return x == other.x && y == other.y && z == other.z;
+    }
+};
+
+namespace std {
+    template <>
+    struct hash<ChunkCoord> {
+        size_t operator()(const ChunkCoord& coord) const {
+            return hash<int>()(coord.x) ^ (hash<int>()(coord.y) << 1) ^ (hash<int>()(coord.z) << 2);
+        }
+    };
+}
+
+// Chunk containing a world voxel
+template <int Size = CHUNK_SIZE>
+inline ChunkCoord WorldToChunkCoord(int x, int y, int z) {
+    using Dimensions = ChunkDimensions<Size>;
+    return ChunkCoord{ Dimensions::ToChunk(x), Dimensions::ToChunk(y), Dimensions::ToChunk(z) };
+}
+
+// Index of a chunk-local voxel in VoxelBlock::voxels
+template <int Size = CHUNK_SIZE>
+inline int LocalVoxelIndex(int x, int y, int z) {
+    return ChunkDimensions<Size>::Index(x, y, z);
+}
 
 enum class BlockType : uint8_t {
     Air = 0,
@@ -16,9 +88,20 @@ enum class BlockType : uint8_t {
     Dirt = 2,
     Stone = 3,
     Sand = 4,
-    Water = 5
+    Water = 5,
+    Wood = 6,
+    Leaves = 7
 };
 
+// Histogram buckets of a voxel block: one per BlockType, and a last one
+// shared by any other voxel value
+constexpr uint32_t BLOCK_TYPE_COUNT = 8;
+constexpr uint32_t VOXEL_TYPE_BUCKETS = BLOCK_TYPE_COUNT + 1;
+
+inline uint32_t VoxelTypeBucket(uint8_t voxel) {
+    return voxel < BLOCK_TYPE_COUNT ? voxel : BLOCK_TYPE_COUNT;
+}
+
 struct Vertex {
     DirectX::XMFLOAT3 position;
     DirectX::XMFLOAT3 normal;
@@ -26,28 +109,117 @@ struct Vertex {
     DirectX::XMFLOAT3 color;
 };
 
-class VoxelChunk {
+// Voxel payload of a chunk. Blocks are shared copy-on-write between the
+// live world and history snapshots: a chunk clones its block on the first
+// edit after it was shared, so snapshots cost one pointer per chunk.
+//
+// The summary fields after the voxels are kept current by SetVoxel and
+// travel with the block, so queries can skip or answer whole chunks
+// without reading their voxels.
+template <int Size>
+struct BasicVoxelBlock {
+    uint8_t voxels[ChunkDimensions<Size>::VOLUME];
+    int solidCount;
+    uint32_t typeCounts[VOXEL_TYPE_BUCKETS];    // by VoxelTypeBucket
+    uint16_t layerSolidCounts[Size];            // solid voxels per y
+    int minSolidY;                              // Size and -1 when empty
+    int maxSolidY;
+};
+
+template <int Size>
+using BasicVoxelBlockRef = std::shared_ptr<BasicVoxelBlock<Size>>;
+
+using VoxelBlock = BasicVoxelBlock<CHUNK_SIZE>;
+using VoxelBlockRef = BasicVoxelBlockRef<CHUNK_SIZE>;
+
+// Blocks are allocated through these so they count against VoxelData
+template <int Size = CHUNK_SIZE>
+BasicVoxelBlockRef<Size> MakeVoxelBlock() {
+    return std::allocate_shared<BasicVoxelBlock<Size>>(TrackingAllocator<BasicVoxelBlock<Size>, MemoryCategory::VoxelData>());
+}
+
+template <int Size>
+BasicVoxelBlockRef<Size> MakeVoxelBlock(const BasicVoxelBlock<Size>& source) {
+    return std::allocate_shared<BasicVoxelBlock<Size>>(TrackingAllocator<BasicVoxelBlock<Size>, MemoryCategory::VoxelData>(), source);
+}
+
+// Bump whenever RegenerateMesh output changes, so cached meshes built by
+// an older mesher are never reused
+constexpr uint32_t MESHER_VERSION = 2;
+
+template <int Size>
+class BasicVoxelChunk;
+
+// Adjacent chunks in the mesher's face order (+Z, -Z, +Y, -Y, +X, -X).
+// Faces against a null neighbour are treated as open.
+template <int Size>
+struct BasicChunkNeighbors {
+    const BasicVoxelChunk<Size>* faces[6];
+};
+
+using ChunkVertexList = std::vector<Vertex, TrackingAllocator<Vertex, MemoryCategory::ChunkMeshes>>;
+using ChunkIndexList = std::vector<uint32_t, TrackingAllocator<uint32_t, MemoryCategory::ChunkMeshes>>;
+
+// Member definitions live in VoxelChunk.cpp, which instantiates 16, 32 and
+// 64; the rest of the engine uses VoxelChunk at CHUNK_SIZE.
+template <int Size>
+class BasicVoxelChunk {
 public:
-    VoxelChunk(int chunkX, int chunkY, int chunkZ);
-    ~VoxelChunk();
+    using Dimensions = ChunkDimensions<Size>;
+    using Block = BasicVoxelBlock<Size>;
+    using BlockRef = BasicVoxelBlockRef<Size>;
+    using Neighbors = BasicChunkNeighbors<Size>;
+    
+    BasicVoxelChunk(int chunkX, int chunkY, int chunkZ);
+    ~BasicVoxelChunk();
     
     void SetVoxel(int x, int y, int z, uint8_t blockType);
     uint8_t GetVoxel(int x, int y, int z) const;
     
-    void GenerateTerrain(int seed);
-    void RegenerateMesh();
-    void Render(Renderer* renderer, Camera* camera);
+    // Chunk-wide shortcuts so queries can skip per-voxel tests
+    bool IsEmpty() const { return m_block->solidCount == 0; }
+    bool IsFull() const { return m_block->solidCount == Dimensions::VOLUME; }
+    
+    // Sharing the block makes the next SetVoxel clone it first
+    const BlockRef& GetBlock() const { return m_block; }
+    void SetBlock(BlockRef block);
+    
+    int GetChunkX() const { return m_chunkX; }
+    int GetChunkY() const { return m_chunkY; }
+    int GetChunkZ() const { return m_chunkZ; }
+    
+    void RegenerateMesh(const Neighbors& neighbors);
+    
+    // CPU mesh produced by RegenerateMesh; the engine copies it into the
+    // shared MeshArena and then releases it here
+    bool IsMeshDirty() const { return m_meshDirty; }
+    void InvalidateMesh() { m_meshDirty = true; }
+    // For meshes that were not built here, e.g. ones from the mesh cache
+    void MarkMeshClean() { m_meshDirty = false; }
+    const ChunkVertexList& GetVertices() const { return m_vertices; }
+    const ChunkIndexList& GetIndices() const { return m_indices; }
+    void ReleaseMeshData();
     
 private:
-    int GetIndex(int x, int y, int z) const;
-    bool IsVoxelSolid(int x, int y, int z) const;
+    // Any coordinate outside [0, Size) sets a bit at or above Size
+    static bool InBounds(int x, int y, int z) {
+        return (static_cast<unsigned>(x) | static_cast<unsigned>(y) | static_cast<unsigned>(z)) < static_cast<unsigned>(Size);
+    }
+    bool IsVoxelSolid(int x, int y, int z, const Neighbors& neighbors) const;
     void AddFace(const DirectX::XMFLOAT3& pos, int face, BlockType blockType);
     DirectX::XMFLOAT3 GetBlockColor(BlockType type) const;
     
-    uint8_t m_voxels[CHUNK_VOLUME];
-    std::vector<Vertex> m_vertices;
-    std::vector<uint32_t> m_indices;
+    BlockRef m_block;
+    ChunkVertexList m_vertices;
+    ChunkIndexList m_indices;
     
     int m_chunkX, m_chunkY, m_chunkZ;
     bool m_meshDirty;
 };
+
+extern template class BasicVoxelChunk<16>;
+extern template class BasicVoxelChunk<32>;
+extern template class BasicVoxelChunk<64>;
+
+using VoxelChunk = BasicVoxelChunk<CHUNK_SIZE>;
+using ChunkNeighbors = BasicChunkNeighbors<CHUNK_SIZE>;
@@ -2,15 +2,77 @@
 #include "VoxelChunk.h"
 #include "Renderer.h"
 #include "Camera.h"
+#include "ThreadPool.h"
+#include "Frustum.h"
+#include "WorldGenerator.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <cmath>
+#include <mutex>
 #include <random>
+#include <thread>
 
-VoxelEngine::VoxelEngine()
+namespace {
+    // Chunks seen this recently are never evicted
+    constexpr uint64_t EVICTION_MIN_AGE_FRAMES = 120;
+    constexpr size_t MAX_RELOADS_PER_FRAME = 8;
+    
+    // Chunks evicted between checks of how much voxel data actually came free
+    constexpr uint32_t EVICTION_BATCH_CHUNKS = 8;
+    
+    // Chunks the terrain generator completes per step, nearest first
+    constexpr size_t TERRAIN_STEP_CHUNKS = 16;
+    
+    // Sets voxels keyed by chunk-local index
+    void ApplyVoxelEdits(VoxelChunk& chunk, const std::unordered_map<int, uint8_t>& edits) {
+        for (const auto& edit : edits) {
+            int index = edit.first;
+            chunk.SetVoxel(index & ChunkLayout::MASK,
+                           (index >> ChunkLayout::SHIFT) & ChunkLayout::MASK,
+                           index >> (2 * ChunkLayout::SHIFT), edit.second);
+        }
+    }
+}
+
+// Shared between the engine and the generation tasks, so tasks that are
+// still queued after a cancel or shutdown only touch this object
+struct VoxelEngine::TerrainJob {
+    int seed = 0;
+    uint32_t total = 0;
+    uint32_t drained = 0;               // main thread only
+    std::atomic<bool> cancelled{ false };
+    std::atomic<uint32_t> generated{ 0 };
+    std::mutex mutex;
+    std::vector<std::unique_ptr<VoxelChunk>> finished;
+};
+
+VoxelEngine::VoxelEngine(ThreadPool* threadPool)
     : m_seed(12345)
+    , m_worldGeneration(0)
+    , m_threadPool(threadPool)
+    , m_pendingSwapped(false)
+    , m_swapThreshold(0.25f)
+    , m_focusX(0.0f)
+    , m_focusY(0.0f)
+    , m_focusZ(0.0f)
+    , m_worldRadius(2)
+    , m_published(nullptr)
+    , m_snapshotVersion(0)
+    , m_snapshotDirty(true)
+    , m_frameIndex(0)
+    , m_hasVisibility(false)
+    , m_nextEditListenerId(1)
 {
+    // Readers always find a snapshot, even before the first world exists
+    PublishSnapshot();
 }
 
-VoxelEngine::~VoxelEngine() = default;
+VoxelEngine::~VoxelEngine() {
+    m_heldEdits.clear();
+    CancelTerrainGeneration();
+    delete m_published.exchange(nullptr);
+}
 
 void VoxelEngine::Initialize() {
     // Generate initial terrain
@@ -19,24 +81,52 @@ void VoxelEngine::Initialize() {
 
 void VoxelEngine::Update(float deltaTime) {
     // Update chunks, unload far chunks, load near chunks, etc.
+    DrainTerrainJob();
+    PublishSnapshot();
 }
 
 void VoxelEngine::Render(Renderer* renderer, Camera* camera) {
-    // Render all visible chunks
-    for (auto& pair : m_chunks) {
-        pair.second->Render(renderer, camera);
+    ++m_frameIndex;
+    UpdateVisibility(camera);
+    UpdateChunkMeshes();
+    EnforceMemoryBudget();
+    
+    // One indirect argument per visible chunk, all sharing the arena pools
+    m_meshArena.BuildDrawCommands(m_drawCommands);
+    if (renderer && camera) {
+        renderer->DrawMeshes(m_meshArena, m_drawCommands, *camera);
+        
+        // The renderer has taken this frame's uploads
+        m_meshArena.ClearDirtyRanges();
     }
 }
 
 void VoxelEngine::SetVoxel(int x, int y, int z, uint8_t blockType) {
     ChunkCoord chunkCoord = WorldToChunk(x, y, z);
+    
+    // The chunk has no terrain yet; the edit waits for it
+    if (m_pendingSwapped && m_unstreamed.count(chunkCoord) != 0) {
+        int index = LocalVoxelIndex(ChunkLayout::ToLocal(x), ChunkLayout::ToLocal(y), ChunkLayout::ToLocal(z));
+        m_heldEdits[chunkCoord][index] = blockType;
+        return;
+    }
+    
     VoxelChunk* chunk = GetOrCreateChunk(chunkCoord);
     
     if (chunk) {
-        int localX = x - chunkCoord.x * CHUNK_SIZE;
-        int localY = y - chunkCoord.y * CHUNK_SIZE;
-        int localZ = z - chunkCoord.z * CHUNK_SIZE;
+        int localX = ChunkLayout::ToLocal(x);
+        int localY = ChunkLayout::ToLocal(y);
+        int localZ = ChunkLayout::ToLocal(z);
         chunk->SetVoxel(localX, localY, localZ, blockType);
+        m_snapshotDirty = true;
+        NotifyEdit(chunkCoord, LocalVoxelIndex(localX, localY, localZ));
+        
+        // Border voxels also decide which faces the neighbours mesh
+        if (localX == 0 || localX == CHUNK_SIZE - 1 ||
+            localY == 0 || localY == CHUNK_SIZE - 1 ||
+            localZ == 0 || localZ == CHUNK_SIZE - 1) {
+            InvalidateNeighborMeshes(chunkCoord);
+        }
     }
 }
 
@@ -45,50 +135,573 @@ uint8_t VoxelEngine::GetVoxel(int x, int y, int z) {
     VoxelChunk* chunk = GetChunk(chunkCoord);
     
     if (chunk) {
-        int localX = x - chunkCoord.x * CHUNK_SIZE;
-        int localY = y - chunkCoord.y * CHUNK_SIZE;
-        int localZ = z - chunkCoord.z * CHUNK_SIZE;
-        return chunk->GetVoxel(localX, localY, localZ);
+        return chunk->GetVoxel(ChunkLayout::ToLocal(x), ChunkLayout::ToLocal(y), ChunkLayout::ToLocal(z));
+    }
+    
+    auto held = m_heldEdits.find(chunkCoord);
+    if (held != m_heldEdits.end()) {
+        auto voxel = held->second.find(LocalVoxelIndex(ChunkLayout::ToLocal(x), ChunkLayout::ToLocal(y), ChunkLayout::ToLocal(z)));
+        if (voxel != held->second.end()) {
+            return voxel->second;
+        }
     }
     
     return 0;
 }
 
 void VoxelEngine::GenerateTerrain(int seed) {
+    CancelTerrainGeneration();
     m_seed = seed;
-    m_chunks.clear();
-    
-    // Generate a 4x2x4 grid of chunks for testing
-    for (int cx = -2; cx < 2; ++cx) {
-        for (int cy = -1; cy < 1; ++cy) {
-            for (int cz = -2; cz < 2; ++cz) {
-                ChunkCoord coord{ cx, cy, cz };
-                auto chunk = std::make_unique<VoxelChunk>(coord.x, coord.y, coord.z);
-                chunk->GenerateTerrain(seed);
-                m_chunks[coord] = std::move(chunk);
+    
+    // Chunks of the world, nearest to the focus first
+    std::vector<ChunkCoord> coords = GetWorldRegion(m_worldRadius);
+    
+    auto distance = [this](const ChunkCoord& c) {
+        float dx = (c.x + 0.5f) * CHUNK_SIZE - m_focusX;
+        float dy = (c.y + 0.5f) * CHUNK_SIZE - m_focusY;
+        float dz = (c.z + 0.5f) * CHUNK_SIZE - m_focusZ;
+        return dx * dx + dy * dy + dz * dz;
+    };
+    std::sort(coords.begin(), coords.end(), [&](const ChunkCoord& a, const ChunkCoord& b) {
+        return distance(a) < distance(b);
+    });
+    
+    m_unstreamed.insert(coords.begin(), coords.end());
+    
+    auto job = std::make_shared<TerrainJob>();
+    job->seed = seed;
+    job->total = static_cast<uint32_t>(coords.size());
+    m_terrainJob = job;
+    m_pendingSwapped = false;
+    
+    // One task drives the staged generator, which spreads each stage batch
+    // over the pool; completed chunks are handed over a few at a time
+    ThreadPool* threadPool = m_threadPool;
+    auto generate = [job, threadPool, coords = std::move(coords)] {
+        WorldGenerator generator(job->seed, coords, threadPool, &job->cancelled);
+        bool more = true;
+        while (more) {
+            std::vector<std::unique_ptr<VoxelChunk>> completed;
+            more = generator.Step(TERRAIN_STEP_CHUNKS, completed);
+            
+            std::lock_guard<std::mutex> lock(job->mutex);
+            job->generated.fetch_add(static_cast<uint32_t>(completed.size()), std::memory_order_relaxed);
+            for (auto& chunk : completed) {
+                job->finished.push_back(std::move(chunk));
             }
         }
+    };
+    
+    if (m_threadPool) {
+        m_threadPool->Submit(std::move(generate));
+    } else {
+        generate();
     }
+    
+    DrainTerrainJob();
+    PublishSnapshot();
 }
 
-ChunkCoord VoxelEngine::WorldToChunk(int x, int y, int z) {
-    return ChunkCoord{
-        x >= 0 ? x / CHUNK_SIZE : (x - CHUNK_SIZE + 1) / CHUNK_SIZE,
-        y >= 0 ? y / CHUNK_SIZE : (y - CHUNK_SIZE + 1) / CHUNK_SIZE,
-        z >= 0 ? z / CHUNK_SIZE : (z - CHUNK_SIZE + 1) / CHUNK_SIZE
+void VoxelEngine::CancelTerrainGeneration() {
+    if (m_terrainJob) {
+        m_terrainJob->cancelled = true;
+        m_terrainJob.reset();
+    }
+    
+    // Chunks that will never stream in keep their held edits over air
+    ApplyHeldEdits();
+    m_unstreamed.clear();
+    m_pendingChunks.clear();
+    m_pendingSwapped = false;
+}
+
+void VoxelEngine::WaitForTerrain() {
+    while (m_terrainJob) {
+        DrainTerrainJob();
+        if (m_terrainJob) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+    PublishSnapshot();
+}
+
+float VoxelEngine::GetTerrainProgress() const {
+    if (!m_terrainJob || m_terrainJob->total == 0) {
+        return 1.0f;
+    }
+    return static_cast<float>(m_terrainJob->generated.load()) / m_terrainJob->total;
+}
+
+void VoxelEngine::SetGenerationFocus(float x, float y, float z) {
+    m_focusX = x;
+    m_focusY = y;
+    m_focusZ = z;
+}
+
+void VoxelEngine::SetSwapThreshold(float fraction) {
+    m_swapThreshold = std::clamp(fraction, 0.0f, 1.0f);
+}
+
+void VoxelEngine::SetWorldRadius(int chunks) {
+    m_worldRadius = std::max(chunks, 1);
+}
+
+void VoxelEngine::DrainTerrainJob() {
+    if (!m_terrainJob) {
+        return;
+    }
+    
+    std::vector<std::unique_ptr<VoxelChunk>> finished;
+    {
+        std::lock_guard<std::mutex> lock(m_terrainJob->mutex);
+        finished.swap(m_terrainJob->finished);
+    }
+    
+    for (auto& chunk : finished) {
+        ChunkCoord coord{ chunk->GetChunkX(), chunk->GetChunkY(), chunk->GetChunkZ() };
+        m_unstreamed.erase(coord);
+        if (m_pendingSwapped) {
+            // The listener sees the terrain; edits made while the chunk was
+            // on its way go on top of it
+            if (m_streamListener) {
+                m_streamListener(coord, chunk->GetBlock());
+            }
+            auto held = m_heldEdits.find(coord);
+            if (held != m_heldEdits.end()) {
+                ApplyVoxelEdits(*chunk, held->second);
+                m_heldEdits.erase(held);
+            }
+            m_chunks[coord] = std::move(chunk);
+            InvalidateNeighborMeshes(coord);
+            m_snapshotDirty = true;
+            NotifyEdit(coord, -1);
+        } else {
+            m_pendingChunks[coord] = std::move(chunk);
+        }
+    }
+    m_terrainJob->drained += static_cast<uint32_t>(finished.size());
+    
+    bool complete = m_terrainJob->drained == m_terrainJob->total;
+    if (!m_pendingSwapped &&
+        (complete || m_terrainJob->drained >= m_swapThreshold * m_terrainJob->total)) {
+        SwapInPendingWorld();
+    }
+    
+    if (complete) {
+        m_terrainJob.reset();
+    }
+}
+
+void VoxelEngine::SwapInPendingWorld() {
+    ReleaseAllMeshes();
+    m_chunks = std::move(m_pendingChunks);
+    m_pendingChunks.clear();
+    m_evicted.clear();
+    m_pageFile.Clear();
+    m_lastVisibleFrame.clear();
+    m_pendingSwapped = true;
+    m_snapshotDirty = true;
+    ++m_worldGeneration;
+    if (m_worldReplacedListener) {
+        m_worldReplacedListener();
+    }
+}
+
+void VoxelEngine::ApplyHeldEdits() {
+    for (const auto& held : m_heldEdits) {
+        ApplyVoxelEdits(*GetOrCreateChunk(held.first), held.second);
+        InvalidateNeighborMeshes(held.first);
+        m_snapshotDirty = true;
+        NotifyEdit(held.first, -1);
+    }
+    m_heldEdits.clear();
+}
+
+void VoxelEngine::PublishSnapshot() {
+    if (!m_snapshotDirty) {
+        return;
+    }
+    
+    std::vector<std::pair<ChunkCoord, VoxelBlockRef>> blocks;
+    blocks.reserve(m_chunks.size());
+    for (const auto& pair : m_chunks) {
+        blocks.emplace_back(pair.first, pair.second->GetBlock());
+    }
+    
+    auto* snapshot = new WorldSnapshot(std::move(blocks), ++m_snapshotVersion);
+    const WorldSnapshot* previous = m_published.exchange(snapshot);
+    if (previous) {
+        m_epochs.Retire(std::unique_ptr<const WorldSnapshot>(previous));
+    }
+    m_snapshotDirty = false;
+}
+
+void VoxelEngine::ReleaseAllMeshes() {
+    for (auto& pair : m_meshHandles) {
+        m_meshArena.Release(pair.second);
+    }
+    m_meshHandles.clear();
+}
+
+void VoxelEngine::ReleaseMesh(const ChunkCoord& coord) {
+    auto handle = m_meshHandles.find(coord);
+    if (handle != m_meshHandles.end()) {
+        m_meshArena.Release(handle->second);
+        m_meshHandles.erase(handle);
+    }
+}
+
+ChunkNeighbors VoxelEngine::GetNeighbors(const ChunkCoord& coord) const {
+    return ChunkNeighbors{ {
+        FindChunk(ChunkCoord{ coord.x, coord.y, coord.z + 1 }),
+        FindChunk(ChunkCoord{ coord.x, coord.y, coord.z - 1 }),
+        FindChunk(ChunkCoord{ coord.x, coord.y + 1, coord.z }),
+        FindChunk(ChunkCoord{ coord.x, coord.y - 1, coord.z }),
+        FindChunk(ChunkCoord{ coord.x + 1, coord.y, coord.z }),
+        FindChunk(ChunkCoord{ coord.x - 1, coord.y, coord.z })
+    } };
+}
+
+void VoxelEngine::InvalidateNeighborMeshes(const ChunkCoord& coord) {
+    static const ChunkCoord offsets[6] = {
+        { 0, 0, 1 }, { 0, 0, -1 }, { 0, 1, 0 }, { 0, -1, 0 }, { 1, 0, 0 }, { -1, 0, 0 }
     };
+    for (const ChunkCoord& offset : offsets) {
+        auto it = m_chunks.find(ChunkCoord{ coord.x + offset.x, coord.y + offset.y, coord.z + offset.z });
+        if (it != m_chunks.end()) {
+            it->second->InvalidateMesh();
+        }
+    }
 }
 
-VoxelChunk* VoxelEngine::GetChunk(const ChunkCoord& coord) {
+bool VoxelEngine::SetMeshCacheDirectory(const std::filesystem::path& directory) {
+    if (directory.empty()) {
+        m_meshCache.Close();
+        return true;
+    }
+    return m_meshCache.Open(directory);
+}
+
+void VoxelEngine::UpdateVisibility(const Camera* camera) {
+    m_hasVisibility = camera != nullptr;
+    if (!camera) {
+        return;
+    }
+    
+    Frustum frustum(DirectX::XMMatrixMultiply(camera->GetViewMatrix(), camera->GetProjectionMatrix()));
+    auto inView = [&frustum](const ChunkCoord& coord) {
+        DirectX::XMFLOAT3 minCorner(static_cast<float>(coord.x * CHUNK_SIZE),
+                                    static_cast<float>(coord.y * CHUNK_SIZE),
+                                    static_cast<float>(coord.z * CHUNK_SIZE));
+        DirectX::XMFLOAT3 maxCorner(minCorner.x + CHUNK_SIZE, minCorner.y + CHUNK_SIZE, minCorner.z + CHUNK_SIZE);
+        return frustum.IntersectsAabb(minCorner, maxCorner);
+    };
+    
+    for (const auto& pair : m_chunks) {
+        bool visible = inView(pair.first);
+        if (visible) {
+            m_lastVisibleFrame[pair.first] = m_frameIndex;
+        }
+        auto handle = m_meshHandles.find(pair.first);
+        if (handle != m_meshHandles.end()) {
+            m_meshArena.SetVisible(handle->second, visible);
+        }
+    }
+    
+    // Bring evicted chunks back a few at a time as they come into view
+    std::vector<ChunkCoord> reload;
+    for (const auto& pair : m_evicted) {
+        if (reload.size() == MAX_RELOADS_PER_FRAME) {
+            break;
+        }
+        if (inView(pair.first)) {
+            reload.push_back(pair.first);
+        }
+    }
+    for (const ChunkCoord& coord : reload) {
+        ReloadChunk(coord);
+    }
+}
+
+void VoxelEngine::EnforceMemoryBudget() {
+    // Meshes waiting for the cache file are written out, not dropped
+    if (m_memoryBudget.GetOverage(MemoryCategory::Cache) > 0) {
+        uint32_t pending = m_meshCache.GetStats().pending;
+        if (m_meshCache.Flush()) {
+            m_memoryBudget.RecordEvictions(MemoryCategory::Cache, pending);
+        }
+    }
+    
+    // Total also counts entities, the cache and the arena's minimum pools,
+    // which no eviction here shrinks. Meshes and voxel data take on the
+    // Total overage only when together they can cover it.
+    uint64_t meshBytes = GetTrackedBytes(MemoryCategory::MeshArena);
+    uint64_t meshFloor = m_meshArena.GetMinimumBytes();
+    uint64_t meshReclaimable = meshBytes > meshFloor ? meshBytes - meshFloor : 0;
+    uint64_t totalOverage = m_memoryBudget.GetOverage(MemoryCategory::Total);
+    if (totalOverage > meshReclaimable + GetTrackedBytes(MemoryCategory::VoxelData)) {
+        totalOverage = 0;
+    }
+    
+    uint64_t meshOverage = std::max(m_memoryBudget.GetOverage(MemoryCategory::MeshArena),
+                                    std::min(totalOverage, meshReclaimable));
+    uint64_t dataOverage = m_memoryBudget.GetOverage(MemoryCategory::VoxelData);
+    if (meshOverage == 0 && dataOverage == 0 && totalOverage == 0) {
+        return;
+    }
+    
+    // Least recently visible first; chunks never seen count as oldest
+    std::vector<std::pair<uint64_t, ChunkCoord>> candidates;
+    for (const auto& pair : m_chunks) {
+        auto seen = m_lastVisibleFrame.find(pair.first);
+        uint64_t lastVisible = seen != m_lastVisibleFrame.end() ? seen->second : 0;
+        if (lastVisible + EVICTION_MIN_AGE_FRAMES <= m_frameIndex) {
+            candidates.emplace_back(lastVisible, pair.first);
+        }
+    }
+    std::sort(candidates.begin(), candidates.end(), [](const auto& a, const auto& b) {
+        return a.first < b.first;
+    });
+    
+    // Meshes go first since they are cheap to rebuild. Freed sizes are
+    // estimates; the tracked totals catch up once the pools are trimmed.
+    uint64_t freed = 0;
+    uint32_t evictions = 0;
+    for (const auto& candidate : candidates) {
+        if (freed >= meshOverage) {
+            break;
+        }
+        auto handle = m_meshHandles.find(candidate.second);
+        if (handle == m_meshHandles.end()) {
+            continue;
+        }
+        freed += m_meshArena.GetMeshBytes(handle->second);
+        ReleaseMesh(candidate.second);
+        m_chunks[candidate.second]->InvalidateMesh();
+        ++evictions;
+    }
+    if (evictions > 0) {
+        m_memoryBudget.RecordEvictions(MemoryCategory::MeshArena, evictions);
+        m_meshArena.Trim();
+    }
+    
+    // Whatever of the Total overage the meshes did not cover falls to
+    // chunk data
+    uint64_t meshFreed = meshBytes - std::min(meshBytes, GetTrackedBytes(MemoryCategory::MeshArena));
+    if (totalOverage > meshFreed) {
+        dataOverage = std::max(dataOverage, totalOverage - meshFreed);
+    }
+    
+    // Then chunk data, in batches, measuring what came free. Blocks still
+    // referenced by undo history are not freed by eviction, so once a
+    // batch frees nothing the rest would not either.
+    freed = 0;
+    evictions = 0;
+    size_t next = 0;
+    while (freed < dataOverage && next < candidates.size()) {
+        uint64_t before = GetTrackedBytes(MemoryCategory::VoxelData);
+        uint32_t batch = 0;
+        for (; next < candidates.size() && batch < EVICTION_BATCH_CHUNKS; ++next) {
+            auto chunk = m_chunks.find(candidates[next].second);
+            if (chunk == m_chunks.end() || chunk->second->IsEmpty()) {
+                continue;
+            }
+            if (EvictChunk(candidates[next].second)) {
+                ++batch;
+            }
+        }
+        if (batch == 0) {
+            break;
+        }
+        evictions += batch;
+        
+        // The published snapshot holds the evicted blocks until replaced
+        PublishSnapshot();
+        uint64_t after = GetTrackedBytes(MemoryCategory::VoxelData);
+        if (after >= before) {
+            break;
+        }
+        freed += before - after;
+    }
+    m_memoryBudget.RecordEvictions(MemoryCategory::VoxelData, evictions);
+}
+
+bool VoxelEngine::EvictChunk(const ChunkCoord& coord) {
+    auto it = m_chunks.find(coord);
+    if (it == m_chunks.end()) {
+        return false;
+    }
+    
+    // Generated chunks depend on their neighbours, so they cannot be rebuilt
+    // on their own and always go to the page file
+    VoxelChunk& chunk = *it->second;
+    uint32_t pageSlot = m_pageFile.Write(*chunk.GetBlock());
+    if (pageSlot == ChunkPageFile::InvalidSlot) {
+        // Nowhere to persist it, so it stays resident
+        return false;
+    }
+    
+    if (m_residencyListener) {
+        m_residencyListener(coord, chunk.GetBlock(), false);
+    }
+    ReleaseMesh(coord);
+    m_chunks.erase(it);
+    m_lastVisibleFrame.erase(coord);
+    m_evicted.emplace(coord, pageSlot);
+    m_snapshotDirty = true;
+    return true;
+}
+
+VoxelChunk* VoxelEngine::ReloadChunk(const ChunkCoord& coord) {
+    auto it = m_evicted.find(coord);
+    if (it == m_evicted.end()) {
+        return nullptr;
+    }
+    
+    uint32_t pageSlot = it->second;
+    m_evicted.erase(it);
+    
+    auto chunk = std::make_unique<VoxelChunk>(coord.x, coord.y, coord.z);
+    VoxelBlockRef block = MakeVoxelBlock();
+    if (m_pageFile.Read(pageSlot, *block)) {
+        chunk->SetBlock(std::move(block));
+    }
+    m_pageFile.Free(pageSlot);
+    
+    VoxelChunk* ptr = chunk.get();
+    m_chunks[coord] = std::move(chunk);
+    m_lastVisibleFrame[coord] = m_frameIndex;
+    m_snapshotDirty = true;
+    
+    // Neighbours meshed while this chunk was away treated it as air
+    InvalidateNeighborMeshes(coord);
+    
+    if (m_residencyListener) {
+        m_residencyListener(coord, ptr->GetBlock(), true);
+    }
+    return ptr;
+}
+
+ChunkResidency VoxelEngine::GetResidency() const {
+    ChunkResidency residency = {};
+    residency.resident = static_cast<uint32_t>(m_chunks.size());
+    residency.evicted = static_cast<uint32_t>(m_evicted.size());
+    residency.persisted = m_pageFile.GetUsedSlots();
+    return residency;
+}
+
+void VoxelEngine::UpdateChunkMeshes() {
+    for (auto& pair : m_chunks) {
+        VoxelChunk* chunk = pair.second.get();
+        if (!chunk->IsMeshDirty()) continue;
+        
+        // Chunks out of view are meshed once they come into view
+        if (m_hasVisibility) {
+            auto seen = m_lastVisibleFrame.find(pair.first);
+            if (seen == m_lastVisibleFrame.end() || seen->second != m_frameIndex) continue;
+        }
+        
+        ChunkNeighbors neighbors = GetNeighbors(pair.first);
+        MeshHandle& handle = m_meshHandles[pair.first];
+        
+        // Cached meshes go from the mapped cache file straight into the
+        // arena. Empty chunks are cheaper to mesh than to hash.
+        uint64_t key = 0;
+        bool cacheable = m_meshCache.IsOpen() && !chunk->IsEmpty();
+        if (cacheable) {
+            key = ComputeChunkMeshKey(*chunk, neighbors);
+            CachedMesh cached;
+            if (m_meshCache.Find(key, cached)) {
+                handle = m_meshArena.Upload(handle, cached.vertices, cached.vertexCount,
+                                            cached.indices, cached.indexCount);
+                chunk->MarkMeshClean();
+                continue;
+            }
+        }
+        
+        chunk->RegenerateMesh(neighbors);
+        
+        const auto& vertices = chunk->GetVertices();
+        const auto& indices = chunk->GetIndices();
+        handle = m_meshArena.Upload(handle,
+            vertices.data(), static_cast<uint32_t>(vertices.size()),
+            indices.data(), static_cast<uint32_t>(indices.size()));
+        if (cacheable) {
+            m_meshCache.Store(key, vertices.data(), static_cast<uint32_t>(vertices.size()),
+                              indices.data(), static_cast<uint32_t>(indices.size()));
+        }
+        
+        // The arena owns the CPU copy from here on
+        chunk->ReleaseMeshData();
+    }
+    
+    // Close holes left by remeshing, a bounded slice of the pools per frame
+    m_meshArena.Defragment();
+}
+
+void VoxelEngine::RestoreChunkBlock(const ChunkCoord& coord, VoxelBlockRef block) {
+    m_snapshotDirty = true;
+    NotifyEdit(coord, -1);
+    if (block) {
+        GetOrCreateChunk(coord)->SetBlock(std::move(block));
+        InvalidateNeighborMeshes(coord);
+        return;
+    }
+    
+    m_chunks.erase(coord);
+    InvalidateNeighborMeshes(coord);
+    m_lastVisibleFrame.erase(coord);
+    ReleaseMesh(coord);
+    
+    auto evicted = m_evicted.find(coord);
+    if (evicted != m_evicted.end()) {
+        m_pageFile.Free(evicted->second);
+        m_evicted.erase(evicted);
+    }
+}
+
+VoxelEngine::EditListenerId VoxelEngine::AddEditListener(EditListener listener) {
+    EditListenerId id = m_nextEditListenerId++;
+    m_editListeners.emplace_back(id, std::move(listener));
+    return id;
+}
+
+void VoxelEngine::RemoveEditListener(EditListenerId id) {
+    m_editListeners.erase(std::remove_if(m_editListeners.begin(), m_editListeners.end(),
+        [id](const auto& entry) { return entry.first == id; }), m_editListeners.end());
+}
+
+void VoxelEngine::NotifyEdit(const ChunkCoord& coord, int voxelIndex) {
+    for (const auto& entry : m_editListeners) {
+        entry.second(coord, voxelIndex);
+    }
+}
+
+ChunkCoord VoxelEngine::WorldToChunk(int x, int y, int z) {
+    return WorldToChunkCoord(x, y, z);
+}
+
+const VoxelChunk* VoxelEngine::FindChunk(const ChunkCoord& coord) const {
     auto it = m_chunks.find(coord);
     return (it != m_chunks.end()) ? it->second.get() : nullptr;
 }
 
+VoxelChunk* VoxelEngine::GetChunk(const ChunkCoord& coord) {
+    auto it = m_chunks.find(coord);
+    if (it != m_chunks.end()) {
+        return it->second.get();
+    }
+    return ReloadChunk(coord);
+}
+
 VoxelChunk* VoxelEngine::GetOrCreateChunk(const ChunkCoord& coord) {
     auto it = m_chunks.find(coord);
     if (it != m_chunks.end()) {
         return it->second.get();
     }
+    if (VoxelChunk* reloaded = ReloadChunk(coord)) {
+        return reloaded;
+    }
     
     auto chunk = std::make_unique<VoxelChunk>(coord.x, coord.y, coord.z);
     VoxelChunk* ptr = chunk.get();
@@ -1,33 +1,34 @@
 #pragma once
 
+#include <atomic>
 #include <cstdint>
+#include <filesystem>
+#include <functional>
 #include <memory>
 #include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "ChunkPageFile.h"
+#include "MemoryBudget.h"
+#include "MeshArena.h"
+#include "MeshCache.h"
+#include "VoxelChunk.h"
+#include "WorldSnapshot.h"
 
-class VoxelChunk;
 class Renderer;
 class Camera;
+class ThreadPool;
 
-struct ChunkCoord {
-    int x, y, z;
-    
-    bool operator==(const ChunkCoord& other) const {
-        return x == other.x && y == other.y && z == other.z;
-    }
+struct ChunkResidency {
+    uint32_t resident;
+    uint32_t evicted;
+    uint32_t persisted;     // evicted chunks held in the page file
 };
 
-namespace std {
-    template <>
-    struct hash<ChunkCoord> {
-        size_t operator()(const ChunkCoord& coord) const {
-            return hash<int>()(coord.x) ^ (hash<int>()(coord.y) << 1) ^ (hash<int>()(coord.z) << 2);
-        }
-    };
-}
-
 class VoxelEngine {
 public:
-    VoxelEngine();
+    // Without a thread pool terrain is generated synchronously
+    explicit VoxelEngine(ThreadPool* threadPool = nullptr);
     ~VoxelEngine();
     
     void Initialize();
@@ -37,13 +38,163 @@ public:
     void SetVoxel(int x, int y, int z, uint8_t blockType);
     uint8_t GetVoxel(int x, int y, int z);
     
+    // Starts building a new world in the background, nearest chunks to the
+    // generation focus first. The current world keeps rendering until the
+    // swap threshold fraction of the new one is ready; calling again with a
+    // new seed cancels the build in flight. Edits made to the old world
+    // while a build is running are discarded at the swap. Edits after the
+    // swap to chunks that have not streamed in yet are held back and
+    // replayed onto the streamed terrain.
     void GenerateTerrain(int seed);
+    int GetSeed() const { return m_seed; }
+    void CancelTerrainGeneration();
+    void WaitForTerrain();
+    bool IsGeneratingTerrain() const { return m_terrainJob != nullptr; }
+    float GetTerrainProgress() const;
+    
+    void SetGenerationFocus(float x, float y, float z);
+    void SetSwapThreshold(float fraction);
+    void SetWorldRadius(int chunks);
+    
+    // Read-only chunk access for batch systems that walk many voxels
+    const VoxelChunk* FindChunk(const ChunkCoord& coord) const;
+    bool HasChunk(const ChunkCoord& coord) const { return m_chunks.count(coord) != 0; }
+    static ChunkCoord WorldToChunk(int x, int y, int z);
+    
+    template <typename Fn>
+    void ForEachChunk(Fn&& fn) const {
+        for (const auto& pair : m_chunks) {
+            fn(pair.first, *pair.second);
+        }
+    }
+    
+    // Worker threads read the world through readers, wait-free, while the
+    // owning thread keeps editing. Readers see the last published snapshot;
+    // Update publishes once per frame if anything changed.
+    VoxelReader CreateReader() const { return VoxelReader(&m_epochs, &m_published); }
+    void PublishSnapshot();
+    uint64_t GetSnapshotVersion() const { return m_snapshotVersion; }
+    
+    // Over budget, Render evicts the meshes of the chunks that have been out
+    // of view the longest, then their voxel data, which goes to a page
+    // file. Evicted chunks come back when they enter the view or are read or edited
+    // through this class; const lookups (FindChunk, readers, physics) see
+    // them as air until then. The Total budget only causes evictions when
+    // meshes and voxel data can cover its overage by themselves.
+    MemoryBudget& GetMemoryBudget() { return m_memoryBudget; }
+    const MemoryBudget& GetMemoryBudget() const { return m_memoryBudget; }
+    ChunkResidency GetResidency() const;
+    bool IsChunkEvicted(const ChunkCoord& coord) const { return m_evicted.count(coord) != 0; }
+    
+    template <typename Fn>
+    void ForEachEvictedChunk(Fn&& fn) const {
+        for (const auto& pair : m_evicted) {
+            fn(pair.first);
+        }
+    }
+    
+    // Called with resident = false just before a chunk is evicted and with
+    // resident = true right after it is loaded back
+    using ResidencyListener = std::function<void(const ChunkCoord& coord, const VoxelBlockRef& block, bool resident)>;
+    void SetResidencyListener(ResidencyListener listener) { m_residencyListener = std::move(listener); }
+    
+    // Called for each chunk that streams in after a world swap, before the
+    // edit listeners; the block is the generated terrain, without the edits
+    // held back for the chunk, which the resident block already has.
+    using StreamListener = std::function<void(const ChunkCoord& coord, const VoxelBlockRef& block)>;
+    void SetStreamListener(StreamListener listener) { m_streamListener = std::move(listener); }
+    
+    // Called when a resident chunk's voxels change: with the chunk-local
+    // voxel index for SetVoxel and with -1 when the whole block is replaced
+    // (undo/redo, chunks streaming in after a world swap). Replacing the
+    // whole world is signalled by GetWorldGeneration instead. Listeners
+    // are called in the order they were added.
+    using EditListener = std::function<void(const ChunkCoord& coord, int voxelIndex)>;
+    using EditListenerId = uint32_t;
+    EditListenerId AddEditListener(EditListener listener);
+    void RemoveEditListener(EditListenerId id);
+    
+    // Swaps a chunk's voxel block (used by undo/redo); null removes the chunk
+    void RestoreChunkBlock(const ChunkCoord& coord, VoxelBlockRef block);
+    
+    // Changes whenever the whole world is replaced, e.g. by GenerateTerrain
+    uint32_t GetWorldGeneration() const { return m_worldGeneration; }
+    
+    // Called right after the whole world is replaced, before any chunk of
+    // the new world can be edited
+    using WorldReplacedListener = std::function<void()>;
+    void SetWorldReplacedListener(WorldReplacedListener listener) { m_worldReplacedListener = std::move(listener); }
+    
+    // Chunk meshes are looked up in this cache before being built; an empty
+    // path turns the cache off. Returns false if the directory is unusable.
+    bool SetMeshCacheDirectory(const std::filesystem::path& directory);
+    const MeshCache& GetMeshCache() const { return m_meshCache; }
+    
+    const MeshArena& GetMeshArena() const { return m_meshArena; }
+    const std::vector<DrawIndexedIndirectArgs>& GetDrawCommands() const { return m_drawCommands; }
     
 private:
-    ChunkCoord WorldToChunk(int x, int y, int z);
     VoxelChunk* GetChunk(const ChunkCoord& coord);
     VoxelChunk* GetOrCreateChunk(const ChunkCoord& coord);
     
+    void UpdateChunkMeshes();
+    void DrainTerrainJob();
+    void SwapInPendingWorld();
+    void ApplyHeldEdits();
+    void ReleaseAllMeshes();
+    void ReleaseMesh(const ChunkCoord& coord);
+    ChunkNeighbors GetNeighbors(const ChunkCoord& coord) const;
+    void InvalidateNeighborMeshes(const ChunkCoord& coord);
+    
+    void UpdateVisibility(const Camera* camera);
+    void EnforceMemoryBudget();
+    bool EvictChunk(const ChunkCoord& coord);
+    VoxelChunk* ReloadChunk(const ChunkCoord& coord);
+    void NotifyEdit(const ChunkCoord& coord, int voxelIndex);
+    
     std::unordered_map<ChunkCoord, std::unique_ptr<VoxelChunk>> m_chunks;
     int m_seed;
+    uint32_t m_worldGeneration;
+    
+    // Background terrain build; finished chunks collect in the back buffer
+    // until the swap, then go straight into m_chunks
+    struct TerrainJob;
+    ThreadPool* m_threadPool;
+    std::shared_ptr<TerrainJob> m_terrainJob;
+    std::unordered_map<ChunkCoord, std::unique_ptr<VoxelChunk>> m_pendingChunks;
+    bool m_pendingSwapped;
+    
+    // Chunks of the build that have not streamed in yet, and the voxels
+    // set in them since the swap (chunk-local index to block type)
+    std::unordered_set<ChunkCoord> m_unstreamed;
+    std::unordered_map<ChunkCoord, std::unordered_map<int, uint8_t>> m_heldEdits;
+    float m_swapThreshold;
+    float m_focusX, m_focusY, m_focusZ;
+    int m_worldRadius;
+    
+    // Published world for concurrent readers
+    mutable EpochManager m_epochs;
+    std::atomic<const WorldSnapshot*> m_published;
+    uint64_t m_snapshotVersion;
+    bool m_snapshotDirty;
+    
+    // Residency; evicted chunks map to their page file slot
+    std::unordered_map<ChunkCoord, uint32_t> m_evicted;
+    std::unordered_map<ChunkCoord, uint64_t> m_lastVisibleFrame;
+    uint64_t m_frameIndex;
+    bool m_hasVisibility;
+    MemoryBudget m_memoryBudget;
+    ChunkPageFile m_pageFile;
+    ResidencyListener m_residencyListener;
+    StreamListener m_streamListener;
+    WorldReplacedListener m_worldReplacedListener;
+    std::vector<std::pair<EditListenerId, EditListener>> m_editListeners;
+    EditListenerId m_nextEditListenerId;
+    
+    // All chunk meshes live in one arena and are drawn with a single
+    // indirect argument array instead of one buffer and draw per chunk
+    MeshArena m_meshArena;
+    std::unordered_map<ChunkCoord, MeshHandle> m_meshHandles;
+    std::vector<DrawIndexedIndirectArgs> m_drawCommands;
+    MeshCache m_meshCache;
 };
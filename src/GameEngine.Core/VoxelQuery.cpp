@@ -0,0 +1,494 @@
+#include "VoxelQuery.h"
+#include "ThreadPool.h"
+#include "VoxelEngine.h"
+#include "WorldSnapshot.h"
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <emmintrin.h>
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    // Voxels per SSE2 compare; chunk rows are whole groups
+    constexpr int GROUP_SIZE = 16;
+    static_assert(CHUNK_SIZE % GROUP_SIZE == 0, "chunk rows must be a multiple of the SSE2 group size");
+
+    // Chunks searched per round by FindFirst and Collect, which stop early
+    constexpr size_t ROUND_CHUNKS = 64;
+
+    enum class ChunkOutcome : uint8_t {
+        Skipped,
+        Summarized,
+        Scanned
+    };
+
+    struct ChunkResult {
+        ChunkOutcome outcome;
+        uint64_t compared;
+    };
+
+    // Bits of a group starting at `x` that fall inside [x0, x1]
+    uint32_t SpanMask(int x, int x0, int x1) {
+        int low = std::max(x0 - x, 0);
+        int high = std::min(x1 - x, GROUP_SIZE - 1);
+        return ((2u << high) - 1) & ~((1u << low) - 1);
+    }
+
+    // Squared distance from the sphere centre to the nearest and farthest
+    // points of a chunk's cube
+    void ChunkDistances(const VoxelRegion& region, const ChunkCoord& coord, double& nearest, double& farthest) {
+        const int origin[3] = { ChunkLayout::ToWorld(coord.x), ChunkLayout::ToWorld(coord.y), ChunkLayout::ToWorld(coord.z) };
+        const double center[3] = { region.centerX, region.centerY, region.centerZ };
+        nearest = 0.0;
+        farthest = 0.0;
+        for (int axis = 0; axis < 3; ++axis) {
+            double low = origin[axis] - center[axis];
+            double high = origin[axis] + CHUNK_SIZE - center[axis];
+            double closest = low > 0.0 ? low : (high < 0.0 ? high : 0.0);
+            double furthest = std::max(std::abs(low), std::abs(high));
+            nearest += closest * closest;
+            farthest += furthest * furthest;
+        }
+    }
+
+    bool ChunkInsideBounds(const VoxelRegion& region, const ChunkCoord& coord) {
+        int x = ChunkLayout::ToWorld(coord.x);
+        int y = ChunkLayout::ToWorld(coord.y);
+        int z = ChunkLayout::ToWorld(coord.z);
+        return x >= region.minX && x + CHUNK_SIZE - 1 <= region.maxX &&
+               y >= region.minY && y + CHUNK_SIZE - 1 <= region.maxY &&
+               z >= region.minZ && z + CHUNK_SIZE - 1 <= region.maxZ;
+    }
+
+    // Walks the rows of one chunk that can hold `voxel` inside the region.
+    // Rows known to match entirely go to visitor.Span(x0, x1, y, z), others
+    // are compared and each group with matches goes to visitor.Group(x, y,
+    // z, mask), where bit i stands for voxel x + i. Coordinates are world
+    // coordinates; a visitor returning false ends the walk.
+    template <typename Visitor>
+    ChunkResult VisitChunk(const VoxelRegion& region, const ChunkCoord& coord, const VoxelBlock& block, uint8_t voxel,
+                           Visitor& visitor) {
+        ChunkResult result = { ChunkOutcome::Skipped, 0 };
+        uint32_t bucket = VoxelTypeBucket(voxel);
+        if (block.typeCounts[bucket] == 0) {
+            return result;
+        }
+
+        int originX = ChunkLayout::ToWorld(coord.x);
+        int originY = ChunkLayout::ToWorld(coord.y);
+        int originZ = ChunkLayout::ToWorld(coord.z);
+        int x0 = std::max(region.minX - originX, 0), x1 = std::min(region.maxX - originX, CHUNK_SIZE - 1);
+        int y0 = std::max(region.minY - originY, 0), y1 = std::min(region.maxY - originY, CHUNK_SIZE - 1);
+        int z0 = std::max(region.minZ - originZ, 0), z1 = std::min(region.maxZ - originZ, CHUNK_SIZE - 1);
+
+        bool air = voxel == static_cast<uint8_t>(BlockType::Air);
+        if (!air) {
+            y0 = std::max(y0, block.minSolidY);
+            y1 = std::min(y1, block.maxSolidY);
+        }
+        bool uniform = bucket < BLOCK_TYPE_COUNT && block.typeCounts[bucket] == static_cast<uint32_t>(CHUNK_VOLUME);
+
+        const __m128i needle = _mm_set1_epi8(static_cast<char>(voxel));
+        bool matched = false;
+        for (int z = z0; z <= z1; ++z) {
+            for (int y = y0; y <= y1; ++y) {
+                int rowX0 = originX + x0;
+                int rowX1 = originX + x1;
+                if (!region.ClipRow(originY + y, originZ + z, rowX0, rowX1)) {
+                    continue;
+                }
+
+                // Layers without solid voxels are all air
+                if (uniform || (air && block.layerSolidCounts[y] == 0)) {
+                    matched = true;
+                    if (result.outcome == ChunkOutcome::Skipped) {
+                        result.outcome = ChunkOutcome::Summarized;
+                    }
+                    if (!visitor.Span(rowX0, rowX1, originY + y, originZ + z)) {
+                        return result;
+                    }
+                    continue;
+                }
+
+                result.outcome = ChunkOutcome::Scanned;
+                const uint8_t* row = block.voxels + LocalVoxelIndex(0, y, z);
+                int localX0 = rowX0 - originX;
+                int localX1 = rowX1 - originX;
+                for (int x = localX0 & ~(GROUP_SIZE - 1); x <= localX1; x += GROUP_SIZE) {
+                    __m128i voxels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + x));
+                    uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(voxels, needle)));
+                    mask &= SpanMask(x, localX0, localX1);
+                    result.compared += GROUP_SIZE;
+                    if (mask) {
+                        matched = true;
+                        if (!visitor.Group(originX + x, originY + y, originZ + z, mask)) {
+                            return result;
+                        }
+                    }
+                }
+            }
+        }
+
+        // A summarized chunk whose rows all fell outside a sphere was skipped
+        if (result.outcome == ChunkOutcome::Summarized && !matched) {
+            result.outcome = ChunkOutcome::Skipped;
+        }
+        return result;
+    }
+
+    struct CountVisitor {
+        uint64_t count = 0;
+
+        bool Span(int x0, int x1, int, int) {
+            count += static_cast<uint64_t>(x1 - x0 + 1);
+            return true;
+        }
+        bool Group(int, int, int, uint32_t mask) {
+            count += std::popcount(mask);
+            return true;
+        }
+    };
+
+    struct CollectVisitor {
+        std::vector<VoxelPosition> positions;
+        size_t limit;
+
+        bool Span(int x0, int x1, int y, int z) {
+            for (int x = x0; x <= x1 && positions.size() < limit; ++x) {
+                positions.push_back(VoxelPosition{ x, y, z });
+            }
+            return positions.size() < limit;
+        }
+        bool Group(int x, int y, int z, uint32_t mask) {
+            while (mask && positions.size() < limit) {
+                positions.push_back(VoxelPosition{ x + std::countr_zero(mask), y, z });
+                mask &= mask - 1;
+            }
+            return positions.size() < limit;
+        }
+    };
+
+    void Tally(VoxelQueryStats& stats, const ChunkResult& result) {
+        switch (result.outcome) {
+        case ChunkOutcome::Skipped:    ++stats.chunksSkipped; break;
+        case ChunkOutcome::Summarized: ++stats.chunksSummarized; break;
+        case ChunkOutcome::Scanned:    ++stats.chunksScanned; break;
+        }
+        stats.voxelsCompared += result.compared;
+    }
+
+    uint32_t Hash(uint32_t value) {
+        value ^= value >> 16;
+        value *= 0x7FEB352Du;
+        value ^= value >> 15;
+        value *= 0x846CA68Bu;
+        value ^= value >> 16;
+        return value;
+    }
+}
+
+VoxelRegion VoxelRegion::Box(int x0, int y0, int z0, int x1, int y1, int z1) {
+    VoxelRegion region = {};
+    region.minX = std::min(x0, x1);
+    region.minY = std::min(y0, y1);
+    region.minZ = std::min(z0, z1);
+    region.maxX = std::max(x0, x1);
+    region.maxY = std::max(y0, y1);
+    region.maxZ = std::max(z0, z1);
+    return region;
+}
+
+VoxelRegion VoxelRegion::Sphere(float x, float y, float z, float radius) {
+    VoxelRegion region = {};
+    region.sphere = true;
+    region.centerX = x;
+    region.centerY = y;
+    region.centerZ = z;
+    region.radius = std::max(radius, 0.0f);
+
+    // Voxel v is inside when |v + 0.5 - centre| <= radius on every axis at least
+    region.minX = static_cast<int>(std::ceil(region.centerX - region.radius - 0.5));
+    region.minY = static_cast<int>(std::ceil(region.centerY - region.radius - 0.5));
+    region.minZ = static_cast<int>(std::ceil(region.centerZ - region.radius - 0.5));
+    region.maxX = static_cast<int>(std::floor(region.centerX + region.radius - 0.5));
+    region.maxY = static_cast<int>(std::floor(region.centerY + region.radius - 0.5));
+    region.maxZ = static_cast<int>(std::floor(region.centerZ + region.radius - 0.5));
+    return region;
+}
+
+bool VoxelRegion::Contains(int x, int y, int z) const {
+    if (x < minX || x > maxX || y < minY || y > maxY || z < minZ || z > maxZ) {
+        return false;
+    }
+    int x0 = x;
+    int x1 = x;
+    return ClipRow(y, z, x0, x1);
+}
+
+bool VoxelRegion::ClipRow(int y, int z, int& x0, int& x1) const {
+    if (sphere) {
+        double dy = y + 0.5 - centerY;
+        double dz = z + 0.5 - centerZ;
+        double remaining = radius * radius - dy * dy - dz * dz;
+        if (remaining < 0.0) {
+            return false;
+        }
+        double half = std::sqrt(remaining);
+        x0 = std::max(x0, static_cast<int>(std::ceil(centerX - half - 0.5)));
+        x1 = std::min(x1, static_cast<int>(std::floor(centerX + half - 0.5)));
+    }
+    return x0 <= x1;
+}
+
+VoxelQuery::VoxelQuery(const VoxelEngine& engine, ThreadPool* threadPool)
+    : m_threadPool(threadPool)
+    , m_stats{}
+{
+    m_findBlock = [&engine](const ChunkCoord& coord) -> const VoxelBlock* {
+        const VoxelChunk* chunk = engine.FindChunk(coord);
+        return chunk ? chunk->GetBlock().get() : nullptr;
+    };
+    m_forEachBlock = [&engine](const BlockVisitor& visit) {
+        engine.ForEachChunk([&](const ChunkCoord& coord, const VoxelChunk& chunk) {
+            visit(coord, *chunk.GetBlock());
+        });
+    };
+    m_countChunks = [&engine] { return static_cast<size_t>(engine.GetResidency().resident); };
+}
+
+VoxelQuery::VoxelQuery(const WorldSnapshot& snapshot, ThreadPool* threadPool)
+    : m_threadPool(threadPool)
+    , m_stats{}
+{
+    m_findBlock = [&snapshot](const ChunkCoord& coord) { return snapshot.FindBlock(coord); };
+    m_forEachBlock = [&snapshot](const BlockVisitor& visit) { snapshot.ForEachBlock(visit); };
+    m_countChunks = [&snapshot] { return snapshot.GetChunkCount(); };
+}
+
+void VoxelQuery::GatherCandidates(const VoxelRegion& region) {
+    m_candidates.clear();
+    m_stats = {};
+    if (region.IsEmpty()) {
+        return;
+    }
+
+    ChunkCoord low = WorldToChunkCoord(region.minX, region.minY, region.minZ);
+    ChunkCoord high = WorldToChunkCoord(region.maxX, region.maxY, region.maxZ);
+    uint64_t span = static_cast<uint64_t>(high.x - low.x + 1) * static_cast<uint64_t>(high.y - low.y + 1) *
+                    static_cast<uint64_t>(high.z - low.z + 1);
+
+    // Look up every chunk in range, or filter the loaded ones when the
+    // range is the larger of the two
+    if (span <= m_countChunks()) {
+        for (int cz = low.z; cz <= high.z; ++cz) {
+            for (int cy = low.y; cy <= high.y; ++cy) {
+                for (int cx = low.x; cx <= high.x; ++cx) {
+                    ChunkCoord coord{ cx, cy, cz };
+                    if (const VoxelBlock* block = m_findBlock(coord)) {
+                        m_candidates.push_back(Candidate{ coord, block });
+                    }
+                }
+            }
+        }
+    } else {
+        m_forEachBlock([&](const ChunkCoord& coord, const VoxelBlock& block) {
+            if (coord.x >= low.x && coord.x <= high.x && coord.y >= low.y && coord.y <= high.y &&
+                coord.z >= low.z && coord.z <= high.z) {
+                m_candidates.push_back(Candidate{ coord, &block });
+            }
+        });
+        std::sort(m_candidates.begin(), m_candidates.end(), [](const Candidate& a, const Candidate& b) {
+            if (a.coord.z != b.coord.z) return a.coord.z < b.coord.z;
+            if (a.coord.y != b.coord.y) return a.coord.y < b.coord.y;
+            return a.coord.x < b.coord.x;
+        });
+    }
+    m_stats.chunks = static_cast<uint32_t>(m_candidates.size());
+
+    // Spheres also drop the chunks in range that they do not reach
+    if (region.sphere) {
+        double radiusSquared = region.radius * region.radius;
+        auto outside = [&](const Candidate& candidate) {
+            double nearest, farthest;
+            ChunkDistances(region, candidate.coord, nearest, farthest);
+            return nearest > radiusSquared;
+        };
+        size_t before = m_candidates.size();
+        m_candidates.erase(std::remove_if(m_candidates.begin(), m_candidates.end(), outside), m_candidates.end());
+        m_stats.chunksSkipped += static_cast<uint32_t>(before - m_candidates.size());
+    }
+}
+
+void VoxelQuery::RunParallel(size_t begin, size_t end, const std::function<void(size_t)>& fn) {
+    if (!m_threadPool || end - begin < 2) {
+        for (size_t i = begin; i < end; ++i) {
+            fn(i);
+        }
+        return;
+    }
+    m_threadPool->ParallelFor(end - begin, 1, [&](size_t rangeBegin, size_t rangeEnd) {
+        for (size_t i = rangeBegin; i < rangeEnd; ++i) {
+            fn(begin + i);
+        }
+    });
+}
+
+uint64_t VoxelQuery::Count(const VoxelRegion& region, uint8_t voxel) {
+    auto start = Clock::now();
+    GatherCandidates(region);
+
+    std::vector<uint64_t> counts(m_candidates.size(), 0);
+    std::vector<ChunkResult> results(m_candidates.size());
+    bool exact = VoxelTypeBucket(voxel) < BLOCK_TYPE_COUNT;
+    double radiusSquared = region.radius * region.radius;
+    RunParallel(0, m_candidates.size(), [&](size_t i) {
+        const Candidate& candidate = m_candidates[i];
+
+        // A chunk wholly inside the region contributes its whole histogram
+        // entry. Sphere containment is tested on the chunk's outer corners,
+        // half a voxel beyond the outermost voxel centres.
+        bool inside = exact && ChunkInsideBounds(region, candidate.coord);
+        if (inside && region.sphere) {
+            double nearest, farthest;
+            ChunkDistances(region, candidate.coord, nearest, farthest);
+            inside = farthest <= radiusSquared;
+        }
+        if (inside) {
+            counts[i] = candidate.block->typeCounts[VoxelTypeBucket(voxel)];
+            results[i] = ChunkResult{ counts[i] ? ChunkOutcome::Summarized : ChunkOutcome::Skipped, 0 };
+            return;
+        }
+
+        CountVisitor visitor;
+        results[i] = VisitChunk(region, candidate.coord, *candidate.block, voxel, visitor);
+        counts[i] = visitor.count;
+    });
+
+    uint64_t total = 0;
+    for (size_t i = 0; i < m_candidates.size(); ++i) {
+        total += counts[i];
+        Tally(m_stats, results[i]);
+    }
+    m_stats.milliseconds = std::chrono::duration<float, std::milli>(Clock::now() - start).count();
+    return total;
+}
+
+bool VoxelQuery::FindFirst(const VoxelRegion& region, uint8_t voxel, VoxelPosition& position) {
+    std::vector<VoxelPosition> found;
+    if (Collect(region, voxel, found, 1) == 0) {
+        return false;
+    }
+    position = found.front();
+    return true;
+}
+
+size_t VoxelQuery::Collect(const VoxelRegion& region, uint8_t voxel, std::vector<VoxelPosition>& positions,
+                           size_t limit) {
+    auto start = Clock::now();
+    GatherCandidates(region);
+
+    // Rounds of chunks are searched in parallel and merged in order, so the
+    // search stops soon after the limit is reached
+    size_t appended = 0;
+    std::vector<CollectVisitor> visitors(ROUND_CHUNKS);
+    std::vector<ChunkResult> results(ROUND_CHUNKS);
+    for (size_t begin = 0; begin < m_candidates.size() && appended < limit; begin += ROUND_CHUNKS) {
+        size_t end = std::min(begin + ROUND_CHUNKS, m_candidates.size());
+        RunParallel(begin, end, [&](size_t i) {
+            CollectVisitor& visitor = visitors[i - begin];
+            visitor.positions.clear();
+            visitor.limit = limit - appended;
+            const Candidate& candidate = m_candidates[i];
+            results[i - begin] = VisitChunk(region, candidate.coord, *candidate.block, voxel, visitor);
+        });
+
+        for (size_t i = begin; i < end; ++i) {
+            // Chunks past the limit were searched but contribute nothing
+            const std::vector<VoxelPosition>& found = visitors[i - begin].positions;
+            size_t take = std::min(found.size(), limit - appended);
+            positions.insert(positions.end(), found.begin(), found.begin() + take);
+            appended += take;
+            Tally(m_stats, results[i - begin]);
+        }
+    }
+    m_stats.milliseconds = std::chrono::duration<float, std::milli>(Clock::now() - start).count();
+    return appended;
+}
+
+VoxelQueryBenchmarkStats MeasureVoxelQueries(int seed, int worldRadius, int queryRadius, uint32_t queries,
+                                             ThreadPool* threadPool) {
+    VoxelEngine world(threadPool);
+    world.SetWorldRadius(worldRadius);
+    world.GenerateTerrain(seed);
+    world.WaitForTerrain();
+
+    VoxelQueryBenchmarkStats stats = {};
+    stats.queries = queries;
+    VoxelQuery query(world, threadPool);
+    double naiveSeconds = 0.0;
+    double querySeconds = 0.0;
+    int extent = std::max(worldRadius, 1) * CHUNK_SIZE;
+    std::vector<VoxelPosition> collected;
+
+    for (uint32_t i = 0; i < queries; ++i) {
+        // Centres near the terrain surface, alternating boxes and spheres
+        int x = static_cast<int>(Hash(i * 3) % (2 * extent)) - extent;
+        int y = static_cast<int>(Hash(i * 3 + 1) % 32) - 8;
+        int z = static_cast<int>(Hash(i * 3 + 2) % (2 * extent)) - extent;
+        VoxelRegion region = (i % 2 == 0)
+            ? VoxelRegion::Box(x - queryRadius, y - queryRadius, z - queryRadius,
+                               x + queryRadius, y + queryRadius, z + queryRadius)
+            : VoxelRegion::Sphere(x + 0.5f, y + 0.5f, z + 0.5f, static_cast<float>(queryRadius));
+
+        for (uint8_t type = 0; type < BLOCK_TYPE_COUNT; ++type) {
+            auto naiveStart = Clock::now();
+            uint64_t expected = 0;
+            for (int vz = region.minZ; vz <= region.maxZ; ++vz) {
+                for (int vy = region.minY; vy <= region.maxY; ++vy) {
+                    for (int vx = region.minX; vx <= region.maxX; ++vx) {
+                        // Only loaded chunks take part, as in VoxelQuery
+                        if (region.Contains(vx, vy, vz) && world.GetVoxel(vx, vy, vz) == type &&
+                            world.HasChunk(VoxelEngine::WorldToChunk(vx, vy, vz))) {
+                            ++expected;
+                        }
+                    }
+                }
+            }
+            auto queryStart = Clock::now();
+            uint64_t count = query.Count(region, type);
+            auto queryEnd = Clock::now();
+            naiveSeconds += std::chrono::duration<double>(queryStart - naiveStart).count();
+            querySeconds += std::chrono::duration<double>(queryEnd - queryStart).count();
+
+            const VoxelQueryStats& last = query.GetLastStats();
+            stats.totals.chunks += last.chunks;
+            stats.totals.chunksSkipped += last.chunksSkipped;
+            stats.totals.chunksSummarized += last.chunksSummarized;
+            stats.totals.chunksScanned += last.chunksScanned;
+            stats.totals.voxelsCompared += last.voxelsCompared;
+            stats.matches += count;
+
+            // Collect and FindFirst must agree with the count
+            collected.clear();
+            VoxelPosition first = {};
+            bool found = query.FindFirst(region, type, first);
+            query.Collect(region, type, collected);
+            bool consistent = collected.size() == count && found == (count > 0) &&
+                              (!found || (first.x == collected[0].x && first.y == collected[0].y &&
+                                          first.z == collected[0].z));
+            if (count != expected || !consistent) {
+                ++stats.mismatches;
+            }
+        }
+    }
+
+    stats.naiveMilliseconds = static_cast<float>(naiveSeconds * 1000.0);
+    stats.queryMilliseconds = static_cast<float>(querySeconds * 1000.0);
+    stats.totals.milliseconds = stats.queryMilliseconds;
+    if (querySeconds > 0.0) {
+        stats.speedup = static_cast<float>(naiveSeconds / querySeconds);
+    }
+    return stats;
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include "VoxelChunk.h"
+
+class ThreadPool;
+class VoxelEngine;
+class WorldSnapshot;
+
+// Voxels inside an inclusive box, or whose centres lie inside a sphere
+struct VoxelRegion {
+    int minX, minY, minZ;           // bounds; empty when a min exceeds its max
+    int maxX, maxY, maxZ;
+    bool sphere;
+    double centerX, centerY, centerZ;
+    double radius;
+
+    // Corners may be given in any order
+    static VoxelRegion Box(int x0, int y0, int z0, int x1, int y1, int z1);
+    static VoxelRegion Sphere(float x, float y, float z, float radius);
+
+    bool IsEmpty() const { return minX > maxX || minY > maxY || minZ > maxZ; }
+    bool Contains(int x, int y, int z) const;
+
+    // Narrows [x0, x1] to the voxels of row (y, z) inside the region;
+    // false if none are
+    bool ClipRow(int y, int z, int& x0, int& x1) const;
+};
+
+struct VoxelQueryStats {
+    uint32_t chunks;                // loaded chunks overlapping the region's bounds
+    uint32_t chunksSkipped;         // ruled out by their summaries or the region's shape
+    uint32_t chunksSummarized;      // answered from summaries without reading voxels
+    uint32_t chunksScanned;
+    uint64_t voxelsCompared;
+    float milliseconds;
+};
+
+// Aggregate voxel queries over loaded chunks. Each chunk is first tested
+// against its block summary: chunks without the value, and for solid values
+// rows outside the solid y range, are skipped; chunks of a single value,
+// all-air rows, and for counts chunks wholly inside the region, are
+// answered from the summary. The remaining rows are compared 16 voxels at
+// a time with SSE2.
+//
+// Matches are reported in scan order: chunks by z, then y, then x, and
+// voxels within a chunk by z, y, x. Chunks that are not loaded (including
+// evicted ones) match nothing, not even air. With a thread pool, chunks are
+// searched in parallel and results are the same as without.
+class VoxelQuery {
+public:
+    // Over the engine's chunks, from the thread that edits the world
+    explicit VoxelQuery(const VoxelEngine& engine, ThreadPool* threadPool = nullptr);
+    // Over a published snapshot, from any thread that keeps it pinned
+    explicit VoxelQuery(const WorldSnapshot& snapshot, ThreadPool* threadPool = nullptr);
+
+    uint64_t Count(const VoxelRegion& region, uint8_t voxel);
+    bool FindFirst(const VoxelRegion& region, uint8_t voxel, VoxelPosition& position);
+    // Appends up to `limit` matches to `positions`; returns the number appended
+    size_t Collect(const VoxelRegion& region, uint8_t voxel, std::vector<VoxelPosition>& positions,
+                   size_t limit = SIZE_MAX);
+
+    const VoxelQueryStats& GetLastStats() const { return m_stats; }
+
+private:
+    struct Candidate {
+        ChunkCoord coord;
+        const VoxelBlock* block;
+    };
+
+    using BlockVisitor = std::function<void(const ChunkCoord&, const VoxelBlock&)>;
+
+    void GatherCandidates(const VoxelRegion& region);
+    void RunParallel(size_t begin, size_t end, const std::function<void(size_t)>& fn);
+
+    std::function<const VoxelBlock*(const ChunkCoord&)> m_findBlock;
+    std::function<void(const BlockVisitor&)> m_forEachBlock;
+    std::function<size_t()> m_countChunks;
+    ThreadPool* m_threadPool;
+    std::vector<Candidate> m_candidates;
+    VoxelQueryStats m_stats;
+};
+
+struct VoxelQueryBenchmarkStats {
+    uint32_t queries;
+    uint64_t matches;               // summed over queries
+    uint32_t mismatches;            // queries whose answer differs from GetVoxel; must be 0
+    float naiveMilliseconds;        // one GetVoxel per voxel
+    float queryMilliseconds;
+    float speedup;
+    VoxelQueryStats totals;         // pruning summed over queries
+};
+
+// Generates a scratch world and counts every block type in boxes and
+// spheres of `queryRadius` around pseudo-random points near the surface,
+// once with VoxelQuery and once with one GetVoxel per voxel
+VoxelQueryBenchmarkStats MeasureVoxelQueries(int seed, int worldRadius, int queryRadius, uint32_t queries,
+                                             ThreadPool* threadPool);
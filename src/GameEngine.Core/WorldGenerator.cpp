@@ -0,0 +1,529 @@
+#include "WorldGenerator.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+namespace {
+    // World layout
+    constexpr int WORLD_MIN_CHUNK_Y = -1;
+    constexpr int WORLD_MAX_CHUNK_Y = 1;
+    constexpr float TERRAIN_BASE_HEIGHT = 8.0f;
+    constexpr float TERRAIN_AMPLITUDE = 14.0f;
+    constexpr float TERRAIN_FREQUENCY = 0.02f;
+    constexpr int TERRAIN_OCTAVES = 4;
+
+    // Caves: worm-shaped tunnels where two noise fields are both near zero
+    constexpr float CAVE_THRESHOLD = 0.015f;
+    constexpr float CAVE_MIN_COVER = 2.0f;
+
+    // Surface: up to SURFACE_DEPTH filler blocks under the top block, only
+    // near the height field so cave floors deep down stay stone
+    constexpr int SURFACE_DEPTH = 3;
+    constexpr float SURFACE_BAND = 8.0f;
+    constexpr float MOUNTAIN_HEIGHT = 17.0f;
+    constexpr float DESERT_TEMPERATURE = 0.35f;
+
+    // Trees: chance per grassland column, in 1/1000
+    constexpr uint32_t TREE_CHANCE = 12;
+
+    enum class Biome {
+        Grassland,
+        Desert,
+        Mountains
+    };
+
+    // Simple 3D Perlin-like noise function
+    float Noise3D(float x, float y, float z, int seed) {
+        uint32_t n = static_cast<uint32_t>(static_cast<int>(x * 57 + y * 113 + z * 197 + seed * 1019));
+        n = (n << 13) ^ n;
+        return 1.0f - ((n * (n * n * 15731u + 789221u) + 1376312589u) & 0x7fffffffu) / 1073741824.0f;
+    }
+
+    float PerlinNoise3D(float x, float y, float z, int seed) {
+        int xi = static_cast<int>(std::floor(x));
+        int yi = static_cast<int>(std::floor(y));
+        int zi = static_cast<int>(std::floor(z));
+
+        float xf = x - xi;
+        float yf = y - yi;
+        float zf = z - zi;
+
+        // Smoothstep
+        float u = xf * xf * (3 - 2 * xf);
+        float v = yf * yf * (3 - 2 * yf);
+        float w = zf * zf * (3 - 2 * zf);
+
+        // Sample corners
+        float n000 = Noise3D(static_cast<float>(xi), static_cast<float>(yi), static_cast<float>(zi), seed);
+        float n100 = Noise3D(static_cast<float>(xi + 1), static_cast<float>(yi), static_cast<float>(zi), seed);
+        float n010 = Noise3D(static_cast<float>(xi), static_cast<float>(yi + 1), static_cast<float>(zi), seed);
+        float n110 = Noise3D(static_cast<float>(xi + 1), static_cast<float>(yi + 1), static_cast<float>(zi), seed);
+        float n001 = Noise3D(static_cast<float>(xi), static_cast<float>(yi), static_cast<float>(zi + 1), seed);
+        float n101 = Noise3D(static_cast<float>(xi + 1), static_cast<float>(yi), static_cast<float>(zi + 1), seed);
+        float n011 = Noise3D(static_cast<float>(xi), static_cast<float>(yi + 1), static_cast<float>(zi + 1), seed);
+        float n111 = Noise3D(static_cast<float>(xi + 1), static_cast<float>(yi + 1), static_cast<float>(zi + 1), seed);
+
+        // Trilinear interpolation
+        float x00 = n000 * (1 - u) + n100 * u;
+        float x10 = n010 * (1 - u) + n110 * u;
+        float x01 = n001 * (1 - u) + n101 * u;
+        float x11 = n011 * (1 - u) + n111 * u;
+
+        float y0 = x00 * (1 - v) + x10 * v;
+        float y1 = x01 * (1 - v) + x11 * v;
+
+        return y0 * (1 - w) + y1 * w;
+    }
+
+    // Fractal Brownian motion over the xz plane, normalized to [-1, 1]
+    float FractalNoise2D(float x, float z, int octaves, int seed) {
+        float sum = 0.0f;
+        float amplitude = 1.0f;
+        float frequency = 1.0f;
+        float total = 0.0f;
+        for (int octave = 0; octave < octaves; ++octave) {
+            sum += PerlinNoise3D(x * frequency, 0.0f, z * frequency, seed + octave * 131) * amplitude;
+            total += amplitude;
+            amplitude *= 0.5f;
+            frequency *= 2.0f;
+        }
+        return sum / total;
+    }
+
+    uint32_t HashColumn(int x, int z, int seed) {
+        uint32_t h = static_cast<uint32_t>(x) * 0x8DA6B343u ^ static_cast<uint32_t>(z) * 0xD8163841u ^
+                     static_cast<uint32_t>(seed) * 0xCB1AB31Fu;
+        h ^= h >> 15;
+        h *= 0x2C1B3C6Du;
+        h ^= h >> 12;
+        h *= 0x297A2D39u;
+        h ^= h >> 15;
+        return h;
+    }
+
+    float TerrainHeight(int x, int z, int seed) {
+        return TERRAIN_BASE_HEIGHT +
+               TERRAIN_AMPLITUDE * FractalNoise2D(x * TERRAIN_FREQUENCY, z * TERRAIN_FREQUENCY, TERRAIN_OCTAVES, seed);
+    }
+
+    Biome GetBiome(int x, int z, float height, int seed) {
+        if (height > MOUNTAIN_HEIGHT) {
+            return Biome::Mountains;
+        }
+        float temperature = PerlinNoise3D(x * 0.008f, 0.0f, z * 0.008f, seed + 7919);
+        return temperature > DESERT_TEMPERATURE ? Biome::Desert : Biome::Grassland;
+    }
+
+    bool IsCave(int x, int y, int z, int seed) {
+        float a = PerlinNoise3D(x * 0.07f, y * 0.11f, z * 0.07f, seed + 4001);
+        float b = PerlinNoise3D(x * 0.07f, y * 0.11f, z * 0.07f, seed + 5003);
+        return a * a + b * b < CAVE_THRESHOLD;
+    }
+
+    // Stone and the surface blocks made from it; decoration is not terrain,
+    // so stages never see trees that other chunks may or may not have placed
+    bool IsTerrain(uint8_t voxel) {
+        switch (static_cast<BlockType>(voxel)) {
+        case BlockType::Grass:
+        case BlockType::Dirt:
+        case BlockType::Stone:
+        case BlockType::Sand:
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    bool IsOpen(uint8_t voxel) {
+        return voxel == static_cast<uint8_t>(BlockType::Air) || voxel == static_cast<uint8_t>(BlockType::Leaves);
+    }
+
+    // A chunk and its 26 neighbours; coordinates are relative to the centre
+    // chunk's origin and may reach one chunk out on every side
+    template <int Size>
+    struct Neighborhood {
+        using Dimensions = ChunkDimensions<Size>;
+
+        BasicVoxelChunk<Size>* chunks[27];
+        int seed;
+
+        BasicVoxelChunk<Size>& Center() const { return *chunks[13]; }
+        int WorldX(int x) const { return Dimensions::ToWorld(chunks[13]->GetChunkX()) + x; }
+        int WorldY(int y) const { return Dimensions::ToWorld(chunks[13]->GetChunkY()) + y; }
+        int WorldZ(int z) const { return Dimensions::ToWorld(chunks[13]->GetChunkZ()) + z; }
+
+        BasicVoxelChunk<Size>* Locate(int& x, int& y, int& z) const {
+            int cx = Dimensions::ToChunk(x) + 1;
+            int cy = Dimensions::ToChunk(y) + 1;
+            int cz = Dimensions::ToChunk(z) + 1;
+            x = Dimensions::ToLocal(x);
+            y = Dimensions::ToLocal(y);
+            z = Dimensions::ToLocal(z);
+            return chunks[cx + cy * 3 + cz * 9];
+        }
+
+        uint8_t Get(int x, int y, int z) const {
+            const BasicVoxelChunk<Size>* chunk = Locate(x, y, z);
+            return chunk ? chunk->GetVoxel(x, y, z) : static_cast<uint8_t>(BlockType::Air);
+        }
+
+        // Writes outside the region are dropped
+        void Set(int x, int y, int z, BlockType type) const {
+            if (BasicVoxelChunk<Size>* chunk = Locate(x, y, z)) {
+                chunk->SetVoxel(x, y, z, static_cast<uint8_t>(type));
+            }
+        }
+    };
+
+    template <int Size>
+    void GenerateDensity(const Neighborhood<Size>& hood) {
+        BasicVoxelChunk<Size>& chunk = hood.Center();
+        for (int x = 0; x < Size; ++x) {
+            for (int z = 0; z < Size; ++z) {
+                float height = TerrainHeight(hood.WorldX(x), hood.WorldZ(z), hood.seed);
+                for (int y = 0; y < Size && hood.WorldY(y) < height; ++y) {
+                    chunk.SetVoxel(x, y, z, static_cast<uint8_t>(BlockType::Stone));
+                }
+            }
+        }
+    }
+
+    template <int Size>
+    void CarveCaves(const Neighborhood<Size>& hood) {
+        BasicVoxelChunk<Size>& chunk = hood.Center();
+        if (chunk.IsEmpty()) {
+            return;
+        }
+        for (int x = 0; x < Size; ++x) {
+            for (int z = 0; z < Size; ++z) {
+                int worldX = hood.WorldX(x);
+                int worldZ = hood.WorldZ(z);
+                float ceiling = TerrainHeight(worldX, worldZ, hood.seed) - CAVE_MIN_COVER;
+                for (int y = 0; y < Size && hood.WorldY(y) < ceiling; ++y) {
+                    if (IsCave(worldX, hood.WorldY(y), worldZ, hood.seed)) {
+                        chunk.SetVoxel(x, y, z, static_cast<uint8_t>(BlockType::Air));
+                    }
+                }
+            }
+        }
+    }
+
+    template <int Size>
+    void ApplySurface(const Neighborhood<Size>& hood) {
+        BasicVoxelChunk<Size>& chunk = hood.Center();
+        if (chunk.IsEmpty()) {
+            return;
+        }
+        for (int x = 0; x < Size; ++x) {
+            for (int z = 0; z < Size; ++z) {
+                int worldX = hood.WorldX(x);
+                int worldZ = hood.WorldZ(z);
+                float height = TerrainHeight(worldX, worldZ, hood.seed);
+                Biome biome = GetBiome(worldX, worldZ, height, hood.seed);
+                if (biome == Biome::Mountains) {
+                    continue;
+                }
+                BlockType top = biome == Biome::Desert ? BlockType::Sand : BlockType::Grass;
+                BlockType filler = biome == Biome::Desert ? BlockType::Sand : BlockType::Dirt;
+
+                // Terrain blocks stacked on this column in the chunk above
+                int cover = 0;
+                while (cover <= SURFACE_DEPTH && IsTerrain(hood.Get(x, Size + cover, z))) {
+                    ++cover;
+                }
+
+                for (int y = Size - 1; y >= 0; --y) {
+                    uint8_t voxel = chunk.GetVoxel(x, y, z);
+                    if (!IsTerrain(voxel)) {
+                        cover = 0;
+                        continue;
+                    }
+                    if (cover <= SURFACE_DEPTH && hood.WorldY(y) >= height - SURFACE_BAND) {
+                        chunk.SetVoxel(x, y, z, static_cast<uint8_t>(cover == 0 ? top : filler));
+                    }
+                    cover = std::min(cover + 1, SURFACE_DEPTH + 1);
+                }
+            }
+        }
+    }
+
+    // Trees are rooted on this chunk's grass but their trunks and crowns
+    // reach into the neighbours. Wood wins over leaves and both only replace
+    // air, so the result does not depend on the order trees are placed in.
+    template <int Size>
+    void PlaceTrees(const Neighborhood<Size>& hood) {
+        BasicVoxelChunk<Size>& chunk = hood.Center();
+        if (chunk.IsEmpty()) {
+            return;
+        }
+        for (int x = 0; x < Size; ++x) {
+            for (int z = 0; z < Size; ++z) {
+                uint32_t hash = HashColumn(hood.WorldX(x), hood.WorldZ(z), hood.seed);
+                if (hash % 1000 >= TREE_CHANCE) {
+                    continue;
+                }
+
+                int root = Size - 1;
+                while (root >= 0 && !(chunk.GetVoxel(x, root, z) == static_cast<uint8_t>(BlockType::Grass) &&
+                                      IsOpen(hood.Get(x, root + 1, z)))) {
+                    --root;
+                }
+                if (root < 0) {
+                    continue;
+                }
+
+                // Trunks stop under overhangs; too little room means no tree
+                int crown = root;
+                int trunk = 4 + static_cast<int>((hash >> 10) % 3);
+                while (crown < root + trunk && IsOpen(hood.Get(x, crown + 1, z))) {
+                    ++crown;
+                }
+                if (crown - root < 3) {
+                    continue;
+                }
+                for (int dy = -2; dy <= 1; ++dy) {
+                    int radius = dy < 0 ? 2 : 1;
+                    for (int dx = -radius; dx <= radius; ++dx) {
+                        for (int dz = -radius; dz <= radius; ++dz) {
+                            bool corner = std::abs(dx) == radius && std::abs(dz) == radius;
+                            if (corner && (dy == 1 || ((hash >> (dx + dz + 16)) & 1))) {
+                                continue;
+                            }
+                            if (hood.Get(x + dx, crown + dy, z + dz) == static_cast<uint8_t>(BlockType::Air)) {
+                                hood.Set(x + dx, crown + dy, z + dz, BlockType::Leaves);
+                            }
+                        }
+                    }
+                }
+                for (int y = root + 1; y <= crown; ++y) {
+                    hood.Set(x, y, z, BlockType::Wood);
+                }
+            }
+        }
+    }
+
+    GenerationStage NeighborPrerequisite(GenerationStage stage) {
+        switch (stage) {
+        case GenerationStage::Surfaced:  return GenerationStage::Carved;
+        case GenerationStage::Decorated: return GenerationStage::Surfaced;
+        case GenerationStage::Complete:  return GenerationStage::Decorated;
+        default:                         return GenerationStage::None;
+        }
+    }
+
+    // Stages that read or write neighbouring chunks run in colour batches
+    bool TouchesNeighbors(GenerationStage stage) {
+        return stage == GenerationStage::Surfaced || stage == GenerationStage::Decorated;
+    }
+
+    int ColorOf(const ChunkCoord& coord) {
+        auto mod3 = [](int value) { return ((value % 3) + 3) % 3; };
+        return mod3(coord.x) + mod3(coord.y) * 3 + mod3(coord.z) * 9;
+    }
+}
+
+std::vector<ChunkCoord> GetWorldRegion(int radius) {
+    std::vector<ChunkCoord> region;
+    for (int cx = -radius; cx < radius; ++cx) {
+        for (int cy = WORLD_MIN_CHUNK_Y; cy <= WORLD_MAX_CHUNK_Y; ++cy) {
+            for (int cz = -radius; cz < radius; ++cz) {
+                region.push_back(ChunkCoord{ cx, cy, cz });
+            }
+        }
+    }
+    return region;
+}
+
+template <int Size>
+BasicWorldGenerator<Size>::BasicWorldGenerator(int seed, const std::vector<ChunkCoord>& order, ThreadPool* threadPool,
+                                               const std::atomic<bool>* cancelled)
+    : m_seed(seed)
+    , m_threadPool(threadPool)
+    , m_cancelled(cancelled)
+    , m_nextRequest(0)
+    , m_stats{}
+{
+    m_nodes.reserve(order.size());
+    for (const ChunkCoord& coord : order) {
+        Node& node = m_nodes[coord];
+        node.chunk = std::make_unique<Chunk>(coord.x, coord.y, coord.z);
+        node.coord = coord;
+        node.stage = GenerationStage::None;
+        node.target = GenerationStage::None;
+        m_order.push_back(&node);
+    }
+
+    // Map nodes never move, so neighbours are linked once
+    for (auto& pair : m_nodes) {
+        Node& node = pair.second;
+        for (int dz = -1; dz <= 1; ++dz) {
+            for (int dy = -1; dy <= 1; ++dy) {
+                for (int dx = -1; dx <= 1; ++dx) {
+                    auto neighbor = m_nodes.find(ChunkCoord{ node.coord.x + dx, node.coord.y + dy, node.coord.z + dz });
+                    node.neighbors[(dx + 1) + (dy + 1) * 3 + (dz + 1) * 9] =
+                        neighbor != m_nodes.end() ? &neighbor->second : nullptr;
+                }
+            }
+        }
+    }
+}
+
+template <int Size>
+BasicWorldGenerator<Size>::~BasicWorldGenerator() = default;
+
+template <int Size>
+bool BasicWorldGenerator<Size>::Step(size_t count, std::vector<std::unique_ptr<Chunk>>& completed) {
+    auto start = std::chrono::steady_clock::now();
+
+    size_t begin = m_nextRequest;
+    size_t end = std::min(begin + std::max<size_t>(count, 1), m_order.size());
+    for (size_t i = begin; i < end; ++i) {
+        Require(m_order[i], GenerationStage::Complete);
+    }
+    Settle();
+
+    bool cancelled = m_cancelled && m_cancelled->load(std::memory_order_relaxed);
+    if (!cancelled) {
+        for (size_t i = begin; i < end; ++i) {
+            completed.push_back(std::move(m_order[i]->chunk));
+        }
+        m_nextRequest = end;
+    }
+
+    m_stats.seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return !cancelled && m_nextRequest < m_order.size();
+}
+
+template <int Size>
+void BasicWorldGenerator<Size>::Require(Node* node, GenerationStage stage) {
+    // Completing a chunk needs its neighbours decorated, which needs theirs
+    // surfaced, and so on outwards
+    std::vector<std::pair<Node*, GenerationStage>> work{ { node, stage } };
+    while (!work.empty()) {
+        auto [current, required] = work.back();
+        work.pop_back();
+        if (current->target >= required) {
+            continue;
+        }
+
+        if (current->stage == current->target) {
+            m_active.push_back(current);
+        }
+        current->target = required;
+
+        GenerationStage prerequisite = NeighborPrerequisite(required);
+        if (prerequisite == GenerationStage::None) {
+            continue;
+        }
+        for (Node* neighbor : current->neighbors) {
+            if (neighbor && neighbor != current) {
+                work.emplace_back(neighbor, prerequisite);
+            }
+        }
+    }
+}
+
+template <int Size>
+bool BasicWorldGenerator<Size>::IsReady(const Node& node, GenerationStage stage) const {
+    if (static_cast<int>(node.stage) + 1 != static_cast<int>(stage) || node.target < stage) {
+        return false;
+    }
+    GenerationStage prerequisite = NeighborPrerequisite(stage);
+    for (const Node* neighbor : node.neighbors) {
+        if (neighbor && neighbor->stage < prerequisite) {
+            return false;
+        }
+    }
+    return true;
+}
+
+template <int Size>
+void BasicWorldGenerator<Size>::Settle() {
+    for (;;) {
+        bool progressed = false;
+        for (uint32_t s = 1; s < GENERATION_STAGE_COUNT; ++s) {
+            GenerationStage stage = static_cast<GenerationStage>(s);
+            if (m_cancelled && m_cancelled->load(std::memory_order_relaxed)) {
+                return;
+            }
+
+            // Advancing one colour to this stage never changes whether
+            // another colour is ready for it, so the split is done once
+            std::vector<Node*> batches[27];
+            for (Node* node : m_active) {
+                if (IsReady(*node, stage)) {
+                    batches[TouchesNeighbors(stage) ? ColorOf(node->coord) : 0].push_back(node);
+                }
+            }
+            for (const std::vector<Node*>& batch : batches) {
+                progressed |= RunBatch(stage, batch);
+            }
+        }
+
+        m_active.erase(std::remove_if(m_active.begin(), m_active.end(),
+            [](const Node* node) { return node->stage == node->target; }), m_active.end());
+        if (!progressed) {
+            return;
+        }
+    }
+}
+
+template <int Size>
+bool BasicWorldGenerator<Size>::RunBatch(GenerationStage stage, const std::vector<Node*>& batch) {
+    if (batch.empty()) {
+        return false;
+    }
+
+    std::atomic<int64_t> busyNanoseconds{ 0 };
+    auto run = [&](size_t begin, size_t end) {
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = begin; i < end; ++i) {
+            Neighborhood<Size> hood;
+            hood.seed = m_seed;
+            for (int n = 0; n < 27; ++n) {
+                Node* neighbor = batch[i]->neighbors[n];
+                hood.chunks[n] = neighbor ? neighbor->chunk.get() : nullptr;
+            }
+
+            switch (stage) {
+            case GenerationStage::Density:   GenerateDensity(hood); break;
+            case GenerationStage::Carved:    CarveCaves(hood); break;
+            case GenerationStage::Surfaced:  ApplySurface(hood); break;
+            case GenerationStage::Decorated: PlaceTrees(hood); break;
+            default: break;
+            }
+        }
+        busyNanoseconds.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start).count());
+    };
+
+    if (m_threadPool && stage != GenerationStage::Complete) {
+        m_threadPool->ParallelFor(batch.size(), 1, run);
+    } else {
+        run(0, batch.size());
+    }
+
+    // Stages are only published between batches, when no task is running
+    for (Node* node : batch) {
+        node->stage = stage;
+    }
+
+    GenerationStageStats& stats = m_stats.stages[static_cast<uint32_t>(stage)];
+    stats.chunks += static_cast<uint32_t>(batch.size());
+    stats.busySeconds += busyNanoseconds.load() * 1e-9;
+    ++m_stats.batches;
+    return true;
+}
+
+template class BasicWorldGenerator<16>;
+template class BasicWorldGenerator<32>;
+template class BasicWorldGenerator<64>;
+
+WorldGenerationStats MeasureWorldGeneration(int seed, int worldRadius, ThreadPool* threadPool) {
+    std::vector<ChunkCoord> region = GetWorldRegion(worldRadius);
+    WorldGenerator generator(seed, region, threadPool);
+    std::vector<std::unique_ptr<VoxelChunk>> completed;
+    generator.Step(region.size(), completed);
+    return generator.GetStats();
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include "VoxelChunk.h"
+
+class ThreadPool;
+
+// Generation stages in order. A chunk enters a stage only once all of its
+// 26 neighbours have reached the stage's prerequisite:
+//
+//   Density    solid stone below a fractal height field     (none)
+//   Carved     worm caves cut out of the stone               (none)
+//   Surfaced   biome surface blocks; reads the chunks above  (neighbours Carved)
+//   Decorated  trees, which reach into neighbouring chunks   (neighbours Surfaced)
+//   Complete   no more writes from any neighbour             (neighbours Decorated)
+enum class GenerationStage : uint8_t {
+    None = 0,
+    Density = 1,
+    Carved = 2,
+    Surfaced = 3,
+    Decorated = 4,
+    Complete = 5,
+};
+
+constexpr uint32_t GENERATION_STAGE_COUNT = 6;
+
+struct GenerationStageStats {
+    uint32_t chunks;
+    double busySeconds;     // summed over worker threads
+};
+
+struct WorldGenerationStats {
+    GenerationStageStats stages[GENERATION_STAGE_COUNT];
+    uint32_t batches;
+    double seconds;         // wall time spent in Step
+};
+
+// Chunk columns of a world of the given radius, in no particular order
+std::vector<ChunkCoord> GetWorldRegion(int radius);
+
+// Staged generator for a fixed region of chunks. Chunks are requested in
+// the given order and only the stages needed to complete them run, so the
+// first requests finish early. Stages that touch neighbours run in 27
+// batches by chunk coordinate modulo 3: chunks of one batch are at least
+// three apart, their 3x3x3 neighbourhoods never overlap, and the batch runs
+// in parallel without locks. Neighbours outside the region count as done
+// and are never written. The result does not depend on scheduling. Voxels
+// depend on the chunk size only where a column has grass in two chunks,
+// since each chunk roots its own trees.
+template <int Size>
+class BasicWorldGenerator {
+public:
+    using Chunk = BasicVoxelChunk<Size>;
+
+    // `cancelled`, if given, is polled between batches
+    BasicWorldGenerator(int seed, const std::vector<ChunkCoord>& order, ThreadPool* threadPool,
+                        const std::atomic<bool>* cancelled = nullptr);
+    ~BasicWorldGenerator();
+
+    BasicWorldGenerator(const BasicWorldGenerator&) = delete;
+    BasicWorldGenerator& operator=(const BasicWorldGenerator&) = delete;
+
+    // Completes the next `count` chunks of the order and moves them to
+    // `completed`. Returns false once every chunk has been handed out.
+    bool Step(size_t count, std::vector<std::unique_ptr<Chunk>>& completed);
+
+    const WorldGenerationStats& GetStats() const { return m_stats; }
+
+private:
+    struct Node {
+        std::unique_ptr<Chunk> chunk;           // null once handed out
+        ChunkCoord coord;
+        GenerationStage stage;
+        GenerationStage target;
+        Node* neighbors[27];                    // 3x3x3 around this one, null outside the region
+    };
+
+    void Require(Node* node, GenerationStage stage);
+    bool IsReady(const Node& node, GenerationStage stage) const;
+    bool RunBatch(GenerationStage stage, const std::vector<Node*>& batch);
+    void Settle();
+
+    int m_seed;
+    ThreadPool* m_threadPool;
+    const std::atomic<bool>* m_cancelled;
+    std::unordered_map<ChunkCoord, Node> m_nodes;
+    std::vector<Node*> m_order;
+    std::vector<Node*> m_active;                // stage below target
+    size_t m_nextRequest;
+    WorldGenerationStats m_stats;
+};
+
+extern template class BasicWorldGenerator<16>;
+extern template class BasicWorldGenerator<32>;
+extern template class BasicWorldGenerator<64>;
+
+using WorldGenerator = BasicWorldGenerator<CHUNK_SIZE>;
+
+// Per-stage throughput benchmark: generates a whole scratch region at once
+WorldGenerationStats MeasureWorldGeneration(int seed, int worldRadius, ThreadPool* threadPool);
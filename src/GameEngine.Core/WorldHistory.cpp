@@ -0,0 +1,157 @@
+#include "WorldHistory.h"
+
+WorldHistory::WorldHistory(size_t maxEntries)
+    : m_maxEntries(maxEntries)
+{
+}
+
+bool WorldHistory::Commit(VoxelEngine& world) {
+    Entry entry;
+    size_t liveChunks = 0;
+
+    world.ForEachChunk([&](const ChunkCoord& coord, const VoxelChunk& chunk) {
+        ++liveChunks;
+        const VoxelBlockRef& block = chunk.GetBlock();
+
+        auto it = m_baseline.find(coord);
+        if (it == m_baseline.end()) {
+            entry.changes.push_back(ChunkChange{ coord, nullptr, block });
+            m_baseline.emplace(coord, block);
+        } else if (it->second != block) {
+            entry.changes.push_back(ChunkChange{ coord, it->second, block });
+            it->second = block;
+        }
+    });
+
+    // Chunks that disappeared since the last commit; evicted chunks still
+    // exist, they are just not resident
+    if (m_baseline.size() > liveChunks) {
+        for (auto it = m_baseline.begin(); it != m_baseline.end();) {
+            if (!world.HasChunk(it->first) && !world.IsChunkEvicted(it->first)) {
+                entry.changes.push_back(ChunkChange{ it->first, it->second, nullptr });
+                it = m_baseline.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    if (entry.changes.empty()) {
+        return false;
+    }
+
+    entry.bytes = MeasureEntry(entry);
+    m_undo.push_back(std::move(entry));
+    m_redo.clear();
+
+    while (m_undo.size() > m_maxEntries) {
+        m_undo.pop_front();
+    }
+    return true;
+}
+
+bool WorldHistory::Undo(VoxelEngine& world) {
+    // Uncommitted edits become their own step first so they can be redone
+    Commit(world);
+
+    if (m_undo.empty()) {
+        return false;
+    }
+
+    Entry entry = std::move(m_undo.back());
+    m_undo.pop_back();
+    Apply(world, entry, false);
+    m_redo.push_back(std::move(entry));
+    return true;
+}
+
+bool WorldHistory::Redo(VoxelEngine& world) {
+    if (m_redo.empty()) {
+        return false;
+    }
+
+    Entry entry = std::move(m_redo.back());
+    m_redo.pop_back();
+    Apply(world, entry, true);
+    m_undo.push_back(std::move(entry));
+    return true;
+}
+
+void WorldHistory::Reset(VoxelEngine& world) {
+    m_undo.clear();
+    m_redo.clear();
+    m_baseline.clear();
+    m_evicted.clear();
+
+    world.ForEachChunk([&](const ChunkCoord& coord, const VoxelChunk& chunk) {
+        m_baseline.emplace(coord, chunk.GetBlock());
+    });
+    world.ForEachEvictedChunk([&](const ChunkCoord& coord) {
+        m_evicted.insert(coord);
+    });
+}
+
+HistoryStats WorldHistory::GetStats() const {
+    HistoryStats stats = {};
+    stats.undoDepth = static_cast<uint32_t>(m_undo.size());
+    stats.redoDepth = static_cast<uint32_t>(m_redo.size());
+
+    for (const Entry& entry : m_undo) {
+        stats.totalBytes += entry.bytes;
+    }
+    for (const Entry& entry : m_redo) {
+        stats.totalBytes += entry.bytes;
+    }
+
+    if (!m_undo.empty()) {
+        stats.lastEntryBytes = m_undo.back().bytes;
+        stats.lastEntryChunks = static_cast<uint32_t>(m_undo.back().changes.size());
+    }
+    return stats;
+}
+
+void WorldHistory::OnChunkEvicted(const ChunkCoord& coord, const VoxelBlockRef& block) {
+    // With uncommitted edits the baseline keeps the pre-edit block, and the
+    // reloaded block shows up as a change at the next commit
+    auto it = m_baseline.find(coord);
+    if (it != m_baseline.end() && it->second == block) {
+        m_baseline.erase(it);
+        m_evicted.insert(coord);
+    }
+}
+
+void WorldHistory::OnChunkReloaded(const ChunkCoord& coord, const VoxelBlockRef& block) {
+    if (m_evicted.erase(coord) > 0) {
+        m_baseline[coord] = block;
+    }
+}
+
+void WorldHistory::OnChunkStreamed(const ChunkCoord& coord, const VoxelBlockRef& block) {
+    m_baseline[coord] = block;
+}
+
+void WorldHistory::Apply(VoxelEngine& world, const Entry& entry, bool forward) {
+    for (const ChunkChange& change : entry.changes) {
+        const VoxelBlockRef& block = forward ? change.after : change.before;
+        world.RestoreChunkBlock(change.coord, block);
+        m_evicted.erase(change.coord);
+
+        if (block) {
+            m_baseline[change.coord] = block;
+        } else {
+            m_baseline.erase(change.coord);
+        }
+    }
+}
+
+size_t WorldHistory::MeasureEntry(const Entry& entry) {
+    // Each entry keeps the pre-edit block of every chunk it touched alive;
+    // the post-edit block is shared with the world or the next entry
+    size_t bytes = sizeof(Entry) + entry.changes.capacity() * sizeof(ChunkChange);
+    for (const ChunkChange& change : entry.changes) {
+        if (change.before) {
+            bytes += sizeof(VoxelBlock);
+        }
+    }
+    return bytes;
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "VoxelChunk.h"
+#include "VoxelEngine.h"
+
+struct HistoryStats {
+    uint32_t undoDepth;
+    uint32_t redoDepth;
+    uint64_t totalBytes;        // memory retained by all undo and redo entries
+    uint64_t lastEntryBytes;    // memory retained by the most recent commit
+    uint32_t lastEntryChunks;
+};
+
+// Undo/redo over copy-on-write chunk blocks. The baseline holds one block
+// reference per chunk as of the last commit; a commit compares block
+// pointers against it (O(chunks), no voxel copies) and records only the
+// chunks whose block changed. Undo and redo swap those blocks back in, so
+// they cost O(changed chunks).
+class WorldHistory {
+public:
+    explicit WorldHistory(size_t maxEntries = 256);
+
+    // Records everything edited since the previous commit as one step.
+    // Returns false if nothing changed.
+    bool Commit(VoxelEngine& world);
+    bool Undo(VoxelEngine& world);
+    bool Redo(VoxelEngine& world);
+
+    // Drops all entries and takes the current world as the new baseline.
+    // Call whenever the world is replaced, before any edits to the new one.
+    void Reset(VoxelEngine& world);
+
+    HistoryStats GetStats() const;
+
+    // Residency changes from the engine's memory budget. An evicted chunk
+    // whose block matches the baseline drops its baseline reference so the
+    // block can be freed; the reloaded block becomes the baseline again.
+    void OnChunkEvicted(const ChunkCoord& coord, const VoxelBlockRef& block);
+    void OnChunkReloaded(const ChunkCoord& coord, const VoxelBlockRef& block);
+
+    // Terrain streaming in after a world swap joins the baseline instead of
+    // being recorded as a step. Edits the engine held back for the chunk
+    // are recorded by the next commit.
+    void OnChunkStreamed(const ChunkCoord& coord, const VoxelBlockRef& block);
+
+private:
+    struct ChunkChange {
+        ChunkCoord coord;
+        VoxelBlockRef before;   // null: chunk did not exist
+        VoxelBlockRef after;    // null: chunk was removed
+    };
+
+    struct Entry {
+        std::vector<ChunkChange> changes;
+        size_t bytes;
+    };
+
+    void Apply(VoxelEngine& world, const Entry& entry, bool forward);
+    static size_t MeasureEntry(const Entry& entry);
+
+    std::unordered_map<ChunkCoord, VoxelBlockRef> m_baseline;
+    std::unordered_set<ChunkCoord> m_evicted;   // baseline entries dropped on eviction
+    std::deque<Entry> m_undo;
+    std::vector<Entry> m_redo;
+    size_t m_maxEntries;
+};
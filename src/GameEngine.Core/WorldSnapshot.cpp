@@ -0,0 +1,221 @@
+#include "WorldSnapshot.h"
+#include "VoxelEngine.h"
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <thread>
+
+WorldSnapshot::WorldSnapshot(std::vector<std::pair<ChunkCoord, VoxelBlockRef>> blocks, uint64_t version)
+    : m_blocks(std::move(blocks))
+    , m_version(version)
+{
+    size_t capacity = 16;
+    while (capacity < m_blocks.size() * 2) {
+        capacity *= 2;
+    }
+    m_slots.assign(capacity, Slot{ ChunkCoord{ 0, 0, 0 }, nullptr });
+    m_mask = capacity - 1;
+
+    for (const auto& entry : m_blocks) {
+        size_t i = HashCoord(entry.first) & m_mask;
+        while (m_slots[i].block) {
+            i = (i + 1) & m_mask;
+        }
+        m_slots[i] = Slot{ entry.first, entry.second.get() };
+    }
+}
+
+const VoxelBlock* WorldSnapshot::FindBlock(const ChunkCoord& coord) const {
+    // Never more than half full, so the probe always reaches an empty slot
+    size_t i = HashCoord(coord) & m_mask;
+    while (const VoxelBlock* block = m_slots[i].block) {
+        if (m_slots[i].coord == coord) {
+            return block;
+        }
+        i = (i + 1) & m_mask;
+    }
+    return nullptr;
+}
+
+uint8_t WorldSnapshot::GetVoxel(int x, int y, int z) const {
+    ChunkCoord coord = WorldToChunkCoord(x, y, z);
+    const VoxelBlock* block = FindBlock(coord);
+    if (!block) {
+        return static_cast<uint8_t>(BlockType::Air);
+    }
+    return block->voxels[LocalVoxelIndex(ChunkLayout::ToLocal(x), ChunkLayout::ToLocal(y), ChunkLayout::ToLocal(z))];
+}
+
+size_t WorldSnapshot::HashCoord(const ChunkCoord& coord) {
+    uint64_t h = static_cast<uint32_t>(coord.x) * 0x9E3779B97F4A7C15ull;
+    h ^= static_cast<uint32_t>(coord.y) * 0xC2B2AE3D27D4EB4Full;
+    h ^= static_cast<uint32_t>(coord.z) * 0x165667B19E3779F9ull;
+    return static_cast<size_t>(h ^ (h >> 29));
+}
+
+EpochManager::EpochManager()
+    : m_epoch(0)
+{
+}
+
+EpochManager::~EpochManager() = default;
+
+int EpochManager::AcquireSlot() {
+    for (unsigned i = 0; i < MAX_VOXEL_READERS; ++i) {
+        bool expected = false;
+        if (m_slots[i].claimed.compare_exchange_strong(expected, true)) {
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
+void EpochManager::ReleaseSlot(int slot) {
+    m_slots[slot].epoch.store(IDLE);
+    m_slots[slot].claimed.store(false);
+}
+
+void EpochManager::Pin(int slot) {
+    // Sequentially consistent so the writer either sees this announcement
+    // or the reader sees the snapshot published before the writer's scan
+    m_slots[slot].epoch.store(m_epoch.load());
+}
+
+void EpochManager::Unpin(int slot) {
+    m_slots[slot].epoch.store(IDLE, std::memory_order_release);
+}
+
+void EpochManager::Retire(std::unique_ptr<const WorldSnapshot> snapshot) {
+    m_retired.push_back(Retired{ std::move(snapshot), m_epoch.load() });
+    m_epoch.fetch_add(1);
+    Reclaim();
+}
+
+void EpochManager::Reclaim() {
+    uint64_t oldestPinned = IDLE;
+    for (const ReaderSlot& slot : m_slots) {
+        oldestPinned = std::min(oldestPinned, slot.epoch.load());
+    }
+
+    // A reader pinned at epoch e may still hold anything retired at e or later
+    m_retired.erase(std::remove_if(m_retired.begin(), m_retired.end(),
+        [oldestPinned](const Retired& retired) { return retired.epoch < oldestPinned; }),
+        m_retired.end());
+}
+
+VoxelReader::VoxelReader(EpochManager* epochs, const std::atomic<const WorldSnapshot*>* published)
+    : m_epochs(epochs)
+    , m_published(published)
+    , m_slot(epochs->AcquireSlot())
+{
+}
+
+VoxelReader::~VoxelReader() {
+    if (m_slot >= 0) {
+        m_epochs->ReleaseSlot(m_slot);
+    }
+}
+
+VoxelReader::VoxelReader(VoxelReader&& other) noexcept
+    : m_epochs(other.m_epochs)
+    , m_published(other.m_published)
+    , m_slot(other.m_slot)
+{
+    other.m_slot = -1;
+}
+
+uint8_t VoxelReader::GetVoxel(int x, int y, int z) const {
+    m_epochs->Pin(m_slot);
+    uint8_t value = m_published->load()->GetVoxel(x, y, z);
+    m_epochs->Unpin(m_slot);
+    return value;
+}
+
+ConcurrentReadStats MeasureConcurrentReads(unsigned readerThreads, unsigned milliseconds) {
+    using Clock = std::chrono::steady_clock;
+
+    VoxelEngine world;
+    world.Initialize();
+
+    // Column the writer repaints as a whole between publishes; it starts
+    // out uniform so any mixed read is a torn snapshot
+    const int columnX = 3, columnZ = 5, columnBottom = -16, columnTop = 15;
+    for (int y = columnBottom; y <= columnTop; ++y) {
+        world.SetVoxel(columnX, y, columnZ, 1);
+    }
+    world.PublishSnapshot();
+
+    std::atomic<bool> stop{ false };
+    std::atomic<uint64_t> reads{ 0 };
+    std::atomic<uint32_t> inconsistent{ 0 };
+
+    std::vector<VoxelReader> readers;
+    for (unsigned i = 0; i < readerThreads; ++i) {
+        VoxelReader reader = world.CreateReader();
+        if (!reader.IsValid()) {
+            break;
+        }
+        readers.push_back(std::move(reader));
+    }
+
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < readers.size(); ++i) {
+        threads.emplace_back([&, i] {
+            const VoxelReader& reader = readers[i];
+            std::minstd_rand rng(static_cast<unsigned>(i) + 1);
+            uint64_t localReads = 0;
+            uint32_t localInconsistent = 0;
+
+            while (!stop.load(std::memory_order_relaxed)) {
+                // Random single-voxel reads across the world
+                for (int n = 0; n < 256; ++n) {
+                    int x = static_cast<int>(rng() % 64) - 32;
+                    int y = static_cast<int>(rng() % 32) - 16;
+                    int z = static_cast<int>(rng() % 64) - 32;
+                    reader.GetVoxel(x, y, z);
+                }
+                localReads += 256;
+
+                // One pinned batch must see the column in a single state
+                reader.Read([&](const WorldSnapshot& snapshot) {
+                    uint8_t first = snapshot.GetVoxel(columnX, columnBottom, columnZ);
+                    for (int y = columnBottom + 1; y <= columnTop; ++y) {
+                        if (snapshot.GetVoxel(columnX, y, columnZ) != first) {
+                            ++localInconsistent;
+                            break;
+                        }
+                    }
+                });
+                localReads += columnTop - columnBottom + 1;
+            }
+
+            reads.fetch_add(localReads);
+            inconsistent.fetch_add(localInconsistent);
+        });
+    }
+
+    ConcurrentReadStats stats = {};
+    auto start = Clock::now();
+    auto end = start + std::chrono::milliseconds(milliseconds);
+    uint8_t paint = 2;
+    while (Clock::now() < end) {
+        for (int y = columnBottom; y <= columnTop; ++y) {
+            world.SetVoxel(columnX, y, columnZ, paint);
+        }
+        stats.edits += columnTop - columnBottom + 1;
+        world.PublishSnapshot();
+        ++stats.publishes;
+        paint = static_cast<uint8_t>(paint % 5 + 1);
+    }
+
+    stop = true;
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    stats.readerThreads = static_cast<uint32_t>(readers.size());
+    stats.reads = reads.load();
+    stats.inconsistentReads = inconsistent.load();
+    stats.seconds = std::chrono::duration<float>(Clock::now() - start).count();
+    return stats;
+}
@@ -0,0 +1,121 @@
+using System;
+using System.IO;
+
+namespace GameEngine.Editor
+{
+    /// <summary>
+    /// Builds a packed command stream for EngineInterop.ExecuteCommandBuffer so that
+    /// a whole batch of camera and voxel operations costs a single P/Invoke.
+    /// The layout mirrors CommandBuffer.h in GameEngine.Core.
+    /// </summary>
+    public sealed class EngineCommandBuffer
+    {
+        private const uint Magic = 0x42434547; // "GECB"
+        private const ushort Version = 1;
+        private const int HeaderSize = 12;
+
+        /// <summary>Largest box one FillVoxels command may cover, in voxels.</summary>
+        public const long MaxFillVolume = 1 << 20;
+
+        /// <summary>Status returned when a FillVoxels box exceeds MaxFillVolume.</summary>
+        public const int FillTooLarge = -8;
+
+        private enum Op : byte
+        {
+            SetCameraPosition = 1,
+            SetCameraRotation = 2,
+            MoveCameraForward = 3,
+            MoveCameraRight = 4,
+            MoveCameraUp = 5,
+            SetVoxel = 6,
+            GetVoxel = 7,
+            GenerateTerrain = 8,
+            GetCameraPosition = 9,
+            FillVoxels = 10,
+            SetEditorMode = 11
+        }
+
+        private readonly MemoryStream _stream = new MemoryStream();
+        private readonly BinaryWriter _writer;
+        private uint _commandCount;
+        private int _resultSize;
+
+        public EngineCommandBuffer()
+        {
+            _writer = new BinaryWriter(_stream);
+            _writer.Write(new byte[HeaderSize]);
+        }
+
+        public uint CommandCount => _commandCount;
+
+        public void SetCameraPosition(float x, float y, float z) { Begin(Op.SetCameraPosition); _writer.Write(x); _writer.Write(y); _writer.Write(z); }
+        public void SetCameraRotation(float pitch, float yaw) { Begin(Op.SetCameraRotation); _writer.Write(pitch); _writer.Write(yaw); }
+        public void MoveCameraForward(float distance) { Begin(Op.MoveCameraForward); _writer.Write(distance); }
+        public void MoveCameraRight(float distance) { Begin(Op.MoveCameraRight); _writer.Write(distance); }
+        public void MoveCameraUp(float distance) { Begin(Op.MoveCameraUp); _writer.Write(distance); }
+        public void SetVoxel(int x, int y, int z, byte blockType) { Begin(Op.SetVoxel); _writer.Write(x); _writer.Write(y); _writer.Write(z); _writer.Write(blockType); }
+        public void GenerateTerrain(int seed) { Begin(Op.GenerateTerrain); _writer.Write(seed); }
+        public void SetEditorMode(bool enabled) { Begin(Op.SetEditorMode); _writer.Write((byte)(enabled ? 1 : 0)); }
+
+        public void FillVoxels(int x0, int y0, int z0, int x1, int y1, int z1, byte blockType)
+        {
+            Begin(Op.FillVoxels);
+            _writer.Write(x0); _writer.Write(y0); _writer.Write(z0);
+            _writer.Write(x1); _writer.Write(y1); _writer.Write(z1);
+            _writer.Write(blockType);
+        }
+
+        /// <summary>Queues a voxel read; returns its byte offset in the result buffer.</summary>
+        public int GetVoxel(int x, int y, int z)
+        {
+            Begin(Op.GetVoxel);
+            _writer.Write(x); _writer.Write(y); _writer.Write(z);
+            return Reserve(1);
+        }
+
+        /// <summary>Queues a camera position read; returns its byte offset in the result buffer.</summary>
+        public int GetCameraPosition()
+        {
+            Begin(Op.GetCameraPosition);
+            return Reserve(3 * sizeof(float));
+        }
+
+        /// <summary>
+        /// Sends the batch to the engine. Returns the number of commands executed,
+        /// or a negative CommandBufferStatus code.
+        /// </summary>
+        public int Execute(out byte[] results)
+        {
+            _writer.Flush();
+            byte[] data = _stream.ToArray();
+            BitConverter.TryWriteBytes(new Span<byte>(data, 0, 4), Magic);
+            BitConverter.TryWriteBytes(new Span<byte>(data, 4, 2), Version);
+            BitConverter.TryWriteBytes(new Span<byte>(data, 8, 4), _commandCount);
+
+            results = new byte[_resultSize];
+            return EngineInterop.ExecuteCommandBuffer(data, (UIntPtr)data.Length,
+                results, (UIntPtr)results.Length, out _);
+        }
+
+        public void Clear()
+        {
+            _stream.SetLength(HeaderSize);
+            _stream.Position = HeaderSize;
+            _commandCount = 0;
+            _resultSize = 0;
+        }
+
+        private void Begin(Op op)
+        {
+            _writer.Write((byte)op);
+            _commandCount++;
+        }
+
+        private int Reserve(int size)
+        {
+            int offset = _resultSize;
+            _resultSize += size;
+            return offset;
+        }
+    }
+}
@@ -13,6 +13,14 @@ namespace GameEngine.Editor
         [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
         public static extern void ShutdownEngine();
 
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        [return: MarshalAs(UnmanagedType.I1)]
+        public static extern bool InitializeEngineHeadless(int width, int height);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        [return: MarshalAs(UnmanagedType.I1)]
+        public static extern bool InitializeEngineSoftware(int width, int height);
+
         [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
         public static extern void UpdateEngine(float deltaTime);
 
@@ -49,6 +57,181 @@ namespace GameEngine.Editor
         [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
         public static extern void GenerateTerrain(int seed);
 
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        [return: MarshalAs(UnmanagedType.I1)]
+        public static extern bool GetTerrainProgress(out float progress);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void CancelTerrainGeneration();
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void SetTerrainSwapThreshold(float fraction);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern ulong CountVoxelsInBox(int x0, int y0, int z0, int x1, int y1, int z1, byte blockType);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern ulong CountVoxelsInSphere(float x, float y, float z, float radius, byte blockType);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        [return: MarshalAs(UnmanagedType.I1)]
+        public static extern bool FindVoxelInBox(int x0, int y0, int z0, int x1, int y1, int z1, byte blockType,
+            out int x, out int y, out int z);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        [return: MarshalAs(UnmanagedType.I1)]
+        public static extern bool FindVoxelInSphere(float x, float y, float z, float radius, byte blockType,
+            out int foundX, out int foundY, out int foundZ);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern uint CollectVoxelsInBox(int x0, int y0, int z0, int x1, int y1, int z1, byte blockType,
+            [Out] int[] positions, uint capacity);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern uint CollectVoxelsInSphere(float x, float y, float z, float radius, byte blockType,
+            [Out] int[] positions, uint capacity);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void MeasureVoxelQueries(int seed, int worldRadius, int queryRadius, uint queries,
+            out float naiveMilliseconds, out float queryMilliseconds, out uint mismatches);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern uint FindPath(float startX, float startY, float startZ, float goalX, float goalY, float goalZ,
+            [Out] int[] positions, uint capacity);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void GetNavigationStats(out uint chunks, out uint regions, out uint portals,
+            out float rebuildMilliseconds);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void MeasurePathfinding(int seed, int worldRadius, uint paths, uint edits,
+            out float pathsPerSecond, out float rebuildMicroseconds, out uint found, out uint invalid, out uint mismatches);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void MeasureConcurrentVoxelReads(uint readerThreads, uint milliseconds,
+            out double readsPerSecond, out uint inconsistentReads);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void SetMemoryBudget(uint category, ulong bytes);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void GetMemoryStats(uint category, out ulong bytes, out ulong peakBytes,
+            out ulong budgetBytes, out uint evictions);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void GetChunkResidency(out uint resident, out uint evicted, out uint persisted);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        [return: MarshalAs(UnmanagedType.I1)]
+        public static extern bool SetMeshCacheDirectory(string path);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void GetMeshCacheStats(out uint hits, out uint misses, out uint entries, out ulong fileBytes);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void MeasureMeshCacheStartup(int seed, int worldRadius, out float coldFirstFrameMilliseconds,
+            out float warmFirstFrameMilliseconds, out float coldMeshMilliseconds, out float warmMeshMilliseconds, out uint warmHits);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void GetMeshArenaStats(out uint meshCount, out float fragmentation, out uint defragmentations,
+            out ulong defragmentedBytes);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void MeasureMeshArenaChurn(uint meshCount, uint frames, out float frameMilliseconds,
+            out float averageFragmentation, out uint defragmentations, out ulong dirtyBytesPerFrame);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void MeasureWorldGeneration(int seed, int worldRadius, out float milliseconds,
+            out uint chunks, [Out] float[] stageChunksPerSecond);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void MeasureReplication(int seed, int worldRadius, uint clients, uint editsPerFrame, uint frames,
+            out float kilobytesPerSecond, out float encodeMegabytesPerSecond, out float decodeMegabytesPerSecond,
+            out float compressionRatio, out uint mismatches);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void MeasureChunkSizes(int seed, int worldRadius, [Out] int[] chunkSizes, [Out] uint[] chunks,
+            [Out] uint[] drawCalls, [Out] float[] generationMilliseconds, [Out] float[] meshMilliseconds,
+            [Out] float[] remeshMicroseconds, [Out] float[] lookupNanoseconds, [Out] ulong[] memoryBytes);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern uint SpawnParticles(float x, float y, float z, uint count, float speed, float lifetime);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void GetEntityStats(out uint entities, out uint archetypes, out uint phases, out float updateMilliseconds);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void MeasureEntityUpdate(uint entityCount, uint frames, out float frameMilliseconds, out float entitiesPerSecond);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        [return: MarshalAs(UnmanagedType.I1)]
+        public static extern bool CommitWorldEdit();
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        [return: MarshalAs(UnmanagedType.I1)]
+        public static extern bool UndoWorldEdit();
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        [return: MarshalAs(UnmanagedType.I1)]
+        public static extern bool RedoWorldEdit();
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void GetHistoryStats(out uint undoDepth, out uint redoDepth, out ulong totalBytes, out ulong lastEntryBytes);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void SetCameraCollision(bool enabled);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern uint CreatePhysicsBody(float x, float y, float z, float halfX, float halfY, float halfZ);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void DestroyPhysicsBody(uint bodyId);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void SetPhysicsBodyVelocity(uint bodyId, float x, float y, float z);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void GetPhysicsBodyPosition(uint bodyId, out float x, out float y, out float z);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void GetPhysicsStats(out uint bodyCount, out uint contactPairs, out float stepMilliseconds);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void MeasurePhysicsStep(uint bodyCount, uint frames, out float stepMilliseconds,
+                                                     out float maxStepMilliseconds, out uint contactPairs);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
+        [return: MarshalAs(UnmanagedType.I1)]
+        public static extern bool SaveFrameImage(string path);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        [return: MarshalAs(UnmanagedType.I1)]
+        public static extern bool GetFrameImageHash(out ulong hash);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
+        [return: MarshalAs(UnmanagedType.I1)]
+        public static extern bool MeasureSoftwareRendering(int width, int height, uint frames, string? imagePath,
+            out float frameMilliseconds, out float trianglesPerSecond, out uint triangles);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
+        [return: MarshalAs(UnmanagedType.I1)]
+        public static extern bool CheckReferenceImage(string? imagePath, out ulong hash);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern int ExecuteCommandBuffer(byte[] commands, UIntPtr commandSize,
+            byte[]? results, UIntPtr resultCapacity, out UIntPtr resultSize);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
+        [return: MarshalAs(UnmanagedType.I1)]
+        public static extern bool StartSessionRecording(string path);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern ulong StopSessionRecording();
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
+        public static extern int ReplaySessionTrace(string path, [MarshalAs(UnmanagedType.I1)] bool realTime,
+            out uint frameCount, out float p50Milliseconds, out float p99Milliseconds, out float maxMilliseconds);
+
         [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
         public static extern void SetEditorMode(bool enabled);
 
@@ -176,7 +176,7 @@ namespace GameEngine.Editor
             Random rand = new Random();
             int seed = rand.Next();
             EngineInterop.GenerateTerrain(seed);
-            LogToConsole($"Generated new terrain with seed: {seed}");
+            LogToConsole($"Generating new terrain with seed: {seed}");
         }
 
         private void ToggleProperties_Click(object sender, RoutedEventArgs e)
@@ -231,6 +231,7 @@ namespace GameEngine.Editor
             // Example: Place block at camera position
             EngineInterop.GetCameraPosition(out float x, out float y, out float z);
             EngineInterop.SetVoxel((int)x, (int)y, (int)z, 1); // Grass block
+            EngineInterop.CommitWorldEdit();
             LogToConsole($"Placed block at ({(int)x}, {(int)y}, {(int)z})");
         }
 
@@ -239,6 +240,7 @@ namespace GameEngine.Editor
             // Example: Remove block at camera position
             EngineInterop.GetCameraPosition(out float x, out float y, out float z);
             EngineInterop.SetVoxel((int)x, (int)y, (int)z, 0); // Air
+            EngineInterop.CommitWorldEdit();
             LogToConsole($"Removed block at ({(int)x}, {(int)y}, {(int)z})");
         }
 
@@ -270,6 +272,26 @@ namespace GameEngine.Editor
                     LogToConsole("  terrain <seed> - Generate new terrain");
                     LogToConsole("  setcam <x> <y> <z> - Set camera position");
                     LogToConsole("  editor - Toggle editor mode");
+                    LogToConsole("  undo / redo - Undo or redo the last world edit");
+                    LogToConsole("  fill <x0> <y0> <z0> <x1> <y1> <z1> <blockType> - Fill a box of voxels as one undo step");
+                    LogToConsole("  record <file> / record stop - Record engine calls to a trace");
+                    LogToConsole("  replay <file> [realtime] - Replay a trace and report frame times");
+                    LogToConsole("  readbench [threads] - Measure concurrent voxel reads for 1..N reader threads");
+                    LogToConsole("  memory [category <MB>] - Show memory use, or set a category budget (0 = unlimited)");
+                    LogToConsole("  meshcache [bench [radius]] - Show mesh cache stats, or compare cold and warm startup");
+                    LogToConsole("  arena [bench [meshes]] - Show mesh pool fragmentation, or measure it under heavy remeshing");
+                    LogToConsole("  genbench [radius] - Measure staged world generation throughput per stage");
+                    LogToConsole("  chunkbench [radius] - Compare generation, meshing, lookups and memory across chunk sizes");
+                    LogToConsole("  query <blockType> [radius] - Count and locate a block type within a radius of the camera");
+                    LogToConsole("  querybench [radius] - Compare voxel queries with per-voxel reads on a scratch world");
+                    LogToConsole("  path <x> <y> <z> - Find a walking path from below the camera to a point");
+                    LogToConsole("  pathbench [paths] - Measure batched pathfinding and graph rebuilds on a scratch world");
+                    LogToConsole("  netbench [clients] [edits] - Measure chunk replication to loopback clients under heavy editing");
+                    LogToConsole("  physics [bench [count]] - Show physics stats, or measure physics steps on a scratch world");
+                    LogToConsole("  particles [count] - Spawn a burst of particle entities at the camera");
+                    LogToConsole("  entities [bench [count]] - Show entity stats, or measure the entity systems on a scratch world");
+                    LogToConsole("  raster [frames] [file.bmp] - Measure the software rasterizer on the current view, optionally saving the image");
+                    LogToConsole("  raster check [file.bmp] - Compare the software image of the reference scene with its recorded hash");
                     break;
                 case "clear":
                     ConsoleOutput.Clear();
@@ -278,7 +300,7 @@ namespace GameEngine.Editor
                     if (parts.Length > 1 && int.TryParse(parts[1], out int seed))
                     {
                         EngineInterop.GenerateTerrain(seed);
-                        LogToConsole($"Generated terrain with seed: {seed}");
+                        LogToConsole($"Generating terrain with seed: {seed}");
                     }
                     else
                     {
@@ -302,6 +324,320 @@ namespace GameEngine.Editor
                 case "editor":
                     IsEditorMode = !IsEditorMode;
                     break;
+                case "fill":
+                    {
+                        int[] box = new int[6];
+                        byte fillType = 0;
+                        bool parsed = parts.Length > 7 && byte.TryParse(parts[7], out fillType);
+                        for (int i = 0; parsed && i < 6; ++i)
+                        {
+                            parsed = int.TryParse(parts[i + 1], out box[i]);
+                        }
+                        if (!parsed)
+                        {
+                            LogToConsole("Usage: fill <x0> <y0> <z0> <x1> <y1> <z1> <blockType>");
+                            break;
+                        }
+
+                        var batch = new EngineCommandBuffer();
+                        batch.FillVoxels(box[0], box[1], box[2], box[3], box[4], box[5], fillType);
+                        int status = batch.Execute(out _);
+                        if (status >= 0)
+                        {
+                            EngineInterop.CommitWorldEdit();
+                            long volume = (Math.Abs((long)box[3] - box[0]) + 1) * (Math.Abs((long)box[4] - box[1]) + 1) *
+                                (Math.Abs((long)box[5] - box[2]) + 1);
+                            LogToConsole($"Filled {volume} voxels");
+                        }
+                        else if (status == EngineCommandBuffer.FillTooLarge)
+                        {
+                            LogToConsole($"Fill failed: the box is larger than {EngineCommandBuffer.MaxFillVolume} voxels");
+                        }
+                        else
+                        {
+                            LogToConsole($"Fill failed with status {status}");
+                        }
+                    }
+                    break;
+                case "undo":
+                case "redo":
+                    bool applied = parts[0].ToLower() == "undo"
+                        ? EngineInterop.UndoWorldEdit()
+                        : EngineInterop.RedoWorldEdit();
+                    EngineInterop.GetHistoryStats(out uint undoDepth, out uint redoDepth, out ulong historyBytes, out _);
+                    LogToConsole(applied
+                        ? $"{parts[0].ToLower()} applied ({undoDepth} undo / {redoDepth} redo steps, {historyBytes / 1024} KB history)"
+                        : $"Nothing to {parts[0].ToLower()}");
+                    break;
+                case "record":
+                    if (parts.Length > 1 && parts[1].ToLower() == "stop")
+                    {
+                        ulong calls = EngineInterop.StopSessionRecording();
+                        LogToConsole($"Recording stopped ({calls} calls)");
+                    }
+                    else if (parts.Length > 1)
+                    {
+                        LogToConsole(EngineInterop.StartSessionRecording(parts[1])
+                            ? $"Recording session to {parts[1]}"
+                            : $"Could not record to {parts[1]}");
+                    }
+                    else
+                    {
+                        LogToConsole("Usage: record <file> | record stop");
+                    }
+                    break;
+                case "replay":
+                    if (parts.Length > 1)
+                    {
+                        bool realTime = parts.Length > 2 && parts[2].ToLower() == "realtime";
+                        int replayed = EngineInterop.ReplaySessionTrace(parts[1], realTime,
+                            out uint frames, out float p50, out float p99, out float max);
+                        LogToConsole(replayed >= 0
+                            ? $"Replayed {replayed} calls, {frames} frames: p50 {p50:F2} ms, p99 {p99:F2} ms, max {max:F2} ms"
+                            : $"Replay failed ({replayed})");
+                    }
+                    else
+                    {
+                        LogToConsole("Usage: replay <file> [realtime]");
+                    }
+                    break;
+                case "readbench":
+                    uint maxReaders = parts.Length > 1 && uint.TryParse(parts[1], out uint n)
+                        ? n
+                        : (uint)Environment.ProcessorCount;
+                    for (uint readers = 1; readers <= maxReaders; readers *= 2)
+                    {
+                        EngineInterop.MeasureConcurrentVoxelReads(readers, 500, out double readsPerSecond, out uint torn);
+                        LogToConsole($"{readers} readers: {readsPerSecond / 1e6:F1} M reads/s, {torn} torn reads");
+                    }
+                    break;
+                case "memory":
+                    string[] categories = { "voxels", "meshes", "arena", "total", "cache", "entities" };
+                    if (parts.Length > 2)
+                    {
+                        int category = Array.IndexOf(categories, parts[1].ToLower());
+                        if (category >= 0 && ulong.TryParse(parts[2], out ulong megabytes))
+                        {
+                            EngineInterop.SetMemoryBudget((uint)category, megabytes * 1024 * 1024);
+                            LogToConsole($"{categories[category]} budget set to {megabytes} MB");
+                        }
+                        else
+                        {
+                            LogToConsole("Usage: memory [voxels|meshes|arena|total|cache|entities <MB>]");
+                        }
+                        break;
+                    }
+                    for (uint category = 0; category < categories.Length; ++category)
+                    {
+                        EngineInterop.GetMemoryStats(category, out ulong bytes, out ulong peak, out ulong budget, out uint evictions);
+                        string limit = budget > 0 ? $"{budget / (1024 * 1024)} MB" : "unlimited";
+                        LogToConsole($"{categories[category]}: {bytes / 1024} KB (peak {peak / 1024} KB, budget {limit}, {evictions} evictions)");
+                    }
+                    EngineInterop.GetChunkResidency(out uint resident, out uint evicted, out uint persisted);
+                    LogToConsole($"chunks: {resident} resident, {evicted} evicted ({persisted} paged to disk)");
+                    break;
+                case "meshcache":
+                    if (parts.Length > 1 && parts[1].ToLower() == "bench")
+                    {
+                        int radius = parts.Length > 2 && int.TryParse(parts[2], out int r) ? r : 4;
+                        EngineInterop.MeasureMeshCacheStartup(12345, radius, out float coldFrame, out float warmFrame,
+                            out float coldMesh, out float warmMesh, out uint warmHits);
+                        LogToConsole($"Cold start: {coldFrame:F1} ms to first frame ({coldMesh:F1} ms meshing)");
+                        LogToConsole($"Warm start: {warmFrame:F1} ms to first frame ({warmMesh:F1} ms meshing, {warmHits} cached meshes)");
+                    }
+                    else
+                    {
+                        EngineInterop.GetMeshCacheStats(out uint hits, out uint misses, out uint entries, out ulong fileBytes);
+                        LogToConsole($"Mesh cache: {entries} meshes, {fileBytes / 1024} KB on disk, {hits} hits, {misses} misses");
+                    }
+                    break;
+                case "arena":
+                    if (parts.Length > 1 && parts[1].ToLower() == "bench")
+                    {
+                        uint meshes = parts.Length > 2 && uint.TryParse(parts[2], out uint m) ? m : 2000;
+                        EngineInterop.MeasureMeshArenaChurn(meshes, 600, out float milliseconds, out float fragmentation,
+                            out uint defragmentations, out ulong dirtyBytes);
+                        LogToConsole($"{meshes} meshes: {milliseconds:F3} ms per frame, {fragmentation:P0} average fragmentation");
+                        LogToConsole($"{defragmentations} defragmentations in 600 frames, {dirtyBytes / 1024} KB re-uploaded per frame");
+                    }
+                    else
+                    {
+                        EngineInterop.GetMeshArenaStats(out uint meshCount, out float fragmentation, out uint defragmentations,
+                            out ulong defragmentedBytes);
+                        LogToConsole($"Mesh arena: {meshCount} meshes, {fragmentation:P0} fragmented, " +
+                            $"{defragmentations} defragmentations moved {defragmentedBytes / 1024} KB");
+                    }
+                    break;
+                case "genbench":
+                    {
+                        int radius = parts.Length > 1 && int.TryParse(parts[1], out int r) ? r : 6;
+                        float[] stageRates = new float[4];
+                        EngineInterop.MeasureWorldGeneration(12345, radius, out float milliseconds, out uint chunks, stageRates);
+                        LogToConsole($"Generated {chunks} chunks in {milliseconds:F1} ms");
+                        LogToConsole($"Chunks per worker second: density {stageRates[0]:F0}, caves {stageRates[1]:F0}, " +
+                            $"surface {stageRates[2]:F0}, decoration {stageRates[3]:F0}");
+                    }
+                    break;
+                case "query":
+                    if (parts.Length > 1 && byte.TryParse(parts[1], out byte queryType))
+                    {
+                        float queryRadius = parts.Length > 2 && float.TryParse(parts[2], out float qr) ? qr : 32.0f;
+                        EngineInterop.GetCameraPosition(out float qx, out float qy, out float qz);
+                        ulong matches = EngineInterop.CountVoxelsInSphere(qx, qy, qz, queryRadius, queryType);
+                        LogToConsole($"{matches} voxels of type {queryType} within {queryRadius:F0} of the camera");
+                        if (EngineInterop.FindVoxelInSphere(qx, qy, qz, queryRadius, queryType, out int fx, out int fy, out int fz))
+                        {
+                            LogToConsole($"First at ({fx}, {fy}, {fz})");
+                        }
+                    }
+                    else
+                    {
+                        LogToConsole("Usage: query <blockType> [radius]");
+                    }
+                    break;
+                case "path":
+                    if (parts.Length > 3 &&
+                        float.TryParse(parts[1], out float pathX) &&
+                        float.TryParse(parts[2], out float pathY) &&
+                        float.TryParse(parts[3], out float pathZ))
+                    {
+                        EngineInterop.GetCameraPosition(out float fromX, out float fromY, out float fromZ);
+                        int[] positions = new int[3 * 1024];
+                        uint length = EngineInterop.FindPath(fromX, fromY, fromZ, pathX, pathY, pathZ, positions, 1024);
+                        if (length == 0)
+                        {
+                            LogToConsole("No path");
+                        }
+                        else
+                        {
+                            LogToConsole($"Path of {length - 1} steps from ({positions[0]}, {positions[1]}, {positions[2]})");
+                        }
+                        EngineInterop.GetNavigationStats(out uint navChunks, out uint navRegions, out uint navPortals, out float navRebuildMs);
+                        LogToConsole($"Navigation: {navChunks} chunks, {navRegions} regions, {navPortals} portals, last rebuild {navRebuildMs:F2} ms");
+                    }
+                    else
+                    {
+                        LogToConsole("Usage: path <x> <y> <z>");
+                    }
+                    break;
+                case "pathbench":
+                    {
+                        uint paths = parts.Length > 1 && uint.TryParse(parts[1], out uint p) ? p : 2000;
+                        EngineInterop.MeasurePathfinding(12345, 8, paths, 200, out float pathsPerSecond, out float rebuildUs,
+                            out uint found, out uint invalid, out uint mismatches);
+                        LogToConsole($"{found} of {paths} paths found, {pathsPerSecond:F0} paths/s, {rebuildUs:F1} us rebuild per edit");
+                        LogToConsole($"{invalid} invalid paths, {mismatches} mismatches with a fresh graph");
+                    }
+                    break;
+                case "querybench":
+                    {
+                        int radius = parts.Length > 1 && int.TryParse(parts[1], out int r) ? r : 16;
+                        EngineInterop.MeasureVoxelQueries(12345, 4, radius, 32, out float naiveMs, out float queryMs, out uint mismatches);
+                        float speedup = queryMs > 0 ? naiveMs / queryMs : 0;
+                        LogToConsole($"Per-voxel reads {naiveMs:F1} ms, queries {queryMs:F1} ms ({speedup:F1}x), {mismatches} mismatches");
+                    }
+                    break;
+                case "chunkbench":
+                    {
+                        int radius = parts.Length > 1 && int.TryParse(parts[1], out int r) ? r : 2;
+                        int[] sizes = new int[3];
+                        uint[] chunkCounts = new uint[3];
+                        uint[] drawCalls = new uint[3];
+                        float[] generationMs = new float[3];
+                        float[] meshMs = new float[3];
+                        float[] remeshUs = new float[3];
+                        float[] lookupNs = new float[3];
+                        ulong[] memoryBytes = new ulong[3];
+                        EngineInterop.MeasureChunkSizes(12345, radius, sizes, chunkCounts, drawCalls, generationMs, meshMs,
+                            remeshUs, lookupNs, memoryBytes);
+                        for (int i = 0; i < sizes.Length; i++)
+                        {
+                            LogToConsole($"{sizes[i]}^3: {chunkCounts[i]} chunks, {drawCalls[i]} draws, generate {generationMs[i]:F1} ms, " +
+                                $"mesh {meshMs[i]:F1} ms ({remeshUs[i]:F0} us per chunk), lookup {lookupNs[i]:F1} ns, " +
+                                $"{memoryBytes[i] / (1024 * 1024)} MB");
+                        }
+                    }
+                    break;
+                case "netbench":
+                    {
+                        uint clients = parts.Length > 1 && uint.TryParse(parts[1], out uint c) ? c : 4;
+                        uint edits = parts.Length > 2 && uint.TryParse(parts[2], out uint e) ? e : 64;
+                        EngineInterop.MeasureReplication(12345, 4, clients, edits, 600, out float kilobytesPerSecond,
+                            out float encodeRate, out float decodeRate, out float ratio, out uint mismatches);
+                        LogToConsole($"{clients} clients, {edits} edits per frame: {kilobytesPerSecond:F1} KB/s at 60 Hz, " +
+                            $"{ratio:F1}x smaller than raw voxels");
+                        LogToConsole($"Encode {encodeRate:F1} MB/s, decode {decodeRate:F1} MB/s, {mismatches} mismatched voxels");
+                    }
+                    break;
+                case "physics":
+                    if (parts.Length > 1 && parts[1].ToLower() == "bench")
+                    {
+                        uint count = parts.Length > 2 && uint.TryParse(parts[2], out uint requested) ? requested : 4000;
+                        EngineInterop.MeasurePhysicsStep(count, 120, out float stepMs, out float maxStepMs, out uint contacts);
+                        LogToConsole($"{count} bodies: {stepMs:F2} ms per step, {maxStepMs:F2} ms worst, {contacts} contact pairs");
+                    }
+                    else
+                    {
+                        EngineInterop.GetPhysicsStats(out uint bodies, out uint contacts, out float stepMs);
+                        LogToConsole($"Physics: {bodies} bodies, {contacts} contact pairs, {stepMs:F2} ms last step");
+                    }
+                    break;
+                case "particles":
+                    {
+                        uint count = parts.Length > 1 && uint.TryParse(parts[1], out uint requested) ? requested : 1000;
+                        EngineInterop.GetCameraPosition(out float camX, out float camY, out float camZ);
+                        uint spawned = EngineInterop.SpawnParticles(camX, camY, camZ, count, 8.0f, 10.0f);
+                        LogToConsole($"Spawned {spawned} particles");
+                    }
+                    break;
+                case "entities":
+                    if (parts.Length > 1 && parts[1].ToLower() == "bench")
+                    {
+                        uint count = parts.Length > 2 && uint.TryParse(parts[2], out uint requested) ? requested : 100000;
+                        EngineInterop.MeasureEntityUpdate(count, 120, out float frameMs, out float perSecond);
+                        LogToConsole($"{count} entities: {frameMs:F2} ms per frame, {perSecond / 1e6f:F1} M entity updates/s");
+                    }
+                    else
+                    {
+                        EngineInterop.GetEntityStats(out uint entities, out uint archetypes, out uint phases, out float updateMs);
+                        LogToConsole($"Entities: {entities} in {archetypes} archetypes, {phases} system phases, {updateMs:F2} ms last update");
+                    }
+                    break;
+                case "raster":
+                    if (parts.Length > 1 && parts[1].ToLower() == "check")
+                    {
+                        string? referencePath = parts.Length > 2 ? parts[2] : null;
+                        bool matches = EngineInterop.CheckReferenceImage(referencePath, out ulong referenceHash);
+                        LogToConsole(matches
+                            ? $"Reference image matches ({referenceHash:x16})"
+                            : $"Reference image differs: hash {referenceHash:x16}");
+                    }
+                    else
+                    {
+                        uint frames = 60;
+                        int pathIndex = 1;
+                        if (parts.Length > 1 && uint.TryParse(parts[1], out uint requested))
+                        {
+                            frames = requested;
+                            pathIndex = 2;
+                        }
+                        string? imagePath = parts.Length > pathIndex ? parts[pathIndex] : null;
+                        if (EngineInterop.MeasureSoftwareRendering(1280, 720, frames, imagePath, out float frameMs,
+                            out float trianglesPerSecond, out uint triangles))
+                        {
+                            LogToConsole($"1280x720: {triangles} triangles, {frameMs:F2} ms per frame, " +
+                                $"{trianglesPerSecond / 1e6f:F1} M triangles/s");
+                            if (imagePath != null)
+                            {
+                                LogToConsole($"Saved {imagePath}");
+                            }
+                        }
+                        else
+                        {
+                            LogToConsole("Software rendering failed");
+                        }
+                    }
+                    break;
                 default:
                     LogToConsole($"Unknown command: {parts[0]}");
                     break;